@@ -12,8 +12,12 @@
 
 #include <acdriver/NonStandard.h>
 #include <plist/Dictionary.h>
+#include <car/Facet.h>
+#include <car/Rendition.h>
 #include <car/Writer.h>
+#include <xcassets/Slot/Idiom.h>
 
+#include <functional>
 #include <memory>
 #include <string>
 #include <utility>
@@ -24,6 +28,9 @@ namespace libutil { class Filesystem; }
 namespace xcassets { namespace Asset { class Asset; } }
 
 namespace acdriver {
+
+class Result;
+
 namespace Compile {
 
 /*
@@ -42,6 +49,23 @@ public:
         Folder,
     };
 
+public:
+    /*
+     * Loads a rendition for the compiled archive. Runs on a worker thread,
+     * so must not touch shared state. On failure, sets an error message.
+     */
+    using RenditionLoader = std::function<ext::optional<car::Rendition>(std::string *error)>;
+
+    /*
+     * A rendition for the compiled archive: the file it is loaded from, the
+     * facet it belongs to, and how to load it.
+     */
+    struct PendingRendition {
+        std::string     path;
+        car::Facet      facet;
+        RenditionLoader loader;
+    };
+
 private:
     std::string                        _root;
     Format                             _format;
@@ -50,9 +74,13 @@ private:
     ext::optional<std::string>         _appIcon;
     ext::optional<std::string>         _launchImage;
     NonStandard::ImageTypeSet          _allowedNonStandardImageTypes;
+    car::Rendition::Compression        _compression;
+    std::vector<xcassets::Slot::Idiom> _targetIdioms;
+    ext::optional<double>              _targetScale;
 
 private:
     ext::optional<car::Writer>         _car;
+    std::vector<PendingRendition>      _renditions;
     std::vector<std::pair<std::string, std::string>> _copies;
     std::unique_ptr<plist::Dictionary> _additionalInfo;
 
@@ -101,6 +129,37 @@ public:
     NonStandard::ImageTypeSet const &allowedNonStandardImageTypes() const
     { return _allowedNonStandardImageTypes; }
 
+    /*
+     * How to compress image data in the compiled catalog.
+     */
+    car::Rendition::Compression compression() const
+    { return _compression; }
+    car::Rendition::Compression &compression()
+    { return _compression; }
+
+    /*
+     * The idioms of the devices to compile for. If empty, images for
+     * every idiom are compiled.
+     */
+    std::vector<xcassets::Slot::Idiom> const &targetIdioms() const
+    { return _targetIdioms; }
+    std::vector<xcassets::Slot::Idiom> &targetIdioms()
+    { return _targetIdioms; }
+
+    /*
+     * The scale of the device to compile for, if only one. Image sets then
+     * keep just the image closest to this scale for each slot.
+     */
+    ext::optional<double> const &targetScale() const
+    { return _targetScale; }
+    ext::optional<double> &targetScale()
+    { return _targetScale; }
+
+    /*
+     * If images for an idiom can be used on the devices compiled for.
+     */
+    bool targetsIdiom(xcassets::Slot::Idiom idiom) const;
+
 public:
     /*
      * If the format is compiled, the compiled catalog writer.
@@ -110,6 +169,22 @@ public:
     ext::optional<car::Writer> &car()
     { return _car; }
 
+    /*
+     * Renditions to load into the compiled catalog.
+     */
+    std::vector<PendingRendition> const &renditions() const
+    { return _renditions; }
+    std::vector<PendingRendition> &renditions()
+    { return _renditions; }
+
+    /*
+     * Load the pending renditions in parallel, then add them to the compiled
+     * catalog in order. Each facet is added before its first rendition that
+     * loads, so facets with no renditions are left out. Errors are reported,
+     * but do not stop the rest from loading. Returns which renditions loaded.
+     */
+    std::vector<bool> loadRenditions(Result *result);
+
     /*
      * Files to copy into the output.
      */
@@ -53,12 +53,18 @@ public:
     private:
         ext::optional<bool>        _allowNonStandardBehavior;
         ImageTypeSet               _allowImageTypes;
+        ext::optional<std::string> _filterForDeviceScale;
 
     public:
         bool allowNonStandardBehavior() const
         { return _allowNonStandardBehavior.value_or(false); }
         ImageTypeSet allowImageTypes() const
         { return _allowImageTypes; }
+        /*
+         * The scale of the device to compile images for, such as "2x".
+         */
+        ext::optional<std::string> const &filterForDeviceScale() const
+        { return _filterForDeviceScale; }
 
     public:
         ext::optional<std::pair<bool, std::string>> parseArgument(std::vector<std::string> const &args, std::vector<std::string>::const_iterator *it);
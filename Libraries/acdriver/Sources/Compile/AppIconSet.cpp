@@ -89,7 +89,10 @@ Compile(
             std::string scaleSuffix = Convert::ScaleSuffix(scale);
 
             xcassets::Slot::Idiom idiom = image.idiom().value_or(xcassets::Slot::Idiom::Universal);
-            // TODO: skip images with idioms inappropriate for target platform
+            if (!compileOutput->targetsIdiom(idiom)) {
+                /* Not used by any device being compiled for. */
+                continue;
+            }
             std::string idiomSuffix = Convert::IdiomSuffix(idiom);
 
             /*
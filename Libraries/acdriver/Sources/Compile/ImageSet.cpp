@@ -32,6 +32,64 @@ using acdriver::Result;
 using libutil::Filesystem;
 using libutil::FSUtil;
 
+/*
+ * If two images fill the same slot except for their scale.
+ */
+static bool
+SameSlotExceptScale(
+    xcassets::Asset::ImageSet::Image const &a,
+    xcassets::Asset::ImageSet::Image const &b)
+{
+    return (a.idiom() == b.idiom() &&
+            a.subtype() == b.subtype() &&
+            a.screenWidth() == b.screenWidth() &&
+            a.widthClass() == b.widthClass() &&
+            a.heightClass() == b.heightClass() &&
+            a.memory() == b.memory() &&
+            a.graphicsFeatureSet() == b.graphicsFeatureSet() &&
+            a.colorSpace() == b.colorSpace());
+}
+
+/*
+ * If an image could be used by the devices being compiled for. Images for
+ * other idioms are skipped, as are images at a scale other than the one
+ * closest to the target scale in the same slot: the smallest scale at least
+ * as large as the target, or the largest scale if all are smaller.
+ */
+static bool
+ImageTargeted(
+    xcassets::Asset::ImageSet const *imageSet,
+    xcassets::Asset::ImageSet::Image const &image,
+    Output const *compileOutput)
+{
+    if (image.idiom() && !compileOutput->targetsIdiom(*image.idiom())) {
+        return false;
+    }
+
+    if (!compileOutput->targetScale() || !image.scale()) {
+        return true;
+    }
+
+    double target = *compileOutput->targetScale();
+    ext::optional<double> best;
+    for (xcassets::Asset::ImageSet::Image const &other : *imageSet->images()) {
+        if (!other.fileName() || other.unassigned() || !other.scale() || !SameSlotExceptScale(image, other)) {
+            continue;
+        }
+
+        double scale = other.scale()->value();
+        if (!best) {
+            best = scale;
+        } else if (*best < target) {
+            best = std::max(*best, scale);
+        } else if (scale >= target) {
+            best = std::min(*best, scale);
+        }
+    }
+
+    return (!best || image.scale()->value() == *best);
+}
+
 bool ImageSet::
 Compile(
     xcassets::Asset::ImageSet const *imageSet,
@@ -43,6 +101,11 @@ Compile(
 
     if (imageSet->images()) {
         for (xcassets::Asset::ImageSet::Image const &image : *imageSet->images()) {
+            /* Skip images before reading them if no target device uses them. */
+            if (!ImageTargeted(imageSet, image, compileOutput)) {
+                continue;
+            }
+
             if (!CompileAsset(imageSet, image, filesystem, compileOutput, result)) {
                 success = false;
             }
@@ -59,6 +122,69 @@ GenerateIdentifier(void) {
     return last;
 }
 
+/*
+ * Read an image and convert it to the archive format. Safe to call from
+ * multiple threads at once. PNG images are decoded; others are stored as-is.
+ */
+static ext::optional<car::Rendition::Data>
+LoadData(
+    Filesystem const *filesystem,
+    std::string const &filename,
+    ext::optional<car::Rendition::Data::Format> rawFormat,
+    std::string const &readError,
+    size_t *width,
+    size_t *height,
+    std::string *error)
+{
+    ext::optional<libutil::MappedFile> contents = filesystem->map(filename);
+    if (!contents) {
+        *error = readError;
+        return ext::nullopt;
+    }
+
+    if (rawFormat) {
+        ext::span<uint8_t const> raw = contents->contents();
+        return car::Rendition::Data(std::vector<uint8_t>(raw.begin(), raw.end()), *rawFormat);
+    }
+
+    auto png = graphics::Format::PNG::Read(contents->contents());
+    if (!png.first) {
+        *error = png.second;
+        return ext::nullopt;
+    }
+
+    graphics::Image const &image = *png.first;
+    *width = image.width();
+    *height = image.height();
+
+    /* Convert the image to the archive format. */
+    switch (image.format().color()) {
+        case graphics::PixelFormat::Color::RGB:
+            return car::Rendition::Data(
+                graphics::PixelFormat::Convert(
+                    image.data(),
+                    image.format(),
+                    graphics::PixelFormat(
+                        graphics::PixelFormat::Color::RGB,
+                        graphics::PixelFormat::Order::Reversed,
+                        graphics::PixelFormat::Alpha::PremultipliedFirst)),
+                car::Rendition::Data::Format::PremultipliedBGRA8);
+        case graphics::PixelFormat::Color::Grayscale:
+            return car::Rendition::Data(
+                graphics::PixelFormat::Convert(
+                    image.data(),
+                    image.format(),
+                    graphics::PixelFormat(
+                        graphics::PixelFormat::Color::Grayscale,
+                        graphics::PixelFormat::Order::Reversed,
+                        graphics::PixelFormat::Alpha::PremultipliedFirst)),
+                car::Rendition::Data::Format::PremultipliedGA8);
+    }
+
+    *error = "unsupported image format";
+    return ext::nullopt;
+}
+
 bool ImageSet::
 CompileAsset(
     xcassets::Asset::ImageSet const *imageSet,
@@ -89,67 +215,19 @@ CompileAsset(
         scale = image.scale()->value();
     }
 
-    // TODO: filter by target-device / device-model / os-version
     uint16_t idiom = Convert::IdiomAttribute(*image.idiom());
 
-    std::vector<uint8_t> pixels;
-    size_t width = 0;
-    size_t height = 0;
-    car::Rendition::Data::Format format = car::Rendition::Data::Format::Data;
+    /*
+     * Formats other than PNG are stored as-is; determine which before loading.
+     */
+    ext::optional<car::Rendition::Data::Format> rawFormat;
+    std::string readError;
 
     if (FSUtil::IsFileExtension(filename, "png", true)) {
-        std::vector<uint8_t> contents;
-        if (!filesystem->read(&contents, filename)) {
-            result->normal(
-                Result::Severity::Error,
-                "unable to read PNG file",
-                filename);
-            return false;
-        }
-
-        auto png = graphics::Format::PNG::Read(contents);
-        if (!png.first) {
-            result->normal(Result::Severity::Error, png.second, filename);
-            return false;
-        }
-
-        graphics::Image const &image = *png.first;
-        width = image.width();
-        height = image.height();
-
-        /* Convert the image to the archive format. */
-        switch (image.format().color()) {
-            case graphics::PixelFormat::Color::RGB:
-                format = car::Rendition::Data::Format::PremultipliedBGRA8;
-                pixels = graphics::PixelFormat::Convert(
-                    image.data(),
-                    image.format(),
-                    graphics::PixelFormat(
-                        graphics::PixelFormat::Color::RGB,
-                        graphics::PixelFormat::Order::Reversed,
-                        graphics::PixelFormat::Alpha::PremultipliedFirst));
-                break;
-            case graphics::PixelFormat::Color::Grayscale:
-                format = car::Rendition::Data::Format::PremultipliedGA8;
-                pixels = graphics::PixelFormat::Convert(
-                    image.data(),
-                    image.format(),
-                    graphics::PixelFormat(
-                        graphics::PixelFormat::Color::Grayscale,
-                        graphics::PixelFormat::Order::Reversed,
-                        graphics::PixelFormat::Alpha::PremultipliedFirst));
-                break;
-        }
+        readError = "unable to read PNG file";
     } else if (FSUtil::IsFileExtension(filename, "jpg", true) || FSUtil::IsFileExtension(filename, "jpeg", true)) {
-        if (!filesystem->read(&pixels, filename)) {
-            result->normal(
-                Result::Severity::Error,
-                "unable to read JPEG file",
-                filename);
-            return false;
-        }
-
-        format = car::Rendition::Data::Format::JPEG;
+        rawFormat = car::Rendition::Data::Format::JPEG;
+        readError = "unable to read JPEG file";
     } else {
         ext::optional<NonStandard::ImageType> type = NonStandard::ImageTypeFromFileExtension(FSUtil::GetFileExtension(filename));
         if (!type) {
@@ -166,34 +244,25 @@ CompileAsset(
                 filename);
             return false;
         }
-        if (!filesystem->read(&pixels, filename)) {
-            result->normal(
-                Result::Severity::Error,
-                "unable to read image file",
-                filename);
-            return false;
-        }
-        format = NonStandard::ImageTypeToDataFormat(*type);
+        rawFormat = NonStandard::ImageTypeToDataFormat(*type);
+        readError = "unable to read image file";
     }
 
-    bool createFacet = false;
     uint16_t facetIdentifier = 0;
     auto it = idMap.find(name);
     if (it == idMap.end()) {
         facetIdentifier = GenerateIdentifier();
         idMap[name] = facetIdentifier;
-        createFacet = true;
     } else {
         facetIdentifier = it->second;
     }
-    if (createFacet) {
-        car::AttributeList attributes = car::AttributeList({
-            { car_attribute_identifier_identifier, facetIdentifier },
-        });
 
-        car::Facet facet = car::Facet::Create(name, attributes);
-        compileOutput->car()->addFacet(facet);
-    }
+    /*
+     * The facet is only added once one of its renditions loads.
+     */
+    car::Facet facet = car::Facet::Create(name, car::AttributeList({
+        { car_attribute_identifier_identifier, facetIdentifier },
+    }));
 
     /*
      * Create rendition for the image.
@@ -204,34 +273,49 @@ CompileAsset(
         { car_attribute_identifier_identifier, facetIdentifier },
     });
 
-    auto data = ext::optional<car::Rendition::Data>(car::Rendition::Data(std::move(pixels), format));
+    /*
+     * Reading and converting the image is deferred so images can load in parallel.
+     */
+    std::string fileName = *image.fileName();
+    ext::optional<xcassets::Resizing> resizing = image.resizing();
+    Filesystem const *readFilesystem = filesystem;
+    car::Rendition::Compression compression = compileOutput->compression();
 
-    car::Rendition rendition = car::Rendition::Create(attributes, std::move(data));
-    rendition.width() = width;
-    rendition.height() = height;
-    rendition.scale() = scale;
-    rendition.fileName() = *image.fileName();
+    compileOutput->renditions().push_back({ filename, facet, [=](std::string *error) -> ext::optional<car::Rendition> {
+        size_t width = 0;
+        size_t height = 0;
+        ext::optional<car::Rendition::Data> data = LoadData(readFilesystem, filename, rawFormat, readError, &width, &height, error);
+        if (!data) {
+            return ext::nullopt;
+        }
+
+        car::Rendition rendition = car::Rendition::Create(attributes, std::move(data));
+        rendition.width() = width;
+        rendition.height() = height;
+        rendition.scale() = scale;
+        rendition.fileName() = fileName;
+        rendition.compression() = compression;
 
-    if (image.resizing()) {
-        xcassets::Resizing const &resizing = *image.resizing();
+        if (resizing) {
+            xcassets::Resizing::Center::Mode centerMode = xcassets::Resizing::Center::Mode::Tile;
+            if (resizing->center()) {
+                xcassets::Resizing::Center const &center = *resizing->center();
+                if (center.mode()) {
+                    centerMode = *center.mode();
+                }
 
-        xcassets::Resizing::Center::Mode centerMode = xcassets::Resizing::Center::Mode::Tile;
-        if (resizing.center()) {
-            xcassets::Resizing::Center const &center = *resizing.center();
-            if (center.mode()) {
-                centerMode = *center.mode();
+                /* TODO: center size is currently ingnored */
             }
 
-            /* TODO: center size is currently ingnored */
+            if (resizing->mode()) {
+                xcassets::Resizing::Mode resizingMode = *resizing->mode();
+                rendition.layout() = Convert::LayoutForResizingAndCenterMode(resizingMode, centerMode);
+                rendition.slices() = Convert::SlicesForResizingModeAndCapInsets(width, height, resizingMode, resizing->capInsets());
+            }
         }
 
-        if (resizing.mode()) {
-            xcassets::Resizing::Mode resizingMode = *resizing.mode();
-            rendition.layout() = Convert::LayoutForResizingAndCenterMode(resizingMode, centerMode);
-            rendition.slices() = Convert::SlicesForResizingModeAndCapInsets(width, height, resizingMode, resizing.capInsets());
-        }
-    }
+        return rendition;
+    } });
 
-    compileOutput->car()->addRendition(std::move(rendition));
     return true;
 }
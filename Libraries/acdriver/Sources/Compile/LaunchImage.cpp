@@ -226,7 +226,9 @@ Compile(
                 continue;
             }
 
-            // TODO: skip images with idioms inappropriate for target platform
+            if (!compileOutput->targetsIdiom(*image.idiom())) {
+                continue;
+            }
 
             /*
              * Get the expected size for the launch image.
@@ -17,12 +17,18 @@
 #include <plist/Format/Format.h>
 #include <plist/Format/XML.h>
 #include <libutil/Filesystem.h>
+#include <libutil/WorkQueue.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <unordered_set>
 
 using acdriver::Compile::Output;
 using acdriver::Version;
 using acdriver::Options;
 using acdriver::Result;
 using libutil::Filesystem;
+using libutil::WorkQueue;
 
 Output::
 Output(
@@ -36,10 +42,92 @@ Output(
     _appIcon                     (appIcon),
     _launchImage                 (launchImage),
     _allowedNonStandardImageTypes (allowedNonStandardImageTypes),
+    _compression                 (car::Rendition::Compression::Default),
     _additionalInfo              (plist::Dictionary::New())
 {
 }
 
+bool Output::
+targetsIdiom(xcassets::Slot::Idiom idiom) const
+{
+    if (_targetIdioms.empty()) {
+        return true;
+    }
+
+    switch (idiom) {
+        case xcassets::Slot::Idiom::Universal:
+            /* Used on any device without a more specific image. */
+            return true;
+        case xcassets::Slot::Idiom::iOSMarketing:
+            /* The App Store icon is included with any iOS device. */
+            return (std::find(_targetIdioms.begin(), _targetIdioms.end(), xcassets::Slot::Idiom::Phone) != _targetIdioms.end() ||
+                    std::find(_targetIdioms.begin(), _targetIdioms.end(), xcassets::Slot::Idiom::Pad) != _targetIdioms.end());
+        case xcassets::Slot::Idiom::Phone:
+        case xcassets::Slot::Idiom::Pad:
+        case xcassets::Slot::Idiom::Desktop:
+        case xcassets::Slot::Idiom::TV:
+        case xcassets::Slot::Idiom::Watch:
+        case xcassets::Slot::Idiom::Car:
+            return (std::find(_targetIdioms.begin(), _targetIdioms.end(), idiom) != _targetIdioms.end());
+    }
+
+    abort();
+}
+
+std::vector<bool> Output::
+loadRenditions(Result *result)
+{
+    struct CompiledRendition {
+        ext::optional<car::AttributeList> attributes;
+        std::vector<uint8_t>              value;
+        std::string                       error;
+    };
+
+    /*
+     * Load, convert, and encode each rendition in parallel. Renditions with
+     * the same pixels share compressed data, so are only compressed once.
+     */
+    std::vector<CompiledRendition> compiled = std::vector<CompiledRendition>(_renditions.size());
+    car::Rendition::EncodeCache cache;
+    {
+        WorkQueue queue(WorkQueue::DefaultThreadCount());
+        for (size_t i = 0; i < _renditions.size(); ++i) {
+            queue.enqueue([this, &compiled, &cache, i] {
+                ext::optional<car::Rendition> rendition = _renditions[i].loader(&compiled[i].error);
+                if (rendition) {
+                    compiled[i].value = rendition->write(&cache);
+                    compiled[i].attributes = rendition->attributes();
+                }
+            });
+        }
+
+        /* Destroying the queue waits for all renditions to finish. */
+    }
+
+    /*
+     * Add renditions and report errors in order, for consistent output.
+     */
+    std::vector<bool> loaded = std::vector<bool>(_renditions.size(), false);
+    std::unordered_set<std::string> facets;
+    for (size_t i = 0; i < _renditions.size(); ++i) {
+        if (!compiled[i].attributes) {
+            result->normal(Result::Severity::Error, compiled[i].error, _renditions[i].path);
+            continue;
+        }
+
+        if (_car) {
+            if (facets.insert(_renditions[i].facet.name()).second) {
+                _car->addFacet(_renditions[i].facet);
+            }
+            _car->addRendition(*compiled[i].attributes, compiled[i].value);
+        }
+        loaded[i] = true;
+    }
+
+    _renditions.clear();
+    return loaded;
+}
+
 std::string Output::
 AssetReference(xcassets::Asset::Asset const *asset)
 {
@@ -15,6 +15,8 @@
 #include <acdriver/Output.h>
 #include <acdriver/Result.h>
 #include <xcassets/Asset/Catalog.h>
+#include <xcassets/Slot/Idiom.h>
+#include <xcassets/Slot/Scale.h>
 #include <xcassets/Slot/SystemVersion.h>
 #include <bom/bom.h>
 #include <car/Reader.h>
@@ -29,6 +31,8 @@
 #include <libutil/Filesystem.h>
 #include <libutil/FSUtil.h>
 
+#include <algorithm>
+
 using acdriver::CompileAction;
 namespace Compile = acdriver::Compile;
 using acdriver::Version;
@@ -166,6 +170,20 @@ DetermineOutputFormat(ext::optional<std::string> const &minimumDeploymentTarget)
     }
 }
 
+static ext::optional<car::Rendition::Compression>
+DetermineCompression(ext::optional<std::string> const &optimization)
+{
+    if (!optimization) {
+        return car::Rendition::Compression::Default;
+    } else if (*optimization == "time") {
+        return car::Rendition::Compression::Fast;
+    } else if (*optimization == "space") {
+        return car::Rendition::Compression::Small;
+    } else {
+        return ext::nullopt;
+    }
+}
+
 static ext::optional<car::Writer>
 CreateWriter(std::string const &path)
 {
@@ -189,10 +207,6 @@ WarnUnsupportedOptions(Options const &options, Result *result)
         result->normal(Result::Severity::Warning, "product type not supported");
     }
 
-    if (options.optimization()) {
-        result->normal(Result::Severity::Warning, "optimization not supported");
-    }
-
     if (options.compressPNGs()) {
         result->normal(Result::Severity::Warning, "compress PNGs not supported");
     }
@@ -214,10 +228,6 @@ WarnUnsupportedOptions(Options const &options, Result *result)
         result->normal(Result::Severity::Warning, "leaderboard set not supportd");
     }
 
-    if (!options.targetDevice().empty()) {
-        result->normal(Result::Severity::Warning, "target device not supported");
-    }
-
     if (options.targetName()) {
         result->normal(Result::Severity::Warning, "target name not supported");
     }
@@ -268,6 +278,38 @@ run(Filesystem *filesystem, Options const &options, Output *output, Result *resu
         options.launchImage(),
         options.nonStandardOptions().allowImageTypes());
 
+    /*
+     * Determine how to compress images, trading size for speed.
+     */
+    ext::optional<car::Rendition::Compression> compression = DetermineCompression(options.optimization());
+    if (!compression) {
+        result->normal(Result::Severity::Error, "invalid optimization: " + *options.optimization());
+        return;
+    }
+    compileOutput.compression() = *compression;
+
+    /*
+     * Determine which devices to compile for. Images for other devices
+     * are skipped before they are read.
+     */
+    for (std::string const &targetDevice : options.targetDevice()) {
+        ext::optional<xcassets::Slot::Idiom> idiom = xcassets::Slot::Idioms::Parse(targetDevice);
+        if (!idiom) {
+            result->normal(Result::Severity::Error, "invalid target device: " + targetDevice);
+            return;
+        }
+        compileOutput.targetIdioms().push_back(*idiom);
+    }
+
+    if (options.nonStandardOptions().filterForDeviceScale()) {
+        ext::optional<xcassets::Slot::Scale> scale = xcassets::Slot::Scale::Parse(*options.nonStandardOptions().filterForDeviceScale());
+        if (!scale) {
+            result->normal(Result::Severity::Error, "invalid device scale: " + *options.nonStandardOptions().filterForDeviceScale());
+            return;
+        }
+        compileOutput.targetScale() = scale->value();
+    }
+
     /*
      * If necessary, create output archive to write into.
      */
@@ -287,8 +329,10 @@ run(Filesystem *filesystem, Options const &options, Output *output, Result *resu
     }
 
     /*
-     * Compile each asset catalog into the output.
+     * Compile each asset catalog into the output. Renditions are loaded
+     * later, so note which renditions came from each catalog.
      */
+    std::vector<std::pair<std::string, std::pair<size_t, size_t>>> compiledInputs;
     for (std::string const &input : options.inputs()) {
         /*
          * Load the input asset catalog.
@@ -306,12 +350,30 @@ run(Filesystem *filesystem, Options const &options, Output *output, Result *resu
         /*
          * Compile the asset catalog.
          */
+        size_t firstRendition = compileOutput.renditions().size();
         if (!Compile::Asset::Compile(catalog.get(), filesystem, &compileOutput, result)) {
             /* Error already printed. */
             continue;
         }
 
-        compileOutput.inputs().push_back(input);
+        compiledInputs.push_back({ input, { firstRendition, compileOutput.renditions().size() } });
+    }
+
+    /*
+     * Load the renditions from all catalogs. Errors are reported, but do
+     * not prevent writing the rest of the output.
+     */
+    std::vector<bool> loaded = compileOutput.loadRenditions(result);
+
+    /*
+     * Only catalogs that compiled completely are inputs.
+     */
+    for (auto const &compiledInput : compiledInputs) {
+        auto begin = loaded.begin() + compiledInput.second.first;
+        auto end = loaded.begin() + compiledInput.second.second;
+        if (std::find(begin, end, false) == end) {
+            compileOutput.inputs().push_back(compiledInput.first);
+        }
     }
 
     /*
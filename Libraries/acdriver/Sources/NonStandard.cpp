@@ -37,6 +37,8 @@ parseArgument(std::vector<std::string> const &args, std::vector<std::string>::co
         return libutil::Options::Current<bool>(&_allowNonStandardBehavior, arg);
     } else if (arg == "--allow-image-type") {
         return InsertNextImageType(_allowImageTypes, args, it);
+    } else if (arg == "--filter-for-device-scale") {
+        return libutil::Options::Next<std::string>(&_filterForDeviceScale, args, it);
     } else {
         return ext::nullopt;
     }
@@ -49,6 +51,10 @@ isValid(acdriver::Result *result) const
         result->normal(Result::Severity::Error, "--allow-image-type requires --allow-non-standard-behavior");
         return false;
     }
+    if (!allowNonStandardBehavior() && filterForDeviceScale()) {
+        result->normal(Result::Severity::Error, "--filter-for-device-scale requires --allow-non-standard-behavior");
+        return false;
+    }
     return true;
 }
 
@@ -136,3 +136,60 @@ TEST(AppIconSet, Compile)
     VerifyIcons(info, "CFBundleIcons", { "AppIcon29x29", "AppIcon60x60" });
     VerifyIcons(info, "CFBundleIcons~ipad", { "AppIcon76x76" });
 }
+
+TEST(AppIconSet, CompileTargetDevice)
+{
+    /* Define asset. */
+    MemoryFilesystem filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::Directory("AppIcon.appiconset", {
+            MemoryFilesystem::Entry::File("Contents.json", CONTENTS({
+                "images" : [
+                    {
+                        "size" : "60x60",
+                        "idiom" : "iphone",
+                        "filename" : "two.png",
+                        "scale" : "2x"
+                    },
+                    {
+                      "size" : "76x76",
+                      "idiom" : "ipad",
+                      "filename" : "pad.png",
+                      "scale" : "1x"
+                    },
+                ],
+                "info" : {
+                    "version" : 1,
+                    "author" : "xcode"
+                }
+            })),
+            MemoryFilesystem::Entry::File("two.png", Contents("2x")),
+            MemoryFilesystem::Entry::File("pad.png", Contents("pad")),
+        }),
+    });
+
+    /* Load asset. */
+    auto asset = xcassets::Asset::Asset::Load(
+        &filesystem,
+        filesystem.path("AppIcon.appiconset"),
+        { },
+        xcassets::Asset::AppIconSet::Extension());
+    auto appIconSet = libutil::static_unique_pointer_cast<xcassets::Asset::AppIconSet>(std::move(asset));
+    ASSERT_NE(appIconSet, nullptr);
+
+    /* Compile asset for only the phone. */
+    Result result;
+    Output output = Output(filesystem.path("output"), Output::Format::Compiled, std::string("AppIcon"), ext::nullopt);
+    output.targetIdioms().push_back(xcassets::Slot::Idiom::Phone);
+    ASSERT_TRUE(AppIconSet::Compile(appIconSet.get(), &output, &result));
+    EXPECT_TRUE(result.success());
+
+    /* Should skip the pad icon. */
+    using Copy = std::pair<std::string, std::string>;
+    EXPECT_EQ(output.copies(), std::vector<Copy>({
+        { filesystem.path("AppIcon.appiconset/two.png"), filesystem.path("output/AppIcon60x60@2x.png") },
+    }));
+
+    plist::Dictionary *info = output.additionalInfo();
+    EXPECT_EQ(info->count(), 1);
+    VerifyIcons(info, "CFBundleIcons", { "AppIcon60x60" });
+}
@@ -0,0 +1,198 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <gtest/gtest.h>
+#include <acdriver/Compile/ImageSet.h>
+#include <acdriver/Compile/Output.h>
+#include <acdriver/Result.h>
+#include <bom/bom.h>
+#include <car/Reader.h>
+#include <graphics/Image.h>
+#include <graphics/PixelFormat.h>
+#include <graphics/Format/PNG.h>
+#include <libutil/Filesystem.h>
+#include <libutil/FSUtil.h>
+#include <libutil/MemoryFilesystem.h>
+
+using acdriver::Compile::ImageSet;
+using acdriver::Compile::Output;
+using acdriver::Result;
+using libutil::Filesystem;
+using libutil::FSUtil;
+using libutil::MemoryFilesystem;
+
+static std::vector<uint8_t>
+Contents(std::string const &string)
+{
+    return std::vector<uint8_t>(string.begin(), string.end());
+}
+
+#define CONTENTS(...) Contents(#__VA_ARGS__)
+
+static std::vector<std::string>
+CompiledFiles(
+    std::vector<xcassets::Slot::Idiom> const &targetIdioms,
+    ext::optional<double> const &targetScale)
+{
+    /* Define asset. Images are never read, so the contents don't matter. */
+    MemoryFilesystem filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::Directory("Image.imageset", {
+            MemoryFilesystem::Entry::File("Contents.json", CONTENTS({
+                "images" : [
+                    { "idiom" : "universal", "filename" : "u1.png", "scale" : "1x" },
+                    { "idiom" : "universal", "filename" : "u2.png", "scale" : "2x" },
+                    { "idiom" : "iphone", "filename" : "p2.png", "scale" : "2x" },
+                    { "idiom" : "iphone", "filename" : "p3.png", "scale" : "3x" },
+                    { "idiom" : "ipad", "filename" : "t1.png", "scale" : "1x" },
+                    { "idiom" : "ipad", "filename" : "t2.png", "scale" : "2x" },
+                ],
+                "info" : {
+                    "version" : 1,
+                    "author" : "xcode"
+                }
+            })),
+        }),
+    });
+
+    /* Load asset. */
+    auto asset = xcassets::Asset::Asset::Load(
+        &filesystem,
+        filesystem.path("Image.imageset"),
+        { },
+        xcassets::Asset::ImageSet::Extension());
+    auto imageSet = libutil::static_unique_pointer_cast<xcassets::Asset::ImageSet>(std::move(asset));
+    EXPECT_NE(imageSet, nullptr);
+    if (imageSet == nullptr) {
+        return std::vector<std::string>();
+    }
+
+    /* Compile asset. */
+    Result result;
+    Output output = Output(filesystem.path("output"), Output::Format::Compiled, ext::nullopt, ext::nullopt);
+    output.car() = car::Writer::Create(car::Writer::unique_ptr_bom(bom_alloc_empty(bom_context_memory(NULL, 0)), bom_free));
+    output.targetIdioms() = targetIdioms;
+    output.targetScale() = targetScale;
+    EXPECT_TRUE(ImageSet::Compile(imageSet.get(), &filesystem, &output, &result));
+    EXPECT_TRUE(result.success());
+
+    std::vector<std::string> files;
+    for (auto const &rendition : output.renditions()) {
+        files.push_back(FSUtil::GetBaseName(rendition.path));
+    }
+    return files;
+}
+
+TEST(ImageSet, CompileAll)
+{
+    EXPECT_EQ(CompiledFiles({ }, ext::nullopt), std::vector<std::string>({
+        "u1.png", "u2.png", "p2.png", "p3.png", "t1.png", "t2.png",
+    }));
+}
+
+TEST(ImageSet, CompileTargetDevice)
+{
+    /* Only the targeted idioms, plus universal images. */
+    EXPECT_EQ(CompiledFiles({ xcassets::Slot::Idiom::Phone }, ext::nullopt), std::vector<std::string>({
+        "u1.png", "u2.png", "p2.png", "p3.png",
+    }));
+    EXPECT_EQ(CompiledFiles({ xcassets::Slot::Idiom::Pad, xcassets::Slot::Idiom::TV }, ext::nullopt), std::vector<std::string>({
+        "u1.png", "u2.png", "t1.png", "t2.png",
+    }));
+}
+
+TEST(ImageSet, CompileTargetScale)
+{
+    /* Exact matches, falling back to the closest larger scale. */
+    EXPECT_EQ(CompiledFiles({ xcassets::Slot::Idiom::Phone }, 2.0), std::vector<std::string>({
+        "u2.png", "p2.png",
+    }));
+    EXPECT_EQ(CompiledFiles({ }, 1.5), std::vector<std::string>({
+        "u2.png", "p2.png", "t2.png",
+    }));
+
+    /* Without a large enough image, the largest is used. */
+    EXPECT_EQ(CompiledFiles({ }, 3.0), std::vector<std::string>({
+        "u2.png", "p3.png", "t2.png",
+    }));
+}
+
+static std::unique_ptr<xcassets::Asset::ImageSet>
+LoadImageSet(Filesystem const *filesystem, std::string const &path)
+{
+    auto asset = xcassets::Asset::Asset::Load(filesystem, path, { }, xcassets::Asset::ImageSet::Extension());
+    return libutil::static_unique_pointer_cast<xcassets::Asset::ImageSet>(std::move(asset));
+}
+
+TEST(ImageSet, CompileUnreadable)
+{
+    graphics::PixelFormat format = graphics::PixelFormat(graphics::PixelFormat::Color::RGB, graphics::PixelFormat::Order::Forward, graphics::PixelFormat::Alpha::Last);
+    auto png = graphics::Format::PNG::Write(graphics::Image(1, 1, format, { 1, 2, 3, 255 }));
+    ASSERT_NE(ext::nullopt, png.first);
+
+    std::vector<uint8_t> contents = CONTENTS({
+        "images" : [
+            { "idiom" : "universal", "filename" : "image.png", "scale" : "1x" },
+            { "idiom" : "universal", "filename" : "unreadable.png", "scale" : "2x" },
+        ],
+        "info" : {
+            "version" : 1,
+            "author" : "xcode"
+        }
+    });
+    std::vector<uint8_t> unreadableContents = CONTENTS({
+        "images" : [
+            { "idiom" : "universal", "filename" : "unreadable.png", "scale" : "1x" },
+        ],
+        "info" : {
+            "version" : 1,
+            "author" : "xcode"
+        }
+    });
+
+    MemoryFilesystem filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::Directory("Partial.imageset", {
+            MemoryFilesystem::Entry::File("Contents.json", contents),
+            MemoryFilesystem::Entry::File("image.png", *png.first),
+            MemoryFilesystem::Entry::File("unreadable.png", Contents("not a png")),
+        }),
+        MemoryFilesystem::Entry::Directory("Unreadable.imageset", {
+            MemoryFilesystem::Entry::File("Contents.json", unreadableContents),
+            MemoryFilesystem::Entry::File("unreadable.png", Contents("not a png")),
+        }),
+    });
+
+    auto partial = LoadImageSet(&filesystem, filesystem.path("Partial.imageset"));
+    auto unreadable = LoadImageSet(&filesystem, filesystem.path("Unreadable.imageset"));
+    ASSERT_NE(nullptr, partial);
+    ASSERT_NE(nullptr, unreadable);
+
+    Result result;
+    Output output = Output(filesystem.path("output"), Output::Format::Compiled, ext::nullopt, ext::nullopt);
+    output.car() = car::Writer::Create(car::Writer::unique_ptr_bom(bom_alloc_empty(bom_context_memory(NULL, 0)), bom_free));
+    EXPECT_TRUE(ImageSet::Compile(partial.get(), &filesystem, &output, &result));
+    EXPECT_TRUE(ImageSet::Compile(unreadable.get(), &filesystem, &output, &result));
+
+    /* Loading reports the unreadable images. */
+    EXPECT_EQ(std::vector<bool>({ true, false, false }), output.loadRenditions(&result));
+    EXPECT_FALSE(result.success());
+    output.car()->write();
+
+    /* Only facets with a loaded rendition are written. */
+    struct bom_context_memory const *memory = bom_memory(output.car()->bom());
+    auto bom = std::unique_ptr<struct bom_context, decltype(&bom_free)>(bom_alloc_load(bom_context_memory(memory->data, memory->size)), bom_free);
+    ext::optional<car::Reader> reader = car::Reader::Load(std::move(bom));
+    ASSERT_NE(ext::nullopt, reader);
+
+    std::vector<std::string> facets;
+    reader->facetIterate([&](car::Facet const &facet) {
+        facets.push_back(facet.name());
+        EXPECT_EQ(1u, reader->lookupRenditions(facet).size());
+    });
+    EXPECT_EQ(std::vector<std::string>({ "Partial" }), facets);
+}
@@ -17,6 +17,7 @@
 #include <string>
 #include <vector>
 #include <ext/optional>
+#include <ext/span>
 
 namespace dependency {
 
@@ -71,7 +72,10 @@ public:
      * Load dependency info from binary data.
      */
     static ext::optional<BinaryDependencyInfo>
-    Deserialize(std::vector<uint8_t> const &contents);
+    Deserialize(ext::span<uint8_t const> contents);
+    static ext::optional<BinaryDependencyInfo>
+    Deserialize(std::vector<uint8_t> const &contents)
+    { return Deserialize(ext::span<uint8_t const>(contents)); }
 
 public:
     /*
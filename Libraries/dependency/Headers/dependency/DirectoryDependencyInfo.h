@@ -52,10 +52,11 @@ public:
 
 public:
     /*
-     * Create dependency info for a directory.
+     * Create dependency info for a directory. If not recursive, only
+     * the immediate contents of the directory are included.
      */
     static ext::optional<DirectoryDependencyInfo>
-    Deserialize(libutil::Filesystem const *filesystem, std::string const &directory);
+    Deserialize(libutil::Filesystem const *filesystem, std::string const &directory, bool recursive);
 
 public:
     /*
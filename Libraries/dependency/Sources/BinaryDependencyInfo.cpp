@@ -67,7 +67,7 @@ serialize() const
 }
 
 ext::optional<BinaryDependencyInfo> BinaryDependencyInfo::
-Deserialize(std::vector<uint8_t> const &contents)
+Deserialize(ext::span<uint8_t const> contents)
 {
     std::string version;
     std::vector<std::string> inputs;
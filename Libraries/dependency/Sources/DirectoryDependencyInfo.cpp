@@ -23,7 +23,7 @@ DirectoryDependencyInfo(std::string const &directory, DependencyInfo const &depe
 }
 
 ext::optional<DirectoryDependencyInfo> DirectoryDependencyInfo::
-Deserialize(Filesystem const *filesystem, std::string const &directory)
+Deserialize(Filesystem const *filesystem, std::string const &directory, bool recursive)
 {
     std::vector<std::string> inputs;
 
@@ -32,8 +32,8 @@ Deserialize(Filesystem const *filesystem, std::string const &directory)
         return ext::nullopt;
     }
 
-    /* Recursively add all paths under this directory. */
-    filesystem->readDirectory(directory, true, [&](std::string const &path) -> bool {
+    /* Add the paths under this directory. */
+    filesystem->readDirectory(directory, recursive, [&](std::string const &path) -> bool {
         inputs.push_back(directory + "/" + path);
         return true;
     });
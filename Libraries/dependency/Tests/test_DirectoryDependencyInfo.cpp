@@ -27,7 +27,7 @@ TEST(DirectoryDependencyInfo, Deserialize)
         }),
     });
 
-    auto info = DirectoryDependencyInfo::Deserialize(&filesystem, filesystem.path("root"));
+    auto info = DirectoryDependencyInfo::Deserialize(&filesystem, filesystem.path("root"), true);
     ASSERT_TRUE(info);
     EXPECT_EQ(info->dependencyInfo().inputs(), std::vector<std::string>({
         filesystem.path("root/file1"),
@@ -38,12 +38,31 @@ TEST(DirectoryDependencyInfo, Deserialize)
     EXPECT_TRUE(info->dependencyInfo().outputs().empty());
 }
 
+TEST(DirectoryDependencyInfo, Shallow)
+{
+    MemoryFilesystem filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::Directory("root", {
+            MemoryFilesystem::Entry::File("file1", { }),
+            MemoryFilesystem::Entry::Directory("dir", {
+                MemoryFilesystem::Entry::File("file2", { }),
+            }),
+        }),
+    });
+
+    auto info = DirectoryDependencyInfo::Deserialize(&filesystem, filesystem.path("root"), false);
+    ASSERT_TRUE(info);
+    EXPECT_EQ(info->dependencyInfo().inputs(), std::vector<std::string>({
+        filesystem.path("root/file1"),
+        filesystem.path("root/dir"),
+    }));
+}
+
 TEST(DirectoryDependencyInfo, File)
 {
     MemoryFilesystem filesystem = MemoryFilesystem({
         MemoryFilesystem::Entry::File("file1", { }),
     });
 
-    auto info = DirectoryDependencyInfo::Deserialize(&filesystem, filesystem.path("file"));
+    auto info = DirectoryDependencyInfo::Deserialize(&filesystem, filesystem.path("file"), true);
     ASSERT_EQ(info, ext::nullopt);
 }
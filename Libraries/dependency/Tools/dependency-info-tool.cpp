@@ -33,6 +33,9 @@ private:
     ext::optional<bool>        _help;
     ext::optional<bool>        _version;
 
+private:
+    ext::optional<bool>        _shallow;
+
 private:
     std::vector<std::pair<dependency::DependencyInfoFormat, std::string>> _inputs;
     ext::optional<std::string> _output;
@@ -48,6 +51,10 @@ public:
     bool version() const
     { return _version.value_or(false); }
 
+public:
+    bool shallow() const
+    { return _shallow.value_or(false); }
+
 public:
     std::vector<std::pair<dependency::DependencyInfoFormat, std::string>> const &inputs() const
     { return _inputs; }
@@ -81,6 +88,8 @@ parseArgument(std::vector<std::string> const &args, std::vector<std::string>::co
         return libutil::Options::Current<bool>(&_help, arg);
     } else if (arg == "-v" || arg == "--version") {
         return libutil::Options::Current<bool>(&_version, arg);
+    } else if (arg == "-s" || arg == "--shallow") {
+        return libutil::Options::Current<bool>(&_shallow, arg);
     } else if (arg == "-o" || arg == "--output") {
         return libutil::Options::Next<std::string>(&_output, args, it);
     } else if (arg == "-n" || arg == "--name") {
@@ -126,6 +135,7 @@ Help(std::string const &error = std::string())
     fprintf(stderr, "Conversion Options:\n");
     fprintf(stderr, INDENT "-o, --output\n");
     fprintf(stderr, INDENT "-n, --name\n");
+    fprintf(stderr, INDENT "-s, --shallow\n");
     fprintf(stderr, "\n");
 
     fprintf(stderr, "Inputs:\n");
@@ -145,7 +155,7 @@ Version()
 }
 
 static bool
-LoadDependencyInfo(Filesystem const *filesystem, std::string const &path, dependency::DependencyInfoFormat format, std::vector<dependency::DependencyInfo> *dependencyInfo)
+LoadDependencyInfo(Filesystem const *filesystem, std::string const &path, dependency::DependencyInfoFormat format, bool shallow, std::vector<dependency::DependencyInfo> *dependencyInfo)
 {
     if (format == dependency::DependencyInfoFormat::Binary) {
         std::vector<uint8_t> contents;
@@ -168,7 +178,7 @@ LoadDependencyInfo(Filesystem const *filesystem, std::string const &path, depend
             return true;
         }
 
-        auto directoryInfo = dependency::DirectoryDependencyInfo::Deserialize(filesystem, path);
+        auto directoryInfo = dependency::DirectoryDependencyInfo::Deserialize(filesystem, path, !shallow);
         if (!directoryInfo) {
             fprintf(stderr, "error: invalid directory\n");
             return false;
@@ -253,7 +263,7 @@ main(int argc, char **argv)
          * Load the dependency info.
          */
         std::vector<dependency::DependencyInfo> info;
-        if (!LoadDependencyInfo(&filesystem, input.second, input.first, &info)) {
+        if (!LoadDependencyInfo(&filesystem, input.second, input.first, options.shallow(), &info)) {
             return EXIT_FAILURE;
         }
 
@@ -268,9 +278,14 @@ main(int argc, char **argv)
     std::string contents = SerializeMakefileDependencyInfo(processContext.currentDirectory(), *options.name(), inputs);
 
     /*
-     * Write out the output.
+     * Write out the output. Leave it alone if unchanged, so Ninja can skip what depends on it.
      */
     std::vector<uint8_t> makefileContents = std::vector<uint8_t>(contents.begin(), contents.end());
+    std::vector<uint8_t> existingContents;
+    if (filesystem.read(&existingContents, *options.output()) && existingContents == makefileContents) {
+        return EXIT_SUCCESS;
+    }
+
     if (!filesystem.write(makefileContents, *options.output())) {
         return EXIT_FAILURE;
     }
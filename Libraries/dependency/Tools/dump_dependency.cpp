@@ -38,7 +38,7 @@ DumpDependencyInfo(dependency::DependencyInfo const &dependencyInfo)
 static bool
 DumpDependencyInfo(Filesystem const *filesystem, std::string const &path)
 {
-    if (auto directoryInfo = dependency::DirectoryDependencyInfo::Deserialize(filesystem, path)) {
+    if (auto directoryInfo = dependency::DirectoryDependencyInfo::Deserialize(filesystem, path, true)) {
         fprintf(stdout, "directory dependency info\n");
         fprintf(stdout, "directory: %s\n", directoryInfo->directory().c_str());
         DumpDependencyInfo(directoryInfo->dependencyInfo());
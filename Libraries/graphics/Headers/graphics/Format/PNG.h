@@ -17,6 +17,7 @@
 #include <utility>
 #include <vector>
 #include <ext/optional>
+#include <ext/span>
 
 namespace graphics {
 namespace Format {
@@ -34,7 +35,10 @@ public:
      * Read a PNG image.
      */
     static std::pair<ext::optional<Image>, std::string>
-    Read(std::vector<uint8_t> const &contents);
+    Read(ext::span<uint8_t const> contents);
+    static std::pair<ext::optional<Image>, std::string>
+    Read(std::vector<uint8_t> const &contents)
+    { return Read(ext::span<uint8_t const>(contents)); }
 
 public:
     /*
@@ -67,6 +67,13 @@ bom_index_reserve(struct bom_context *context, size_t count);
 uint32_t
 bom_index_add(struct bom_context *context, const void *data, size_t data_len);
 
+/*
+ * Add many indexes at once, growing the index list and data section only
+ * once. The new indexes are numbered consecutively; the first is returned.
+ */
+uint32_t
+bom_index_add_bulk(struct bom_context *context, size_t count, const void *const *data, const size_t *data_len);
+
 uint32_t
 bom_free_indices_add(struct bom_context *context, size_t count);
 
@@ -118,6 +125,28 @@ bom_tree_reserve(struct bom_tree_context *tree, size_t count);
 void
 bom_tree_add(struct bom_tree_context *tree, const void *key, size_t key_len, const void *value, size_t value_len);
 
+struct bom_tree_pair {
+    const void *key;
+    size_t key_len;
+    const void *value;
+    size_t value_len;
+};
+
+/*
+ * The order keys are stored in within a tree: bytewise, shorter keys first.
+ */
+int
+bom_tree_key_compare(const void *key, size_t key_len, const void *other_key, size_t other_key_len);
+
+/*
+ * Create a tree from pairs already sorted by bom_tree_key_compare(). The
+ * tree is laid out in full-sized pages in a single pass, so this is linear
+ * in the number of pairs, unlike repeated calls to bom_tree_add(). Pairs
+ * with the same value pointer and length share a single value index.
+ */
+struct bom_tree_context *
+bom_tree_alloc_sorted(struct bom_context *context, const char *variable_name, const struct bom_tree_pair *pairs, size_t count);
+
 
 #ifdef __cplusplus
 }
@@ -313,6 +313,64 @@ bom_index_add(struct bom_context *context, const void *data, size_t data_len)
     return index_to_add;
 }
 
+uint32_t
+bom_index_add_bulk(struct bom_context *context, size_t count, const void *const *data, const size_t *data_len)
+{
+    assert(context != NULL);
+    assert(count == 0 || (data != NULL && data_len != NULL));
+    assert(context->iteration_count == 0 && "cannot mutate while iterating");
+
+    struct bom_header *header = (struct bom_header *)context->memory.data;
+    struct bom_index_header *index_header = (struct bom_index_header *)((uintptr_t)header + ntohl(header->index_offset));
+
+    /* Grow the index list once for all of the new indexes. */
+    size_t first_index = ntohl(index_header->count);
+    uint32_t index_point = ntohl(header->index_offset) + sizeof(struct bom_index_header) + sizeof(struct bom_index) * first_index;
+    size_t new_index_length = sizeof(struct bom_index_header) + sizeof(struct bom_index) * (first_index + count);
+    size_t available_index_length = ntohl(header->index_length) - (sizeof(struct bom_index) * 2);
+    if (new_index_length > available_index_length) {
+        ptrdiff_t index_delta = new_index_length - available_index_length;
+        _bom_address_resize(context, index_point, index_delta);
+
+        /* Re-fetch, invalidated by resize. */
+        header = (struct bom_header *)context->memory.data;
+        header->index_length = htonl(ntohl(header->index_length) + index_delta);
+        memset((void *)((uintptr_t)header + index_point), 0, index_delta);
+    }
+
+    /* Insert all of the data at the very end. */
+    size_t total_len = 0;
+    for (size_t i = 0; i < count; i++) {
+        total_len += data_len[i];
+    }
+
+    uint32_t data_point = context->memory.size;
+    _bom_address_resize(context, data_point, total_len);
+
+    /* Re-fetch, invalidated by resize. */
+    header = (struct bom_header *)context->memory.data;
+    index_header = (struct bom_index_header *)((uintptr_t)header + ntohl(header->index_offset));
+
+    /* Update values in newly inserted indexes and copy their data. */
+    uint32_t address = data_point;
+    for (size_t i = 0; i < count; i++) {
+        struct bom_index *index = &index_header->index[first_index + i];
+        index->address = htonl(address);
+        index->length = htonl(data_len[i]);
+
+        if (data_len[i] > 0) {
+            memcpy((void *)((uintptr_t)header + address), data[i], data_len[i]);
+        }
+        address += data_len[i];
+    }
+
+    /* Update length for newly added indexes. */
+    index_header->count = htonl(first_index + count);
+    header->block_count = index_header->count;
+
+    return first_index;
+}
+
 uint32_t
 bom_free_indices_add(struct bom_context *context, size_t count)
 {
@@ -158,7 +158,8 @@ bom_tree_iterate(struct bom_tree_context *tree_context, bom_tree_iterator iterat
 
     struct bom_tree_entry *paths = (struct bom_tree_entry *)bom_index_get(tree_context->context, ntohl(tree->child), NULL);
     if (paths != NULL) {
-        if (!paths->is_leaf) {
+        /* Descend to the first leaf; leaves are linked from there. */
+        while (paths != NULL && !paths->is_leaf) {
             struct bom_tree_entry_indexes *indexes = &paths->indexes[0];
             paths = (struct bom_tree_entry *)bom_index_get(tree_context->context, ntohl(indexes->value_index), NULL);
         }
@@ -200,6 +201,17 @@ bom_tree_reserve(struct bom_tree_context *tree_context, size_t count)
     bom_index_append(tree_context->context, paths_index, sizeof(struct bom_tree_entry_indexes) * count);
 }
 
+int
+bom_tree_key_compare(const void *key, size_t key_len, const void *other_key, size_t other_key_len)
+{
+    /* If the values are seemingly identical, order shorter keys first. */
+    int result = memcmp(key, other_key, other_key_len < key_len ? other_key_len : key_len);
+    if (result == 0 && key_len != other_key_len) {
+        result = key_len < other_key_len ? -1 : 1;
+    }
+    return result;
+}
+
 void
 bom_tree_add(struct bom_tree_context *tree_context, const void *key, size_t key_len, const void *value, size_t value_len)
 {
@@ -243,12 +255,8 @@ bom_tree_add(struct bom_tree_context *tree_context, const void *key, size_t key_
         size_t other_len;
         void *other_key = bom_index_get(tree_context->context, ntohl(other_index->key_index), &other_len);
 
-        /* Check the ordering for the candidate key and the existing key value. If the values are
-           seemingly identical, order shorter keys first. */
-        int result = other_key == NULL ? -1 : memcmp(key, other_key, other_len < key_len ? other_len : key_len);
-        if (result == 0 && key_len != other_len) {
-            result = key_len < other_len ? -1 : 1;
-        }
+        /* Check the ordering for the candidate key and the existing key value. */
+        int result = other_key == NULL ? -1 : bom_tree_key_compare(key, key_len, other_key, other_len);
 
         if (result < 0) {
             /* If comparing c in [a,b,c,d,e], then choose [a,b,c] as the
@@ -277,3 +285,219 @@ bom_tree_add(struct bom_tree_context *tree_context, const void *key, size_t key_
     tree->path_count = htonl(ntohl(tree->path_count) + 1);
     paths->count = htons(ntohs(paths->count) + 1);
 }
+
+struct _bom_tree_value_ref {
+    const void *value;
+    size_t value_len;
+    size_t pair;
+};
+
+static int
+_bom_tree_value_ref_compare(const void *a, const void *b)
+{
+    const struct _bom_tree_value_ref *lhs = a;
+    const struct _bom_tree_value_ref *rhs = b;
+
+    if (lhs->value != rhs->value) {
+        return (uintptr_t)lhs->value < (uintptr_t)rhs->value ? -1 : 1;
+    } else if (lhs->value_len != rhs->value_len) {
+        return lhs->value_len < rhs->value_len ? -1 : 1;
+    } else if (lhs->pair != rhs->pair) {
+        return lhs->pair < rhs->pair ? -1 : 1;
+    } else {
+        return 0;
+    }
+}
+
+/*
+ * For each pair, find the first pair with the same value, and count the
+ * number of unique values. Returns false on allocation failure.
+ */
+static bool
+_bom_tree_shared_values(const struct bom_tree_pair *pairs, size_t count, size_t *shared, size_t *unique)
+{
+    struct _bom_tree_value_ref *refs = malloc(sizeof(*refs) * (count > 0 ? count : 1));
+    if (refs == NULL) {
+        return false;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        refs[i].value = pairs[i].value;
+        refs[i].value_len = pairs[i].value_len;
+        refs[i].pair = i;
+    }
+    qsort(refs, count, sizeof(*refs), _bom_tree_value_ref_compare);
+
+    *unique = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (i > 0 && refs[i].value == refs[i - 1].value && refs[i].value_len == refs[i - 1].value_len) {
+            /* Sorted by pair within equal values, so the first is the earliest pair. */
+            shared[refs[i].pair] = shared[refs[i - 1].pair];
+        } else {
+            shared[refs[i].pair] = refs[i].pair;
+            (*unique)++;
+        }
+    }
+
+    free(refs);
+    return true;
+}
+
+struct bom_tree_context *
+bom_tree_alloc_sorted(struct bom_context *context, const char *variable_name, const struct bom_tree_pair *pairs, size_t count)
+{
+    assert(count == 0 || pairs != NULL);
+
+    struct bom_tree_context *tree_context = _bom_tree_alloc(context, variable_name);
+    if (tree_context == NULL) {
+        return NULL;
+    }
+
+    const size_t node_size = 4096;
+    const size_t page_capacity = (node_size - sizeof(struct bom_tree_entry)) / sizeof(struct bom_tree_entry_indexes);
+
+    /* Count the pages in each level of the tree, from the leaves up to a single root. */
+    size_t leaf_count = count == 0 ? 1 : (count + page_capacity - 1) / page_capacity;
+    size_t page_count = 0;
+    for (size_t level_count = leaf_count; ; level_count = (level_count + page_capacity - 1) / page_capacity) {
+        page_count += level_count;
+        if (level_count == 1) {
+            break;
+        }
+    }
+
+    size_t *shared = malloc(sizeof(*shared) * (count > 0 ? count : 1));
+    size_t unique_count = 0;
+    if (shared == NULL || !_bom_tree_shared_values(pairs, count, shared, &unique_count)) {
+        free(shared);
+        bom_tree_free(tree_context);
+        return NULL;
+    }
+
+    /* Indexes are assigned in order: keys and unique values, then pages leaves first, then the tree. */
+    struct bom_context_memory const *memory = bom_memory(context);
+    struct bom_header *header = (struct bom_header *)memory->data;
+    struct bom_index_header *index_header = (struct bom_index_header *)((uintptr_t)header + ntohl(header->index_offset));
+    uint32_t first_index = ntohl(index_header->count);
+    uint32_t first_page_index = first_index + count + unique_count;
+    uint32_t tree_index = first_page_index + page_count;
+
+    size_t block_count = count + unique_count + page_count + 1;
+    const void **data = malloc(sizeof(*data) * block_count);
+    size_t *data_len = malloc(sizeof(*data_len) * block_count);
+    uint32_t *key_indexes = malloc(sizeof(*key_indexes) * (count > 0 ? count : 1));
+    uint32_t *value_indexes = malloc(sizeof(*value_indexes) * (count > 0 ? count : 1));
+    uint8_t *pages = calloc(page_count, node_size);
+    uint32_t *last_keys = malloc(sizeof(*last_keys) * page_count);
+    if (data == NULL || data_len == NULL || key_indexes == NULL || value_indexes == NULL || pages == NULL || last_keys == NULL) {
+        free(shared);
+        free(data);
+        free(data_len);
+        free(key_indexes);
+        free(value_indexes);
+        free(pages);
+        free(last_keys);
+        bom_tree_free(tree_context);
+        return NULL;
+    }
+
+    size_t block = 0;
+    for (size_t i = 0; i < count; i++) {
+        assert(i == 0 || bom_tree_key_compare(pairs[i - 1].key, pairs[i - 1].key_len, pairs[i].key, pairs[i].key_len) <= 0);
+
+        key_indexes[i] = first_index + block;
+        data[block] = pairs[i].key;
+        data_len[block] = pairs[i].key_len;
+        block++;
+
+        if (shared[i] == i) {
+            value_indexes[i] = first_index + block;
+            data[block] = pairs[i].value;
+            data_len[block] = pairs[i].value_len;
+            block++;
+        } else {
+            /* The first pair with this value is always earlier. */
+            value_indexes[i] = value_indexes[shared[i]];
+        }
+    }
+    assert(block == count + unique_count);
+
+    /* Fill leaves in order, linking each to its neighbors. */
+    for (size_t l = 0; l < leaf_count; l++) {
+        struct bom_tree_entry *entry = (struct bom_tree_entry *)(pages + l * node_size);
+        size_t start = l * page_capacity;
+        size_t end = start + page_capacity < count ? start + page_capacity : count;
+
+        entry->is_leaf = htons(1);
+        entry->count = htons(end - start);
+        entry->forward = htonl(l + 1 < leaf_count ? first_page_index + l + 1 : 0);
+        entry->backward = htonl(l > 0 ? first_page_index + l - 1 : 0);
+
+        for (size_t i = start; i < end; i++) {
+            entry->indexes[i - start].key_index = htonl(key_indexes[i]);
+            entry->indexes[i - start].value_index = htonl(value_indexes[i]);
+        }
+
+        last_keys[l] = end > start ? key_indexes[end - 1] : 0;
+    }
+
+    /* Fill each branch level, pointing at the pages of the level below and their last keys. */
+    size_t child_start = 0;
+    size_t child_count = leaf_count;
+    while (child_count > 1) {
+        size_t level_start = child_start + child_count;
+        size_t level_count = (child_count + page_capacity - 1) / page_capacity;
+
+        for (size_t p = 0; p < level_count; p++) {
+            struct bom_tree_entry *entry = (struct bom_tree_entry *)(pages + (level_start + p) * node_size);
+            size_t start = p * page_capacity;
+            size_t end = start + page_capacity < child_count ? start + page_capacity : child_count;
+
+            entry->is_leaf = htons(0);
+            entry->count = htons(end - start);
+            entry->forward = htonl(0);
+            entry->backward = htonl(0);
+
+            for (size_t c = start; c < end; c++) {
+                entry->indexes[c - start].key_index = htonl(last_keys[child_start + c]);
+                entry->indexes[c - start].value_index = htonl(first_page_index + child_start + c);
+            }
+
+            last_keys[level_start + p] = last_keys[child_start + end - 1];
+        }
+
+        child_start = level_start;
+        child_count = level_count;
+    }
+
+    for (size_t p = 0; p < page_count; p++) {
+        data[count + unique_count + p] = pages + p * node_size;
+        data_len[count + unique_count + p] = node_size;
+    }
+
+    struct bom_tree tree;
+    memcpy(tree.magic, "tree", 4);
+    tree.version = htonl(1);
+    tree.child = htonl(first_page_index + page_count - 1);
+    tree.node_size = htonl(node_size);
+    tree.path_count = htonl(count);
+    tree.unknown3 = 0;
+    data[block_count - 1] = &tree;
+    data_len[block_count - 1] = sizeof(tree);
+
+    uint32_t added_index = bom_index_add_bulk(context, block_count, data, data_len);
+    assert(added_index == first_index);
+    (void)added_index;
+
+    free(shared);
+    free(data);
+    free(data_len);
+    free(key_indexes);
+    free(value_indexes);
+    free(pages);
+    free(last_keys);
+
+    bom_variable_add(context, variable_name, tree_index);
+
+    return tree_context;
+}
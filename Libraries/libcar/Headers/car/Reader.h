@@ -17,8 +17,8 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
-#include <unordered_map>
 
 namespace car {
 
@@ -27,6 +27,11 @@ class Rendition;
 
 /*
  * An archive within a BOM file holding facets and their renditions.
+ *
+ * Loading an archive reads only its header. Facets and renditions are
+ * indexed the first time they are used, by recording where their keys and
+ * values are in the BOM; values, including image data, are not read until
+ * they are looked up. Indexing is not thread safe.
  */
 class Reader {
 public:
@@ -42,14 +47,25 @@ private:
     } KeyValuePair;
 
 private:
-    unique_ptr_bom                                  _bom;
-    ext::optional<struct car_key_format *>          _keyfmt;
-    std::unordered_map<std::string, void *>         _facetValues;
-    std::unordered_multimap<uint16_t, KeyValuePair> _renditionValues;
+    unique_ptr_bom                         _bom;
+    ext::optional<struct car_key_format *> _keyfmt;
+    size_t                                 _identifierIndex;
+
+private:
+    /*
+     * Facets sorted by name, and renditions sorted by facet identifier.
+     * Both are built when first needed.
+     */
+    mutable ext::optional<std::vector<KeyValuePair>>                        _facetValues;
+    mutable ext::optional<std::vector<std::pair<uint16_t, KeyValuePair>>>  _renditionValues;
 
 private:
     Reader(unique_ptr_bom bom);
 
+private:
+    std::vector<KeyValuePair> const &facetValues() const;
+    std::vector<std::pair<uint16_t, KeyValuePair>> const &renditionValues() const;
+
 public:
     void facetFastIterate(std::function<void(void *key, size_t key_len, void *value, size_t value_len)> const &facet) const;
     void renditionFastIterate(std::function<void(void *key, size_t key_len, void *value, size_t value_len)> const &iterator) const;
@@ -71,13 +87,13 @@ public:
      * The number of Facets read
      */
     int facetCount() const
-    { return _facetValues.size(); }
+    { return facetValues().size(); }
 
     /*
      * The number of Renditions read
      */
      int renditionCount() const
-     { return _renditionValues.size(); }
+     { return renditionValues().size(); }
 
 public:
     /*
@@ -13,8 +13,12 @@
 #include <car/AttributeList.h>
 #include <ext/optional>
 
+#include <memory>
+#include <mutex>
 #include <string>
 #include <functional>
+#include <unordered_map>
+#include <vector>
 
 namespace car {
 
@@ -85,6 +89,64 @@ public:
         { return _format; }
     };
 
+public:
+    /*
+     * How pixel data is compressed when the rendition is written.
+     */
+    enum class Compression {
+        /*
+         * Standard zlib compression.
+         */
+        Default,
+        /*
+         * Fastest to write: zlib level 1, run-length encoded for
+         * single-color images.
+         */
+        Fast,
+        /*
+         * Smallest output: zlib level 9.
+         */
+        Small,
+    };
+
+public:
+    /*
+     * Compressed pixel data, by the pixels and how they are compressed. Lets
+     * renditions with the same pixels, such as the same image used for more
+     * than one idiom, only be compressed once. Can be used from any thread.
+     */
+    class EncodeCache {
+    private:
+        struct Entry {
+            std::vector<uint8_t>                        pixels;
+            std::shared_ptr<std::vector<uint8_t> const> encoded;
+        };
+
+    private:
+        std::mutex                                   _mutex;
+        std::unordered_multimap<std::string, Entry> _encoded;
+
+    public:
+        EncodeCache();
+
+    public:
+        EncodeCache(EncodeCache const &) = delete;
+        EncodeCache &operator=(EncodeCache const &) = delete;
+
+    public:
+        /*
+         * Compressed data for pixels, if the same pixels were compressed
+         * before with the same content key. The pixels themselves are
+         * compared, so keys only need to be likely to differ.
+         */
+        std::shared_ptr<std::vector<uint8_t> const> find(std::string const &key, uint8_t const *pixels, size_t length);
+
+        /*
+         * Record the compressed data for pixels with a content key.
+         */
+        void insert(std::string const &key, uint8_t const *pixels, size_t length, std::shared_ptr<std::vector<uint8_t> const> const &encoded);
+    };
+
 public:
     enum class ResizeMode {
         FixedSize,
@@ -122,6 +184,7 @@ private:
     std::vector<Slice>              _slices;
     enum car_rendition_value_layout _layout;
     ext::optional<std::string>      _UTI;
+    Compression                     _compression;
 
 private:
     Rendition(AttributeList const &attributes, std::function<ext::optional<Data>(Rendition const *)> const &data);
@@ -226,6 +289,15 @@ public:
     std::vector<Slice> &slices()
     { return _slices; }
 
+public:
+    /*
+     * How the pixel data is compressed when written.
+     */
+    Compression compression() const
+    { return _compression; }
+    Compression &compression()
+    { return _compression; }
+
 public:
     /*
      * The rendition pixel data. May incur expensive decoding.
@@ -238,6 +310,12 @@ public:
      */
     std::vector<uint8_t> write() const;
 
+    /*
+     * Serialize the rendition, reusing compressed pixel data from the cache
+     * when a rendition with the same pixels was already written.
+     */
+    std::vector<uint8_t> write(EncodeCache *cache) const;
+
 public:
     /*
      * Dump a description of the rendition. For debugging.
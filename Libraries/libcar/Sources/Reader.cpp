@@ -12,6 +12,7 @@
 #include <car/Rendition.h>
 #include <car/car_format.h>
 
+#include <algorithm>
 #include <limits>
 #include <random>
 
@@ -25,13 +26,22 @@ using car::Rendition;
 
 Reader::
 Reader(unique_ptr_bom bom) :
-    _bom(std::move(bom)),
-    _keyfmt(ext::nullopt),
-    _facetValues({ }),
-    _renditionValues({ })
+    _bom            (std::move(bom)),
+    _keyfmt         (ext::nullopt),
+    _identifierIndex(0)
 {
 }
 
+/*
+ * Orders keys as strings, so facets can be found by name.
+ */
+static bool
+KeyLess(void const *key, size_t key_len, void const *other_key, size_t other_key_len)
+{
+    int result = memcmp(key, other_key, std::min(key_len, other_key_len));
+    return (result < 0 || (result == 0 && key_len < other_key_len));
+}
+
 struct _car_iterator_ctx {
     Reader const *reader;
     void *iterator;
@@ -53,11 +63,57 @@ _car_tree_iterator(Reader const *reader, const char *tree_variable, bom_tree_ite
     bom_tree_free(tree);
 }
 
+std::vector<Reader::KeyValuePair> const &Reader::
+facetValues() const
+{
+    if (!_facetValues) {
+        /* Facet trees are normally sorted by name already, but don't rely on it. */
+        std::vector<KeyValuePair> values;
+        facetFastIterate([&values](void *key, size_t key_len, void *value, size_t value_len) {
+            values.push_back({ key, key_len, value, value_len });
+        });
+        std::stable_sort(values.begin(), values.end(), [](KeyValuePair const &a, KeyValuePair const &b) {
+            return KeyLess(a.key, a.key_len, b.key, b.key_len);
+        });
+        _facetValues = std::move(values);
+    }
+
+    return *_facetValues;
+}
+
+std::vector<std::pair<uint16_t, Reader::KeyValuePair>> const &Reader::
+renditionValues() const
+{
+    if (!_renditionValues) {
+        /*
+         * Rendition keys are lists of attributes in the order of the key format,
+         * so the tree is not sorted by facet identifier. Record just where each
+         * key and value is, sorted by identifier; the values are not read.
+         */
+        size_t identifier_index = _identifierIndex;
+        std::vector<std::pair<uint16_t, KeyValuePair>> values;
+        renditionFastIterate([identifier_index, &values](void *key, size_t key_len, void *value, size_t value_len) {
+            if ((identifier_index + 1) * sizeof(uint16_t) > key_len) {
+                return;
+            }
+
+            car_rendition_key *rendition_key = (car_rendition_key *)key;
+            values.push_back({ rendition_key[identifier_index], { key, key_len, value, value_len } });
+        });
+        std::stable_sort(values.begin(), values.end(), [](std::pair<uint16_t, KeyValuePair> const &a, std::pair<uint16_t, KeyValuePair> const &b) {
+            return a.first < b.first;
+        });
+        _renditionValues = std::move(values);
+    }
+
+    return *_renditionValues;
+}
+
 void Reader::
 facetIterate(std::function<void(Facet const &)> const &iterator) const
 {
-    for (const auto &item : _facetValues) {
-        Facet facet = Facet::Load(item.first, (struct car_facet_value *)item.second);
+    for (KeyValuePair const &kv : facetValues()) {
+        Facet facet = Facet::Load(std::string(static_cast<char *>(kv.key), kv.key_len), (struct car_facet_value *)kv.value);
         iterator(facet);
     }
 }
@@ -79,7 +135,7 @@ void Reader::
 renditionIterate(std::function<void(Rendition const &)> const &iterator) const
 {
     auto keyfmt = *_keyfmt;
-    for (const auto &it : _renditionValues) {
+    for (const auto &it : renditionValues()) {
         KeyValuePair kv = (KeyValuePair)it.second;
         car_rendition_key *rendition_key = (car_rendition_key *)kv.key;
         struct car_rendition_value *rendition_value = (struct car_rendition_value *)kv.value;
@@ -181,14 +237,6 @@ Load(unique_ptr_bom bom)
 
     auto reader = Reader(std::move(bom));
 
-    /*
-     * Iterate through the facets as fast as possible just save the name and value pointer for lookups later.
-     */
-    reader.facetFastIterate([&reader](void *key, size_t key_len, void *value, size_t value_len) {
-        auto name = std::string(static_cast<char *>(key), key_len);
-        reader._facetValues.insert({ name, value });
-    });
-
     /* Load the key format from the BOM. */
     int key_format_index = bom_variable_get(reader.bom(), car_key_format_variable);
     struct car_key_format *keyfmt = (struct car_key_format *)bom_index_get(reader.bom(), key_format_index, NULL);
@@ -202,27 +250,13 @@ Load(unique_ptr_bom bom)
      * The index into the attribute list for the identifer for the matching facet.
      * The attribute list is a list of uint16_t in the key portion of the entry for the rendition.
      */
-    size_t identifier_index = 0;
-
-    /* Scan the key format for the facet identifier index. */
     for (size_t i = 0; i < keyfmt->num_identifiers; i++) {
         if (keyfmt->identifier_list[i] == car_attribute_identifier_identifier) {
-            identifier_index = i;
+            reader._identifierIndex = i;
             break;
         }
     }
 
-    /* Iterate through the renditions as fast as possible. Save the key and value pointers, indexed by the Facet identifier. */
-    reader.renditionFastIterate([identifier_index,&reader](void *key, size_t key_len, void *value, size_t value_len) {
-        KeyValuePair kv;
-        kv.key = key;
-        kv.key_len = key_len;
-        kv.value = value;
-        kv.value_len = value_len;
-        car_rendition_key *rendition_key = (car_rendition_key *)key;
-        reader._renditionValues.insert({ rendition_key[identifier_index], kv });
-    });
-
     return std::move(reader);
 }
 
@@ -231,13 +265,16 @@ Reader::lookupFacet(std::string name) const
 {
     ext::optional<Facet> result;
 
-    auto lookup = _facetValues.find(name);
+    std::vector<KeyValuePair> const &values = facetValues();
+    auto lookup = std::lower_bound(values.begin(), values.end(), name, [](KeyValuePair const &kv, std::string const &name) {
+        return KeyLess(kv.key, kv.key_len, name.data(), name.size());
+    });
 
-    if (lookup == _facetValues.end()) {
+    if (lookup == values.end() || lookup->key_len != name.size() || memcmp(lookup->key, name.data(), name.size()) != 0) {
         return result;
     }
 
-    struct car_facet_value *facet_value = (struct car_facet_value *)lookup->second;
+    struct car_facet_value *facet_value = (struct car_facet_value *)lookup->value;
     AttributeList attributes = AttributeList::Load(facet_value->attributes_count, facet_value->attributes);
     result = Facet::Create(name, attributes);
 
@@ -260,7 +297,10 @@ lookupRenditions(Facet const &facet) const
     }
 
     auto keyfmt = *_keyfmt;
-    auto lookupRendition = _renditionValues.equal_range(*facet_identifier);
+    std::vector<std::pair<uint16_t, KeyValuePair>> const &values = renditionValues();
+    auto lookupRendition = std::equal_range(values.begin(), values.end(), std::make_pair(*facet_identifier, KeyValuePair()), [](std::pair<uint16_t, KeyValuePair> const &a, std::pair<uint16_t, KeyValuePair> const &b) {
+        return a.first < b.first;
+    });
     for (auto it = lookupRendition.first; it != lookupRendition.second; ++it) {
         KeyValuePair value = (KeyValuePair)it->second;
         car_rendition_key *rendition_key = (car_rendition_key *)value.key;
@@ -10,8 +10,12 @@
 #include <car/Rendition.h>
 #include <car/Reader.h>
 #include <car/car_format.h>
+#include <libutil/md5.h>
+
+#include <algorithm>
 
 #include <cassert>
+#include <cstdlib>
 #include <cstring>
 #include <cstdio>
 
@@ -33,6 +37,34 @@
 using car::Rendition;
 using car::AttributeList;
 
+Rendition::EncodeCache::
+EncodeCache()
+{
+}
+
+std::shared_ptr<std::vector<uint8_t> const> Rendition::EncodeCache::
+find(std::string const &key, uint8_t const *pixels, size_t length)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto range = _encoded.equal_range(key);
+    for (auto it = range.first; it != range.second; ++it) {
+        Entry const &entry = it->second;
+        if (entry.pixels.size() == length && memcmp(entry.pixels.data(), pixels, length) == 0) {
+            return entry.encoded;
+        }
+    }
+
+    return nullptr;
+}
+
+void Rendition::EncodeCache::
+insert(std::string const &key, uint8_t const *pixels, size_t length, std::shared_ptr<std::vector<uint8_t> const> const &encoded)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _encoded.insert({ key, Entry { std::vector<uint8_t>(pixels, pixels + length), encoded } });
+}
+
 Rendition::Data::
 Data(std::vector<uint8_t> const &data, Format format) :
     _data  (data),
@@ -82,7 +114,8 @@ Rendition(AttributeList const &attributes, std::function<ext::optional<Data>(Ren
     _scale       (1.0),
     _isVector    (false),
     _isOpaque    (false),
-    _isResizable (false)
+    _isResizable (false),
+    _compression (Compression::Default)
 {
 }
 
@@ -95,7 +128,8 @@ Rendition(AttributeList const &attributes, ext::optional<Data> const &data) :
     _scale      (1.0),
     _isVector   (false),
     _isOpaque   (false),
-    _isResizable(false)
+    _isResizable(false),
+    _compression(Compression::Default)
 {
 }
 
@@ -142,7 +176,7 @@ dump() const
 }
 
 static ext::optional<Rendition::Data> Decode(struct car_rendition_value *value);
-static ext::optional<std::vector<uint8_t>> Encode(Rendition const *rendition, ext::optional<Rendition::Data> data);
+static ext::optional<std::vector<uint8_t>> Encode(Rendition const *rendition, ext::optional<Rendition::Data> data, Rendition::EncodeCache *cache);
 
 
 static Rendition::ResizeMode
@@ -436,8 +470,123 @@ Decode(struct car_rendition_value *value)
     return data;
 }
 
+/*
+ * Parameters for compressing pixel data. Pixel data is always written with
+ * zlib; only the level and strategy vary. The reader also decodes LZVN and
+ * LZFSE, but no encoder for either is available here.
+ */
+struct Codec {
+    enum car_rendition_data_compression_magic magic;
+    int level;
+    int strategy;
+};
+
+static bool
+IsSingleColor(uint8_t const *pixels, size_t length, size_t bytes_per_pixel)
+{
+    if (bytes_per_pixel == 0 || length < bytes_per_pixel) {
+        return false;
+    }
+
+    for (size_t offset = bytes_per_pixel; offset + bytes_per_pixel <= length; offset += bytes_per_pixel) {
+        if (memcmp(pixels, pixels + offset, bytes_per_pixel) != 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static Codec
+SelectCodec(Rendition::Compression compression, uint8_t const *pixels, size_t length, size_t bytes_per_pixel)
+{
+    switch (compression) {
+        case Rendition::Compression::Default:
+            return { car_rendition_data_compression_magic_zlib, Z_DEFAULT_COMPRESSION, Z_DEFAULT_STRATEGY };
+        case Rendition::Compression::Fast:
+            /* Run-length encoding is both fastest and smallest for flat-colored images. */
+            if (IsSingleColor(pixels, length, bytes_per_pixel)) {
+                return { car_rendition_data_compression_magic_zlib, 1, Z_RLE };
+            } else {
+                return { car_rendition_data_compression_magic_zlib, 1, Z_DEFAULT_STRATEGY };
+            }
+        case Rendition::Compression::Small:
+            return { car_rendition_data_compression_magic_zlib, Z_BEST_COMPRESSION, Z_DEFAULT_STRATEGY };
+    }
+
+    abort();
+}
+
+/*
+ * Compress with zlib in gzip format, appending to output after the given
+ * number of reserved bytes. The output is sized once, up front.
+ */
+static bool
+CompressZlib(Codec const &codec, uint8_t const *uncompressed_data, size_t uncompressed_length, size_t reserved, std::vector<uint8_t> *output)
+{
+    z_stream zlibStream;
+    memset(&zlibStream, 0, sizeof(zlibStream));
+
+    int windowSize = 16 + MAX_WBITS;
+    int err = deflateInit2(&zlibStream, codec.level, Z_DEFLATED, windowSize, 8, codec.strategy);
+    if (err != Z_OK) {
+        return false;
+    }
+
+    output->resize(reserved + deflateBound(&zlibStream, static_cast<uLong>(uncompressed_length)));
+
+    zlibStream.next_in = const_cast<Bytef *>(static_cast<Bytef const *>(uncompressed_data));
+    zlibStream.avail_in = static_cast<uInt>(uncompressed_length);
+    zlibStream.next_out = static_cast<Bytef *>(output->data() + reserved);
+    zlibStream.avail_out = static_cast<uInt>(output->size() - reserved);
+
+    err = deflate(&zlibStream, Z_FINISH);
+    if (err != Z_STREAM_END) {
+        deflateEnd(&zlibStream);
+        fprintf(stderr, "Zlib error %d", err);
+        return false;
+    }
+
+    output->resize(reserved + zlibStream.total_out);
+    deflateEnd(&zlibStream);
+
+    /* The gzip header includes an operating system field. For consistent results, clear it. */
+    if (zlibStream.total_out > 9) {
+        (*output)[reserved + 9] = 0;
+    }
+
+    return true;
+}
+
+/*
+ * Identifies compressed pixel data: everything that changes how the pixels
+ * are compressed, and a hash of the pixels. The cache compares the pixels.
+ */
+static std::string
+EncodeCacheKey(Rendition const *rendition, Rendition::Data const &data, size_t length)
+{
+    uint32_t parameters[] = {
+        static_cast<uint32_t>(data.format()),
+        static_cast<uint32_t>(rendition->compression()),
+        static_cast<uint32_t>(rendition->width()),
+        static_cast<uint32_t>(rendition->height()),
+    };
+
+    md5_state_t state;
+    md5_init(&state);
+
+    size_t const chunk = 1 << 30;
+    for (size_t offset = 0; offset < length; offset += chunk) {
+        md5_append(&state, data.data().data() + offset, static_cast<int>(std::min(chunk, length - offset)));
+    }
+
+    md5_byte_t digest[16];
+    md5_finish(&state, digest);
+    return std::string(reinterpret_cast<char const *>(parameters), sizeof(parameters)) + std::string(reinterpret_cast<char const *>(digest), sizeof(digest));
+}
+
 static ext::optional<std::vector<uint8_t>>
-Encode(Rendition const *rendition, ext::optional<Rendition::Data> data)
+Encode(Rendition const *rendition, ext::optional<Rendition::Data> data, Rendition::EncodeCache *cache)
 {
     if (!data || data->data().size() == 0) {
         return ext::nullopt;
@@ -450,59 +599,36 @@ Encode(Rendition const *rendition, ext::optional<Rendition::Data> data)
         return data->data();
     }
 
-    /* The selected algorithm, only zlib for now. */
-    enum car_rendition_data_compression_magic compression_magic = car_rendition_data_compression_magic_zlib;
     size_t bytes_per_pixel = Rendition::Data::FormatSize(data->format());
-
     size_t uncompressed_length = rendition->width() * rendition->height() * bytes_per_pixel;
-    void *uncompressed_data = static_cast<void *>(data->data().data());
-
-    std::vector<uint8_t> compressed_vector;
-    if (compression_magic == car_rendition_data_compression_magic_zlib) {
-        z_stream zlibStream;
-        memset(&zlibStream, 0, sizeof(zlibStream));
-        zlibStream.next_in = static_cast<Bytef *>(uncompressed_data);
-        zlibStream.avail_in = static_cast<uInt>(uncompressed_length);
-
-        int deflateLevel = Z_DEFAULT_COMPRESSION;
-        int windowSize = 16 + MAX_WBITS;
-        int err = deflateInit2(&zlibStream, deflateLevel, Z_DEFLATED, windowSize, 8, Z_DEFAULT_STRATEGY);
-        if (err != Z_OK) {
-            return ext::nullopt;
-        }
-
-        while (true) {
-            uint8_t tmp[4096];
-            zlibStream.next_out = (Bytef*)&tmp;
-            zlibStream.avail_out = (uInt)sizeof(tmp);
-            err = deflate(&zlibStream, Z_FINISH);
-            size_t block_size = sizeof(tmp) - zlibStream.avail_out;
-            compressed_vector.resize(compressed_vector.size() + block_size);
-            memcpy(&compressed_vector[compressed_vector.size() - block_size], &tmp[0], block_size);
-            if (err == Z_STREAM_END) {  /* Done */
-                break;
-            }
-            if (err != Z_OK) {  /* Z_OK -> Made progress, else err */
-                deflateEnd(&zlibStream);
-                fprintf(stderr, "Zlib error %d", err);
-                return ext::nullopt;
-            }
-        }
-        deflateEnd(&zlibStream);
+    if (uncompressed_length > data->data().size()) {
+        return ext::nullopt;
+    }
 
-        /* The gzip header includes an operating system field. For consistent results, clear it. */
-        if (compressed_vector.size() > 9) {
-            compressed_vector[9] = 0;
+    std::string key;
+    if (cache != nullptr) {
+        key = EncodeCacheKey(rendition, *data, uncompressed_length);
+        if (std::shared_ptr<std::vector<uint8_t> const> encoded = cache->find(key, data->data().data(), uncompressed_length)) {
+            return *encoded;
         }
     }
 
-    std::vector<uint8_t> output = std::vector<uint8_t>(sizeof(struct car_rendition_data_header1));
+    Codec codec = SelectCodec(rendition->compression(), data->data().data(), uncompressed_length, bytes_per_pixel);
+
+    /* Compress directly after the header, into a buffer large enough for any result. */
+    std::vector<uint8_t> output;
+    if (!CompressZlib(codec, data->data().data(), uncompressed_length, sizeof(struct car_rendition_data_header1), &output)) {
+        return ext::nullopt;
+    }
 
     struct car_rendition_data_header1 *header1 = reinterpret_cast<struct car_rendition_data_header1 *>(output.data());
     memcpy(header1->magic, "MLEC", sizeof(header1->magic));
-    header1->length = compressed_vector.size();
-    header1->compression = compression_magic;
-    output.insert(output.end(), compressed_vector.begin(), compressed_vector.end());
+    header1->length = output.size() - sizeof(struct car_rendition_data_header1);
+    header1->compression = codec.magic;
+
+    if (cache != nullptr) {
+        cache->insert(key, data->data().data(), uncompressed_length, std::make_shared<std::vector<uint8_t> const>(output));
+    }
 
     return output;
 }
@@ -525,6 +651,12 @@ Create(
 
 std::vector<uint8_t> Rendition::
 write() const
+{
+    return write(nullptr);
+}
+
+std::vector<uint8_t> Rendition::
+write(EncodeCache *cache) const
 {
     // Create header
     struct car_rendition_value header;
@@ -626,7 +758,7 @@ write() const
     info_bytes_per_row.bytes_per_row = _width * bytes_per_pixel;
 
     // Write bitmap data
-    ext::optional<std::vector<uint8_t>> data = Encode(this, renditionData);
+    ext::optional<std::vector<uint8_t>> data = Encode(this, renditionData, cache);
     if (!data) {
         printf("Error: no bitmap data for %s\n", this->fileName().c_str());
         data = ext::optional<std::vector<uint8_t>>(std::vector<uint8_t>());
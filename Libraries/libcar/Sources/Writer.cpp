@@ -10,6 +10,7 @@
 #include <car/Writer.h>
 #include <car/car_format.h>
 
+#include <algorithm>
 #include <random>
 #include <set>
 #include <unordered_set>
@@ -56,10 +57,19 @@ addRendition(void *key, size_t key_len, void *value, size_t value_len)
     _rawRenditions.emplace_back(kv);
 }
 
+void Writer::
+addRendition(AttributeList const &attributes, std::vector<uint8_t> const &value)
+{
+    if (attributes.get(car_attribute_identifier_identifier) != ext::nullopt) {
+        _encodedRenditions.push_back({ attributes, value });
+    }
+}
+
 static std::vector<enum car_attribute_identifier>
 DetermineKeyFormat(
     std::unordered_map<std::string, Facet> const &facets,
-    std::unordered_multimap<uint16_t, Rendition> const &renditions)
+    std::unordered_multimap<uint16_t, Rendition> const &renditions,
+    std::vector<std::pair<car::AttributeList, std::vector<uint8_t>>> const &encodedRenditions)
 {
     std::unordered_set<enum car_attribute_identifier> format;
     auto insert = [&format](enum car_attribute_identifier identifier, uint16_t value) {
@@ -74,11 +84,58 @@ DetermineKeyFormat(
         item.second.attributes().iterate(insert);
     }
 
+    for (auto const &item : encodedRenditions) {
+        item.first.iterate(insert);
+    }
+
     /* Sort attributes to preserve ordering. */
     auto ordered = std::set<enum car_attribute_identifier>(format.begin(), format.end());
     return std::vector<enum car_attribute_identifier>(ordered.begin(), ordered.end());
 }
 
+/*
+ * Point pairs with identical values at the same value, so the value is only
+ * stored once. For example, the same image used for more than one idiom.
+ */
+static void
+ShareIdenticalValues(std::vector<struct bom_tree_pair> *pairs)
+{
+    std::unordered_multimap<uint64_t, size_t> seen;
+    for (size_t i = 0; i < pairs->size(); i++) {
+        struct bom_tree_pair &pair = (*pairs)[i];
+        uint8_t const *value = static_cast<uint8_t const *>(pair.value);
+
+        /* FNV-1a. */
+        uint64_t hash = 14695981039346656037ULL;
+        for (size_t n = 0; n < pair.value_len; n++) {
+            hash = (hash ^ value[n]) * 1099511628211ULL;
+        }
+
+        bool shared = false;
+        auto range = seen.equal_range(hash);
+        for (auto it = range.first; it != range.second; ++it) {
+            struct bom_tree_pair const &other = (*pairs)[it->second];
+            if (other.value_len == pair.value_len && memcmp(other.value, pair.value, pair.value_len) == 0) {
+                pair.value = other.value;
+                shared = true;
+                break;
+            }
+        }
+
+        if (!shared) {
+            seen.insert({ hash, i });
+        }
+    }
+}
+
+static void
+SortTreePairs(std::vector<struct bom_tree_pair> *pairs)
+{
+    std::stable_sort(pairs->begin(), pairs->end(), [](struct bom_tree_pair const &lhs, struct bom_tree_pair const &rhs) {
+        return bom_tree_key_compare(lhs.key, lhs.key_len, rhs.key, rhs.key_len) < 0;
+    });
+}
+
 void Writer::
 write() const
 {
@@ -88,7 +145,7 @@ write() const
      * Each tree entry (facet or rendition) requires 2: one key index, one value index.
      */
     uint32_t facet_count = _facets.size();
-    uint32_t rendition_count = _renditions.size() + _rawRenditions.size();
+    uint32_t rendition_count = _renditions.size() + _rawRenditions.size() + _encodedRenditions.size();
     uint32_t bom_index_count = 8 + facet_count * 2 + rendition_count * 2;
     bom_index_reserve(_bom.get(), bom_index_count);
 
@@ -125,7 +182,7 @@ write() const
     struct car_key_format *keyfmt;
     size_t keyfmt_size;
     if (_keyfmt == ext::nullopt) {
-      std::vector<enum car_attribute_identifier> format = DetermineKeyFormat(_facets, _renditions);
+      std::vector<enum car_attribute_identifier> format = DetermineKeyFormat(_facets, _renditions, _encodedRenditions);
       keyfmt_size = sizeof(struct car_key_format) + (format.size() * sizeof(uint32_t));
       keyfmt = (struct car_key_format *)malloc(keyfmt_size);
       strncpy(keyfmt->magic, "tmfk", 4);
@@ -139,47 +196,74 @@ write() const
       keyfmt_size = sizeof(struct car_key_format) + (keyfmt->num_identifiers * sizeof(uint32_t));
     }
 
+    /* The key format is packed; copy the identifiers out for aligned access. */
+    std::vector<uint32_t> identifiers = std::vector<uint32_t>(keyfmt->num_identifiers);
+    memcpy(identifiers.data(), keyfmt->identifier_list, identifiers.size() * sizeof(uint32_t));
+
     int key_format_index = bom_index_add(_bom.get(), keyfmt, keyfmt_size);
     bom_variable_add(_bom.get(), car_key_format_variable, key_format_index);
 
     /* Write facets. */
-    struct bom_tree_context *facets_tree_context = bom_tree_alloc_empty(_bom.get(), car_facet_keys_variable);
-    bom_tree_reserve(facets_tree_context, facet_count);
+    std::vector<std::vector<uint8_t>> facet_values;
+    std::vector<struct bom_tree_pair> facet_pairs;
+    facet_values.reserve(_facets.size());
+    facet_pairs.reserve(_facets.size());
+    for (auto const &item : _facets) {
+        facet_values.push_back(item.second.write());
+        facet_pairs.push_back({
+            reinterpret_cast<void const *>(item.first.c_str()),
+            item.first.size(),
+            reinterpret_cast<void const *>(facet_values.back().data()),
+            facet_values.back().size(),
+        });
+    }
+
+    SortTreePairs(&facet_pairs);
+    struct bom_tree_context *facets_tree_context = bom_tree_alloc_sorted(_bom.get(), car_facet_keys_variable, facet_pairs.data(), facet_pairs.size());
     if (facets_tree_context != NULL) {
-        for (auto const &item : _facets) {
-            auto facet_value = item.second.write();
-            bom_tree_add(
-                facets_tree_context,
-                reinterpret_cast<void const *>(item.first.c_str()),
-                item.first.size(),
-                reinterpret_cast<void const *>(facet_value.data()),
-                facet_value.size());
-        }
         bom_tree_free(facets_tree_context);
     }
 
     /* Write renditions. */
-    struct bom_tree_context *renditions_tree_context = bom_tree_alloc_empty(_bom.get(), car_renditions_variable);
-    bom_tree_reserve(renditions_tree_context, rendition_count);
+    std::vector<std::vector<uint8_t>> rendition_keys;
+    std::vector<std::vector<uint8_t>> rendition_values;
+    std::vector<struct bom_tree_pair> rendition_pairs;
+    rendition_keys.reserve(_renditions.size() + _encodedRenditions.size());
+    rendition_values.reserve(_renditions.size());
+    rendition_pairs.reserve(rendition_count);
+    Rendition::EncodeCache encode_cache;
+    for (auto const &item : _renditions) {
+        rendition_keys.push_back(item.second.attributes().write(identifiers.size(), identifiers.data()));
+        rendition_values.push_back(item.second.write(&encode_cache));
+        rendition_pairs.push_back({
+            reinterpret_cast<void const *>(rendition_keys.back().data()),
+            rendition_keys.back().size(),
+            reinterpret_cast<void const *>(rendition_values.back().data()),
+            rendition_values.back().size(),
+        });
+    }
+    for (auto const &item : _encodedRenditions) {
+        rendition_keys.push_back(item.first.write(identifiers.size(), identifiers.data()));
+        rendition_pairs.push_back({
+            reinterpret_cast<void const *>(rendition_keys.back().data()),
+            rendition_keys.back().size(),
+            reinterpret_cast<void const *>(item.second.data()),
+            item.second.size(),
+        });
+    }
+    for (auto const &item : _rawRenditions) {
+        rendition_pairs.push_back({
+            item.key,
+            item.keyLength,
+            item.value,
+            item.valueLength,
+        });
+    }
+
+    ShareIdenticalValues(&rendition_pairs);
+    SortTreePairs(&rendition_pairs);
+    struct bom_tree_context *renditions_tree_context = bom_tree_alloc_sorted(_bom.get(), car_renditions_variable, rendition_pairs.data(), rendition_pairs.size());
     if (renditions_tree_context != NULL) {
-        for (auto const &item : _renditions) {
-            auto attributes_value = item.second.attributes().write(keyfmt->num_identifiers, keyfmt->identifier_list);
-            auto rendition_value = item.second.write();
-            bom_tree_add(
-                renditions_tree_context,
-                reinterpret_cast<void const *>(attributes_value.data()),
-                attributes_value.size(),
-                reinterpret_cast<void const *>(rendition_value.data()),
-                rendition_value.size());
-        }
-        for (auto const &item : _rawRenditions) {
-            bom_tree_add(
-                renditions_tree_context,
-                item.key,
-                item.keyLength,
-                item.value,
-                item.valueLength);
-        }
         bom_tree_free(renditions_tree_context);
     }
 
@@ -244,3 +244,93 @@ TEST(Rendition, SerializeSlices)
     }
 }
 
+
+static std::vector<uint8_t>
+SerializeWithCompression(std::vector<uint8_t> const &bitmap, size_t width, size_t height, Rendition::Compression compression)
+{
+    auto data = car::Rendition::Data(bitmap, car::Rendition::Data::Format::PremultipliedBGRA8);
+    car::Rendition rendition = car::Rendition::Create(EmptyAttributeList(), data);
+    rendition.width() = width;
+    rendition.height() = height;
+    rendition.scale() = 1.0;
+    rendition.fileName() = "test.png";
+    rendition.layout() = car_rendition_value_layout_one_part_scale;
+    rendition.compression() = compression;
+    return rendition.write();
+}
+
+TEST(Rendition, SerializeCompression)
+{
+    size_t width = 64;
+    size_t height = 64;
+
+    /* A gradient, and a single color image that can be run-length encoded. */
+    auto gradient = std::vector<uint8_t>(width * height * 4);
+    for (size_t i = 0; i < gradient.size(); i++) {
+        gradient[i] = static_cast<uint8_t>((i * 7) / 5);
+    }
+    auto flat = std::vector<uint8_t>(width * height * 4);
+    for (size_t i = 0; i < flat.size(); i += 4) {
+        flat[i + 0] = 0x10;
+        flat[i + 1] = 0x20;
+        flat[i + 2] = 0x30;
+        flat[i + 3] = 0xff;
+    }
+
+    for (auto const &bitmap : { gradient, flat }) {
+        std::vector<uint8_t> defaultValue = SerializeWithCompression(bitmap, width, height, Rendition::Compression::Default);
+        std::vector<uint8_t> fastValue = SerializeWithCompression(bitmap, width, height, Rendition::Compression::Fast);
+        std::vector<uint8_t> smallValue = SerializeWithCompression(bitmap, width, height, Rendition::Compression::Small);
+        EXPECT_LE(smallValue.size(), defaultValue.size());
+
+        /* All compression choices decode to the original pixels. */
+        for (std::vector<uint8_t> &value : { std::ref(defaultValue), std::ref(fastValue), std::ref(smallValue) }) {
+            car::Rendition deserialized = car::Rendition::Load(EmptyAttributeList(), reinterpret_cast<struct car_rendition_value *>(value.data()));
+            auto deserialized_data = deserialized.data();
+            ASSERT_NE(deserialized_data, ext::nullopt);
+            EXPECT_EQ(deserialized_data->data(), bitmap);
+        }
+    }
+}
+
+TEST(Rendition, SerializeEncodeCache)
+{
+    size_t width = 16;
+    size_t height = 16;
+
+    auto gradient = std::vector<uint8_t>(width * height * 4);
+    for (size_t i = 0; i < gradient.size(); i++) {
+        gradient[i] = static_cast<uint8_t>((i * 7) / 5);
+    }
+    auto other = gradient;
+    other[0] = 0xff;
+
+    auto create = [width, height](std::vector<uint8_t> const &bitmap, Rendition::Compression compression) {
+        car::Rendition rendition = car::Rendition::Create(EmptyAttributeList(), car::Rendition::Data(bitmap, car::Rendition::Data::Format::PremultipliedBGRA8));
+        rendition.width() = width;
+        rendition.height() = height;
+        rendition.scale() = 1.0;
+        rendition.fileName() = "test.png";
+        rendition.layout() = car_rendition_value_layout_one_part_scale;
+        rendition.compression() = compression;
+        return rendition;
+    };
+
+    /* Results are the same with or without the cache. */
+    Rendition::EncodeCache cache;
+    EXPECT_EQ(create(gradient, Rendition::Compression::Default).write(&cache), create(gradient, Rendition::Compression::Default).write());
+    EXPECT_EQ(create(gradient, Rendition::Compression::Default).write(&cache), create(gradient, Rendition::Compression::Default).write());
+
+    /* Different pixels or compression are not reused. */
+    EXPECT_EQ(create(other, Rendition::Compression::Default).write(&cache), create(other, Rendition::Compression::Default).write());
+    EXPECT_EQ(create(gradient, Rendition::Compression::Small).write(&cache), create(gradient, Rendition::Compression::Small).write());
+    EXPECT_NE(create(other, Rendition::Compression::Default).write(&cache), create(gradient, Rendition::Compression::Default).write(&cache));
+
+    /* Pixels are compared, so colliding keys are not reused. */
+    Rendition::EncodeCache colliding;
+    auto encoded = std::make_shared<std::vector<uint8_t> const>(std::vector<uint8_t>({ 1, 2, 3 }));
+    colliding.insert("key", gradient.data(), gradient.size(), encoded);
+    EXPECT_EQ(encoded, colliding.find("key", gradient.data(), gradient.size()));
+    EXPECT_EQ(nullptr, colliding.find("key", other.data(), other.size()));
+    EXPECT_EQ(nullptr, colliding.find("key", gradient.data(), gradient.size() - 1));
+}
@@ -18,6 +18,7 @@
 #include <car/Writer.h>
 #include <car/Reader.h>
 
+#include <algorithm>
 #include <cstdio>
 #include <string>
 
@@ -254,3 +255,151 @@ TEST(Writer, TestWriter100Optimal)
     EXPECT_EQ(rendition_count, create_rendition_count);
 }
 
+
+TEST(Writer, TestWriterMultiplePages)
+{
+    /* Enough facets and renditions to need several leaf pages per tree. */
+    size_t create_facet_count = 1500;
+
+    auto writer_bom = car::Writer::unique_ptr_bom(bom_alloc_empty(bom_context_memory(NULL, 0)), bom_free);
+    EXPECT_NE(writer_bom, nullptr);
+
+    auto writer = car::Writer::Create(std::move(writer_bom));
+    EXPECT_NE(writer, ext::nullopt);
+
+    for (size_t facet_identifier = 1; facet_identifier <= create_facet_count; facet_identifier++) {
+      car::AttributeList attributes = car::AttributeList({
+          { car_attribute_identifier_idiom, car_attribute_identifier_idiom_value_universal },
+          { car_attribute_identifier_scale, 1 },
+          { car_attribute_identifier_identifier, static_cast<uint16_t>(facet_identifier) },
+      });
+
+      car::Facet facet = car::Facet::Create("testpattern_" + std::to_string(facet_identifier), attributes);
+      writer->addFacet(facet);
+
+      auto data = car::Rendition::Data(test_pixels, car::Rendition::Data::Format::PremultipliedBGRA8);
+      car::Rendition rendition = car::Rendition::Create(attributes, data);
+      rendition.width() = 8;
+      rendition.height() = 8;
+      rendition.scale() = 1.0;
+      rendition.fileName() = "testpattern_" + std::to_string(facet_identifier) + ".png";
+      rendition.layout() = car_rendition_value_layout_one_part_scale;
+      writer->addRendition(rendition);
+    }
+
+    writer->write();
+
+    /* Read back. */
+    struct bom_context_memory const *writer_memory = bom_memory(writer->bom());
+    struct bom_context_memory reader_memory = bom_context_memory(writer_memory->data, writer_memory->size);
+    auto reader_bom = std::unique_ptr<struct bom_context, decltype(&bom_free)>(bom_alloc_load(reader_memory), bom_free);
+    EXPECT_NE(reader_bom, nullptr);
+
+    /* Facet keys are visited in sorted order across pages. */
+    struct bom_tree_context *facets_tree = bom_tree_alloc_load(reader_bom.get(), car_facet_keys_variable);
+    ASSERT_NE(facets_tree, nullptr);
+    std::vector<std::string> facet_names;
+    bom_tree_iterate(facets_tree, [](struct bom_tree_context *tree, void *key, size_t key_len, void *value, size_t value_len, void *ctx) {
+        static_cast<std::vector<std::string> *>(ctx)->push_back(std::string(static_cast<char const *>(key), key_len));
+    }, &facet_names);
+    bom_tree_free(facets_tree);
+    EXPECT_EQ(facet_names.size(), create_facet_count);
+    EXPECT_TRUE(std::is_sorted(facet_names.begin(), facet_names.end()));
+
+    ext::optional<car::Reader> reader = car::Reader::Load(std::move(reader_bom));
+    EXPECT_NE(reader, ext::nullopt);
+
+    size_t facet_count = 0;
+    size_t rendition_count = 0;
+    reader->facetIterate([&reader, &facet_count, &rendition_count](car::Facet const &facet) {
+        facet_count++;
+        rendition_count += reader->lookupRenditions(facet).size();
+    });
+
+    EXPECT_EQ(facet_count, create_facet_count);
+    EXPECT_EQ(rendition_count, create_facet_count);
+    EXPECT_EQ(static_cast<size_t>(reader->facetCount()), create_facet_count);
+    EXPECT_EQ(static_cast<size_t>(reader->renditionCount()), create_facet_count);
+
+    /* Look up a single facet and its renditions by name. */
+    ext::optional<car::Facet> facet = reader->lookupFacet("testpattern_1234");
+    ASSERT_NE(facet, ext::nullopt);
+    EXPECT_EQ(facet->attributes().get(car_attribute_identifier_identifier), ext::optional<uint16_t>(1234));
+
+    std::vector<car::Rendition> renditions = reader->lookupRenditions(*facet);
+    ASSERT_EQ(renditions.size(), 1u);
+    EXPECT_EQ(renditions.front().fileName(), "testpattern_1234.png");
+    EXPECT_EQ(renditions.front().data()->data(), test_pixels);
+
+    EXPECT_EQ(reader->lookupFacet("testpattern_0"), ext::nullopt);
+    EXPECT_EQ(reader->lookupFacet("testpattern_12345"), ext::nullopt);
+}
+
+TEST(Writer, TestWriterSharedValues)
+{
+    auto writer_bom = car::Writer::unique_ptr_bom(bom_alloc_empty(bom_context_memory(NULL, 0)), bom_free);
+    EXPECT_NE(writer_bom, nullptr);
+
+    auto writer = car::Writer::Create(std::move(writer_bom));
+    EXPECT_NE(writer, ext::nullopt);
+
+    car::Facet facet = car::Facet::Create("testpattern", car::AttributeList({
+        { car_attribute_identifier_identifier, 1 },
+    }));
+    writer->addFacet(facet);
+
+    /* The same image for two idioms, and a different image for a third. */
+    std::vector<uint8_t> other_pixels = test_pixels;
+    other_pixels[0] = 0xff;
+    std::vector<std::pair<uint16_t, std::vector<uint8_t>>> idioms = {
+        { car_attribute_identifier_idiom_value_phone, test_pixels },
+        { car_attribute_identifier_idiom_value_pad, test_pixels },
+        { car_attribute_identifier_idiom_value_tv, other_pixels },
+    };
+    for (auto const &idiom : idioms) {
+        car::AttributeList attributes = car::AttributeList({
+            { car_attribute_identifier_idiom, idiom.first },
+            { car_attribute_identifier_scale, 1 },
+            { car_attribute_identifier_identifier, 1 },
+        });
+
+        car::Rendition rendition = car::Rendition::Create(attributes, car::Rendition::Data(idiom.second, car::Rendition::Data::Format::PremultipliedBGRA8));
+        rendition.width() = 8;
+        rendition.height() = 8;
+        rendition.scale() = 1.0;
+        rendition.fileName() = "testpattern.png";
+        rendition.layout() = car_rendition_value_layout_one_part_scale;
+        writer->addRendition(rendition);
+    }
+
+    writer->write();
+
+    /* Read back. */
+    struct bom_context_memory const *writer_memory = bom_memory(writer->bom());
+    struct bom_context_memory reader_memory = bom_context_memory(writer_memory->data, writer_memory->size);
+    auto reader_bom = std::unique_ptr<struct bom_context, decltype(&bom_free)>(bom_alloc_load(reader_memory), bom_free);
+    EXPECT_NE(reader_bom, nullptr);
+
+    /* The identical renditions point at the same value. */
+    std::vector<void *> values;
+    struct bom_tree_context *renditions_tree = bom_tree_alloc_load(reader_bom.get(), car_renditions_variable);
+    ASSERT_NE(renditions_tree, nullptr);
+    bom_tree_iterate(renditions_tree, [](struct bom_tree_context *tree, void *key, size_t key_len, void *value, size_t value_len, void *ctx) {
+        static_cast<std::vector<void *> *>(ctx)->push_back(value);
+    }, &values);
+    bom_tree_free(renditions_tree);
+    ASSERT_EQ(values.size(), 3);
+    std::sort(values.begin(), values.end());
+    EXPECT_EQ(std::unique(values.begin(), values.end()) - values.begin(), 2);
+
+    ext::optional<car::Reader> reader = car::Reader::Load(std::move(reader_bom));
+    EXPECT_NE(reader, ext::nullopt);
+
+    std::vector<car::Rendition> renditions = reader->lookupRenditions(facet);
+    ASSERT_EQ(renditions.size(), 3);
+    for (car::Rendition const &rendition : renditions) {
+        ext::optional<uint16_t> idiom = rendition.attributes().get(car_attribute_identifier_idiom);
+        ASSERT_NE(idiom, ext::nullopt);
+        EXPECT_EQ(rendition.data()->data(), (*idiom == car_attribute_identifier_idiom_value_tv ? other_pixels : test_pixels));
+    }
+}
@@ -86,8 +86,8 @@ rendition_dump(car::Rendition const &rendition, std::string const &path)
 int
 main(int argc, char **argv)
 {
-    if (argc != 2 && argc != 3) {
-        fprintf(stderr, "error: missing input\n");
+    if (argc < 2 || argc > 4) {
+        fprintf(stderr, "usage: %s input.car [output] [facet]\n", argv[0]);
         return 1;
     }
 
@@ -96,6 +96,12 @@ main(int argc, char **argv)
         output = argv[2];
     }
 
+    /* Only dump one facet, if specified. */
+    ext::optional<std::string> name;
+    if (argc > 3) {
+        name = std::string(argv[3]);
+    }
+
     struct bom_context_memory memory = bom_context_memory_file(argv[1], false, 0);
     auto bom = std::unique_ptr<struct bom_context, decltype(&bom_free)>(bom_alloc_load(memory), bom_free);
     if (bom == nullptr) {
@@ -125,7 +131,7 @@ main(int argc, char **argv)
     int facet_count = 0;
     int rendition_count = 0;
 
-    car->facetIterate([&car, &facet_count, &rendition_count, output](car::Facet const &facet) {
+    auto facet_dump = [&car, &facet_count, &rendition_count, output](car::Facet const &facet) {
         facet_count++;
         facet.dump();
 
@@ -135,7 +141,19 @@ main(int argc, char **argv)
             rendition_dump(rendition, output + "/" + rendition.fileName());
             rendition_count++;
         }
-    });
+    };
+
+    if (name) {
+        ext::optional<car::Facet> facet = car->lookupFacet(*name);
+        if (!facet) {
+            fprintf(stderr, "error: no facet named %s\n", name->c_str());
+            return 1;
+        }
+
+        facet_dump(*facet);
+    } else {
+        car->facetIterate(facet_dump);
+    }
 
     printf("Found %d facets and %d renditions\n", facet_count, rendition_count);
     return 0;
@@ -18,6 +18,8 @@ class DefaultFilesystem : public Filesystem {
 public:
     virtual bool exists(std::string const &path) const;
     virtual ext::optional<Type> type(std::string const &path) const;
+    virtual ext::optional<uint64_t> modificationTime(std::string const &path) const;
+    virtual ext::optional<uint64_t> size(std::string const &path) const;
 
 public:
     virtual bool isReadable(std::string const &path) const;
@@ -29,8 +31,10 @@ public:
     virtual bool writeFilePermissions(std::string const &path, Permissions::Operation operation, Permissions permissions);
     virtual bool createFile(std::string const &path);
     virtual bool read(std::vector<uint8_t> *contents, std::string const &path, size_t offset = 0, ext::optional<size_t> length = ext::nullopt) const;
+    virtual ext::optional<MappedFile> map(std::string const &path) const;
     virtual bool write(std::vector<uint8_t> const &contents, std::string const &path);
     virtual bool copyFile(std::string const &from, std::string const &to);
+    virtual bool moveFile(std::string const &from, std::string const &to);
     virtual bool removeFile(std::string const &path);
 
 public:
@@ -10,6 +10,7 @@
 #ifndef __libutil_Filesystem_h
 #define __libutil_Filesystem_h
 
+#include <libutil/MappedFile.h>
 #include <libutil/Permissions.h>
 
 #include <functional>
@@ -50,6 +51,18 @@ public:
      */
     virtual ext::optional<Type> type(std::string const &path) const = 0;
 
+    /*
+     * Get the last modification time of a filesystem entry, following
+     * symbolic links. The time is in nanoseconds from an unspecified
+     * epoch, so it is only useful to compare against other entries.
+     */
+    virtual ext::optional<uint64_t> modificationTime(std::string const &path) const = 0;
+
+    /*
+     * Get the size in bytes of a file, following symbolic links.
+     */
+    virtual ext::optional<uint64_t> size(std::string const &path) const = 0;
+
 public:
     /*
      * Test if a file is readable.
@@ -88,16 +101,34 @@ public:
      */
     virtual bool read(std::vector<uint8_t> *contents, std::string const &path, size_t offset = 0, ext::optional<size_t> length = ext::nullopt) const = 0;
 
+    /*
+     * Map a file for reading, avoiding a copy of its contents where
+     * possible. By default, reads the file into memory.
+     */
+    virtual ext::optional<MappedFile> map(std::string const &path) const;
+
     /*
      * Write to a file.
      */
     virtual bool write(std::vector<uint8_t> const &contents, std::string const &path) = 0;
 
+    /*
+     * Write to a file through a temporary file moved into place, so
+     * other readers never see a partial write.
+     */
+    bool writeAtomic(std::vector<uint8_t> const &contents, std::string const &path);
+
     /*
      * Copy a file to a new path.
      */
     virtual bool copyFile(std::string const &from, std::string const &to);
 
+    /*
+     * Move a file to a new path, replacing any file there. By default,
+     * copies the file then removes the original.
+     */
+    virtual bool moveFile(std::string const &from, std::string const &to);
+
     /*
      * Delete a file.
      */
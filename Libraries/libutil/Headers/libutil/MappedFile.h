@@ -0,0 +1,49 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef __libutil_MappedFile_h
+#define __libutil_MappedFile_h
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <ext/span>
+
+namespace libutil {
+
+/*
+ * Read-only contents of a file, without a copy where possible. The storage
+ * behind the contents, such as a memory mapping, lives as long as any copy
+ * of the mapped file does.
+ */
+class MappedFile {
+private:
+    std::shared_ptr<void const> _storage;
+    ext::span<uint8_t const>    _contents;
+
+public:
+    MappedFile(std::shared_ptr<void const> const &storage, ext::span<uint8_t const> contents);
+
+public:
+    /*
+     * The contents of the file.
+     */
+    ext::span<uint8_t const> contents() const
+    { return _contents; }
+
+public:
+    /*
+     * Create a mapped file owning a copy of some contents.
+     */
+    static MappedFile Copy(std::vector<uint8_t> const &contents);
+};
+
+}
+
+#endif // !__libutil_MappedFile_h
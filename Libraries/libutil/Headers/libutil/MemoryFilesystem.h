@@ -22,7 +22,8 @@ public:
 
     public:
         Type                 _type;
-        std::vector<uint8_t> _contents;
+        uint64_t             _modificationTime;
+        std::shared_ptr<std::vector<uint8_t> const> _contents;
         std::vector<Entry>   _children;
 
     private:
@@ -37,10 +38,16 @@ public:
     public:
         Type type() const
         { return _type; }
-        std::vector<uint8_t> &contents()
-        { return _contents; }
+        uint64_t &modificationTime()
+        { return _modificationTime; }
+        uint64_t modificationTime() const
+        { return _modificationTime; }
         std::vector<uint8_t> const &contents() const
+        { return *_contents; }
+        std::shared_ptr<std::vector<uint8_t> const> const &sharedContents() const
         { return _contents; }
+        void setContents(std::vector<uint8_t> const &contents)
+        { _contents = std::make_shared<std::vector<uint8_t> const>(contents); }
         std::vector<Entry> &children()
         { return _children; }
         std::vector<Entry> const &children() const
@@ -56,7 +63,8 @@ public:
     };
 
 private:
-    Entry _root;
+    Entry    _root;
+    uint64_t _clock;
 
 public:
     MemoryFilesystem(std::vector<Entry> const &entries);
@@ -73,6 +81,8 @@ public:
 public:
     virtual bool exists(std::string const &path) const;
     virtual ext::optional<Type> type(std::string const &path) const;
+    virtual ext::optional<uint64_t> modificationTime(std::string const &path) const;
+    virtual ext::optional<uint64_t> size(std::string const &path) const;
 
 public:
     virtual bool isReadable(std::string const &path) const;
@@ -84,8 +94,10 @@ public:
     virtual bool writeFilePermissions(std::string const &path, Permissions::Operation operation, Permissions permissions);
     virtual bool createFile(std::string const &path);
     virtual bool read(std::vector<uint8_t> *contents, std::string const &path, size_t offset = 0, ext::optional<size_t> length = ext::nullopt) const;
+    virtual ext::optional<MappedFile> map(std::string const &path) const;
     virtual bool write(std::vector<uint8_t> const &contents, std::string const &path);
     virtual bool copyFile(std::string const &from, std::string const &to);
+    virtual bool moveFile(std::string const &from, std::string const &to);
     virtual bool removeFile(std::string const &path);
 
 public:
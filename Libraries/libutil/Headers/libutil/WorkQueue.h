@@ -0,0 +1,70 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef __libutil_WorkQueue_h
+#define __libutil_WorkQueue_h
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace libutil {
+
+/*
+ * A fixed-size pool of worker threads that runs queued work in the
+ * order it was enqueued. Threads are started on demand, so an unused
+ * queue costs nothing. Destroying the queue waits for all queued work.
+ */
+class WorkQueue {
+private:
+    size_t                            _threadCount;
+    std::vector<std::thread>          _threads;
+    size_t                            _idle;
+    std::mutex                        _mutex;
+    std::condition_variable           _condition;
+    std::deque<std::function<void()>> _work;
+    bool                              _stopped;
+
+public:
+    explicit WorkQueue(size_t threadCount);
+    ~WorkQueue();
+
+private:
+    WorkQueue(WorkQueue const &) = delete;
+    WorkQueue &operator=(WorkQueue const &) = delete;
+
+public:
+    /*
+     * The maximum number of work items run at once.
+     */
+    size_t threadCount() const
+    { return _threadCount; }
+
+public:
+    /*
+     * Queue work to run on a worker thread.
+     */
+    void enqueue(std::function<void()> const &work);
+
+private:
+    void run();
+
+public:
+    /*
+     * The number of threads to use by default: one per hardware thread.
+     */
+    static size_t DefaultThreadCount();
+};
+
+}
+
+#endif  // !__libutil_WorkQueue_h
@@ -24,6 +24,8 @@
 #include <unistd.h>
 #include <libgen.h>
 #include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #if defined(__APPLE__) || defined(__FreeBSD__)
 #include <copyfile.h>
@@ -34,6 +36,7 @@
 
 using libutil::DefaultFilesystem;
 using libutil::Filesystem;
+using libutil::MappedFile;
 using libutil::Permissions;
 
 #if _WIN32
@@ -183,6 +186,57 @@ type(std::string const &path) const
 #endif
 }
 
+ext::optional<uint64_t> DefaultFilesystem::
+modificationTime(std::string const &path) const
+{
+#if _WIN32
+    WideString wide = StringToWideString(path);
+
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (!GetFileAttributesExW(wide.c_str(), GetFileExInfoStandard, &data)) {
+        return ext::nullopt;
+    }
+
+    /* File times are in 100 nanosecond intervals. */
+    uint64_t time = (static_cast<uint64_t>(data.ftLastWriteTime.dwHighDateTime) << 32) | data.ftLastWriteTime.dwLowDateTime;
+    return time * 100;
+#else
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0) {
+        return ext::nullopt;
+    }
+
+#if defined(__APPLE__)
+    struct timespec const &time = st.st_mtimespec;
+#else
+    struct timespec const &time = st.st_mtim;
+#endif
+    return static_cast<uint64_t>(time.tv_sec) * 1000000000 + static_cast<uint64_t>(time.tv_nsec);
+#endif
+}
+
+ext::optional<uint64_t> DefaultFilesystem::
+size(std::string const &path) const
+{
+#if _WIN32
+    WideString wide = StringToWideString(path);
+
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (!GetFileAttributesExW(wide.c_str(), GetFileExInfoStandard, &data)) {
+        return ext::nullopt;
+    }
+
+    return (static_cast<uint64_t>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+#else
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0) {
+        return ext::nullopt;
+    }
+
+    return static_cast<uint64_t>(st.st_size);
+#endif
+}
+
 bool DefaultFilesystem::
 isReadable(std::string const &path) const
 {
@@ -562,6 +616,49 @@ read(std::vector<uint8_t> *contents, std::string const &path, size_t offset, ext
 #endif
 }
 
+ext::optional<MappedFile> DefaultFilesystem::
+map(std::string const &path) const
+{
+#if _WIN32
+    return Filesystem::map(path);
+#else
+    /*
+     * Below this size, setting up and tearing down a mapping costs more
+     * than copying the contents into memory.
+     */
+    static off_t const MinimumMapSize = 16 * 1024;
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return ext::nullopt;
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        ::close(fd);
+        return ext::nullopt;
+    }
+
+    if (st.st_size < MinimumMapSize) {
+        ::close(fd);
+        return Filesystem::map(path);
+    }
+
+    size_t size = static_cast<size_t>(st.st_size);
+    void *address = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+
+    if (address == MAP_FAILED) {
+        return Filesystem::map(path);
+    }
+
+    auto storage = std::shared_ptr<void const>(address, [size](void const *address) {
+        ::munmap(const_cast<void *>(address), size);
+    });
+    return MappedFile(storage, ext::span<uint8_t const>(static_cast<uint8_t const *>(address), size));
+#endif
+}
+
 bool DefaultFilesystem::
 write(std::vector<uint8_t> const &contents, std::string const &path)
 {
@@ -664,6 +761,26 @@ copyFile(std::string const &from, std::string const &to)
 #endif
 }
 
+bool DefaultFilesystem::
+moveFile(std::string const &from, std::string const &to)
+{
+#if _WIN32
+    WideString fwide = StringToWideString(from);
+    WideString twide = StringToWideString(to);
+    if (!MoveFileExW(fwide.c_str(), twide.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+        return false;
+    }
+
+    return true;
+#else
+    if (::rename(from.c_str(), to.c_str()) < 0) {
+        return false;
+    }
+
+    return true;
+#endif
+}
+
 bool DefaultFilesystem::
 removeFile(std::string const &path)
 {
@@ -925,11 +1042,17 @@ createDirectory(std::string const &path, bool recursive)
 #if _WIN32
             WideString wide = StringToWideString(directory);
             if (!CreateDirectoryW(wide.c_str(), nullptr)) {
-                return false;
+                /* Another process or thread may have created it concurrently. */
+                if (GetLastError() != ERROR_ALREADY_EXISTS || this->type(directory) != Type::Directory) {
+                    return false;
+                }
             }
 #else
             if (::mkdir(directory.c_str(), mode) != 0) {
-                return false;
+                /* Another process or thread may have created it concurrently. */
+                if (errno != EEXIST || this->type(directory) != Type::Directory) {
+                    return false;
+                }
             }
 #endif
 
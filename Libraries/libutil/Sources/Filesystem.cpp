@@ -10,12 +10,24 @@
 #include <libutil/Filesystem.h>
 #include <libutil/FSUtil.h>
 
+#include <random>
 #include <unordered_set>
 #include <sstream>
 
 using libutil::Filesystem;
 using libutil::FSUtil;
 
+ext::optional<libutil::MappedFile> Filesystem::
+map(std::string const &path) const
+{
+    std::vector<uint8_t> contents;
+    if (!this->read(&contents, path)) {
+        return ext::nullopt;
+    }
+
+    return MappedFile::Copy(contents);
+}
+
 bool Filesystem::
 copyFile(std::string const &from, std::string const &to)
 {
@@ -32,6 +44,41 @@ copyFile(std::string const &from, std::string const &to)
     return true;
 }
 
+bool Filesystem::
+moveFile(std::string const &from, std::string const &to)
+{
+    if (!this->copyFile(from, to)) {
+        return false;
+    }
+
+    return this->removeFile(from);
+}
+
+bool Filesystem::
+writeAtomic(std::vector<uint8_t> const &contents, std::string const &path)
+{
+    /*
+     * Write next to the destination so the move stays on one volume. The
+     * random suffix keeps concurrent writers from sharing a temporary file.
+     */
+    std::random_device device;
+    std::ostringstream temporary;
+    temporary << path << ".tmp." << std::hex << device();
+    std::string temporaryPath = temporary.str();
+
+    if (!this->write(contents, temporaryPath)) {
+        this->removeFile(temporaryPath);
+        return false;
+    }
+
+    if (!this->moveFile(temporaryPath, path)) {
+        this->removeFile(temporaryPath);
+        return false;
+    }
+
+    return true;
+}
+
 bool Filesystem::
 copySymbolicLink(std::string const &from, std::string const &to)
 {
@@ -0,0 +1,26 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <libutil/MappedFile.h>
+
+using libutil::MappedFile;
+
+MappedFile::
+MappedFile(std::shared_ptr<void const> const &storage, ext::span<uint8_t const> contents) :
+    _storage (storage),
+    _contents(contents)
+{
+}
+
+MappedFile MappedFile::
+Copy(std::vector<uint8_t> const &contents)
+{
+    auto storage = std::make_shared<std::vector<uint8_t> const>(contents);
+    return MappedFile(storage, ext::span<uint8_t const>(*storage));
+}
@@ -21,8 +21,10 @@ using libutil::FSUtil;
 
 MemoryFilesystem::Entry::
 Entry(std::string const &name, Type type) :
-    _name(name),
-    _type(type)
+    _name            (name),
+    _type            (type),
+    _modificationTime(0),
+    _contents        (std::make_shared<std::vector<uint8_t> const>())
 {
 }
 
@@ -58,7 +60,7 @@ MemoryFilesystem::Entry MemoryFilesystem::Entry::
 File(std::string const &name, std::vector<uint8_t> const &contents)
 {
     MemoryFilesystem::Entry entry = MemoryFilesystem::Entry(name, Type::File);
-    entry.contents() = contents;
+    entry.setContents(contents);
     return entry;
 }
 
@@ -73,10 +75,11 @@ Directory(std::string const &name, std::vector<Entry> const &children)
 MemoryFilesystem::
 MemoryFilesystem(std::vector<MemoryFilesystem::Entry> const &entries) :
 #if _WIN32
-    _root(MemoryFilesystem::Entry::Directory("C:", entries))
+    _root (MemoryFilesystem::Entry::Directory("C:", entries)),
 #else
-    _root(MemoryFilesystem::Entry::Directory("", entries))
+    _root (MemoryFilesystem::Entry::Directory("", entries)),
 #endif
+    _clock(0)
 {
 }
 
@@ -196,6 +199,42 @@ type(std::string const &path) const
     return type;
 }
 
+ext::optional<uint64_t> MemoryFilesystem::
+modificationTime(std::string const &path) const
+{
+    ext::optional<uint64_t> modificationTime;
+
+    if (!WalkPath<MemoryFilesystem::Entry const>(this, path, false, [&modificationTime](MemoryFilesystem::Entry const *parent, std::string const &name, MemoryFilesystem::Entry const *entry) -> MemoryFilesystem::Entry const * {
+        if (entry != nullptr) {
+            modificationTime = entry->modificationTime();
+        }
+
+        return entry;
+    })) {
+        return ext::nullopt;
+    }
+
+    return modificationTime;
+}
+
+ext::optional<uint64_t> MemoryFilesystem::
+size(std::string const &path) const
+{
+    ext::optional<uint64_t> size;
+
+    if (!WalkPath<MemoryFilesystem::Entry const>(this, path, false, [&size](MemoryFilesystem::Entry const *parent, std::string const &name, MemoryFilesystem::Entry const *entry) -> MemoryFilesystem::Entry const * {
+        if (entry != nullptr && entry->type() == Type::File) {
+            size = entry->contents().size();
+        }
+
+        return entry;
+    })) {
+        return ext::nullopt;
+    }
+
+    return size;
+}
+
 bool MemoryFilesystem::
 isReadable(std::string const &path) const
 {
@@ -270,7 +309,7 @@ writeDirectoryPermissions(std::string const &path, Permissions::Operation operat
 bool MemoryFilesystem::
 createFile(std::string const &path)
 {
-    return WalkPath<MemoryFilesystem::Entry>(this, path, false, [](MemoryFilesystem::Entry *parent, std::string const &name, MemoryFilesystem::Entry *entry) -> MemoryFilesystem::Entry * {
+    return WalkPath<MemoryFilesystem::Entry>(this, path, false, [this](MemoryFilesystem::Entry *parent, std::string const &name, MemoryFilesystem::Entry *entry) -> MemoryFilesystem::Entry * {
         if (entry != nullptr) {
             if (entry->type() == Type::File) {
                 /* Exists as a file. */
@@ -282,6 +321,7 @@ createFile(std::string const &path)
         } else {
             /* Add empty file. */
             MemoryFilesystem::Entry file = MemoryFilesystem::Entry::File(name, std::vector<uint8_t>());
+            file.modificationTime() = ++_clock;
             std::vector<MemoryFilesystem::Entry> *children = &parent->children();
             children->emplace_back(std::move(file));
             return &children->back();
@@ -309,6 +349,23 @@ read(std::vector<uint8_t> *contents, std::string const &path, size_t offset, ext
     });
 }
 
+ext::optional<libutil::MappedFile> MemoryFilesystem::
+map(std::string const &path) const
+{
+    ext::optional<MappedFile> mapped;
+    WalkPath<MemoryFilesystem::Entry const>(this, path, false, [&](MemoryFilesystem::Entry const *parent, std::string const &name, MemoryFilesystem::Entry const *entry) -> MemoryFilesystem::Entry const * {
+        if (entry == nullptr || entry->type() != Type::File) {
+            return nullptr;
+        }
+
+        /* Contents are never modified in place, so share them. */
+        std::shared_ptr<std::vector<uint8_t> const> const &contents = entry->sharedContents();
+        mapped = MappedFile(contents, ext::span<uint8_t const>(*contents));
+        return entry;
+    });
+    return mapped;
+}
+
 bool MemoryFilesystem::
 write(std::vector<uint8_t> const &contents, std::string const &path)
 {
@@ -316,7 +373,8 @@ write(std::vector<uint8_t> const &contents, std::string const &path)
         if (entry != nullptr) {
             if (entry->type() == Type::File) {
                 /* Exists as a file, replace contents. */
-                entry->contents() = contents;
+                entry->setContents(contents);
+                entry->modificationTime() = ++_clock;
                 return entry;
             } else {
                 /* Exists already, but not as a file. */
@@ -325,6 +383,7 @@ write(std::vector<uint8_t> const &contents, std::string const &path)
         } else {
             /* Add file. */
             MemoryFilesystem::Entry file = MemoryFilesystem::Entry::File(name, contents);
+            file.modificationTime() = ++_clock;
             std::vector<MemoryFilesystem::Entry> *children = &parent->children();
             children->emplace_back(std::move(file));
             return &children->back();
@@ -338,6 +397,12 @@ copyFile(std::string const &from, std::string const &to)
     return Filesystem::copyFile(from, to);
 }
 
+bool MemoryFilesystem::
+moveFile(std::string const &from, std::string const &to)
+{
+    return Filesystem::moveFile(from, to);
+}
+
 bool MemoryFilesystem::
 removeFile(std::string const &path)
 {
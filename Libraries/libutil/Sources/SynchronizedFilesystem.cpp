@@ -0,0 +1,236 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <libutil/SynchronizedFilesystem.h>
+
+using libutil::SynchronizedFilesystem;
+using libutil::Filesystem;
+using libutil::MappedFile;
+using libutil::Permissions;
+
+SynchronizedFilesystem::
+SynchronizedFilesystem(Filesystem *filesystem) :
+    _filesystem(filesystem)
+{
+}
+
+SynchronizedFilesystem::
+~SynchronizedFilesystem()
+{
+}
+
+bool SynchronizedFilesystem::
+exists(std::string const &path) const
+{
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+    return _filesystem->exists(path);
+}
+
+ext::optional<Filesystem::Type> SynchronizedFilesystem::
+type(std::string const &path) const
+{
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+    return _filesystem->type(path);
+}
+
+ext::optional<uint64_t> SynchronizedFilesystem::
+modificationTime(std::string const &path) const
+{
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+    return _filesystem->modificationTime(path);
+}
+
+ext::optional<uint64_t> SynchronizedFilesystem::
+size(std::string const &path) const
+{
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+    return _filesystem->size(path);
+}
+
+bool SynchronizedFilesystem::
+isReadable(std::string const &path) const
+{
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+    return _filesystem->isReadable(path);
+}
+
+bool SynchronizedFilesystem::
+isWritable(std::string const &path) const
+{
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+    return _filesystem->isWritable(path);
+}
+
+bool SynchronizedFilesystem::
+isExecutable(std::string const &path) const
+{
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+    return _filesystem->isExecutable(path);
+}
+
+ext::optional<Permissions> SynchronizedFilesystem::
+readFilePermissions(std::string const &path) const
+{
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+    return _filesystem->readFilePermissions(path);
+}
+
+bool SynchronizedFilesystem::
+writeFilePermissions(std::string const &path, Permissions::Operation operation, Permissions permissions)
+{
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+    return _filesystem->writeFilePermissions(path, operation, permissions);
+}
+
+bool SynchronizedFilesystem::
+createFile(std::string const &path)
+{
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+    return _filesystem->createFile(path);
+}
+
+bool SynchronizedFilesystem::
+read(std::vector<uint8_t> *contents, std::string const &path, size_t offset, ext::optional<size_t> length) const
+{
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+    return _filesystem->read(contents, path, offset, length);
+}
+
+ext::optional<MappedFile> SynchronizedFilesystem::
+map(std::string const &path) const
+{
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+    return _filesystem->map(path);
+}
+
+bool SynchronizedFilesystem::
+write(std::vector<uint8_t> const &contents, std::string const &path)
+{
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+    return _filesystem->write(contents, path);
+}
+
+bool SynchronizedFilesystem::
+copyFile(std::string const &from, std::string const &to)
+{
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+    return _filesystem->copyFile(from, to);
+}
+
+bool SynchronizedFilesystem::
+moveFile(std::string const &from, std::string const &to)
+{
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+    return _filesystem->moveFile(from, to);
+}
+
+bool SynchronizedFilesystem::
+removeFile(std::string const &path)
+{
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+    return _filesystem->removeFile(path);
+}
+
+ext::optional<Permissions> SynchronizedFilesystem::
+readSymbolicLinkPermissions(std::string const &path) const
+{
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+    return _filesystem->readSymbolicLinkPermissions(path);
+}
+
+bool SynchronizedFilesystem::
+writeSymbolicLinkPermissions(std::string const &path, Permissions::Operation operation, Permissions permissions)
+{
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+    return _filesystem->writeSymbolicLinkPermissions(path, operation, permissions);
+}
+
+ext::optional<std::string> SynchronizedFilesystem::
+readSymbolicLinkCanonical(std::string const &path, bool *directory) const
+{
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+    return _filesystem->readSymbolicLinkCanonical(path, directory);
+}
+
+ext::optional<std::string> SynchronizedFilesystem::
+readSymbolicLink(std::string const &path, bool *directory) const
+{
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+    return _filesystem->readSymbolicLink(path, directory);
+}
+
+bool SynchronizedFilesystem::
+writeSymbolicLink(std::string const &target, std::string const &path, bool directory)
+{
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+    return _filesystem->writeSymbolicLink(target, path, directory);
+}
+
+bool SynchronizedFilesystem::
+copySymbolicLink(std::string const &from, std::string const &to)
+{
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+    return _filesystem->copySymbolicLink(from, to);
+}
+
+bool SynchronizedFilesystem::
+removeSymbolicLink(std::string const &path)
+{
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+    return _filesystem->removeSymbolicLink(path);
+}
+
+ext::optional<Permissions> SynchronizedFilesystem::
+readDirectoryPermissions(std::string const &path) const
+{
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+    return _filesystem->readDirectoryPermissions(path);
+}
+
+bool SynchronizedFilesystem::
+writeDirectoryPermissions(std::string const &path, Permissions::Operation operation, Permissions permissions, bool recursive)
+{
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+    return _filesystem->writeDirectoryPermissions(path, operation, permissions, recursive);
+}
+
+bool SynchronizedFilesystem::
+createDirectory(std::string const &path, bool recursive)
+{
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+    return _filesystem->createDirectory(path, recursive);
+}
+
+bool SynchronizedFilesystem::
+readDirectory(std::string const &path, bool recursive, std::function<void(std::string const &)> const &cb) const
+{
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+    return _filesystem->readDirectory(path, recursive, cb);
+}
+
+bool SynchronizedFilesystem::
+copyDirectory(std::string const &from, std::string const &to, bool recursive)
+{
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+    return _filesystem->copyDirectory(from, to, recursive);
+}
+
+bool SynchronizedFilesystem::
+removeDirectory(std::string const &path, bool recursive)
+{
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+    return _filesystem->removeDirectory(path, recursive);
+}
+
+std::string SynchronizedFilesystem::
+resolvePath(std::string const &path) const
+{
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+    return _filesystem->resolvePath(path);
+}
@@ -0,0 +1,81 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <libutil/WorkQueue.h>
+
+using libutil::WorkQueue;
+
+WorkQueue::
+WorkQueue(size_t threadCount) :
+    _threadCount(threadCount > 0 ? threadCount : 1),
+    _idle       (0),
+    _stopped    (false)
+{
+}
+
+WorkQueue::
+~WorkQueue()
+{
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _stopped = true;
+    }
+    _condition.notify_all();
+
+    for (std::thread &thread : _threads) {
+        thread.join();
+    }
+}
+
+void WorkQueue::
+enqueue(std::function<void()> const &work)
+{
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _work.push_back(work);
+
+        /* Start another thread if all existing threads could be busy. */
+        if (_idle < _work.size() && _threads.size() < _threadCount) {
+            _threads.push_back(std::thread(&WorkQueue::run, this));
+        }
+    }
+    _condition.notify_one();
+}
+
+void WorkQueue::
+run()
+{
+    while (true) {
+        std::function<void()> work;
+
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _idle++;
+            _condition.wait(lock, [this] { return _stopped || !_work.empty(); });
+            _idle--;
+
+            /* Finish all queued work before stopping. */
+            if (_work.empty()) {
+                return;
+            }
+
+            work = std::move(_work.front());
+            _work.pop_front();
+        }
+
+        work();
+    }
+}
+
+size_t WorkQueue::
+DefaultThreadCount()
+{
+    unsigned int count = std::thread::hardware_concurrency();
+    return (count > 0 ? count : 1);
+}
@@ -10,6 +10,8 @@
 #include <gtest/gtest.h>
 #include <libutil/MemoryFilesystem.h>
 
+#include <algorithm>
+
 using libutil::MemoryFilesystem;
 using libutil::Filesystem;
 
@@ -19,6 +21,12 @@ Contents(std::string const &string)
     return std::vector<uint8_t>(string.begin(), string.end());
 }
 
+static std::vector<uint8_t>
+Contents(ext::span<uint8_t const> span)
+{
+    return std::vector<uint8_t>(span.begin(), span.end());
+}
+
 static MemoryFilesystem
 BasicFilesystem()
 {
@@ -61,6 +69,37 @@ TEST(MemoryFilesystem, Type)
     EXPECT_EQ(filesystem.type(filesystem.path("invalid1/invalid2")), ext::nullopt);
 }
 
+TEST(MemoryFilesystem, ModificationTime)
+{
+    auto filesystem = BasicFilesystem();
+    EXPECT_EQ(filesystem.modificationTime(filesystem.path("invalid")), ext::nullopt);
+
+    ext::optional<uint64_t> initial = filesystem.modificationTime(filesystem.path("file1"));
+    ASSERT_NE(initial, ext::nullopt);
+
+    /* Writing updates the modification time. */
+    EXPECT_TRUE(filesystem.write(Contents("new"), filesystem.path("file1")));
+    ext::optional<uint64_t> written = filesystem.modificationTime(filesystem.path("file1"));
+    ASSERT_NE(written, ext::nullopt);
+    EXPECT_GT(*written, *initial);
+
+    /* New files are newer than existing ones. */
+    EXPECT_TRUE(filesystem.createFile(filesystem.path("dir1/file3")));
+    ext::optional<uint64_t> created = filesystem.modificationTime(filesystem.path("dir1/file3"));
+    ASSERT_NE(created, ext::nullopt);
+    EXPECT_GT(*created, *written);
+}
+
+TEST(MemoryFilesystem, Size)
+{
+    auto filesystem = BasicFilesystem();
+    EXPECT_EQ(filesystem.size(filesystem.path("invalid")), ext::nullopt);
+    EXPECT_EQ(filesystem.size(filesystem.path("dir1")), ext::nullopt);
+
+    EXPECT_TRUE(filesystem.write(Contents("new"), filesystem.path("file1")));
+    EXPECT_EQ(filesystem.size(filesystem.path("file1")), ext::optional<uint64_t>(3));
+}
+
 TEST(MemoryFilesystem, IsReadable)
 {
     auto filesystem = BasicFilesystem();
@@ -164,6 +203,29 @@ TEST(MemoryFilesystem, Read)
     EXPECT_EQ(contents, Contents(""));
 }
 
+TEST(MemoryFilesystem, Map)
+{
+    auto filesystem = BasicFilesystem();
+
+    /* Map file. */
+    ext::optional<libutil::MappedFile> mapped = filesystem.map(filesystem.path("dir1/file2"));
+    ASSERT_TRUE(mapped);
+    EXPECT_EQ(Contents(mapped->contents()), Contents("two1"));
+
+    /* Mapped contents are unchanged by later writes. */
+    EXPECT_TRUE(filesystem.write(Contents("new"), filesystem.path("dir1/file2")));
+    EXPECT_EQ(Contents(mapped->contents()), Contents("two1"));
+    mapped = filesystem.map(filesystem.path("dir1/file2"));
+    ASSERT_TRUE(mapped);
+    EXPECT_EQ(Contents(mapped->contents()), Contents("new"));
+
+    /* Can't map directory. */
+    EXPECT_FALSE(filesystem.map(filesystem.path("dir1")));
+
+    /* Can't map nonexistent file. */
+    EXPECT_FALSE(filesystem.map(filesystem.path("invalid")));
+}
+
 TEST(MemoryFilesystem, Write)
 {
     auto filesystem = BasicFilesystem();
@@ -221,6 +283,44 @@ TEST(MemoryFilesystem, CopyFile)
     EXPECT_EQ(contents, Contents("one"));
 }
 
+TEST(MemoryFilesystem, MoveFile)
+{
+    std::vector<uint8_t> contents;
+    auto filesystem = BasicFilesystem();
+
+    /* Can't move a nonexistent file. */
+    EXPECT_FALSE(filesystem.moveFile(filesystem.path("invalid"), filesystem.path("moved")));
+
+    /* Can move over an existing file. */
+    EXPECT_TRUE(filesystem.moveFile(filesystem.path("file1"), filesystem.path("dir1/file2")));
+    EXPECT_FALSE(filesystem.exists(filesystem.path("file1")));
+    EXPECT_TRUE(filesystem.read(&contents, filesystem.path("dir1/file2")));
+    EXPECT_EQ(contents, Contents("one"));
+}
+
+TEST(MemoryFilesystem, WriteAtomic)
+{
+    std::vector<uint8_t> contents;
+    auto filesystem = BasicFilesystem();
+
+    /* Replaces the file, leaving no temporary file behind. */
+    EXPECT_TRUE(filesystem.writeAtomic(Contents("new"), filesystem.path("dir1/file2")));
+    EXPECT_TRUE(filesystem.read(&contents, filesystem.path("dir1/file2")));
+    EXPECT_EQ(contents, Contents("new"));
+
+    std::vector<std::string> files;
+    EXPECT_TRUE(filesystem.readDirectory(filesystem.path("dir1"), false, [&](std::string const &name) {
+        files.push_back(name);
+    }));
+    EXPECT_EQ(1, std::count(files.begin(), files.end(), "file2"));
+    EXPECT_EQ(0, std::count_if(files.begin(), files.end(), [](std::string const &name) {
+        return name.find(".tmp.") != std::string::npos;
+    }));
+
+    /* Must write to a real path. */
+    EXPECT_FALSE(filesystem.writeAtomic(Contents("new"), filesystem.path("invalid/file")));
+}
+
 TEST(MemoryFilesystem, RemoveFile)
 {
     auto filesystem = BasicFilesystem();
@@ -0,0 +1,67 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <gtest/gtest.h>
+#include <libutil/WorkQueue.h>
+
+#include <atomic>
+
+using libutil::WorkQueue;
+
+TEST(WorkQueue, RunsAllWork)
+{
+    std::atomic<int> count(0);
+
+    {
+        WorkQueue queue(4);
+        for (int i = 0; i < 100; i++) {
+            queue.enqueue([&count] { count++; });
+        }
+    }
+
+    EXPECT_EQ(100, count.load());
+}
+
+TEST(WorkQueue, LimitsConcurrency)
+{
+    std::atomic<int> running(0);
+    std::atomic<int> maximum(0);
+
+    {
+        WorkQueue queue(2);
+        for (int i = 0; i < 20; i++) {
+            queue.enqueue([&running, &maximum] {
+                int current = ++running;
+                int previous = maximum.load();
+                while (current > previous && !maximum.compare_exchange_weak(previous, current)) {
+                }
+
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                running--;
+            });
+        }
+    }
+
+    EXPECT_LE(maximum.load(), 2);
+    EXPECT_GE(maximum.load(), 1);
+}
+
+TEST(WorkQueue, SerialOrder)
+{
+    std::vector<int> order;
+
+    {
+        WorkQueue queue(1);
+        for (int i = 0; i < 10; i++) {
+            queue.enqueue([&order, i] { order.push_back(i); });
+        }
+    }
+
+    EXPECT_EQ(std::vector<int>({ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 }), order);
+}
@@ -17,6 +17,7 @@
 #include <ext/optional>
 
 namespace libutil { class Filesystem; }
+namespace pbxspec { class SpecificationCache; }
 namespace process { class Context; }
 namespace process { class User; }
 
@@ -34,12 +35,18 @@ private:
     pbxsetting::Environment              _baseEnvironment;
     std::vector<std::string>             _baseExecutablePaths;
 
+private:
+    std::shared_ptr<pbxspec::SpecificationCache> _specificationCache;
+    ext::optional<std::string>                   _specificationCachePath;
+
 public:
     Environment(
         pbxspec::Manager::shared_ptr const &specManager,
         std::shared_ptr<xcsdk::SDK::Manager> const &sdkManager,
         pbxsetting::Environment const &baseEnvironment,
-        std::vector<std::string> const &baseExecutablePaths);
+        std::vector<std::string> const &baseExecutablePaths,
+        std::shared_ptr<pbxspec::SpecificationCache> const &specificationCache,
+        ext::optional<std::string> const &specificationCachePath);
 
 public:
     /*
@@ -67,10 +74,19 @@ public:
     std::vector<std::string> const &baseExecutablePaths() const
     { return _baseExecutablePaths; }
 
+public:
+    /*
+     * Saves the specifications parsed while creating the environment,
+     * so later runs can skip parsing them. Failing to save is not fatal.
+     */
+    void saveSpecificationCache(libutil::Filesystem *filesystem) const;
+
 public:
     /*
      * Creates a build environment from the default configuration
-     * of each of the build environment's subcomponents.
+     * of each of the build environment's subcomponents. Parsed
+     * specifications are cached in $XCBUILD_SPECIFICATION_CACHE
+     * if it is set; otherwise, nothing is cached.
      */
     static ext::optional<Environment>
     Default(
@@ -23,11 +23,13 @@ class PhaseInvocations {
 private:
     std::vector<Tool::Invocation>    _invocations;
     std::vector<Tool::AuxiliaryFile> _auxiliaryFiles;
+    std::vector<std::string>         _scannedDirectories;
 
 public:
     PhaseInvocations(
         std::vector<Tool::Invocation> const &invocations,
-        std::vector<Tool::AuxiliaryFile> const &auxiliaryFiles);
+        std::vector<Tool::AuxiliaryFile> const &auxiliaryFiles,
+        std::vector<std::string> const &scannedDirectories);
     ~PhaseInvocations();
 
 public:
@@ -35,6 +37,8 @@ public:
     { return _invocations; }
     std::vector<Tool::AuxiliaryFile> const &auxiliaryFiles() const
     { return _auxiliaryFiles; }
+    std::vector<std::string> const &scannedDirectories() const
+    { return _scannedDirectories; }
 
 public:
     static PhaseInvocations
@@ -15,6 +15,7 @@
 
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace pbxsetting { class Environment; }
@@ -28,9 +29,20 @@ class PrecompiledHeaderInfo;
 class SearchPaths;
 
 class ClangResolver {
+private:
+    struct SourceTemplate;
+
 private:
     pbxspec::PBX::Compiler::shared_ptr _compiler;
 
+private:
+    /*
+     * Compiler invocations for sources, independent of the file being
+     * compiled. Keyed by everything besides the file's path that affects
+     * the invocation; the resolver is used for a single target.
+     */
+    mutable std::unordered_map<std::string, std::unique_ptr<SourceTemplate>> _sourceTemplates;
+
 public:
     ClangResolver(pbxspec::PBX::Compiler::shared_ptr const &compiler);
     ~ClangResolver();
@@ -46,6 +58,13 @@ public:
         pbxsetting::Environment const &environment,
         PrecompiledHeaderInfo const &precompiledHeaderInfo) const;
 
+private:
+    std::unique_ptr<SourceTemplate> createSourceTemplate(
+        Tool::Context *toolContext,
+        pbxsetting::Environment const &environment,
+        Tool::Input const &input,
+        std::string const &output) const;
+
 public:
     pbxspec::PBX::Compiler::shared_ptr const &compiler() const
     { return _compiler; }
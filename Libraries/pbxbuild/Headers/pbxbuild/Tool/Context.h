@@ -52,6 +52,7 @@ private:
 
 private:
     std::vector<Tool::AuxiliaryFile> _auxiliaryFiles;
+    std::vector<std::string>         _scannedDirectories;
 
 private:
     uint32_t                         _currentPhaseInvocationPriority;
@@ -120,6 +121,16 @@ public:
     std::vector<Tool::AuxiliaryFile> &auxiliaryFiles()
     { return _auxiliaryFiles; }
 
+public:
+    /*
+     * Directories whose contents were listed while resolving, so the
+     * resolved invocations can change when files are added or removed.
+     */
+    std::vector<std::string> const &scannedDirectories() const
+    { return _scannedDirectories; }
+    std::vector<std::string> &scannedDirectories()
+    { return _scannedDirectories; }
+
 public:
     uint32_t currentPhaseInvocationPriority() const
     { return _currentPhaseInvocationPriority; }
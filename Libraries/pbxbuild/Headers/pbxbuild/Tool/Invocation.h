@@ -12,6 +12,7 @@
 
 #include <dependency/DependencyInfoFormat.h>
 
+#include <memory>
 #include <string>
 #include <vector>
 #include <unordered_map>
@@ -89,6 +90,7 @@ private:
     ext::optional<Executable>                    _executable;
     std::vector<std::string>                     _arguments;
     std::unordered_map<std::string, std::string> _environment;
+    std::shared_ptr<std::unordered_map<std::string, std::string> const> _sharedEnvironment;
     std::string                                  _workingDirectory;
 
 private:
@@ -140,6 +142,24 @@ public:
     std::string &workingDirectory()
     { return _workingDirectory; }
 
+public:
+    /*
+     * Environment variables shared with other invocations, such as exported
+     * build settings. Variables in the invocation's own environment override
+     * shared variables with the same name.
+     */
+    std::shared_ptr<std::unordered_map<std::string, std::string> const> const &sharedEnvironment() const
+    { return _sharedEnvironment; }
+    std::shared_ptr<std::unordered_map<std::string, std::string> const> &sharedEnvironment()
+    { return _sharedEnvironment; }
+
+    /*
+     * The full environment to run the invocation with: its own environment
+     * variables combined with the shared environment variables.
+     */
+    std::unordered_map<std::string, std::string>
+    completeEnvironment() const;
+
 public:
     std::vector<std::string> const &inputs() const
     { return _inputs; }
@@ -12,6 +12,7 @@
 #include <xcsdk/Environment.h>
 #include <pbxsetting/DefaultSettings.h>
 #include <pbxsetting/Environment.h>
+#include <pbxspec/SpecificationCache.h>
 #include <process/Context.h>
 #include <process/User.h>
 #include <libutil/Filesystem.h>
@@ -24,14 +25,42 @@ Environment(
     pbxspec::Manager::shared_ptr const &specManager,
     std::shared_ptr<xcsdk::SDK::Manager> const &sdkManager,
     pbxsetting::Environment const &baseEnvironment,
-    std::vector<std::string> const &baseExecutablePaths) :
+    std::vector<std::string> const &baseExecutablePaths,
+    std::shared_ptr<pbxspec::SpecificationCache> const &specificationCache,
+    ext::optional<std::string> const &specificationCachePath) :
     _specManager(specManager),
     _sdkManager(sdkManager),
     _baseEnvironment(baseEnvironment),
-    _baseExecutablePaths(baseExecutablePaths)
+    _baseExecutablePaths(baseExecutablePaths),
+    _specificationCache(specificationCache),
+    _specificationCachePath(specificationCachePath)
 {
 }
 
+void Build::Environment::
+saveSpecificationCache(Filesystem *filesystem) const
+{
+    if (_specificationCache == nullptr || !_specificationCachePath || !_specificationCache->modified()) {
+        return;
+    }
+
+    if (!_specificationCache->save(filesystem, *_specificationCachePath)) {
+        fprintf(stderr, "warning: unable to write specification cache %s\n", _specificationCachePath->c_str());
+    }
+}
+
+static ext::optional<std::string>
+SpecificationCachePath(process::Context const *processContext)
+{
+    /* The cache is opt-in: nothing is written unless a path is given. */
+    ext::optional<std::string> path = processContext->environmentVariable("XCBUILD_SPECIFICATION_CACHE");
+    if (!path || path->empty()) {
+        return ext::nullopt;
+    }
+
+    return path;
+}
+
 ext::optional<Build::Environment> Build::Environment::
 Default(process::User const *user, process::Context const *processContext, Filesystem const *filesystem)
 {
@@ -58,10 +87,19 @@ Default(process::User const *user, process::Context const *processContext, Files
         }
     }
 
+    /*
+     * Load the cache of parsed specifications from previous runs.
+     */
+    ext::optional<std::string> cachePath = SpecificationCachePath(processContext);
+    std::shared_ptr<pbxspec::SpecificationCache> cache;
+    if (cachePath) {
+        cache = std::make_shared<pbxspec::SpecificationCache>(pbxspec::SpecificationCache::Load(filesystem, *cachePath));
+    }
+
     /*
      * Register global specifications.
      */
-    specManager->registerDomains(filesystem, pbxspec::Manager::DefaultDomains(*developerRoot));
+    specManager->registerDomains(filesystem, pbxspec::Manager::DefaultDomains(*developerRoot), cache.get());
 
     auto configuration = xcsdk::Configuration::Load(filesystem, xcsdk::Configuration::DefaultPaths(user, processContext));
     auto sdkManager = xcsdk::SDK::Manager::Open(filesystem, *developerRoot, configuration);
@@ -77,12 +115,12 @@ Default(process::User const *user, process::Context const *processContext, Files
     for (xcsdk::SDK::Platform::shared_ptr const &platform : sdkManager->platforms()) {
         platforms.insert({ platform->name(), platform->path() });
     }
-    specManager->registerDomains(filesystem, pbxspec::Manager::PlatformDomains(platforms));
+    specManager->registerDomains(filesystem, pbxspec::Manager::PlatformDomains(platforms), cache.get());
 
     /*
      * Register global specifications, but depend on platform-specific specifications.
      */
-    specManager->registerDomains(filesystem, pbxspec::Manager::PlatformDependentDomains(*developerRoot));
+    specManager->registerDomains(filesystem, pbxspec::Manager::PlatformDependentDomains(*developerRoot), cache.get());
 
     pbxspec::PBX::BuildSystem::shared_ptr buildSystem = specManager->buildSystem("com.apple.build-system.core", { "default" });
     if (buildSystem == nullptr) {
@@ -98,5 +136,5 @@ Default(process::User const *user, process::Context const *processContext, Files
         baseEnvironment.insertBack(level, false);
     }
 
-    return Build::Environment(specManager, sdkManager, baseEnvironment, processContext->executableSearchPaths());
+    return Build::Environment(specManager, sdkManager, baseEnvironment, processContext->executableSearchPaths(), cache, cachePath);
 }
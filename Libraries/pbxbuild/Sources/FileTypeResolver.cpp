@@ -14,7 +14,11 @@
 #include <libutil/Strings.h>
 #include <libutil/Wildcard.h>
 
+#include <algorithm>
 #include <cassert>
+#include <cstdlib>
+#include <iterator>
+#include <unordered_map>
 
 using pbxbuild::FileTypeResolver;
 using pbxbuild::DirectedGraph;
@@ -38,6 +42,148 @@ SortedFileTypes(std::vector<pbxspec::PBX::FileType::shared_ptr> const &fileTypes
     return graph.ordered();
 }
 
+static std::string
+Lowercase(std::string const &string)
+{
+    std::string result = string;
+    std::transform(result.begin(), result.end(), result.begin(), ::tolower);
+    return result;
+}
+
+namespace {
+
+/*
+ * A precompiled file name pattern. Plain names and "*suffix" patterns,
+ * which cover nearly all patterns in practice, avoid the wildcard matcher.
+ */
+class FilenamePattern {
+private:
+    enum class Kind {
+        Literal,
+        Suffix,
+        Wildcard,
+    };
+
+private:
+    Kind        _kind;
+    std::string _pattern;
+
+public:
+    explicit FilenamePattern(std::string const &pattern)
+    {
+        std::string::size_type special = pattern.find_first_of("*[");
+        if (special == std::string::npos) {
+            _kind = Kind::Literal;
+            _pattern = pattern;
+        } else if (special == 0 && pattern[0] == '*' && pattern.find_first_of("*[", 1) == std::string::npos) {
+            _kind = Kind::Suffix;
+            _pattern = pattern.substr(1);
+        } else {
+            _kind = Kind::Wildcard;
+            _pattern = pattern;
+        }
+    }
+
+public:
+    bool match(std::string const &fileName) const
+    {
+        switch (_kind) {
+            case Kind::Literal:
+                return fileName == _pattern;
+            case Kind::Suffix:
+                return fileName.size() >= _pattern.size() && fileName.compare(fileName.size() - _pattern.size(), _pattern.size(), _pattern) == 0;
+            case Kind::Wildcard:
+                return Wildcard::Match(_pattern, fileName);
+        }
+
+        abort();
+    }
+};
+
+/*
+ * Lookup structures for the file types in a set of domains. Built once per
+ * specification manager and domain set, then shared by every resolution.
+ */
+struct FileTypeIndex {
+    /* File types, most specific first. */
+    std::vector<pbxspec::PBX::FileType::shared_ptr> fileTypes;
+
+    /* Compiled filename patterns, parallel to the file types. */
+    std::vector<ext::optional<std::vector<FilenamePattern>>> patterns;
+
+    /* Candidate file types (as sorted indexes) by lowercased extension. */
+    std::unordered_map<std::string, std::vector<size_t>> extensions;
+
+    /* Candidate file types for an extension no file type declares. */
+    std::vector<size_t> extensionless;
+};
+
+}
+
+static std::shared_ptr<FileTypeIndex const>
+CreateFileTypeIndex(pbxspec::Manager::shared_ptr const &specManager, std::vector<std::string> const &domains)
+{
+    ext::optional<std::vector<pbxspec::PBX::FileType::shared_ptr>> sorted = SortedFileTypes(specManager->fileTypes(domains));
+    if (!sorted) {
+        return nullptr;
+    }
+
+    auto index = std::make_shared<FileTypeIndex>();
+
+    /* Ordered so more specific file types are processed first. */
+    index->fileTypes = *sorted;
+
+    std::unordered_map<std::string, std::vector<size_t>> extensions;
+    for (size_t i = 0; i < index->fileTypes.size(); ++i) {
+        pbxspec::PBX::FileType::shared_ptr const &fileType = index->fileTypes[i];
+
+        if (fileType->filenamePatterns()) {
+            std::vector<FilenamePattern> patterns;
+            for (std::string const &pattern : *fileType->filenamePatterns()) {
+                patterns.push_back(FilenamePattern(pattern));
+            }
+            index->patterns.push_back(patterns);
+        } else {
+            index->patterns.push_back(ext::nullopt);
+        }
+
+        if (fileType->extensions()) {
+            for (std::string const &extension : *fileType->extensions()) {
+                // TODO(grp): Is this correct? Needed for handling ".S" as ".s", but might be over-broad.
+                std::vector<size_t> *candidates = &extensions[Lowercase(extension)];
+                if (candidates->empty() || candidates->back() != i) {
+                    candidates->push_back(i);
+                }
+            }
+        } else {
+            index->extensionless.push_back(i);
+        }
+    }
+
+    /*
+     * File types without extensions can match any file, so they are
+     * candidates for every extension. Merge them in to keep sorted order.
+     */
+    for (auto const &entry : extensions) {
+        std::vector<size_t> candidates;
+        candidates.reserve(entry.second.size() + index->extensionless.size());
+        std::merge(entry.second.begin(), entry.second.end(), index->extensionless.begin(), index->extensionless.end(), std::back_inserter(candidates));
+        index->extensions.insert({ entry.first, std::move(candidates) });
+    }
+
+    return index;
+}
+
+static std::shared_ptr<FileTypeIndex const>
+GetFileTypeIndex(pbxspec::Manager::shared_ptr const &specManager, std::vector<std::string> const &domains)
+{
+    /* Kept with the manager, so it's rebuilt if more file types are registered. */
+    std::shared_ptr<void const> index = specManager->derived("FileTypeIndex", domains, [&]() -> std::shared_ptr<void const> {
+        return CreateFileTypeIndex(specManager, domains);
+    });
+    return std::static_pointer_cast<FileTypeIndex const>(index);
+}
+
 pbxspec::PBX::FileType::shared_ptr FileTypeResolver::
 Resolve(Filesystem const *filesystem, pbxspec::Manager::shared_ptr const &specManager, std::vector<std::string> const &domains, std::string const &filePath)
 {
@@ -49,38 +195,28 @@ Resolve(Filesystem const *filesystem, pbxspec::Manager::shared_ptr const &specMa
 
     std::vector<uint8_t> fileContents;
 
-    /* Reverse first so more specific file types are processed first. */
-    std::vector<pbxspec::PBX::FileType::shared_ptr> const &fileTypes = specManager->fileTypes(domains);
-    ext::optional<std::vector<pbxspec::PBX::FileType::shared_ptr>> result = SortedFileTypes(fileTypes);
-    if (!result) {
+    std::shared_ptr<FileTypeIndex const> index = GetFileTypeIndex(specManager, domains);
+    if (index == nullptr) {
         fprintf(stderr, "error: cycle creating file type graph\n");
         return nullptr;
     }
 
-    std::vector<pbxspec::PBX::FileType::shared_ptr> const &sortedFileTypes = *result;
-    for (pbxspec::PBX::FileType::shared_ptr const &fileType : sortedFileTypes) {
-        if (isReadable && fileType->isFolder() != isFolder) {
-            continue;
-        }
+    /*
+     * Only file types declaring this extension, or declaring no extensions
+     * at all, can match. Candidates are already in sorted order.
+     */
+    auto extensionCandidates = index->extensions.find(Lowercase(fileExtension));
+    std::vector<size_t> const &candidates = (extensionCandidates != index->extensions.end() ? extensionCandidates->second : index->extensionless);
 
-        bool empty = true;
+    for (size_t candidate : candidates) {
+        pbxspec::PBX::FileType::shared_ptr const &fileType = index->fileTypes[candidate];
 
-        if (fileType->extensions()) {
-            empty = false;
-            bool matched = false;
-
-            for (std::string const &extension : *fileType->extensions()) {
-                // TODO(grp): Is this correct? Needed for handling ".S" as ".s", but might be over-broad.
-                if (libutil::strcasecmp(extension.c_str(), fileExtension.c_str()) == 0) {
-                    matched = true;
-                }
-            }
-
-            if (!matched) {
-                continue;
-            }
+        if (isReadable && fileType->isFolder() != isFolder) {
+            continue;
         }
 
+        /* Extensions were matched by the index lookup. */
+        bool empty = !fileType->extensions();
 
         if (fileType->prefix()) {
             empty = false;
@@ -97,13 +233,14 @@ Resolve(Filesystem const *filesystem, pbxspec::Manager::shared_ptr const &specMa
             }
         }
 
-        if (fileType->filenamePatterns()) {
+        if (ext::optional<std::vector<FilenamePattern>> const &patterns = index->patterns[candidate]) {
             empty = false;
             bool matched = false;
 
-            for (std::string const &pattern : *fileType->filenamePatterns()) {
-                if (Wildcard::Match(pattern, fileName)) {
+            for (FilenamePattern const &pattern : *patterns) {
+                if (pattern.match(fileName)) {
                     matched = true;
+                    break;
                 }
             }
 
@@ -29,9 +29,10 @@ namespace Tool = pbxbuild::Tool;
 namespace Target = pbxbuild::Target;
 
 Phase::PhaseInvocations::
-PhaseInvocations(std::vector<Tool::Invocation> const &invocations, std::vector<Tool::AuxiliaryFile> const &auxiliaryFiles) :
-    _invocations   (invocations),
-    _auxiliaryFiles(auxiliaryFiles)
+PhaseInvocations(std::vector<Tool::Invocation> const &invocations, std::vector<Tool::AuxiliaryFile> const &auxiliaryFiles, std::vector<std::string> const &scannedDirectories) :
+    _invocations       (invocations),
+    _auxiliaryFiles    (auxiliaryFiles),
+    _scannedDirectories(scannedDirectories)
 {
 }
 
@@ -244,6 +245,6 @@ Create(Phase::Environment const &phaseEnvironment, pbxproj::PBX::Target::shared_
     /* Restore current phase invocation priority level */
     phaseContext.toolContext().currentPhaseInvocationPriority() = currentPhaseInvocationPriorityCache;
 
-    return Phase::PhaseInvocations(phaseContext.toolContext().invocations(), phaseContext.toolContext().auxiliaryFiles());
+    return Phase::PhaseInvocations(phaseContext.toolContext().invocations(), phaseContext.toolContext().auxiliaryFiles(), phaseContext.toolContext().scannedDirectories());
 }
 
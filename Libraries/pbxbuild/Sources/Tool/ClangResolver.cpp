@@ -22,6 +22,8 @@
 #include <pbxsetting/Value.h>
 #include <libutil/FSUtil.h>
 
+#include <algorithm>
+
 namespace Tool = pbxbuild::Tool;
 using libutil::FSUtil;
 
@@ -129,7 +131,8 @@ CompileLogMessage(
     std::string const &input,
     ext::optional<std::string> const &dialect,
     std::string const &output,
-    pbxsetting::Environment const &environment,
+    std::string const &variant,
+    std::string const &arch,
     std::string const &workingDirectory
 )
 {
@@ -137,8 +140,8 @@ CompileLogMessage(
     logMessage += logTitle + " ";
     logMessage += output + " ";
     logMessage += FSUtil::GetRelativePath(input, workingDirectory) + " ";
-    logMessage += environment.resolve("variant") + " ";
-    logMessage += environment.resolve("arch") + " ";
+    logMessage += variant + " ";
+    logMessage += arch + " ";
     if (dialect) {
         logMessage += *dialect + " ";
     }
@@ -167,7 +170,7 @@ resolvePrecompiledHeader(
 
     ext::optional<std::string> const &dialect = (input.fileType() != nullptr ? input.fileType()->GCCDialectName() : ext::nullopt);
     std::string logTitle = DialectIsCPlusPlus(dialect) ? "ProcessPCH++" : "ProcessPCH";
-    std::string logMessage = CompileLogMessage(_compiler, logTitle, input.path(), dialect, output, env, toolContext->workingDirectory());
+    std::string logMessage = CompileLogMessage(_compiler, logTitle, input.path(), dialect, output, env.resolve("variant"), env.resolve("arch"), toolContext->workingDirectory());
 
     auto serializedFile = Tool::AuxiliaryFile::Data(
         env.expand(precompiledHeaderInfo.serializedOutputPath()),
@@ -195,29 +198,87 @@ resolvePrecompiledHeader(
     toolContext->auxiliaryFiles().push_back(serializedFile);
 }
 
-void Tool::ClangResolver::
-resolveSource(
-    Tool::Context *toolContext,
-    pbxsetting::Environment const &environment,
-    Tool::Input const &input,
-    std::string const &outputDirectory) const
+/*
+ * Stand-ins for the parts of a source invocation that vary between files.
+ * Anything built from the input marker depends on the input file in a way
+ * that can't be substituted, so the invocation can't be shared. The output
+ * marker is replaced by each file's output base name everywhere it appears,
+ * except in precompiled headers, which are shared between files.
+ */
+static char const InputMarker = '\x01';
+static char const OutputMarker = '\x02';
+
+struct Tool::ClangResolver::SourceTemplate {
+    bool                                         reusable;
+    std::string                                  executable;
+    std::vector<std::string>                     arguments;
+    std::unordered_map<std::string, std::string> environment;
+    std::vector<std::string>                     linkerArgs;
+    std::vector<std::string>                     inputDependencies;
+    std::shared_ptr<Tool::PrecompiledHeaderInfo> precompiledHeaderInfo;
+    std::vector<std::string>                     dependencyInfoArguments;
+    ext::optional<std::string>                   dependencyInfoFile;
+    std::vector<std::string>                     outputs;
+    std::string                                  variant;
+    std::string                                  arch;
+};
+
+static bool
+ContainsMarker(std::string const &value, char marker = InputMarker)
 {
-    Tool::HeadermapInfo const &headermapInfo = toolContext->headermapInfo();
+    return value.find(marker) != std::string::npos;
+}
 
-    std::string resolvedOutputDirectory;
-    if (_compiler->outputDir()) {
-        resolvedOutputDirectory = environment.expand(*_compiler->outputDir());
-    } else {
-        resolvedOutputDirectory = outputDirectory;
+static bool
+ContainsMarker(std::vector<std::string> const &values, char marker = InputMarker)
+{
+    return std::any_of(values.begin(), values.end(), [marker](std::string const &value) {
+        return ContainsMarker(value, marker);
+    });
+}
+
+static std::string
+ReplaceOutputMarker(std::string const &value, std::string const &outputBaseName)
+{
+    std::string result;
+    for (char c : value) {
+        if (c == OutputMarker) {
+            result += outputBaseName;
+        } else {
+            result += c;
+        }
     }
+    return result;
+}
 
-    std::string outputExtension = _compiler->outputFileExtension().value_or("o");
+static std::vector<std::string>
+ReplaceOutputMarker(std::vector<std::string> const &values, std::string const &outputBaseName)
+{
+    std::vector<std::string> result;
+    for (std::string const &value : values) {
+        result.push_back(ReplaceOutputMarker(value, outputBaseName));
+    }
+    return result;
+}
 
-    std::string outputBaseName = FSUtil::GetBaseNameWithoutExtension(input.path());
-    if (input.fileNameDisambiguator()) {
-        outputBaseName = *input.fileNameDisambiguator();
+static std::unordered_map<std::string, std::string>
+ReplaceOutputMarker(std::unordered_map<std::string, std::string> const &values, std::string const &outputBaseName)
+{
+    std::unordered_map<std::string, std::string> result;
+    for (auto const &value : values) {
+        result.insert({ ReplaceOutputMarker(value.first, outputBaseName), ReplaceOutputMarker(value.second, outputBaseName) });
     }
-    std::string output = resolvedOutputDirectory + "/" + outputBaseName + "." + outputExtension;
+    return result;
+}
+
+std::unique_ptr<Tool::ClangResolver::SourceTemplate> Tool::ClangResolver::
+createSourceTemplate(
+    Tool::Context *toolContext,
+    pbxsetting::Environment const &environment,
+    Tool::Input const &input,
+    std::string const &output) const
+{
+    Tool::HeadermapInfo const &headermapInfo = toolContext->headermapInfo();
 
     ext::optional<std::string> const &dialect = (input.fileType() != nullptr ? input.fileType()->GCCDialectName() : ext::nullopt);
     std::vector<std::string> inputArguments = input.compilerFlags().value_or(std::vector<std::string>());
@@ -229,22 +290,24 @@ resolveSource(
     Tool::OptionsResult options = Tool::OptionsResult::Create(toolEnvironment, toolContext->workingDirectory(), input.fileType());
     Tool::Tokens::ToolExpansions tokens = Tool::Tokens::ExpandTool(toolEnvironment, options);
 
-    std::vector<std::string> inputDependencies;
-    inputDependencies.insert(inputDependencies.end(), headermapInfo.systemHeadermapFiles().begin(), headermapInfo.systemHeadermapFiles().end());
-    inputDependencies.insert(inputDependencies.end(), headermapInfo.userHeadermapFiles().begin(), headermapInfo.userHeadermapFiles().end());
+    std::unique_ptr<SourceTemplate> sourceTemplate = std::unique_ptr<SourceTemplate>(new SourceTemplate());
+    sourceTemplate->reusable = false;
 
-    std::vector<std::string> arguments;
-    AppendDialectFlags(&arguments, dialect);
-    size_t dialectOffset = arguments.size();
+    std::vector<std::string> *inputDependencies = &sourceTemplate->inputDependencies;
+    inputDependencies->insert(inputDependencies->end(), headermapInfo.systemHeadermapFiles().begin(), headermapInfo.systemHeadermapFiles().end());
+    inputDependencies->insert(inputDependencies->end(), headermapInfo.userHeadermapFiles().begin(), headermapInfo.userHeadermapFiles().end());
 
-    arguments.insert(arguments.end(), tokens.arguments().begin(), tokens.arguments().end());
-    Tool::CompilerCommon::AppendIncludePathFlags(&arguments, env, toolContext->searchPaths(), headermapInfo);
-    AppendFrameworkPathFlags(&arguments, env, toolContext->searchPaths());
-    AppendCustomFlags(&arguments, env, dialect);
+    std::vector<std::string> *arguments = &sourceTemplate->arguments;
+    AppendDialectFlags(arguments, dialect);
+    size_t dialectOffset = arguments->size();
+
+    arguments->insert(arguments->end(), tokens.arguments().begin(), tokens.arguments().end());
+    Tool::CompilerCommon::AppendIncludePathFlags(arguments, env, toolContext->searchPaths(), headermapInfo);
+    AppendFrameworkPathFlags(arguments, env, toolContext->searchPaths());
+    AppendCustomFlags(arguments, env, dialect);
 
     bool precompilePrefixHeader = pbxsetting::Type::ParseBoolean(env.resolve("GCC_PRECOMPILE_PREFIX_HEADER"));
     std::string prefixHeader = env.resolve("GCC_PREFIX_HEADER");
-    std::shared_ptr<Tool::PrecompiledHeaderInfo> precompiledHeaderInfo = nullptr;
 
     if (!prefixHeader.empty()) {
         std::string prefixHeaderFile = FSUtil::ResolveRelativePath(prefixHeader, toolContext->workingDirectory());
@@ -252,42 +315,148 @@ resolveSource(
         if (precompilePrefixHeader) {
             std::vector<std::string> precompiledHeaderArguments;
             AppendDialectFlags(&precompiledHeaderArguments, dialect, "-header");
-            precompiledHeaderArguments.insert(precompiledHeaderArguments.end(), arguments.begin() + dialectOffset, arguments.end());
+            precompiledHeaderArguments.insert(precompiledHeaderArguments.end(), arguments->begin() + dialectOffset, arguments->end());
             // Added below, but need to have here in case it affects the precompiled header (as it often does).
             precompiledHeaderArguments.insert(precompiledHeaderArguments.end(), inputArguments.begin(), inputArguments.end());
 
-            precompiledHeaderInfo = std::make_shared<Tool::PrecompiledHeaderInfo>(PrecompiledHeaderInfo::Create(_compiler, prefixHeaderFile, input.fileType(), precompiledHeaderArguments));
-            AppendPrefixHeaderFlags(&arguments, env.expand(precompiledHeaderInfo->logicalOutputPath()));
-            inputDependencies.push_back(env.expand(precompiledHeaderInfo->compileOutputPath()));
+            sourceTemplate->precompiledHeaderInfo = std::make_shared<Tool::PrecompiledHeaderInfo>(PrecompiledHeaderInfo::Create(_compiler, prefixHeaderFile, input.fileType(), precompiledHeaderArguments));
+            AppendPrefixHeaderFlags(arguments, env.expand(sourceTemplate->precompiledHeaderInfo->logicalOutputPath()));
+            inputDependencies->push_back(env.expand(sourceTemplate->precompiledHeaderInfo->compileOutputPath()));
         } else {
-            AppendPrefixHeaderFlags(&arguments, prefixHeaderFile);
-            inputDependencies.push_back(prefixHeaderFile);
+            AppendPrefixHeaderFlags(arguments, prefixHeaderFile);
+            inputDependencies->push_back(prefixHeaderFile);
         }
     }
 
-    AppendNotUsedInPrecompsFlags(&arguments, env);
+    AppendNotUsedInPrecompsFlags(arguments, env);
     // After all of the configurable settings, so they can override.
-    arguments.insert(arguments.end(), inputArguments.begin(), inputArguments.end());
-    AppendDependencyInfoFlags(&arguments, _compiler, env);
+    arguments->insert(arguments->end(), inputArguments.begin(), inputArguments.end());
+    AppendDependencyInfoFlags(&sourceTemplate->dependencyInfoArguments, _compiler, env);
+
+    if (_compiler->dependencyInfoFile()) {
+        sourceTemplate->dependencyInfoFile = env.expand(*_compiler->dependencyInfoFile());
+    }
+
+    sourceTemplate->executable = tokens.executable();
+    sourceTemplate->environment = options.environment();
+    sourceTemplate->linkerArgs = options.linkerArgs();
+    sourceTemplate->outputs = toolEnvironment.outputs(toolContext->workingDirectory());
+    sourceTemplate->variant = env.resolve("variant");
+    sourceTemplate->arch = env.resolve("arch");
+    return sourceTemplate;
+}
+
+void Tool::ClangResolver::
+resolveSource(
+    Tool::Context *toolContext,
+    pbxsetting::Environment const &environment,
+    Tool::Input const &input,
+    std::string const &outputDirectory) const
+{
+    std::string resolvedOutputDirectory;
+    if (_compiler->outputDir()) {
+        resolvedOutputDirectory = environment.expand(*_compiler->outputDir());
+    } else {
+        resolvedOutputDirectory = outputDirectory;
+    }
+
+    std::string outputExtension = _compiler->outputFileExtension().value_or("o");
+
+    std::string outputBaseName = FSUtil::GetBaseNameWithoutExtension(input.path());
+    if (input.fileNameDisambiguator()) {
+        outputBaseName = *input.fileNameDisambiguator();
+    }
+    std::string output = resolvedOutputDirectory + "/" + outputBaseName + "." + outputExtension;
+    std::string outputTemplate = resolvedOutputDirectory + "/" + OutputMarker + "." + outputExtension;
+
+    ext::optional<std::string> const &dialect = (input.fileType() != nullptr ? input.fileType()->GCCDialectName() : ext::nullopt);
+
+    /*
+     * Options are the same for every file with the same settings, so only
+     * evaluate them once for each combination rather than for each file.
+     */
+    std::string key;
+    for (std::string const &component : {
+        resolvedOutputDirectory,
+        environment.resolve("variant"),
+        environment.resolve("arch"),
+        (input.fileType() != nullptr ? input.fileType()->identifier() : std::string()),
+        input.localization().value_or(std::string()),
+    }) {
+        key += component;
+        key += '\0';
+    }
+    if (input.compilerFlags()) {
+        for (std::string const &flag : *input.compilerFlags()) {
+            key += flag;
+            key += '\0';
+        }
+    }
+
+    auto it = _sourceTemplates.find(key);
+    if (it == _sourceTemplates.end()) {
+        std::string marker = std::string(1, InputMarker);
+        Tool::Input markerInput = Tool::Input(
+            "/" + marker + "/" + marker + "." + marker,
+            input.fileType(),
+            input.buildRule(),
+            marker,
+            input.localization(),
+            input.localizationGroupIdentifier(),
+            input.attributes(),
+            input.compilerFlags());
+
+        std::unique_ptr<SourceTemplate> markerTemplate = createSourceTemplate(toolContext, environment, markerInput, outputTemplate);
+
+        /* If any of the invocation depends on the input, it can't be shared between files. */
+        markerTemplate->reusable =
+            !ContainsMarker(markerTemplate->executable) &&
+            !ContainsMarker(markerTemplate->arguments) &&
+            !ContainsMarker(markerTemplate->linkerArgs) &&
+            !ContainsMarker(markerTemplate->inputDependencies) &&
+            !ContainsMarker(markerTemplate->dependencyInfoArguments) &&
+            !ContainsMarker(markerTemplate->dependencyInfoFile.value_or(std::string())) &&
+            !ContainsMarker(markerTemplate->outputs) &&
+            std::none_of(markerTemplate->environment.begin(), markerTemplate->environment.end(), [](std::pair<std::string const, std::string> const &variable) {
+                return ContainsMarker(variable.first) || ContainsMarker(variable.second);
+            }) &&
+            (markerTemplate->precompiledHeaderInfo == nullptr ||
+             (!ContainsMarker(markerTemplate->precompiledHeaderInfo->arguments()) &&
+              !ContainsMarker(markerTemplate->precompiledHeaderInfo->arguments(), OutputMarker)));
+
+        it = _sourceTemplates.insert({ key, std::move(markerTemplate) }).first;
+    }
+
+    SourceTemplate const *sourceTemplate = it->second.get();
+    std::unique_ptr<SourceTemplate> inputTemplate;
+    if (!sourceTemplate->reusable) {
+        inputTemplate = createSourceTemplate(toolContext, environment, input, outputTemplate);
+        sourceTemplate = inputTemplate.get();
+    }
+
+    std::vector<std::string> arguments = ReplaceOutputMarker(sourceTemplate->arguments, outputBaseName);
+    for (std::string const &argument : sourceTemplate->dependencyInfoArguments) {
+        arguments.push_back(ReplaceOutputMarker(argument, outputBaseName));
+    }
     AppendInputOutputFlags(&arguments, _compiler, input.path(), output);
 
-    std::string logMessage = CompileLogMessage(_compiler, "CompileC", input.path(), dialect, output, env, toolContext->workingDirectory());
+    std::string logMessage = CompileLogMessage(_compiler, "CompileC", input.path(), dialect, output, sourceTemplate->variant, sourceTemplate->arch, toolContext->workingDirectory());
 
     std::vector<Tool::Invocation::DependencyInfo> dependencyInfo;
-    if (_compiler->dependencyInfoFile()) {
+    if (sourceTemplate->dependencyInfoFile) {
         dependencyInfo.push_back(Tool::Invocation::DependencyInfo(
             dependency::DependencyInfoFormat::Makefile,
-            env.expand(*_compiler->dependencyInfoFile())));
+            ReplaceOutputMarker(*sourceTemplate->dependencyInfoFile, outputBaseName)));
     }
 
     Tool::Invocation invocation;
-    invocation.executable() = Tool::Invocation::Executable::Determine(tokens.executable());
+    invocation.executable() = Tool::Invocation::Executable::Determine(ReplaceOutputMarker(sourceTemplate->executable, outputBaseName));
     invocation.arguments() = arguments;
-    invocation.environment() = options.environment();
+    invocation.environment() = ReplaceOutputMarker(sourceTemplate->environment, outputBaseName);
     invocation.workingDirectory() = toolContext->workingDirectory();
-    invocation.inputs() = toolEnvironment.inputs(toolContext->workingDirectory());
-    invocation.outputs() = toolEnvironment.outputs(toolContext->workingDirectory());
-    invocation.inputDependencies() = inputDependencies;
+    invocation.inputs() = { FSUtil::ResolveRelativePath(input.path(), toolContext->workingDirectory()) };
+    invocation.outputs() = ReplaceOutputMarker(sourceTemplate->outputs, outputBaseName);
+    invocation.inputDependencies() = ReplaceOutputMarker(sourceTemplate->inputDependencies, outputBaseName);
     invocation.dependencyInfo() = dependencyInfo;
     invocation.logMessage() = logMessage;
     invocation.priority() = toolContext->currentPhaseInvocationPriority();
@@ -302,18 +471,19 @@ resolveSource(
     Tool::CompilationInfo *compilationInfo = &toolContext->compilationInfo();
 
     /* If we have precompiled header info, create an invocation for the precompiled header. */
-    if (precompiledHeaderInfo != nullptr) {
-        std::string hash = precompiledHeaderInfo->hash();
+    if (sourceTemplate->precompiledHeaderInfo != nullptr) {
+        Tool::PrecompiledHeaderInfo const &precompiledHeaderInfo = *sourceTemplate->precompiledHeaderInfo;
+        std::string hash = precompiledHeaderInfo.hash();
 
         auto precompiledHeaderInfoMap = &compilationInfo->precompiledHeaderInfo();
         if (precompiledHeaderInfoMap->find(hash) == precompiledHeaderInfoMap->end()) {
             /* This precompiled header wasn't already created, create it now. */
-            precompiledHeaderInfoMap->insert({ hash, *precompiledHeaderInfo });
+            precompiledHeaderInfoMap->insert({ hash, precompiledHeaderInfo });
 
             resolvePrecompiledHeader(
                 toolContext,
                 environment,
-                *precompiledHeaderInfo
+                precompiledHeaderInfo
             );
         }
     }
@@ -326,7 +496,7 @@ resolveSource(
         compilationInfo->linkerDriver() = _compiler->execPath()->raw();
     }
 
-    for (std::string const &linkerArg : options.linkerArgs()) {
+    for (std::string const &linkerArg : ReplaceOutputMarker(sourceTemplate->linkerArgs, outputBaseName)) {
         std::vector<std::string> *linkerArguments = &compilationInfo->linkerArguments();
 
         /* Avoid duplicating arguments for multiple compiler invocations. */
@@ -76,3 +76,14 @@ Tool::Invocation::
 {
 }
 
+std::unordered_map<std::string, std::string> Tool::Invocation::
+completeEnvironment() const
+{
+    std::unordered_map<std::string, std::string> environment = _environment;
+    if (_sharedEnvironment != nullptr) {
+        /* Inserting does not replace, so the invocation's variables take precedence. */
+        environment.insert(_sharedEnvironment->begin(), _sharedEnvironment->end());
+    }
+    return environment;
+}
+
@@ -53,6 +53,31 @@ ScriptInputOutputLevel(std::vector<std::string> const &inputFiles, std::vector<s
     return pbxsetting::Level(settings);
 }
 
+/*
+ * Resolves the settings in the given levels, and the exported settings that
+ * depend on them. Only these differ between invocations; the rest of the
+ * exported settings are shared between them.
+ */
+static std::unordered_map<std::string, std::string>
+ScriptLevelValues(pbxsetting::Environment const &sharedEnvironment, pbxsetting::Environment const &environment, std::vector<pbxsetting::Level> const &levels)
+{
+    std::vector<std::string> names;
+    for (pbxsetting::Level const &level : levels) {
+        for (pbxsetting::Setting const &setting : level.settings()) {
+            names.push_back(setting.name());
+        }
+    }
+
+    std::unordered_map<std::string, std::string> values;
+    for (std::string const &name : names) {
+        values.insert({ name, environment.resolve(name) });
+    }
+    for (std::string const &name : sharedEnvironment.computeDependents(pbxsetting::Condition::Empty(), names)) {
+        values.insert({ name, environment.resolve(name) });
+    }
+    return values;
+}
+
 void Tool::ScriptResolver::
 resolve(
     Tool::Context *toolContext,
@@ -63,9 +88,9 @@ resolve(
 
     std::string script = environment.expand(legacyTarget->buildArgumentsString());
 
-    std::unordered_map<std::string, std::string> environmentVariables;
+    std::shared_ptr<std::unordered_map<std::string, std::string> const> environmentVariables;
     if (legacyTarget->passBuildSettingsInEnvironment()) {
-        environmentVariables = environment.computeValues(pbxsetting::Condition::Empty());
+        environmentVariables = environment.computeSharedValues(pbxsetting::Condition::Empty());
     }
 
     std::string fullWorkingDirectory = FSUtil::ResolveRelativePath(legacyTarget->buildWorkingDirectory(), toolContext->workingDirectory());
@@ -73,7 +98,7 @@ resolve(
     Tool::Invocation invocation;
     invocation.executable() = Tool::Invocation::Executable::Determine(legacyTarget->buildToolPath());
     invocation.arguments() = pbxsetting::Type::ParseList(script);
-    invocation.environment() = environmentVariables;
+    invocation.sharedEnvironment() = environmentVariables;
     invocation.workingDirectory() = fullWorkingDirectory;
     invocation.logMessage() = logMessage;
     invocation.priority() = toolContext->currentPhaseInvocationPriority();
@@ -113,15 +138,17 @@ resolve(
     std::string contents = (!buildPhase->shellPath().empty() ? "#!" + buildPhase->shellPath() + "\n" : "") + buildPhase->shellScript();
     auto scriptFile = Tool::AuxiliaryFile::Data(scriptFilePath, std::vector<uint8_t>(contents.begin(), contents.end()), true);
 
+    pbxsetting::Level scriptLevel = ScriptInputOutputLevel(inputFiles, outputFiles, true);
     pbxsetting::Environment scriptEnvironment = pbxsetting::Environment(environment);
-    scriptEnvironment.insertFront(ScriptInputOutputLevel(inputFiles, outputFiles, true), false);
-    std::unordered_map<std::string, std::string> environmentVariables = scriptEnvironment.computeValues(pbxsetting::Condition::Empty());
+    scriptEnvironment.insertFront(scriptLevel, false);
 
     Tool::Invocation invocation;
     invocation.executable() = Tool::Invocation::Executable::External("/bin/sh");
     invocation.arguments() = { "-c", Escape::Shell(scriptFilePath) };
-    invocation.environment() = environmentVariables;
+    invocation.environment() = ScriptLevelValues(environment, scriptEnvironment, { scriptLevel });
+    invocation.sharedEnvironment() = environment.computeSharedValues(pbxsetting::Condition::Empty());
     invocation.workingDirectory() = toolContext->workingDirectory();
+    invocation.inputs() = { scriptFilePath }; /* Changing the script runs it again. */
     invocation.phonyInputs() = inputFiles; /* User-specified, may not exist. */
     invocation.outputs() = outputFiles;
     invocation.logMessage() = phaseEnvironment.expand(logMessage);
@@ -176,15 +203,19 @@ resolve(
     });
 
     /*
-     * Compute the final environment by adding the standard script levels.
+     * Compute the final environment by adding the standard script levels. Most
+     * exported build settings are the same for every file using the rule, so
+     * only the settings that depend on the input and output are stored for
+     * each invocation.
      */
-    ruleEnvironment.insertFront(ScriptInputOutputLevel({ inputAbsolutePath }, outputFiles, false), false);
-    std::unordered_map<std::string, std::string> environmentVariables = ruleEnvironment.computeValues(pbxsetting::Condition::Empty());
+    pbxsetting::Level scriptLevel = ScriptInputOutputLevel({ inputAbsolutePath }, outputFiles, false);
+    ruleEnvironment.insertFront(scriptLevel, false);
 
     Tool::Invocation invocation;
     invocation.executable() = Tool::Invocation::Executable::External("/bin/sh");
     invocation.arguments() = { "-c", buildRule->script() };
-    invocation.environment() = environmentVariables;
+    invocation.environment() = ScriptLevelValues(environment, ruleEnvironment, { level, scriptLevel });
+    invocation.sharedEnvironment() = environment.computeSharedValues(pbxsetting::Condition::Empty());
     invocation.workingDirectory() = toolContext->workingDirectory();
     invocation.inputs() = { inputAbsolutePath };
     invocation.outputs() = outputFiles;
@@ -0,0 +1,149 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <gtest/gtest.h>
+#include <pbxbuild/Tool/ClangResolver.h>
+#include <pbxbuild/Tool/Context.h>
+#include <pbxbuild/Tool/Input.h>
+#include <pbxbuild/Tool/SearchPaths.h>
+#include <pbxspec/Manager.h>
+#include <pbxsetting/Environment.h>
+#include <libutil/MemoryFilesystem.h>
+
+#include <algorithm>
+
+namespace Tool = pbxbuild::Tool;
+using libutil::MemoryFilesystem;
+
+/*
+ * Create a resolver for a compiler defined by an ASCII specification.
+ */
+static std::unique_ptr<Tool::ClangResolver>
+Resolver(std::string const &specification)
+{
+    auto filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::File("compiler.xcspec", std::vector<uint8_t>(specification.begin(), specification.end())),
+    });
+
+    auto manager = std::make_shared<pbxspec::Manager>();
+    manager->registerDomains(&filesystem, { { "test", filesystem.path("compiler.xcspec") } });
+    return Tool::ClangResolver::Create(manager, { "test" }, "test");
+}
+
+/*
+ * Resolve sources with a resolver, returning the arguments for each.
+ */
+static std::vector<std::vector<std::string>>
+Arguments(Tool::ClangResolver const *resolver, std::vector<std::string> const &paths)
+{
+    Tool::Context context = Tool::Context(nullptr, { }, "/root", Tool::SearchPaths({ }, { }, { }, { }));
+
+    pbxsetting::Environment environment;
+    environment.insertBack(pbxsetting::Level({
+        pbxsetting::Setting::Create("FLAG", "value"),
+        pbxsetting::Setting::Create("DIAGNOSTICS", "YES"),
+    }), false);
+
+    for (std::string const &path : paths) {
+        resolver->resolveSource(&context, environment, Tool::Input(path, nullptr), "/out");
+    }
+
+    /* Only the options and per-file arguments; include paths come first. */
+    std::vector<std::vector<std::string>> arguments;
+    for (Tool::Invocation const &invocation : context.invocations()) {
+        std::vector<std::string> const &all = invocation.arguments();
+        std::vector<std::string> filtered = { all[0], all[1] };
+        filtered.insert(filtered.end(), std::find(all.begin(), all.end(), "-F") + 1, all.end());
+        arguments.push_back(filtered);
+    }
+    return arguments;
+}
+
+TEST(ClangResolver, SharedOptions)
+{
+    auto resolver = Resolver(R"SPEC((
+        {
+            Type = Compiler;
+            Identifier = test.compiler;
+            ExecPath = cc;
+            DependencyInfoFile = "$(OutputDir)/$(OutputFileBase).d";
+            DependencyInfoArgs = ( "-MF", "$(DependencyInfoFile)" );
+            Options = (
+                { Name = FLAG; Type = String; CommandLineFlag = "-flag"; },
+            );
+        },
+    ))SPEC");
+    ASSERT_NE(nullptr, resolver);
+
+    auto arguments = Arguments(resolver.get(), { "/root/one.c", "/root/sub/two.c" });
+    ASSERT_EQ(2u, arguments.size());
+    EXPECT_EQ(std::vector<std::string>({ "-flag", "value", "-MF", "/out/one.d", "-c", "/root/one.c", "-o", "/out/one.o" }), arguments[0]);
+    EXPECT_EQ(std::vector<std::string>({ "-flag", "value", "-MF", "/out/two.d", "-c", "/root/sub/two.c", "-o", "/out/two.o" }), arguments[1]);
+}
+
+TEST(ClangResolver, InputOptions)
+{
+    /* Options that depend on the input are evaluated for each file. */
+    auto resolver = Resolver(R"SPEC((
+        {
+            Type = Compiler;
+            Identifier = test.compiler;
+            ExecPath = cc;
+            Options = (
+                { Name = DIAGNOSTICS; Type = Boolean; CommandLineArgs = { YES = ( "--diagnostics", "$(InputFileBase).dia" ); }; },
+            );
+        },
+    ))SPEC");
+    ASSERT_NE(nullptr, resolver);
+
+    auto arguments = Arguments(resolver.get(), { "/root/one.c", "/root/two.c" });
+    ASSERT_EQ(2u, arguments.size());
+    EXPECT_EQ(std::vector<std::string>({ "--diagnostics", "one.dia", "-c", "/root/one.c", "-o", "/out/one.o" }), arguments[0]);
+    EXPECT_EQ(std::vector<std::string>({ "--diagnostics", "two.dia", "-c", "/root/two.c", "-o", "/out/two.o" }), arguments[1]);
+}
+
+TEST(ClangResolver, OutputOptions)
+{
+    /* Options that depend on the output are shared, with each file's output substituted. */
+    auto resolver = Resolver(R"SPEC((
+        {
+            Type = Compiler;
+            Identifier = test.compiler;
+            ExecPath = cc;
+            Options = (
+                {
+                    Name = DIAGNOSTICS;
+                    Type = Boolean;
+                    CommandLineArgs = { YES = ( "--diagnostics", "$(OutputFileBase).dia" ); };
+                    AdditionalLinkerArgs = { YES = ( "-Wl,-object_path,$(OutputFileBase)" ); };
+                },
+                { Name = OUTPUT_NAME; Type = String; DefaultValue = "$(OutputFileBase)"; SetValueInEnvironmentVariable = OUTPUT_NAME; },
+            );
+        },
+    ))SPEC");
+    ASSERT_NE(nullptr, resolver);
+
+    auto arguments = Arguments(resolver.get(), { "/root/one.c", "/root/two.c" });
+    ASSERT_EQ(2u, arguments.size());
+    EXPECT_EQ(std::vector<std::string>({ "--diagnostics", "one.dia", "-c", "/root/one.c", "-o", "/out/one.o" }), arguments[0]);
+    EXPECT_EQ(std::vector<std::string>({ "--diagnostics", "two.dia", "-c", "/root/two.c", "-o", "/out/two.o" }), arguments[1]);
+
+    Tool::Context context = Tool::Context(nullptr, { }, "/root", Tool::SearchPaths({ }, { }, { }, { }));
+    pbxsetting::Environment environment;
+    environment.insertBack(pbxsetting::Level({
+        pbxsetting::Setting::Create("DIAGNOSTICS", "YES"),
+    }), false);
+    resolver->resolveSource(&context, environment, Tool::Input("/root/one.c", nullptr), "/out");
+    resolver->resolveSource(&context, environment, Tool::Input("/root/two.c", nullptr), "/out");
+
+    ASSERT_EQ(2u, context.invocations().size());
+    EXPECT_EQ("one", context.invocations()[0].environment().at("OUTPUT_NAME"));
+    EXPECT_EQ("two", context.invocations()[1].environment().at("OUTPUT_NAME"));
+    EXPECT_EQ(std::vector<std::string>({ "-Wl,-object_path,one", "-Wl,-object_path,two" }), context.compilationInfo().linkerArguments());
+}
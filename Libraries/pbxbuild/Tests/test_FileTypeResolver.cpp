@@ -0,0 +1,85 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <gtest/gtest.h>
+#include <pbxbuild/FileTypeResolver.h>
+#include <libutil/MemoryFilesystem.h>
+
+using pbxbuild::FileTypeResolver;
+using libutil::MemoryFilesystem;
+
+static std::string const Specifications = R"(
+(
+    { Type = FileType; Identifier = file; },
+    { Type = FileType; Identifier = folder; IsFolder = YES; },
+    { Type = FileType; Identifier = text; BasedOn = file; },
+    { Type = FileType; Identifier = sourcecode; BasedOn = text; },
+    { Type = FileType; Identifier = sourcecode.c; BasedOn = sourcecode; Extensions = ( c ); },
+    { Type = FileType; Identifier = sourcecode.c.h; BasedOn = sourcecode.c; Extensions = ( h ); },
+    { Type = FileType; Identifier = sourcecode.asm; BasedOn = sourcecode; Extensions = ( s ); },
+    { Type = FileType; Identifier = sourcecode.make; BasedOn = sourcecode; FilenamePatterns = ( Makefile, "*.mk" ); },
+    { Type = FileType; Identifier = text.plist.info; BasedOn = text.plist; Extensions = ( plist ); FilenamePatterns = ( "*Info.plist" ); },
+    { Type = FileType; Identifier = text.plist; BasedOn = text; Extensions = ( plist ); },
+)
+)";
+
+static pbxspec::Manager::shared_ptr
+CreateManager(MemoryFilesystem const *filesystem)
+{
+    auto manager = std::make_shared<pbxspec::Manager>();
+    manager->registerDomains(filesystem, { { "test", filesystem->path("specs") } });
+    return manager;
+}
+
+TEST(FileTypeResolver, Resolve)
+{
+    auto filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::Directory("specs", {
+            MemoryFilesystem::Entry::File("FileTypes.xcspec", std::vector<uint8_t>(Specifications.begin(), Specifications.end())),
+        }),
+    });
+    auto manager = CreateManager(&filesystem);
+
+    auto identifier = [&](std::string const &path) -> std::string {
+        pbxspec::PBX::FileType::shared_ptr fileType = FileTypeResolver::Resolve(&filesystem, manager, { "test" }, path);
+        return (fileType != nullptr ? fileType->identifier() : std::string());
+    };
+
+    /* Repeat to exercise the cached index. */
+    for (int i = 0; i < 2; ++i) {
+        EXPECT_EQ("sourcecode.c", identifier("/src/main.c"));
+        EXPECT_EQ("sourcecode.c.h", identifier("/src/main.h"));
+        EXPECT_EQ("sourcecode.asm", identifier("/src/start.S"));
+        EXPECT_EQ("sourcecode.make", identifier("/src/Makefile"));
+        EXPECT_EQ("sourcecode.make", identifier("/src/rules.mk"));
+        EXPECT_EQ("text.plist.info", identifier("/src/App-Info.plist"));
+        EXPECT_EQ("text.plist", identifier("/src/Settings.plist"));
+        EXPECT_EQ("file", identifier("/src/unknown.xyz"));
+    }
+}
+
+TEST(FileTypeResolver, SeparateManagers)
+{
+    auto filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::Directory("specs", {
+            MemoryFilesystem::Entry::File("FileTypes.xcspec", std::vector<uint8_t>(Specifications.begin(), Specifications.end())),
+        }),
+    });
+
+    auto first = CreateManager(&filesystem);
+    pbxspec::PBX::FileType::shared_ptr firstType = FileTypeResolver::Resolve(&filesystem, first, { "test" }, "/src/main.c");
+    ASSERT_NE(nullptr, firstType);
+
+    /* Types resolved with another manager come from that manager. */
+    auto second = CreateManager(&filesystem);
+    pbxspec::PBX::FileType::shared_ptr secondType = FileTypeResolver::Resolve(&filesystem, second, { "test" }, "/src/main.c");
+    ASSERT_NE(nullptr, secondType);
+    EXPECT_EQ(second->fileType("sourcecode.c", { "test" }), secondType);
+    EXPECT_NE(firstType, secondType);
+}
@@ -12,6 +12,7 @@
 #include <pbxproj/PBX/LegacyTarget.h>
 #include <pbxproj/PBX/NativeTarget.h>
 #include <pbxproj/Context.h>
+#include <plist/Arena.h>
 #include <plist/Array.h>
 #include <plist/Boolean.h>
 #include <plist/Integer.h>
@@ -204,16 +205,22 @@ Open(Filesystem const *filesystem, std::string const &path)
         return nullptr;
     }
 
-    std::vector<uint8_t> contents;
-    if (!filesystem->read(&contents, realPath)) {
+    ext::optional<libutil::MappedFile> contents = filesystem->map(realPath);
+    if (!contents) {
         fprintf(stderr, "error: project file %s is not readable\n", projectFileName.c_str());
         return nullptr;
     }
 
     //
-    // Parse property list
+    // Parse property list. The parsed objects are only used while creating
+    // the project, so allocate them together and free them at once.
     //
-    auto result = plist::Format::Any::Deserialize(contents);
+    plist::Arena arena;
+    std::pair<std::unique_ptr<plist::Object>, std::string> result;
+    {
+        plist::Arena::Scope scope(&arena);
+        result = plist::Format::Any::Deserialize(contents->contents());
+    }
     if (result.first == nullptr) {
         fprintf(stderr, "error: project file %s is not parseable: %s\n", projectFileName.c_str(), result.second.c_str());
         return nullptr;
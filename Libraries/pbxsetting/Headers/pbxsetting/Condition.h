@@ -35,6 +35,12 @@ public:
     bool
     match(Condition const &condition) const;
 
+public:
+    bool operator==(Condition const &rhs) const
+    { return _values == rhs._values; }
+    bool operator!=(Condition const &rhs) const
+    { return !(*this == rhs); }
+
 public:
     static Condition const &
     Empty(void);
@@ -13,9 +13,12 @@
 #include <pbxsetting/Condition.h>
 #include <pbxsetting/Level.h>
 
-#include <list>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 namespace pbxsetting {
 
@@ -25,8 +28,31 @@ namespace pbxsetting {
  */
 class Environment {
 private:
-    std::list<Level> _levels;
-    size_t           _offset;
+    /*
+     * Levels are kept in immutable linked lists, so copies of an environment
+     * share them. Adding a level to the front of a list shares the rest.
+     */
+    struct Node {
+        Level                       level;
+        std::shared_ptr<Node const> next;
+    };
+
+private:
+    std::shared_ptr<Node const> _levels;
+    std::shared_ptr<Node const> _defaultLevels;
+
+private:
+    /*
+     * Resolved values of settings, by condition. Shared between copies
+     * until either changes its levels, when it gets an empty cache.
+     */
+    struct Cache {
+        std::mutex                                                                   mutex;
+        std::unordered_map<Condition, std::unordered_map<std::string, std::string>> values;
+        std::unordered_map<Condition, std::shared_ptr<std::unordered_map<std::string, std::string> const>> computed;
+        std::unordered_map<Condition, std::shared_ptr<std::unordered_map<std::string, std::vector<std::string>> const>> readers;
+    };
+    std::shared_ptr<Cache> _cache;
 
 public:
     explicit Environment();
@@ -60,6 +86,21 @@ public:
     std::unordered_map<std::string, std::string>
     computeValues(Condition const &condition) const;
 
+    /*
+     * Computes all values for all settings present in the environment, once.
+     * The result is shared with copies of the environment until they change.
+     */
+    std::shared_ptr<std::unordered_map<std::string, std::string> const>
+    computeSharedValues(Condition const &condition) const;
+
+    /*
+     * Finds the settings present in the environment whose values read any of
+     * the given settings, directly or through other settings. What each setting
+     * reads is found once, and shared like computed values.
+     */
+    std::unordered_set<std::string>
+    computeDependents(Condition const &condition, std::vector<std::string> const &settings) const;
+
 public:
     /*
      * Adds a level to the environment, at the front (will override any existing
@@ -85,11 +126,15 @@ private:
     struct InheritanceContext {
         bool valid;
         std::string setting;
-        std::list<Level>::const_iterator it;
+        Node const *node;
+        bool defaults;
+        std::unordered_set<std::string> *reads;
     };
+    void advance(InheritanceContext *context) const;
     std::string resolveValue(Condition const &condition, Value const &value, InheritanceContext const &context) const;
     std::string resolveInheritance(Condition const &condition, InheritanceContext const &context) const;
     std::string resolveAssignment(Condition const &condition, std::string const &setting) const;
+    std::string resolveAssignmentUncached(Condition const &condition, std::string const &setting, std::unordered_set<std::string> *reads) const;
 };
 
 }
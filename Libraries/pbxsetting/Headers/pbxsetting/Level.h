@@ -14,9 +14,11 @@
 #include <pbxsetting/Setting.h>
 #include <pbxsetting/Value.h>
 
-#include <vector>
-#include <utility>
 #include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace pbxsetting {
 
@@ -29,6 +31,12 @@ class Level {
 private:
     std::shared_ptr<std::vector<Setting>> _settings;
 
+private:
+    /*
+     * Indexes into `_settings` for each setting name, in order.
+     */
+    std::shared_ptr<std::unordered_map<std::string, std::vector<size_t>>> _index;
+
 public:
     /*
      * Creates a level with the given settings.
@@ -22,7 +22,9 @@ using libutil::FSUtil;
 
 Environment::
 Environment() :
-    _offset(0)
+    _levels       (nullptr),
+    _defaultLevels(nullptr),
+    _cache        (std::make_shared<Cache>())
 {
 }
 
@@ -114,6 +116,20 @@ ProcessOperation(std::string const &value, std::string const &operation)
     }
 }
 
+void Environment::
+advance(InheritanceContext *context) const
+{
+    if (context->node != nullptr) {
+        context->node = context->node->next.get();
+    }
+
+    /* Default levels come after all other levels. */
+    if (context->node == nullptr && !context->defaults) {
+        context->node = _defaultLevels.get();
+        context->defaults = true;
+    }
+}
+
 std::string Environment::
 resolveValue(Condition const &condition, Value const &value, InheritanceContext const &context) const
 {
@@ -136,6 +152,9 @@ resolveValue(Condition const &condition, Value const &value, InheritanceContext
                         setting = resolved.substr(0, colon);
                     }
 
+                    if (context.reads != nullptr) {
+                        context.reads->insert(setting);
+                    }
                     std::string value = resolveAssignment(condition, setting);
 
                     while (colon != std::string::npos) {
@@ -160,8 +179,8 @@ std::string Environment::
 resolveInheritance(Condition const &condition, InheritanceContext const &context) const
 {
     InheritanceContext ctx = context;
-    for (++ctx.it; ctx.it != _levels.end(); ++ctx.it) {
-        auto result = ctx.it->get(ctx.setting, condition);
+    for (advance(&ctx); ctx.node != nullptr; advance(&ctx)) {
+        auto result = ctx.node->level.get(ctx.setting, condition);
         if (result.first) {
             return resolveValue(condition, result.second, ctx);
         }
@@ -173,11 +192,39 @@ resolveInheritance(Condition const &condition, InheritanceContext const &context
 std::string Environment::
 resolveAssignment(Condition const &condition, std::string const &setting) const
 {
-    InheritanceContext context = { true, setting };
+    /* A setting's value only depends on the levels, so can be reused. */
+    {
+        std::lock_guard<std::mutex> lock(_cache->mutex);
+
+        auto CI = _cache->values.find(condition);
+        if (CI != _cache->values.end()) {
+            auto VI = CI->second.find(setting);
+            if (VI != CI->second.end()) {
+                return VI->second;
+            }
+        }
+    }
+
+    std::string value = resolveAssignmentUncached(condition, setting, nullptr);
+
+    {
+        std::lock_guard<std::mutex> lock(_cache->mutex);
+        _cache->values[condition].insert({ setting, value });
+    }
+
+    return value;
+}
 
-    for (context.it = _levels.begin(); context.it != _levels.end(); ++context.it) {
-        Level const &level = *context.it;
-        auto result = level.get(setting, condition);
+std::string Environment::
+resolveAssignmentUncached(Condition const &condition, std::string const &setting, std::unordered_set<std::string> *reads) const
+{
+    InheritanceContext context = { true, setting, _levels.get(), false, reads };
+    if (context.node == nullptr) {
+        advance(&context);
+    }
+
+    for (; context.node != nullptr; advance(&context)) {
+        auto result = context.node->level.get(setting, condition);
         if (result.first) {
             return resolveValue(condition, result.second, context);
         }
@@ -185,6 +232,8 @@ resolveAssignment(Condition const &condition, std::string const &setting) const
 
     if (condition.values().empty()) {
         return "";
+    } else if (reads != nullptr) {
+        return resolveAssignmentUncached(Condition::Empty(), setting, reads);
     } else {
         return resolveAssignment(Condition::Empty(), setting);
     }
@@ -193,7 +242,7 @@ resolveAssignment(Condition const &condition, std::string const &setting) const
 std::string Environment::
 expand(Value const &value, Condition const &condition) const
 {
-    return resolveValue(condition, value, { false });
+    return resolveValue(condition, value, { false, std::string(), nullptr, false, nullptr });
 }
 
 std::string Environment::
@@ -219,10 +268,12 @@ computeValues(Condition const &condition) const
 {
     std::unordered_map<std::string, std::string> values;
 
-    for (Level const &level : _levels) {
-        for (Setting const &setting : level.settings()) {
-            if (values.find(setting.name()) == values.end()) {
-                values[setting.name()] = resolve(setting.name(), condition);
+    for (Node const *levels : { _levels.get(), _defaultLevels.get() }) {
+        for (Node const *node = levels; node != nullptr; node = node->next.get()) {
+            for (Setting const &setting : node->level.settings()) {
+                if (values.find(setting.name()) == values.end()) {
+                    values[setting.name()] = resolve(setting.name(), condition);
+                }
             }
         }
     }
@@ -230,47 +281,128 @@ computeValues(Condition const &condition) const
     return values;
 }
 
+std::shared_ptr<std::unordered_map<std::string, std::string> const> Environment::
+computeSharedValues(Condition const &condition) const
+{
+    {
+        std::lock_guard<std::mutex> lock(_cache->mutex);
+
+        auto CI = _cache->computed.find(condition);
+        if (CI != _cache->computed.end()) {
+            return CI->second;
+        }
+    }
+
+    /* Computing values resolves settings, which also uses the cache. */
+    auto values = std::make_shared<std::unordered_map<std::string, std::string> const>(computeValues(condition));
+
+    {
+        std::lock_guard<std::mutex> lock(_cache->mutex);
+        return _cache->computed.insert({ condition, values }).first->second;
+    }
+}
+
+std::unordered_set<std::string> Environment::
+computeDependents(Condition const &condition, std::vector<std::string> const &settings) const
+{
+    std::shared_ptr<std::unordered_map<std::string, std::vector<std::string>> const> readers;
+    {
+        std::lock_guard<std::mutex> lock(_cache->mutex);
+
+        auto CI = _cache->readers.find(condition);
+        if (CI != _cache->readers.end()) {
+            readers = CI->second;
+        }
+    }
+
+    if (readers == nullptr) {
+        /* Resolve each setting again to find what it reads, then invert that. */
+        auto computed = std::make_shared<std::unordered_map<std::string, std::vector<std::string>>>();
+        std::unordered_set<std::string> resolved;
+        for (Node const *levels : { _levels.get(), _defaultLevels.get() }) {
+            for (Node const *node = levels; node != nullptr; node = node->next.get()) {
+                for (Setting const &setting : node->level.settings()) {
+                    if (!resolved.insert(setting.name()).second) {
+                        continue;
+                    }
+
+                    std::unordered_set<std::string> reads;
+                    resolveAssignmentUncached(condition, setting.name(), &reads);
+                    for (std::string const &read : reads) {
+                        (*computed)[read].push_back(setting.name());
+                    }
+                }
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(_cache->mutex);
+        readers = _cache->readers.insert({ condition, computed }).first->second;
+    }
+
+    std::unordered_set<std::string> dependents;
+    std::vector<std::string> pending = settings;
+    while (!pending.empty()) {
+        std::string setting = pending.back();
+        pending.pop_back();
+
+        auto RI = readers->find(setting);
+        if (RI == readers->end()) {
+            continue;
+        }
+
+        for (std::string const &reader : RI->second) {
+            if (dependents.insert(reader).second) {
+                pending.push_back(reader);
+            }
+        }
+    }
+
+    return dependents;
+}
+
 void Environment::
 insertFront(Level const &level, bool isDefault)
 {
-    if (!isDefault) {
-        _levels.push_front(level);
-        ++_offset;
-    } else {
-        _levels.insert(std::next(_levels.begin(), _offset), level);
-    }
+    _cache = std::make_shared<Cache>();
+
+    std::shared_ptr<Node const> *levels = (isDefault ? &_defaultLevels : &_levels);
+    *levels = std::shared_ptr<Node const>(new Node { level, *levels });
 }
 
 void Environment::
 insertBack(Level const &level, bool isDefault)
 {
-    if (!isDefault) {
-        _levels.insert(std::next(_levels.begin(), _offset), level);
-        ++_offset;
-    } else {
-        _levels.push_back(level);
+    _cache = std::make_shared<Cache>();
+
+    /* The list is shared, so every node before the new one is copied. */
+    std::shared_ptr<Node const> *levels = (isDefault ? &_defaultLevels : &_levels);
+
+    std::vector<Level const *> previous;
+    for (Node const *node = levels->get(); node != nullptr; node = node->next.get()) {
+        previous.push_back(&node->level);
+    }
+
+    std::shared_ptr<Node const> result = std::shared_ptr<Node const>(new Node { level, nullptr });
+    for (auto it = previous.rbegin(); it != previous.rend(); ++it) {
+        result = std::shared_ptr<Node const>(new Node { **it, result });
     }
+
+    *levels = result;
 }
 
 void Environment::
 dump() const
 {
-    size_t offset = 0;
+    for (bool defaults : { false, true }) {
+        printf(defaults ? "=== Default Levels ===\n" : "=== Levels ===\n");
 
-    for (Level const &level : _levels) {
-        if (offset == _offset) {
-            printf("=== Default Levels ===\n");
-        } else if (offset == 0) {
-            printf("=== Remaining Levels ===\n");
-        }
-
-        printf("Level:\n");
-        for (Setting const &setting : level.settings()) {
-            printf("    %s = %s\n", setting.name().c_str(), setting.value().raw().c_str());
+        for (Node const *node = (defaults ? _defaultLevels.get() : _levels.get()); node != nullptr; node = node->next.get()) {
+            printf("Level:\n");
+            for (Setting const &setting : node->level.settings()) {
+                printf("    %s = %s\n", setting.name().c_str(), setting.value().raw().c_str());
+            }
+            printf("\n");
         }
-        printf("\n");
-
-        ++offset;
     }
 }
 
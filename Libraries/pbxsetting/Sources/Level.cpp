@@ -16,8 +16,12 @@ using pbxsetting::Value;
 
 Level::
 Level(std::vector<Setting> const &settings) :
-    _settings(std::make_shared<std::vector<Setting>>(settings))
+    _settings(std::make_shared<std::vector<Setting>>(settings)),
+    _index   (std::make_shared<std::unordered_map<std::string, std::vector<size_t>>>())
 {
+    for (size_t i = 0; i < _settings->size(); ++i) {
+        (*_index)[(*_settings)[i].name()].push_back(i);
+    }
 }
 
 Level::
@@ -28,9 +32,16 @@ Level::
 std::pair<bool, Value> Level::
 get(std::string const &setting, Condition const &condition) const
 {
-    for (auto it = _settings->rbegin(); it != _settings->rend(); ++it) {
-        if (it->match(setting, condition)) {
-            return std::make_pair(true, it->value());
+    auto index = _index->find(setting);
+    if (index == _index->end()) {
+        return std::make_pair(false, Value::Empty());
+    }
+
+    /* Later settings override earlier ones. */
+    for (auto it = index->second.rbegin(); it != index->second.rend(); ++it) {
+        Setting const &candidate = (*_settings)[*it];
+        if (candidate.match(setting, condition)) {
+            return std::make_pair(true, candidate.value());
         }
     }
 
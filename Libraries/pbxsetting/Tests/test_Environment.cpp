@@ -2,6 +2,7 @@
 #include <gtest/gtest.h>
 #include <pbxsetting/Environment.h>
 
+using pbxsetting::Condition;
 using pbxsetting::Environment;
 using pbxsetting::Level;
 using pbxsetting::Setting;
@@ -172,3 +173,130 @@ TEST(Environment, Default)
     EXPECT_EQ(env.resolve("THREE"), "3");
 }
 
+
+TEST(Environment, ConditionalIndex)
+{
+    Environment env;
+    env.insertBack(Level({
+        Setting::Parse("FLAGS", "base"),
+        *Setting::Parse("FLAGS[arch=arm64] = arm64, $(inherited)"),
+        Setting::Parse("OTHER", "other"),
+    }), false);
+    env.insertBack(Level({
+        Setting::Parse("FLAGS", "default"),
+    }), false);
+
+    auto arm64 = pbxsetting::Condition(std::unordered_map<std::string, std::string>({ { "arch", "arm64" } }));
+    auto x86_64 = pbxsetting::Condition(std::unordered_map<std::string, std::string>({ { "arch", "x86_64" } }));
+    EXPECT_EQ(env.resolve("FLAGS", arm64), "arm64, default");
+    EXPECT_EQ(env.resolve("FLAGS", x86_64), "base");
+    EXPECT_EQ(env.resolve("FLAGS"), "base");
+    EXPECT_EQ(env.resolve("OTHER", arm64), "other");
+}
+
+TEST(Environment, CacheInvalidation)
+{
+    Environment env;
+    env.insertBack(Level({
+        Setting::Parse("ONE", "one"),
+        Setting::Parse("TWO", "$(ONE) two"),
+    }), false);
+    EXPECT_EQ(env.resolve("TWO"), "one two");
+
+    /* Copies see the same values until they change. */
+    Environment copy = Environment(env);
+    EXPECT_EQ(copy.resolve("TWO"), "one two");
+
+    copy.insertFront(Level({
+        Setting::Parse("ONE", "1"),
+    }), false);
+    EXPECT_EQ(copy.resolve("TWO"), "1 two");
+    EXPECT_EQ(env.resolve("TWO"), "one two");
+
+    env.insertBack(Level({
+        Setting::Parse("THREE", "three"),
+    }), false);
+    EXPECT_EQ(env.resolve("THREE"), "three");
+}
+
+TEST(Environment, SharedLevels)
+{
+    Environment base;
+    base.insertBack(Level({
+        Setting::Parse("ONE", "one"),
+    }), false);
+    base.insertBack(Level({
+        Setting::Parse("TWO", "two"),
+    }), true);
+
+    /* Copies share levels, but changes to either don't affect the other. */
+    Environment front = Environment(base);
+    front.insertFront(Level({
+        Setting::Parse("ONE", "1, $(inherited)"),
+    }), false);
+    front.insertFront(Level({
+        Setting::Parse("TWO", "2, $(inherited)"),
+    }), true);
+
+    Environment back = Environment(base);
+    back.insertBack(Level({
+        Setting::Parse("ONE", "ignored"),
+        Setting::Parse("THREE", "three"),
+    }), false);
+
+    EXPECT_EQ(front.resolve("ONE"), "1, one");
+    EXPECT_EQ(front.resolve("TWO"), "2, two");
+    EXPECT_EQ(front.resolve("THREE"), "");
+    EXPECT_EQ(back.resolve("ONE"), "one");
+    EXPECT_EQ(back.resolve("THREE"), "three");
+    EXPECT_EQ(base.resolve("ONE"), "one");
+    EXPECT_EQ(base.resolve("TWO"), "two");
+    EXPECT_EQ(base.resolve("THREE"), "");
+}
+
+TEST(Environment, SharedValues)
+{
+    Environment base;
+    base.insertBack(Level({
+        Setting::Parse("ONE", "one"),
+        Setting::Parse("TWO", "$(ONE) two"),
+    }), false);
+
+    auto values = base.computeSharedValues(Condition::Empty());
+    ASSERT_NE(nullptr, values);
+    EXPECT_EQ(base.computeValues(Condition::Empty()), *values);
+
+    /* Copies share computed values until they change. */
+    Environment copy = Environment(base);
+    EXPECT_EQ(values, copy.computeSharedValues(Condition::Empty()));
+
+    copy.insertFront(Level({
+        Setting::Parse("ONE", "1"),
+    }), false);
+    auto changed = copy.computeSharedValues(Condition::Empty());
+    EXPECT_NE(values, changed);
+    EXPECT_EQ("1 two", changed->at("TWO"));
+    EXPECT_EQ("one two", values->at("TWO"));
+}
+
+TEST(Environment, ComputeDependents)
+{
+    Environment environment;
+    environment.insertFront(Level({
+        Setting::Parse("DIRECT", "$(INPUT)"),
+        Setting::Parse("INDIRECT", "$(DIRECT:base) $(OTHER)"),
+        Setting::Parse("NAMED", "$(VALUE_$(INPUT))"),
+        Setting::Parse("OTHER", "other"),
+    }), false);
+    environment.insertFront(Level({
+        Setting::Parse("INHERITED", "$(inherited) $(OTHER)"),
+    }), false);
+    environment.insertFront(Level({
+        Setting::Parse("INHERITED", "$(inherited) $(INPUT)"),
+    }), false);
+
+    std::unordered_set<std::string> expected = { "DIRECT", "INDIRECT", "NAMED", "INHERITED" };
+    EXPECT_EQ(expected, environment.computeDependents(Condition::Empty(), { "INPUT" }));
+    EXPECT_EQ(std::unordered_set<std::string>({ "INDIRECT", "INHERITED" }), environment.computeDependents(Condition::Empty(), { "OTHER" }));
+    EXPECT_TRUE(environment.computeDependents(Condition::Empty(), { "UNUSED" }).empty());
+}
@@ -24,15 +24,20 @@
 #include <pbxspec/PBX/Specification.h>
 #include <pbxspec/PBX/Tool.h>
 
+#include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 
 namespace libutil { class Filesystem; }
 
+namespace pbxspec { class SpecificationCache; }
+
 namespace pbxspec {
 
 class Manager {
@@ -44,89 +49,127 @@ private:
     std::map<std::string, std::map<SpecificationType, PBX::Specification::vector>> _specifications;
     PBX::BuildRule::vector                                                         _buildRules;
 
+private:
+    /*
+     * Specifications by domain, type, and identifier.
+     */
+    std::unordered_map<std::string, std::map<SpecificationType, std::unordered_map<std::string, PBX::Specification::shared_ptr>>> _index;
+
+    /*
+     * Specification lists already built for a list of domains and a type.
+     * Cleared when specifications are added. The flag separates lists of
+     * the base specification type from lists of the derived type.
+     */
+    mutable std::map<std::vector<std::string>, std::map<std::pair<SpecificationType, bool>, std::shared_ptr<void const>>> _found;
+    mutable std::mutex _foundMutex;
+
+    /*
+     * Data derived from the specifications in a list of domains, by name.
+     * Cleared when specifications are added, like the lists above.
+     */
+    mutable std::map<std::pair<std::string, std::vector<std::string>>, std::shared_ptr<void const>> _derived;
+
 public:
     Manager();
     ~Manager();
 
 public:
+    /*
+     * Lists of specifications are valid until more are registered.
+     */
     PBX::Specification::shared_ptr
     specification(SpecificationType type, std::string const &identifier, std::vector<std::string> const &domains) const;
-    PBX::Specification::vector
+    PBX::Specification::vector const &
     specifications(SpecificationType type, std::vector<std::string> const &domains) const;
 
 public:
     PBX::Architecture::shared_ptr
     architecture(std::string const &identifier, std::vector<std::string> const &domains) const;
-    PBX::Architecture::vector
+    PBX::Architecture::vector const &
     architectures(std::vector<std::string> const &domains) const;
 
 public:
     PBX::BuildPhase::shared_ptr
     buildPhase(std::string const &identifier, std::vector<std::string> const &domains) const;
-    PBX::BuildPhase::vector
+    PBX::BuildPhase::vector const &
     buildPhases(std::vector<std::string> const &domains) const;
 
 public:
     PBX::BuildSettings::shared_ptr
     buildSettings(std::string const &identifier, std::vector<std::string> const &domains) const;
-    PBX::BuildSettings::vector
+    PBX::BuildSettings::vector const &
     buildSettingses(std::vector<std::string> const &domains) const;
 
 public:
     PBX::BuildStep::shared_ptr
     buildStep(std::string const &identifier, std::vector<std::string> const &domains) const;
-    PBX::BuildStep::vector
+    PBX::BuildStep::vector const &
     buildSteps(std::vector<std::string> const &domains) const;
 
 public:
     PBX::BuildSystem::shared_ptr
     buildSystem(std::string const &identifier, std::vector<std::string> const &domains) const;
-    PBX::BuildSystem::vector
+    PBX::BuildSystem::vector const &
     buildSystems(std::vector<std::string> const &domains) const;
 
 public:
     PBX::Compiler::shared_ptr
     compiler(std::string const &identifier, std::vector<std::string> const &domains) const;
-    PBX::Compiler::vector
+    PBX::Compiler::vector const &
     compilers(std::vector<std::string> const &domains) const;
 
 public:
     PBX::FileType::shared_ptr
     fileType(std::string const &identifier, std::vector<std::string> const &domains) const;
-    PBX::FileType::vector
+    PBX::FileType::vector const &
     fileTypes(std::vector<std::string> const &domains) const;
 
 public:
     PBX::Linker::shared_ptr
     linker(std::string const &identifier, std::vector<std::string> const &domains) const;
-    PBX::Linker::vector
+    PBX::Linker::vector const &
     linkers(std::vector<std::string> const &domains) const;
 
 public:
     PBX::PackageType::shared_ptr
     packageType(std::string const &identifier, std::vector<std::string> const &domains) const;
-    PBX::PackageType::vector
+    PBX::PackageType::vector const &
     packageTypes(std::vector<std::string> const &domains) const;
 
 public:
     PBX::ProductType::shared_ptr
     productType(std::string const &identifier, std::vector<std::string> const &domains) const;
-    PBX::ProductType::vector
+    PBX::ProductType::vector const &
     productTypes(std::vector<std::string> const &domains) const;
 
 public:
     PBX::Tool::shared_ptr
     tool(std::string const &identifier, std::vector<std::string> const &domains) const;
-    PBX::Tool::vector
+    PBX::Tool::vector const &
     tools(std::vector<std::string> const &domains) const;
 
+public:
+    /*
+     * Data derived from the specifications in the domains, such as lookup
+     * tables, kept with the manager so it is shared between users. Created
+     * by `create` on first use for a name and list of domains, and valid
+     * until more specifications are registered. Nothing is kept if `create`
+     * returns null.
+     */
+    std::shared_ptr<void const>
+    derived(std::string const &name, std::vector<std::string> const &domains, std::function<std::shared_ptr<void const>()> const &create) const;
+
 public:
     inline PBX::BuildRule::vector buildRules(void) const
     { return _buildRules; }
     PBX::BuildRule::vector synthesizedBuildRules(std::vector<std::string> const &domains) const;
 
 public:
-    void registerDomains(libutil::Filesystem const *filesystem, std::vector<std::pair<std::string, std::string>> const &domains);
+    /*
+     * Load the specifications in the domains. If a cache is provided, unchanged
+     * specification files are loaded from it and others are added to it.
+     */
+    void registerDomains(libutil::Filesystem const *filesystem, std::vector<std::pair<std::string, std::string>> const &domains, SpecificationCache *cache = nullptr);
     bool registerBuildRules(libutil::Filesystem const *filesystem, std::string const &path);
 
 private:
@@ -138,7 +181,7 @@ private:
     typename T::shared_ptr
     findSpecification(std::vector<std::string> const &domains, std::string const &identifier, SpecificationType type = T::Type()) const;
     template <typename T>
-    typename T::vector
+    typename T::vector const &
     findSpecifications(std::vector<std::string> const &domains, SpecificationType type = T::Type()) const;
 
 public:
@@ -22,6 +22,7 @@ namespace libutil { class Filesystem; }
 namespace plist { class Dictionary; }
 namespace pbxspec { class Manager; }
 namespace pbxspec { class Context; }
+namespace pbxspec { class SpecificationCache; }
 
 namespace pbxspec { namespace PBX {
 
@@ -102,7 +103,8 @@ public:
         libutil::Filesystem const *filesystem,
         Context *context,
         std::string const &filename,
-        ext::optional<SpecificationType> defaultType = ext::nullopt);
+        ext::optional<SpecificationType> defaultType = ext::nullopt,
+        SpecificationCache *cache = nullptr);
 
 private:
     static Specification::shared_ptr Parse(Context *context, plist::Dictionary const *dict, ext::optional<SpecificationType> defaultType);
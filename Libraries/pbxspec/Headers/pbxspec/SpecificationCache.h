@@ -0,0 +1,90 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef __pbxspec_SpecificationCache_h
+#define __pbxspec_SpecificationCache_h
+
+#include <plist/Object.h>
+#include <plist/Format/BinaryView.h>
+#include <libutil/MappedFile.h>
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace libutil { class Filesystem; }
+
+namespace pbxspec {
+
+/*
+ * Parsed contents of specification files, persisted between runs in the
+ * binary property list format. Entries are keyed by the path of the file
+ * and are only valid while the file's modification time is unchanged.
+ * A loaded cache stays mapped; each entry is only decoded when its file
+ * is looked up, so registering a domain only touches that domain's files.
+ */
+class SpecificationCache {
+private:
+    struct Entry {
+        uint64_t              modificationTime;
+        plist::Object const  *contents;
+        bool                  used;
+    };
+
+private:
+    std::vector<std::unique_ptr<plist::Object>>    _storage;
+    std::unordered_map<std::string, Entry>         _entries;
+    bool                                           _modified;
+
+private:
+    ext::optional<libutil::MappedFile>             _file;
+    std::unique_ptr<plist::Format::BinaryView>     _view;
+    ext::optional<plist::Format::BinaryView::Value> _files;
+
+public:
+    SpecificationCache();
+
+public:
+    /*
+     * Find the cached contents of a file, if still valid.
+     */
+    plist::Object const *
+    lookup(std::string const &path, uint64_t modificationTime);
+
+    /*
+     * Add the contents of a file, replacing any previous contents.
+     */
+    plist::Object const *
+    insert(std::string const &path, uint64_t modificationTime, std::unique_ptr<plist::Object> contents);
+
+public:
+    /*
+     * If the cache needs to be saved. Entries for files that were not
+     * looked up or inserted since loading are dropped when saving.
+     */
+    bool modified() const;
+
+public:
+    /*
+     * Write the cache to a path. The file is replaced, not rewritten, so
+     * other processes loading the cache see either the old or new cache.
+     */
+    bool save(libutil::Filesystem *filesystem, std::string const &path) const;
+
+    /*
+     * Load a cache from a path. If it can't be loaded, the cache is empty.
+     */
+    static SpecificationCache
+    Load(libutil::Filesystem const *filesystem, std::string const &path);
+};
+
+}
+
+#endif  // !__pbxspec_SpecificationCache_h
@@ -9,6 +9,7 @@
 
 #include <pbxspec/Manager.h>
 #include <pbxspec/Context.h>
+#include <pbxspec/SpecificationCache.h>
 #include <plist/Array.h>
 #include <plist/Dictionary.h>
 #include <plist/Object.h>
@@ -18,6 +19,7 @@
 
 using pbxspec::Manager;
 using pbxspec::Context;
+using pbxspec::SpecificationCache;
 using pbxspec::SpecificationType;
 using pbxspec::SpecificationTypes;
 namespace PBX = pbxspec::PBX;
@@ -35,10 +37,21 @@ Manager::
 }
 
 template <typename T>
-typename T::vector Manager::
+typename T::vector const &Manager::
 findSpecifications(std::vector<std::string> const &domains, SpecificationType type) const
 {
-    typename T::vector specifications;
+    std::lock_guard<std::mutex> lock(_foundMutex);
+
+    std::pair<SpecificationType, bool> key = std::make_pair(type, std::is_same<T, PBX::Specification>::value);
+    auto domainsFound = _found.find(domains);
+    if (domainsFound != _found.end()) {
+        auto found = domainsFound->second.find(key);
+        if (found != domainsFound->second.end()) {
+            return *std::static_pointer_cast<typename T::vector const>(found->second);
+        }
+    }
+
+    auto specifications = std::make_shared<typename T::vector>();
 
     for (std::string const &domain : domains) {
         if (domain == AnyDomain()) {
@@ -46,7 +59,7 @@ findSpecifications(std::vector<std::string> const &domains, SpecificationType ty
                 auto const &it = entry.second.find(type);
                 if (it != entry.second.end()) {
                     for (auto const &s : it->second) {
-                        specifications.emplace_back(std::static_pointer_cast<T>(s));
+                        specifications->emplace_back(std::static_pointer_cast<T>(s));
                     }
                 }
             }
@@ -56,28 +69,49 @@ findSpecifications(std::vector<std::string> const &domains, SpecificationType ty
                 auto const &it = doit->second.find(type);
                 if (it != doit->second.end()) {
                     for (auto const &s : it->second) {
-                        specifications.emplace_back(std::static_pointer_cast<T>(s));
+                        specifications->emplace_back(std::static_pointer_cast<T>(s));
                     }
                 }
             }
         }
     }
 
-    return specifications;
+    _found[domains].insert({ key, specifications });
+    return *specifications;
 }
 
 template <typename T>
 typename T::shared_ptr Manager::
 findSpecification(std::vector<std::string> const &domains, std::string const &identifier, SpecificationType type) const
 {
-    typename T::vector vector = findSpecifications <T> (domains, type);
+    auto find = [&](std::string const &domain) -> PBX::Specification::shared_ptr {
+        auto doit = _index.find(domain);
+        if (doit == _index.end()) {
+            return nullptr;
+        }
 
-    auto I = std::find_if(vector.begin(), vector.end(), [&identifier](PBX::Specification::shared_ptr const &spec) -> bool {
-        return identifier == spec->identifier();
-    });
+        auto tit = doit->second.find(type);
+        if (tit == doit->second.end()) {
+            return nullptr;
+        }
 
-    if (I != vector.end()) {
-        return *I;
+        auto it = tit->second.find(identifier);
+        return (it != tit->second.end() ? it->second : nullptr);
+    };
+
+    /* Search in the same order as the lists of specifications. */
+    for (std::string const &domain : domains) {
+        if (domain == AnyDomain()) {
+            for (auto const &entry : _specifications) {
+                if (PBX::Specification::shared_ptr specification = find(entry.first)) {
+                    return std::static_pointer_cast<T>(specification);
+                }
+            }
+        } else {
+            if (PBX::Specification::shared_ptr specification = find(domain)) {
+                return std::static_pointer_cast<T>(specification);
+            }
+        }
     }
 
     return nullptr;
@@ -89,7 +123,7 @@ specification(SpecificationType type, std::string const &identifier, std::vector
     return findSpecification <PBX::Specification> (domains, identifier, type);
 }
 
-PBX::Specification::vector Manager::
+PBX::Specification::vector const &Manager::
 specifications(SpecificationType type, std::vector<std::string> const &domains) const
 {
     return findSpecifications <PBX::Specification> (domains, type);
@@ -101,7 +135,7 @@ architecture(std::string const &identifier, std::vector<std::string> const &doma
     return findSpecification <PBX::Architecture> (domains, identifier);
 }
 
-PBX::Architecture::vector Manager::
+PBX::Architecture::vector const &Manager::
 architectures(std::vector<std::string> const &domains) const
 {
     return findSpecifications <PBX::Architecture> (domains);
@@ -113,7 +147,7 @@ buildPhase(std::string const &identifier, std::vector<std::string> const &domain
     return findSpecification <PBX::BuildPhase> (domains, identifier);
 }
 
-PBX::BuildPhase::vector Manager::
+PBX::BuildPhase::vector const &Manager::
 buildPhases(std::vector<std::string> const &domains) const
 {
     return findSpecifications <PBX::BuildPhase> (domains);
@@ -125,7 +159,7 @@ buildSettings(std::string const &identifier, std::vector<std::string> const &dom
     return findSpecification <PBX::BuildSettings> (domains, identifier);
 }
 
-PBX::BuildSettings::vector Manager::
+PBX::BuildSettings::vector const &Manager::
 buildSettingses(std::vector<std::string> const &domains) const
 {
     return findSpecifications <PBX::BuildSettings> (domains);
@@ -137,7 +171,7 @@ buildStep(std::string const &identifier, std::vector<std::string> const &domains
     return findSpecification <PBX::BuildStep> (domains, identifier);
 }
 
-PBX::BuildStep::vector Manager::
+PBX::BuildStep::vector const &Manager::
 buildSteps(std::vector<std::string> const &domains) const
 {
     return findSpecifications <PBX::BuildStep> (domains);
@@ -149,7 +183,7 @@ buildSystem(std::string const &identifier, std::vector<std::string> const &domai
     return findSpecification <PBX::BuildSystem> (domains, identifier);
 }
 
-PBX::BuildSystem::vector Manager::
+PBX::BuildSystem::vector const &Manager::
 buildSystems(std::vector<std::string> const &domains) const
 {
     return findSpecifications <PBX::BuildSystem> (domains);
@@ -161,7 +195,7 @@ compiler(std::string const &identifier, std::vector<std::string> const &domains)
     return findSpecification <PBX::Compiler> (domains, identifier);
 }
 
-PBX::Compiler::vector Manager::
+PBX::Compiler::vector const &Manager::
 compilers(std::vector<std::string> const &domains) const
 {
     return findSpecifications <PBX::Compiler> (domains);
@@ -173,7 +207,7 @@ fileType(std::string const &identifier, std::vector<std::string> const &domains)
     return findSpecification <PBX::FileType> (domains, identifier);
 }
 
-PBX::FileType::vector Manager::
+PBX::FileType::vector const &Manager::
 fileTypes(std::vector<std::string> const &domains) const
 {
     return findSpecifications <PBX::FileType> (domains);
@@ -185,7 +219,7 @@ linker(std::string const &identifier, std::vector<std::string> const &domains) c
     return findSpecification <PBX::Linker> (domains, identifier);
 }
 
-PBX::Linker::vector Manager::
+PBX::Linker::vector const &Manager::
 linkers(std::vector<std::string> const &domains) const
 {
     return findSpecifications <PBX::Linker> (domains);
@@ -197,7 +231,7 @@ packageType(std::string const &identifier, std::vector<std::string> const &domai
     return findSpecification <PBX::PackageType> (domains, identifier);
 }
 
-PBX::PackageType::vector Manager::
+PBX::PackageType::vector const &Manager::
 packageTypes(std::vector<std::string> const &domains) const
 {
     return findSpecifications <PBX::PackageType> (domains);
@@ -209,7 +243,7 @@ productType(std::string const &identifier, std::vector<std::string> const &domai
     return findSpecification <PBX::ProductType> (domains, identifier);
 }
 
-PBX::ProductType::vector Manager::
+PBX::ProductType::vector const &Manager::
 productTypes(std::vector<std::string> const &domains) const
 {
     return findSpecifications <PBX::ProductType> (domains);
@@ -221,12 +255,36 @@ tool(std::string const &identifier, std::vector<std::string> const &domains) con
     return findSpecification <PBX::Tool> (domains, identifier);
 }
 
-PBX::Tool::vector Manager::
+PBX::Tool::vector const &Manager::
 tools(std::vector<std::string> const &domains) const
 {
     return findSpecifications <PBX::Tool> (domains);
 }
 
+std::shared_ptr<void const> Manager::
+derived(std::string const &name, std::vector<std::string> const &domains, std::function<std::shared_ptr<void const>()> const &create) const
+{
+    auto key = std::make_pair(name, domains);
+
+    {
+        std::lock_guard<std::mutex> lock(_foundMutex);
+        auto it = _derived.find(key);
+        if (it != _derived.end()) {
+            return it->second;
+        }
+    }
+
+    /* Created without the lock held, as it can look up specifications. */
+    std::shared_ptr<void const> value = create();
+    if (value == nullptr) {
+        return nullptr;
+    }
+
+    /* If created at the same time on another thread, share the first. */
+    std::lock_guard<std::mutex> lock(_foundMutex);
+    return _derived.insert({ key, value }).first->second;
+}
+
 PBX::BuildRule::vector Manager::
 synthesizedBuildRules(std::vector<std::string> const &domains) const
 {
@@ -282,6 +340,11 @@ addSpecification(PBX::Specification::shared_ptr const &spec)
             spec->type(), spec->domain().c_str(), spec->identifier().c_str());
 #endif
     _specifications[spec->domain()][spec->type()].push_back(spec);
+    _index[spec->domain()][spec->type()].insert({ spec->identifier(), spec });
+
+    std::lock_guard<std::mutex> lock(_foundMutex);
+    _found.clear();
+    _derived.clear();
 }
 
 bool Manager::
@@ -362,7 +425,7 @@ inheritSpecification(PBX::Specification::shared_ptr const &specification, std::v
 }
 
 void Manager::
-registerDomains(Filesystem const *filesystem, std::vector<std::pair<std::string, std::string>> const &domains)
+registerDomains(Filesystem const *filesystem, std::vector<std::pair<std::string, std::string>> const &domains, SpecificationCache *cache)
 {
     PBX::Specification::vector specifications;
 
@@ -408,7 +471,7 @@ registerDomains(Filesystem const *filesystem, std::vector<std::pair<std::string,
                         fprintf(stderr, "importing specification '%s'\n", path.c_str());
 #endif
 
-                        ext::optional<PBX::Specification::vector> fileSpecifications = PBX::Specification::Open(filesystem, &context, path, defaultType);
+                        ext::optional<PBX::Specification::vector> fileSpecifications = PBX::Specification::Open(filesystem, &context, path, defaultType, cache);
                         if (fileSpecifications) {
                             specifications.insert(specifications.end(), fileSpecifications->begin(), fileSpecifications->end());
                         } else {
@@ -424,7 +487,7 @@ registerDomains(Filesystem const *filesystem, std::vector<std::pair<std::string,
 #if 0
                 fprintf(stderr, "importing specification '%s'\n", realPath.c_str());
 #endif
-                ext::optional<PBX::Specification::vector> fileSpecifications = PBX::Specification::Open(filesystem, &context, realPath);
+                ext::optional<PBX::Specification::vector> fileSpecifications = PBX::Specification::Open(filesystem, &context, realPath, ext::nullopt, cache);
                 if (fileSpecifications) {
                     specifications.insert(specifications.end(), fileSpecifications->begin(), fileSpecifications->end());
                 } else {
@@ -467,12 +530,12 @@ registerDomains(Filesystem const *filesystem, std::vector<std::pair<std::string,
 bool Manager::
 registerBuildRules(Filesystem const *filesystem, std::string const &path)
 {
-    std::vector<uint8_t> contents;
-    if (!filesystem->read(&contents, path)) {
+    ext::optional<libutil::MappedFile> contents = filesystem->map(path);
+    if (!contents) {
         return false;
     }
 
-    std::unique_ptr<plist::Object> plist = plist::Format::Any::Deserialize(contents).first;
+    std::unique_ptr<plist::Object> plist = plist::Format::Any::Deserialize(contents->contents()).first;
     if (plist == nullptr) {
         return false;
     }
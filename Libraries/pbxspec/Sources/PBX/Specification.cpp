@@ -18,6 +18,7 @@
 #include <pbxspec/PBX/Tool.h>
 #include <pbxspec/Context.h>
 #include <pbxspec/Inherit.h>
+#include <pbxspec/SpecificationCache.h>
 #include <plist/Array.h>
 #include <plist/Boolean.h>
 #include <plist/Dictionary.h>
@@ -200,7 +201,7 @@ Parse(Context *context, plist::Dictionary const *dict, ext::optional<Specificati
 }
 
 ext::optional<Specification::vector> Specification::
-Open(Filesystem const *filesystem, Context *context, std::string const &filename, ext::optional<SpecificationType> defaultType)
+Open(Filesystem const *filesystem, Context *context, std::string const &filename, ext::optional<SpecificationType> defaultType, SpecificationCache *cache)
 {
     if (filename.empty()) {
         fprintf(stderr, "error: empty specification path\n");
@@ -213,33 +214,54 @@ Open(Filesystem const *filesystem, Context *context, std::string const &filename
         return ext::nullopt;
     }
 
-    std::vector<uint8_t> contents;
-    if (!filesystem->read(&contents, realPath)) {
-        fprintf(stderr, "error: unable to read specification plist\n");
-        return ext::nullopt;
-    }
-
     //
-    // Parse property list
+    // Use the cached property list if the file is unchanged.
     //
-    std::unique_ptr<plist::Object> plist = plist::Format::Any::Deserialize(contents).first;
+    ext::optional<uint64_t> modificationTime;
+    plist::Object const *plist = nullptr;
+    std::unique_ptr<plist::Object> parsed;
+    if (cache != nullptr) {
+        modificationTime = filesystem->modificationTime(realPath);
+        if (modificationTime) {
+            plist = cache->lookup(realPath, *modificationTime);
+        }
+    }
+
     if (plist == nullptr) {
-        fprintf(stderr, "error: unable to parse specification plist\n");
-        return ext::nullopt;
+        ext::optional<libutil::MappedFile> contents = filesystem->map(realPath);
+        if (!contents) {
+            fprintf(stderr, "error: unable to read specification plist\n");
+            return ext::nullopt;
+        }
+
+        //
+        // Parse property list
+        //
+        parsed = plist::Format::Any::Deserialize(contents->contents()).first;
+        if (parsed == nullptr) {
+            fprintf(stderr, "error: unable to parse specification plist\n");
+            return ext::nullopt;
+        }
+
+        if (cache != nullptr && modificationTime) {
+            plist = cache->insert(realPath, *modificationTime, std::move(parsed));
+        } else {
+            plist = parsed.get();
+        }
     }
 
     //
     // If this is a dictionary, then it's a single specification,
     // if it's an array then multiple specifications are present.
     //
-    if (auto dict = plist::CastTo <plist::Dictionary> (plist.get())) {
+    if (auto dict = plist::CastTo <plist::Dictionary> (plist)) {
         if (auto spec = Parse(context, dict, defaultType)) {
             return Specification::vector({ spec });
         } else {
             fprintf(stderr, "error: single specification failed to parse\n");
             return ext::nullopt;
         }
-    } else if (auto array = plist::CastTo <plist::Array> (plist.get())) {
+    } else if (auto array = plist::CastTo <plist::Array> (plist)) {
         size_t errors = 0;
         Specification::vector specifications;
 
@@ -0,0 +1,162 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <pbxspec/SpecificationCache.h>
+#include <plist/Dictionary.h>
+#include <plist/Integer.h>
+#include <plist/Format/Binary.h>
+#include <plist/Format/BinaryView.h>
+#include <libutil/Filesystem.h>
+#include <libutil/FSUtil.h>
+
+using pbxspec::SpecificationCache;
+using libutil::Filesystem;
+using libutil::FSUtil;
+
+/*
+ * Increment when the layout of the cache changes.
+ */
+static int64_t const CacheVersion = 1;
+
+SpecificationCache::
+SpecificationCache() :
+    _modified(false)
+{
+}
+
+plist::Object const *SpecificationCache::
+lookup(std::string const &path, uint64_t modificationTime)
+{
+    auto it = _entries.find(path);
+    if (it != _entries.end()) {
+        if (it->second.modificationTime != modificationTime) {
+            return nullptr;
+        }
+
+        it->second.used = true;
+        return it->second.contents;
+    }
+
+    /* Decode the entry from the loaded cache on first use. */
+    if (!_files) {
+        return nullptr;
+    }
+
+    ext::optional<plist::Format::BinaryView::Value> file = _files->value(path);
+    if (!file || file->type() != plist::ObjectType::Dictionary) {
+        return nullptr;
+    }
+
+    ext::optional<plist::Format::BinaryView::Value> cachedTime = file->value("ModificationTime");
+    ext::optional<plist::Format::BinaryView::Value> contents = file->value("Contents");
+    if (!cachedTime || !contents) {
+        return nullptr;
+    }
+
+    auto integer = plist::CastTo<plist::Integer>(cachedTime->object());
+    if (integer == nullptr || static_cast<uint64_t>(integer->value()) != modificationTime) {
+        return nullptr;
+    }
+
+    plist::Object const *object = contents->object();
+    if (object == nullptr) {
+        return nullptr;
+    }
+
+    _entries[path] = { modificationTime, object, true };
+    return object;
+}
+
+plist::Object const *SpecificationCache::
+insert(std::string const &path, uint64_t modificationTime, std::unique_ptr<plist::Object> contents)
+{
+    plist::Object const *object = contents.get();
+    _storage.push_back(std::move(contents));
+    _entries[path] = { modificationTime, object, true };
+    _modified = true;
+    return object;
+}
+
+bool SpecificationCache::
+modified() const
+{
+    if (_modified) {
+        return true;
+    }
+
+    /* Without changes, every entry is used only if each loaded file was looked up. */
+    ext::optional<size_t> count = (_files ? _files->count() : ext::optional<size_t>(0));
+    return !count || _entries.size() != *count;
+}
+
+bool SpecificationCache::
+save(Filesystem *filesystem, std::string const &path) const
+{
+    auto files = plist::Dictionary::New();
+    for (auto const &entry : _entries) {
+        if (!entry.second.used) {
+            continue;
+        }
+
+        auto file = plist::Dictionary::New();
+        file->set("ModificationTime", plist::Integer::New(static_cast<int64_t>(entry.second.modificationTime)));
+        file->set("Contents", entry.second.contents->copy());
+        files->set(entry.first, std::move(file));
+    }
+
+    auto root = plist::Dictionary::New();
+    root->set("Version", plist::Integer::New(CacheVersion));
+    root->set("Files", std::move(files));
+
+    auto serialize = plist::Format::Binary::Serialize(root.get(), plist::Format::Binary::Create());
+    if (serialize.first == nullptr) {
+        return false;
+    }
+
+    if (!filesystem->createDirectory(FSUtil::GetDirectoryName(path), true)) {
+        return false;
+    }
+
+    /* Other processes may have the cache mapped; replace it, don't rewrite it. */
+    return filesystem->writeAtomic(*serialize.first, path);
+}
+
+SpecificationCache SpecificationCache::
+Load(Filesystem const *filesystem, std::string const &path)
+{
+    SpecificationCache cache;
+
+    /* Map the cache; entries are decoded from it as they are looked up. */
+    ext::optional<libutil::MappedFile> contents = filesystem->map(path);
+    if (!contents) {
+        return cache;
+    }
+
+    auto view = plist::Format::BinaryView::Open(contents->contents());
+    if (view.first == nullptr) {
+        return cache;
+    }
+
+    plist::Format::BinaryView::Value root = view.first->root();
+    ext::optional<plist::Format::BinaryView::Value> version = root.value("Version");
+    ext::optional<plist::Format::BinaryView::Value> files = root.value("Files");
+    if (!version || !files || files->type() != plist::ObjectType::Dictionary) {
+        return cache;
+    }
+
+    auto integer = plist::CastTo<plist::Integer>(version->object());
+    if (integer == nullptr || integer->value() != CacheVersion) {
+        return cache;
+    }
+
+    cache._file = std::move(contents);
+    cache._view = std::move(view.first);
+    cache._files = files;
+    return cache;
+}
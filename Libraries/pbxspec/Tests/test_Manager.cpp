@@ -0,0 +1,96 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <gtest/gtest.h>
+#include <pbxspec/Manager.h>
+#include <libutil/MemoryFilesystem.h>
+
+using pbxspec::Manager;
+using libutil::MemoryFilesystem;
+
+static MemoryFilesystem::Entry
+File(std::string const &name, std::string const &contents)
+{
+    return MemoryFilesystem::Entry::File(name, std::vector<uint8_t>(contents.begin(), contents.end()));
+}
+
+TEST(Manager, Lookup)
+{
+    auto filesystem = MemoryFilesystem({
+        File("first.xcspec", "( { Type = FileType; Identifier = text; }, { Type = FileType; Identifier = first; }, { Type = Architecture; Identifier = text; } )"),
+        File("second.xcspec", "( { Type = FileType; Identifier = text; }, { Type = FileType; Identifier = second; } )"),
+        File("third.xcspec", "( { Type = FileType; Identifier = third; } )"),
+    });
+
+    Manager manager;
+    manager.registerDomains(&filesystem, {
+        { "first", filesystem.path("first.xcspec") },
+        { "second", filesystem.path("second.xcspec") },
+    });
+
+    /* Identifiers are found in the first listed domain containing them. */
+    auto text = manager.fileType("text", { "second", "first" });
+    ASSERT_NE(nullptr, text);
+    EXPECT_EQ("second", text->domain());
+    EXPECT_EQ("first", manager.fileType("text", { "first", "second" })->domain());
+    EXPECT_EQ("first", manager.fileType("text", { Manager::AnyDomain() })->domain());
+    EXPECT_EQ(nullptr, manager.fileType("first", { "second" }));
+    EXPECT_EQ(nullptr, manager.fileType("missing", { Manager::AnyDomain() }));
+
+    /* Identifiers are separate between types. */
+    EXPECT_NE(nullptr, manager.architecture("text", { "first" }));
+    EXPECT_EQ(nullptr, manager.architecture("first", { "first" }));
+
+    /* Lists are in domain order, and repeated lookups share a list. */
+    auto const &fileTypes = manager.fileTypes({ "second", "first" });
+    ASSERT_EQ(4u, fileTypes.size());
+    EXPECT_EQ("second", fileTypes[0]->domain());
+    EXPECT_EQ("first", fileTypes[3]->identifier());
+    EXPECT_EQ(&fileTypes, &manager.fileTypes({ "second", "first" }));
+    EXPECT_EQ(4u, manager.specifications(pbxspec::SpecificationType::FileType, { "second", "first" }).size());
+
+    /* Registering more specifications updates the lists. */
+    manager.registerDomains(&filesystem, { { "third", filesystem.path("third.xcspec") } });
+    EXPECT_EQ(5u, manager.fileTypes({ Manager::AnyDomain() }).size());
+    EXPECT_NE(nullptr, manager.fileType("third", { Manager::AnyDomain() }));
+}
+
+TEST(Manager, Derived)
+{
+    auto filesystem = MemoryFilesystem({
+        File("first.xcspec", "( { Type = FileType; Identifier = first; } )"),
+        File("second.xcspec", "( { Type = FileType; Identifier = second; } )"),
+    });
+
+    Manager manager;
+    manager.registerDomains(&filesystem, { { "first", filesystem.path("first.xcspec") } });
+
+    int created = 0;
+    auto count = [&]() -> std::shared_ptr<void const> {
+        created++;
+        return std::make_shared<size_t>(manager.fileTypes({ Manager::AnyDomain() }).size());
+    };
+
+    /* Created once for each name and list of domains. */
+    auto first = manager.derived("count", { Manager::AnyDomain() }, count);
+    EXPECT_EQ(1u, *std::static_pointer_cast<size_t const>(first));
+    EXPECT_EQ(first, manager.derived("count", { Manager::AnyDomain() }, count));
+    EXPECT_EQ(1, created);
+    manager.derived("count", { "first" }, count);
+    EXPECT_EQ(2, created);
+
+    /* Nothing is kept if creating fails. */
+    EXPECT_EQ(nullptr, manager.derived("none", { "first" }, [] { return nullptr; }));
+
+    /* Registering more specifications creates it again. */
+    manager.registerDomains(&filesystem, { { "second", filesystem.path("second.xcspec") } });
+    auto second = manager.derived("count", { Manager::AnyDomain() }, count);
+    EXPECT_EQ(2u, *std::static_pointer_cast<size_t const>(second));
+    EXPECT_EQ(3, created);
+}
@@ -0,0 +1,71 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <gtest/gtest.h>
+#include <pbxspec/Manager.h>
+#include <pbxspec/SpecificationCache.h>
+#include <libutil/MemoryFilesystem.h>
+
+using pbxspec::Manager;
+using pbxspec::SpecificationCache;
+using libutil::MemoryFilesystem;
+
+static std::vector<uint8_t>
+Contents(std::string const &string)
+{
+    return std::vector<uint8_t>(string.begin(), string.end());
+}
+
+static std::string const Specifications = R"(
+(
+    { Type = FileType; Identifier = text; },
+    { Type = FileType; Identifier = sourcecode; BasedOn = text; Extensions = ( c ); },
+)
+)";
+
+TEST(SpecificationCache, RoundTrip)
+{
+    auto filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::Directory("specs", {
+            MemoryFilesystem::Entry::File("FileTypes.xcspec", Contents(Specifications)),
+        }),
+    });
+    std::string specPath = filesystem.path("specs/FileTypes.xcspec");
+    std::string cachePath = filesystem.path("cache/specifications.cache");
+
+    /* Nothing to load, so parsed specifications are added. */
+    SpecificationCache cache = SpecificationCache::Load(&filesystem, cachePath);
+    Manager first;
+    first.registerDomains(&filesystem, { { "test", filesystem.path("specs") } }, &cache);
+    ASSERT_NE(nullptr, first.fileType("sourcecode", { "test" }));
+    EXPECT_TRUE(cache.modified());
+    ASSERT_TRUE(cache.save(&filesystem, cachePath));
+
+    /* Specifications load from the cache without change. */
+    SpecificationCache loaded = SpecificationCache::Load(&filesystem, cachePath);
+    EXPECT_TRUE(loaded.modified());
+    EXPECT_EQ(nullptr, loaded.lookup(specPath, *filesystem.modificationTime(specPath) + 1));
+    EXPECT_NE(nullptr, loaded.lookup(specPath, *filesystem.modificationTime(specPath)));
+    Manager second;
+    second.registerDomains(&filesystem, { { "test", filesystem.path("specs") } }, &loaded);
+    auto sourcecode = second.fileType("sourcecode", { "test" });
+    ASSERT_NE(nullptr, sourcecode);
+    EXPECT_EQ("text", sourcecode->base()->identifier());
+    EXPECT_FALSE(loaded.modified());
+
+    /* Changed files are not loaded from the cache. */
+    ASSERT_TRUE(filesystem.write(Contents("( { Type = FileType; Identifier = changed; } )"), specPath));
+    SpecificationCache stale = SpecificationCache::Load(&filesystem, cachePath);
+    EXPECT_EQ(nullptr, stale.lookup(specPath, *filesystem.modificationTime(specPath)));
+    Manager third;
+    third.registerDomains(&filesystem, { { "test", filesystem.path("specs") } }, &stale);
+    EXPECT_NE(nullptr, third.fileType("changed", { "test" }));
+    EXPECT_EQ(nullptr, third.fileType("sourcecode", { "test" }));
+    EXPECT_TRUE(stale.modified());
+}
@@ -0,0 +1,85 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef __plist_Arena_h
+#define __plist_Arena_h
+
+#include <plist/Base.h>
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace plist {
+
+/*
+ * Bump allocator for property list objects. While a scope for an arena is
+ * active on a thread, objects created on that thread are allocated from the
+ * arena instead of individually on the heap. Deleting an object allocated
+ * in an arena runs its destructor, but its memory is only released when the
+ * arena is destroyed, all at once. Objects created outside of any scope are
+ * allocated on the heap as usual, with nothing extra added.
+ *
+ * The arena must outlive all objects allocated in it. Parse a document into
+ * an arena when the whole document is discarded together, such as a project
+ * file that is read once and converted into other objects.
+ */
+class Arena {
+public:
+    /*
+     * Makes an arena current on this thread while in scope.
+     */
+    class Scope {
+    private:
+        Arena *_previous;
+
+    public:
+        explicit Scope(Arena *arena);
+        ~Scope();
+
+    public:
+        Scope(Scope const &) = delete;
+        Scope &operator=(Scope const &) = delete;
+    };
+
+private:
+    std::vector<std::pair<char *, size_t>> _blocks;
+    char                                  *_next;
+    size_t                                 _remaining;
+
+public:
+    Arena();
+    ~Arena();
+
+public:
+    Arena(Arena const &) = delete;
+    Arena &operator=(Arena const &) = delete;
+
+public:
+    /*
+     * Allocate memory from the arena. Allocations too large to share a block
+     * get a block of their own, still released with the arena.
+     */
+    void *allocate(size_t size);
+
+    /*
+     * If memory was allocated from this arena.
+     */
+    bool contains(void const *pointer) const;
+
+public:
+    /*
+     * The arena objects are currently allocated from on this thread, if any.
+     */
+    static Arena *Current();
+};
+
+}
+
+#endif  // !__plist_Arena_h
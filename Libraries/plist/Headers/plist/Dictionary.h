@@ -14,14 +14,57 @@
 #include <plist/Object.h>
 
 #include <algorithm>
+#include <iterator>
 #include <vector>
 #include <unordered_map>
 
 namespace plist {
 
 class Dictionary : public Object {
+public:
+    /*
+     * Iterates over keys, in insertion order.
+     */
+    class const_iterator {
+    private:
+        std::vector<std::string const *>::const_iterator _it;
+
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef std::string               value_type;
+        typedef std::ptrdiff_t            difference_type;
+        typedef std::string const        *pointer;
+        typedef std::string const        &reference;
+
+    public:
+        explicit const_iterator(std::vector<std::string const *>::const_iterator it) :
+            _it(it)
+        {
+        }
+
+    public:
+        inline reference operator*() const
+        { return **_it; }
+        inline pointer operator->() const
+        { return *_it; }
+
+        inline const_iterator &operator++()
+        { ++_it; return *this; }
+        inline const_iterator operator++(int)
+        { const_iterator result = *this; ++_it; return result; }
+
+        inline bool operator==(const_iterator const &other) const
+        { return _it == other._it; }
+        inline bool operator!=(const_iterator const &other) const
+        { return _it != other._it; }
+    };
+
 private:
-    std::vector<std::string>                                 _keys;
+    /*
+     * Keys are stored once, in the map; the order refers to the map's keys,
+     * which don't move when the map grows.
+     */
+    std::vector<std::string const *>                         _keys;
     std::unordered_map<std::string, std::unique_ptr<Object>> _map;
 
 public:
@@ -50,17 +93,17 @@ public:
 
     inline std::string const &key(size_t index) const
     {
-        return _keys[index];
+        return *_keys[index];
     }
 
     inline Object const *value(size_t index) const
     {
-        return (index < _keys.size()) ? value(_keys[index]) : nullptr;
+        return (index < _keys.size()) ? value(*_keys[index]) : nullptr;
     }
 
     inline Object *value(size_t index)
     {
-        return (index < _keys.size()) ? value(_keys[index]) : nullptr;
+        return (index < _keys.size()) ? value(*_keys[index]) : nullptr;
     }
 
     template <typename T>
@@ -110,8 +153,8 @@ public:
     inline void set(std::string const &key, std::unique_ptr<Object> obj)
     {
         remove(key);
-        _keys.push_back(key);
-        _map.insert(std::make_pair(key, std::move(obj)));
+        auto it = _map.insert(std::make_pair(key, std::move(obj))).first;
+        _keys.push_back(&it->first);
     }
 
     inline void remove(std::string const &key)
@@ -119,20 +162,20 @@ public:
         auto it = _map.find(key);
 
         if (it != _map.end()) {
+            _keys.erase(std::find(_keys.begin(), _keys.end(), &it->first));
             _map.erase(it);
-            _keys.erase(std::find(_keys.begin(), _keys.end(), key));
         }
     }
 
 public:
-    inline std::vector<std::string>::const_iterator begin() const
+    inline const_iterator begin() const
     {
-        return _keys.begin();
+        return const_iterator(_keys.begin());
     }
 
-    inline std::vector<std::string>::const_iterator end() const
+    inline const_iterator end() const
     {
-        return _keys.end();
+        return const_iterator(_keys.end());
     }
 
 public:
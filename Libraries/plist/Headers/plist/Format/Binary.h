@@ -25,6 +25,16 @@ public:
 
 public:
     static Binary Create();
+
+public:
+    using Format<Binary>::Serialize;
+
+    /*
+     * Serialize directly to a file descriptor, without building the full
+     * contents in memory. The descriptor is not closed.
+     */
+    static std::pair<bool, std::string>
+    Serialize(Object const *object, Binary const &format, int descriptor);
 };
 
 }
@@ -0,0 +1,142 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef __plist_Format_BinaryView_h
+#define __plist_Format_BinaryView_h
+
+#include <plist/Object.h>
+#include <plist/ObjectType.h>
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <ext/optional>
+#include <ext/span>
+
+namespace plist {
+namespace Format {
+
+/*
+ * Read-only view of a binary property list. Opening the view only reads
+ * the header, trailer, and offset table bounds; objects are decoded from
+ * the contents when accessed, so looking up a single key only touches the
+ * bytes along its path. The contents, usually a mapped file, must outlive
+ * the view. A view is not safe to use from multiple threads at once.
+ */
+class BinaryView {
+public:
+    /*
+     * A reference to an object in the view. Cheap to copy.
+     */
+    class Value {
+    private:
+        BinaryView const *_view;
+        uint64_t          _reference;
+
+    public:
+        Value(BinaryView const *view, uint64_t reference);
+
+    public:
+        /*
+         * The index of the object in the offset table.
+         */
+        uint64_t reference() const
+        { return _reference; }
+
+    public:
+        /*
+         * The type of the object. None if the object is corrupted.
+         */
+        ObjectType type() const;
+
+        /*
+         * The number of items in an array or dictionary.
+         */
+        ext::optional<size_t> count() const;
+
+    public:
+        /*
+         * An item in an array, or a value in a dictionary, by index.
+         */
+        ext::optional<Value> value(size_t index) const;
+
+        /*
+         * A key in a dictionary, by index.
+         */
+        ext::optional<std::string> key(size_t index) const;
+
+        /*
+         * A value in a dictionary, by key. Keys are compared in place.
+         */
+        ext::optional<Value> value(std::string const &key) const;
+
+    public:
+        /*
+         * The decoded object, owned by the view. Objects are decoded on
+         * first access, including within containers, so objects shared by
+         * multiple references decode once.
+         */
+        Object const *object() const;
+
+        /*
+         * A decoded copy of the object, owned by the caller.
+         */
+        std::unique_ptr<Object> copy() const;
+    };
+
+private:
+    ext::span<uint8_t const> _contents;
+    size_t                   _offsetIntByteSize;
+    size_t                   _objectRefByteSize;
+    uint64_t                 _objectsCount;
+    uint64_t                 _topLevelObject;
+    size_t                   _offsetTableOffset;
+
+private:
+    mutable std::unordered_map<uint64_t, std::unique_ptr<Object>> _objects;
+
+public:
+    BinaryView(
+        ext::span<uint8_t const> contents,
+        size_t offsetIntByteSize,
+        size_t objectRefByteSize,
+        uint64_t objectsCount,
+        uint64_t topLevelObject,
+        size_t offsetTableOffset);
+
+public:
+    /*
+     * The top level object.
+     */
+    Value root() const
+    { return Value(this, _topLevelObject); }
+
+private:
+    friend class Value;
+    struct Record;
+
+    ext::optional<Record> record(uint64_t reference) const;
+    ext::optional<uint64_t> itemReference(Record const &record, size_t index) const;
+    Object const *decode(uint64_t reference, size_t depth) const;
+    std::unique_ptr<Object> decodeUncached(uint64_t reference, size_t depth) const;
+
+public:
+    /*
+     * Open a view of binary property list contents. Fails if the header,
+     * trailer, or offset table is not valid.
+     */
+    static std::pair<std::unique_ptr<BinaryView>, std::string>
+    Open(ext::span<uint8_t const> contents);
+};
+
+}
+}
+
+#endif  // !__plist_Format_BinaryView_h
@@ -12,6 +12,7 @@
 
 #include <plist/Base.h>
 
+#include <ext/span>
 #include <vector>
 
 namespace plist {
@@ -32,11 +33,24 @@ private:
 
 public:
     static Encoding
-    Detect(std::vector<uint8_t> const &contents);
+    Detect(ext::span<uint8_t const> contents);
+    static Encoding
+    Detect(std::vector<uint8_t> const &contents)
+    { return Detect(ext::span<uint8_t const>(contents)); }
 
 public:
     static std::vector<uint8_t>
-    Convert(std::vector<uint8_t> const &contents, Encoding from, Encoding to);
+    Convert(ext::span<uint8_t const> contents, Encoding from, Encoding to);
+    static std::vector<uint8_t>
+    Convert(std::vector<uint8_t> const &contents, Encoding from, Encoding to)
+    { return Convert(ext::span<uint8_t const>(contents), from, to); }
+
+    /*
+     * Convert to UTF-8. Contents already in UTF-8 are returned in place,
+     * otherwise the converted contents are kept in storage.
+     */
+    static ext::span<uint8_t const>
+    ConvertUTF8(ext::span<uint8_t const> contents, Encoding from, std::vector<uint8_t> *storage);
 
 public:
     static std::vector<uint8_t>
@@ -13,6 +13,7 @@
 #include <plist/Base.h>
 #include <plist/Object.h>
 
+#include <ext/span>
 #include <vector>
 
 namespace plist {
@@ -26,14 +27,17 @@ protected:
 
 public:
     static std::unique_ptr<T>
-    Identify(std::vector<uint8_t> const &contents);
+    Identify(ext::span<uint8_t const> contents);
+    static std::unique_ptr<T>
+    Identify(std::vector<uint8_t> const &contents)
+    { return Identify(ext::span<uint8_t const>(contents)); }
 
 public:
     static std::pair<std::unique_ptr<Object>, std::string>
-    Deserialize(std::vector<uint8_t> const &contents, T const &format);
+    Deserialize(ext::span<uint8_t const> contents, T const &format);
 
     static std::pair<std::unique_ptr<Object>, std::string>
-    Deserialize(std::vector<uint8_t> const &contents)
+    Deserialize(ext::span<uint8_t const> contents)
     {
         std::unique_ptr<T> format = Identify(contents);
         if (format == nullptr) {
@@ -43,6 +47,14 @@ public:
         return Deserialize(contents, *format);
     }
 
+    static std::pair<std::unique_ptr<Object>, std::string>
+    Deserialize(std::vector<uint8_t> const &contents, T const &format)
+    { return Deserialize(ext::span<uint8_t const>(contents), format); }
+
+    static std::pair<std::unique_ptr<Object>, std::string>
+    Deserialize(std::vector<uint8_t> const &contents)
+    { return Deserialize(ext::span<uint8_t const>(contents)); }
+
 public:
     static std::pair<std::unique_ptr<std::vector<uint8_t>>, std::string>
     Serialize(Object const *object, T const &format);
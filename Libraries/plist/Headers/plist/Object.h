@@ -19,15 +19,24 @@
 namespace plist {
 
 class Object {
+private:
+    bool _arena;
+
 protected:
-    Object()
-    {
-    }
+    Object();
+    Object(Object const &object);
+    Object &operator=(Object const &object);
 
 public:
-    virtual ~Object()
-    {
-    }
+    virtual ~Object();
+
+public:
+    /*
+     * Objects are allocated from the current arena, if there is one. Only
+     * objects allocated outside of an arena are released when deleted.
+     */
+    static void *operator new(size_t size);
+    static void operator delete(void *pointer);
 
 public:
     virtual ObjectType type() const = 0;
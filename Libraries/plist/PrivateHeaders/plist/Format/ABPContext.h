@@ -25,12 +25,14 @@ protected:
 
 protected:
     off_t                       _offset;
-    std::vector<uint8_t> const *_contents;
 
 protected:
-    ABPContext(std::vector<uint8_t> const *contents);
+    ABPContext();
     ~ABPContext();
 
+protected:
+    virtual size_t contentsSize() const = 0;
+
 protected:
     off_t seek(off_t offset, int whence);
     off_t tell();
@@ -13,17 +13,19 @@
 #include <plist/Format/ABPContext.h>
 #include <plist/Objects.h>
 
+#include <ext/span>
 #include <string>
 #include <unordered_set>
 
 class ABPReader : public ABPContext {
 public:
+    ext::span<uint8_t const>              _contents;
     plist::Object                       **_objects;
     std::unordered_set<plist::Object *>   _seen;
     std::string                           _error;
 
 public:
-    ABPReader(std::vector<uint8_t> const *contents);
+    ABPReader(ext::span<uint8_t const> contents);
     ~ABPReader();
 
 public:
@@ -33,6 +35,9 @@ public:
     plist::Object *readTopLevelObject();
     plist::Object *readObject(uint64_t reference);
 
+protected:
+    virtual size_t contentsSize() const;
+
 public:
     std::string const &error() const
     { return _error; }
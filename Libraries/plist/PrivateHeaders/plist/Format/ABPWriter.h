@@ -14,6 +14,7 @@
 #include <plist/Format/ABPRecordType.h>
 #include <plist/Objects.h>
 
+#include <string>
 #include <vector>
 #include <unordered_map>
 #include <unordered_set>
@@ -24,13 +25,25 @@ private:
     std::unordered_map<plist::Object const *, plist::Object const *> _mappings;
     std::unordered_set<plist::Object const *>                        _written;
     std::unordered_map<plist::Dictionary const *, std::unordered_map<int, plist::String *>> _keyStrings;
+    std::unordered_map<std::string, plist::Object const *>           _interned;
 
 public:
     std::vector<uint8_t>                                            *_mutableContents;
 
+private:
+    int                                                              _descriptor;
+    std::vector<uint8_t>                                             _buffer;
+    size_t                                                           _flushed;
+
 public:
     ABPWriter(std::vector<uint8_t> *contents);
 
+    /*
+     * Stream the output to a file descriptor as it is written, rather than
+     * building it in memory. Only appending is supported.
+     */
+    ABPWriter(int descriptor);
+
 public:
     bool open();
     bool finalize();
@@ -41,7 +54,11 @@ public:
 public:
     int write(void const *data, size_t length);
 
+protected:
+    virtual size_t contentsSize() const;
+
 private:
+    bool flush();
     bool writeByte(uint8_t byte);
     bool writeWord0(size_t nbytes, uint64_t value, bool swap);
     bool writeWord(size_t nbytes, uint64_t value);
@@ -82,6 +99,7 @@ private:
     bool writePreflightDictionary(plist::Dictionary const *dict);
 
 private:
+    plist::Object const *internObject(plist::Object const *object);
     bool processObject(plist::Object const **object, uint32_t *refno, bool userProcess);
 };
 
@@ -12,6 +12,7 @@
 
 #include <plist/Base.h>
 
+#include <ext/span>
 #include <vector>
 #include <string>
 #include <unordered_map>
@@ -54,7 +55,7 @@ public:
     { return _column; }
 
 protected:
-    bool parse(std::vector<uint8_t> const &contents);
+    bool parse(ext::span<uint8_t const> contents);
 
 protected:
     virtual void onBeginParse();
@@ -26,7 +26,7 @@ public:
     SimpleXMLParser();
 
 public:
-    Dictionary *parse(std::vector<uint8_t> const &contents);
+    Dictionary *parse(ext::span<uint8_t const> contents);
 
 private:
     virtual void onBeginParse();
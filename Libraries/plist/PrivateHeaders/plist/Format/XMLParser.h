@@ -41,7 +41,7 @@ public:
     XMLParser();
 
 public:
-    Object *parse(std::vector<uint8_t> const &contents);
+    Object *parse(ext::span<uint8_t const> contents);
 
 private:
     virtual void onBeginParse();
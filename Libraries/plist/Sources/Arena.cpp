@@ -0,0 +1,104 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <plist/Arena.h>
+
+#include <cstdlib>
+
+using plist::Arena;
+
+static size_t const BlockSize = 256 * 1024;
+
+/*
+ * Larger allocations get their own block, to avoid wasting most of a block.
+ */
+static size_t const MaximumAllocation = 4 * 1024;
+
+static size_t const Alignment = 16;
+
+static thread_local Arena *CurrentArena = nullptr;
+
+Arena::Scope::
+Scope(Arena *arena) :
+    _previous(CurrentArena)
+{
+    CurrentArena = arena;
+}
+
+Arena::Scope::
+~Scope()
+{
+    CurrentArena = _previous;
+}
+
+Arena::
+Arena() :
+    _next     (nullptr),
+    _remaining(0)
+{
+}
+
+Arena::
+~Arena()
+{
+    for (std::pair<char *, size_t> const &block : _blocks) {
+        free(block.first);
+    }
+}
+
+void *Arena::
+allocate(size_t size)
+{
+    size = (size + Alignment - 1) & ~(Alignment - 1);
+
+    if (size > MaximumAllocation) {
+        char *block = static_cast<char *>(malloc(size));
+        if (block == nullptr) {
+            abort();
+        }
+
+        _blocks.push_back({ block, size });
+        return block;
+    }
+
+    if (size > _remaining) {
+        char *block = static_cast<char *>(malloc(BlockSize));
+        if (block == nullptr) {
+            abort();
+        }
+
+        _blocks.push_back({ block, BlockSize });
+        _next = block;
+        _remaining = BlockSize;
+    }
+
+    void *result = _next;
+    _next += size;
+    _remaining -= size;
+    return result;
+}
+
+bool Arena::
+contains(void const *pointer) const
+{
+    char const *memory = static_cast<char const *>(pointer);
+    for (std::pair<char *, size_t> const &block : _blocks) {
+        if (memory >= block.first && memory < block.first + block.second) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+Arena *Arena::
+Current()
+{
+    return CurrentArena;
+}
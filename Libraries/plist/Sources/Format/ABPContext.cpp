@@ -12,11 +12,10 @@
 #include <cstring>
 
 ABPContext::
-ABPContext(std::vector<uint8_t> const *contents) :
+ABPContext() :
     _flags   (0),
     _offsets (nullptr),
-    _offset  (0),
-    _contents(contents)
+    _offset  (0)
 {
 }
 
@@ -39,7 +38,7 @@ seek(off_t offset, int whence)
             this->_offset += offset;
             break;
         case SEEK_END:
-            this->_offset = this->_contents->size() + offset;
+            this->_offset = this->contentsSize() + offset;
         default:
             break;
     }
@@ -51,8 +50,8 @@ seek(off_t offset, int whence)
     }
 
     /* Error if past the end. */
-    if (this->_offset > static_cast<off_t>(this->_contents->size())) {
-        this->_offset = static_cast<off_t>(this->_contents->size());
+    if (this->_offset > static_cast<off_t>(this->contentsSize())) {
+        this->_offset = static_cast<off_t>(this->contentsSize());
         return -1;
     }
 
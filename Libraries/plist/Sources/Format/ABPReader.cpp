@@ -400,8 +400,9 @@ _readObject()
 }
 
 ABPReader::
-ABPReader(std::vector<uint8_t> const *contents) :
-    ABPContext(contents),
+ABPReader(ext::span<uint8_t const> contents) :
+    ABPContext(),
+    _contents(contents),
     _objects (nullptr)
 {
 }
@@ -419,6 +420,12 @@ ABPReader::
     }
 }
 
+size_t ABPReader::
+contentsSize() const
+{
+    return this->_contents.size();
+}
+
 bool ABPReader::
 open()
 {
@@ -499,13 +506,13 @@ int ABPReader::
 read(void *data, size_t length)
 {
     /* Adjust size for remaining contents. */
-    size_t remaining = this->_contents->size() - this->_offset;
+    size_t remaining = this->_contents.size() - this->_offset;
     if (remaining < length) {
         length = remaining;
     }
 
     /* Copy into read buffer. */
-    ::memcpy(data, this->_contents->data() + this->_offset, length);
+    ::memcpy(data, this->_contents.data() + this->_offset, length);
 
     this->_offset += length;
     return length;
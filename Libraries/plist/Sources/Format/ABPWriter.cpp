@@ -12,6 +12,13 @@
 #include <plist/Objects.h>
 
 #include <cassert>
+#include <cerrno>
+
+#if _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
 
 using plist::Format::Encoding;
 using plist::Format::Encodings;
@@ -28,6 +35,11 @@ using plist::UID;
 using plist::Array;
 using plist::Dictionary;
 
+/*
+ * Streamed output is written to the descriptor in chunks of this size.
+ */
+static size_t const StreamBufferSize = 64 * 1024;
+
 enum {
     kABPWriteObjectTopLevel  = (1 << 0), /* Object is top level. */
     kABPWriteObjectReference = (1 << 1), /* Write only the reference, even if not written yet. */
@@ -364,6 +376,41 @@ writePreflightDictionary(Dictionary const *dict)
     return true;
 }
 
+/*
+ * Find an equal scalar object that was already seen, so each distinct value
+ * is written only once, as CoreFoundation does. Containers are not shared.
+ */
+Object const *ABPWriter::
+internObject(Object const *object)
+{
+    std::string key = std::string(1, static_cast<char>(object->type()));
+
+    if (auto integer = plist::CastTo<Integer>(object)) {
+        int64_t value = integer->value();
+        key.append(reinterpret_cast<char const *>(&value), sizeof(value));
+    } else if (auto real = plist::CastTo<Real>(object)) {
+        double value = real->value();
+        key.append(reinterpret_cast<char const *>(&value), sizeof(value));
+    } else if (auto string = plist::CastTo<String>(object)) {
+        key.append(string->value());
+    } else if (auto data = plist::CastTo<Data>(object)) {
+        key.append(reinterpret_cast<char const *>(data->value().data()), data->value().size());
+    } else if (auto date = plist::CastTo<Date>(object)) {
+        uint64_t value = date->unixTimeValue();
+        key.append(reinterpret_cast<char const *>(&value), sizeof(value));
+    } else if (auto uid = plist::CastTo<UID>(object)) {
+        uint32_t value = uid->value();
+        key.append(reinterpret_cast<char const *>(&value), sizeof(value));
+    } else if (auto boolean = plist::CastTo<Boolean>(object)) {
+        key.push_back(boolean->value() ? 1 : 0);
+    } else if (plist::CastTo<Null>(object) == nullptr) {
+        return object;
+    }
+
+    auto result = this->_interned.insert({ key, object });
+    return result.first->second;
+}
+
 /*
  * Process an object, calls the user callback in order to
  * return a suitable object for the encoding; the object
@@ -388,6 +435,9 @@ processObject(Object const **object, uint32_t *refno, bool userProcess)
 
         /* Process the object for mapping. */
         if (userProcess) {
+            /* Share equal scalar values. */
+            newObject = this->internObject(origObject);
+
             ObjectType type = newObject->type();
             /*
              * Cache mapping, but do so only if newObject is different
@@ -549,11 +599,32 @@ writeObject(Object const *object, uint32_t flags)
 
 ABPWriter::
 ABPWriter(std::vector<uint8_t> *contents) :
-    ABPContext      (contents),
-    _mutableContents(contents)
+    ABPContext      (),
+    _mutableContents(contents),
+    _descriptor     (-1),
+    _flushed        (0)
+{
+}
+
+ABPWriter::
+ABPWriter(int descriptor) :
+    ABPContext      (),
+    _mutableContents(nullptr),
+    _descriptor     (descriptor),
+    _flushed        (0)
 {
 }
 
+size_t ABPWriter::
+contentsSize() const
+{
+    if (this->_mutableContents == nullptr) {
+        return this->_flushed + this->_buffer.size();
+    }
+
+    return this->_mutableContents->size();
+}
+
 bool ABPWriter::
 open()
 {
@@ -595,6 +666,9 @@ finalize()
     if (!this->writeTrailer(false))
         return false;
 
+    if (!this->flush())
+        return false;
+
     this->_flags |= kABPContextFlushed;
     return true;
 }
@@ -665,9 +739,50 @@ writeTopLevelObject(Object const *object)
     return success;
 }
 
+bool ABPWriter::
+flush()
+{
+    if (this->_mutableContents != nullptr)
+        return true;
+
+    size_t written = 0;
+    while (written < this->_buffer.size()) {
+#if _WIN32
+        int result = ::_write(this->_descriptor, this->_buffer.data() + written, static_cast<unsigned int>(this->_buffer.size() - written));
+#else
+        ssize_t result = ::write(this->_descriptor, this->_buffer.data() + written, this->_buffer.size() - written);
+        if (result < 0 && errno == EINTR)
+            continue;
+#endif
+        if (result <= 0)
+            return false;
+
+        written += static_cast<size_t>(result);
+    }
+
+    this->_flushed += this->_buffer.size();
+    this->_buffer.clear();
+    return true;
+}
+
 int ABPWriter::
 write(void const *data, size_t length)
 {
+    if (this->_mutableContents == nullptr) {
+        /* Streamed output can only be appended to. */
+        if (static_cast<size_t>(this->_offset) != this->contentsSize())
+            return -1;
+
+        uint8_t const *bytes = static_cast<uint8_t const *>(data);
+        this->_buffer.insert(this->_buffer.end(), bytes, bytes + length);
+        this->_offset += length;
+
+        if (this->_buffer.size() >= StreamBufferSize && !this->flush())
+            return -1;
+
+        return length;
+    }
+
     int needed = (this->_mutableContents->size() - this->_offset + length);
     if (needed > 0) {
         this->_mutableContents->resize(this->_mutableContents->size() + needed);
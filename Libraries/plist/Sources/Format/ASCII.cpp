@@ -35,7 +35,7 @@ namespace plist { namespace Format {
 
 template<>
 std::unique_ptr<ASCII> Format<ASCII>::
-Identify(std::vector<uint8_t> const &contents)
+Identify(ext::span<uint8_t const> contents)
 {
     Encoding encoding = Encodings::Detect(contents);
 
@@ -220,12 +220,13 @@ Identify(std::vector<uint8_t> const &contents)
 
 template<>
 std::pair<std::unique_ptr<Object>, std::string> Format<ASCII>::
-Deserialize(std::vector<uint8_t> const &contents, ASCII const &format)
+Deserialize(ext::span<uint8_t const> contents, ASCII const &format)
 {
     std::unique_ptr<Object> root = nullptr;
     std::string             error;
 
-    std::vector<uint8_t> const data = Encodings::Convert(contents, format.encoding(), Encoding::UTF8);
+    std::vector<uint8_t> converted;
+    ext::span<uint8_t const> data = Encodings::ConvertUTF8(contents, format.encoding(), &converted);
 
     /* Create lexer. */
     ASCIIPListLexer lexer;
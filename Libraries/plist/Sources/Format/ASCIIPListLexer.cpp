@@ -14,6 +14,20 @@
 #include <string.h>
 #include <stdlib.h>
 
+#if defined(__AVX2__)
+#define ASCIIPLIST_LEXER_AVX2 1
+#include <immintrin.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ASCIIPLIST_LEXER_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 /*
  * Syntax:
  *
@@ -68,6 +82,14 @@
 
 /** Helpers **/
 
+/*
+ * The character at p, or '\0' at the end of the buffer. The buffer does not
+ * need to be terminated, so reads past the current token must go through here.
+ */
+static inline char
+peekchar(ASCIIPListLexer const *lexer, char const *p)
+{ return (p < lexer->endBuffer ? *p : '\0'); }
+
 static inline bool
 istokenseparator(char ch, ASCIIPListLexer *lexer)
 {
@@ -82,6 +104,17 @@ istokenseparator(char ch, ASCIIPListLexer *lexer)
              (ch == ',' || ch == ';' || ch == ')' || ch == '=')));
 }
 
+/*
+ * Whether p starts with a keyword followed by a token separator.
+ */
+static inline bool
+iskeyword(ASCIIPListLexer *lexer, char const *p, char const *keyword, size_t length)
+{
+    return (static_cast<size_t>(lexer->endBuffer - p) >= length &&
+            memcmp(p, keyword, length) == 0 &&
+            istokenseparator(peekchar(lexer, p + length), lexer));
+}
+
 static inline bool
 isodigit(char ch)
 { return (ch >= '0' && ch <= '7'); }
@@ -101,14 +134,152 @@ hex2bin(char ch)
         return (ch - '0');
 }
 
+/** Scanning **/
+
+/*
+ * The scanners below find the end of strings, comments and unquoted tokens
+ * 32 or 16 bytes at a time where vector instructions are available, then
+ * finish the remainder of the buffer one byte at a time. Scanning always
+ * stops at the end of the buffer, which does not need to be terminated.
+ */
+
+static inline unsigned
+counttrailingzeros(uint32_t mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return index;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+static inline bool
+isunquotedchar(char ch)
+{
+    /* '$' is encountered in pbxproj files. */
+    char lower = (ch | 0x20);
+    return ((lower >= 'a' && lower <= 'z') || (ch >= '-' && ch <= ':') || ch == '_' || ch == '$');
+}
+
+/*
+ * Find the first of four characters, or the end of the buffer.
+ */
+static char const *
+ASCIIPListLexerScan(ASCIIPListLexer const *lexer, char const *p, char c0, char c1, char c2, char c3)
+{
+    char const *end = lexer->endBuffer;
+
+    if (!lexer->scalar) {
+#if ASCIIPLIST_LEXER_AVX2
+        __m256i const v0 = _mm256_set1_epi8(c0), v1 = _mm256_set1_epi8(c1);
+        __m256i const v2 = _mm256_set1_epi8(c2), v3 = _mm256_set1_epi8(c3);
+        for (; end - p >= 32; p += 32) {
+            __m256i const chunk = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(p));
+            __m256i const match = _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpeq_epi8(chunk, v0), _mm256_cmpeq_epi8(chunk, v1)),
+                _mm256_or_si256(_mm256_cmpeq_epi8(chunk, v2), _mm256_cmpeq_epi8(chunk, v3)));
+            uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(match));
+            if (mask != 0) {
+                return p + counttrailingzeros(mask);
+            }
+        }
+#endif
+#if ASCIIPLIST_LEXER_SSE2
+        __m128i const w0 = _mm_set1_epi8(c0), w1 = _mm_set1_epi8(c1);
+        __m128i const w2 = _mm_set1_epi8(c2), w3 = _mm_set1_epi8(c3);
+        for (; end - p >= 16; p += 16) {
+            __m128i const chunk = _mm_loadu_si128(reinterpret_cast<__m128i const *>(p));
+            __m128i const match = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(chunk, w0), _mm_cmpeq_epi8(chunk, w1)),
+                _mm_or_si128(_mm_cmpeq_epi8(chunk, w2), _mm_cmpeq_epi8(chunk, w3)));
+            uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(match));
+            if (mask != 0) {
+                return p + counttrailingzeros(mask);
+            }
+        }
+#endif
+    }
+
+    for (; p < end; p++) {
+        if (*p == c0 || *p == c1 || *p == c2 || *p == c3) {
+            return p;
+        }
+    }
+
+    return end;
+}
+
+/*
+ * Find the first character that can't be part of an unquoted string.
+ */
+static char const *
+ASCIIPListLexerScanUnquoted(ASCIIPListLexer const *lexer, char const *p)
+{
+    char const *end = lexer->endBuffer;
+
+    if (!lexer->scalar) {
+        /*
+         * Letters, a range covering '-' '.' '/', digits and ':', and two
+         * other characters. Bytes above 0x7f are negative, so are outside
+         * of all ranges when compared as signed.
+         */
+#if ASCIIPLIST_LEXER_AVX2
+        __m256i const lowerA = _mm256_set1_epi8('a' - 1), lowerZ = _mm256_set1_epi8('z' + 1);
+        __m256i const rangeA = _mm256_set1_epi8('-' - 1), rangeZ = _mm256_set1_epi8(':' + 1);
+        __m256i const caseBit = _mm256_set1_epi8(0x20);
+        __m256i const underscore = _mm256_set1_epi8('_'), dollar = _mm256_set1_epi8('$');
+        for (; end - p >= 32; p += 32) {
+            __m256i const chunk = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(p));
+            __m256i const lower = _mm256_or_si256(chunk, caseBit);
+            __m256i const letter = _mm256_and_si256(_mm256_cmpgt_epi8(lower, lowerA), _mm256_cmpgt_epi8(lowerZ, lower));
+            __m256i const range = _mm256_and_si256(_mm256_cmpgt_epi8(chunk, rangeA), _mm256_cmpgt_epi8(rangeZ, chunk));
+            __m256i const other = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, underscore), _mm256_cmpeq_epi8(chunk, dollar));
+            __m256i const token = _mm256_or_si256(_mm256_or_si256(letter, range), other);
+            uint32_t mask = ~static_cast<uint32_t>(_mm256_movemask_epi8(token));
+            if (mask != 0) {
+                return p + counttrailingzeros(mask);
+            }
+        }
+#endif
+#if ASCIIPLIST_LEXER_SSE2
+        __m128i const lowerA = _mm_set1_epi8('a' - 1), lowerZ = _mm_set1_epi8('z' + 1);
+        __m128i const rangeA = _mm_set1_epi8('-' - 1), rangeZ = _mm_set1_epi8(':' + 1);
+        __m128i const caseBit = _mm_set1_epi8(0x20);
+        __m128i const underscore = _mm_set1_epi8('_'), dollar = _mm_set1_epi8('$');
+        for (; end - p >= 16; p += 16) {
+            __m128i const chunk = _mm_loadu_si128(reinterpret_cast<__m128i const *>(p));
+            __m128i const lower = _mm_or_si128(chunk, caseBit);
+            __m128i const letter = _mm_and_si128(_mm_cmpgt_epi8(lower, lowerA), _mm_cmpgt_epi8(lowerZ, lower));
+            __m128i const range = _mm_and_si128(_mm_cmpgt_epi8(chunk, rangeA), _mm_cmpgt_epi8(rangeZ, chunk));
+            __m128i const other = _mm_or_si128(_mm_cmpeq_epi8(chunk, underscore), _mm_cmpeq_epi8(chunk, dollar));
+            __m128i const token = _mm_or_si128(_mm_or_si128(letter, range), other);
+            uint32_t mask = ~static_cast<uint32_t>(_mm_movemask_epi8(token)) & 0xffff;
+            if (mask != 0) {
+                return p + counttrailingzeros(mask);
+            }
+        }
+#endif
+    }
+
+    for (; p < end; p++) {
+        if (!isunquotedchar(*p)) {
+            return p;
+        }
+    }
+
+    return end;
+}
+
 static int
 ASCIIPListLexerReadInlineComment(ASCIIPListLexer *lexer)
 {
     char const *b, *p = lexer->pointer + 2;
 
     lexer->tokenBegin = (p - lexer->inputBuffer);
-    for (b = p; *p != '\0' && *p != '\n' && *p != '\r'; p++)
-        ;
+    b = p;
+    p = ASCIIPListLexerScan(lexer, p, '\0', '\n', '\r', '\r');
     lexer->tokenLength = p - b;
     lexer->pointer = p;
 
@@ -121,11 +292,11 @@ ASCIIPListLexerReadLongComment(ASCIIPListLexer *lexer)
     char const *b, *p = lexer->pointer + 2;
 
     lexer->tokenBegin = (p - lexer->inputBuffer);
-    for (b = p; *p != '\0'; p++) {
+    for (b = p; (p = ASCIIPListLexerScan(lexer, p, '\0', '\n', '*', '*')) < lexer->endBuffer && *p != '\0'; p++) {
         if (p[0] == '\n') {
             lexer->line++;
             lexer->lineStart = p + 1;
-        } else if (p[0] == '*' && p[1] == '/') {
+        } else if (p + 1 < lexer->endBuffer && p[1] == '/') {
             lexer->tokenLength = p - b;
             lexer->pointer = p + 2;
             return kASCIIPListLexerTokenLongComment;
@@ -141,14 +312,12 @@ ASCIIPListLexerReadSingleQuotedString(ASCIIPListLexer *lexer)
     char const *b, *p = lexer->pointer + 1;
 
     lexer->tokenBegin = (p - lexer->inputBuffer);
-    for (b = p; *p != '\'' && *p != '\0'; p++) {
-        if (*p == '\n') {
-            lexer->line++;
-            lexer->lineStart = p + 1;
-        }
+    for (b = p; (p = ASCIIPListLexerScan(lexer, p, '\'', '\0', '\n', '\n')) < lexer->endBuffer && *p == '\n'; p++) {
+        lexer->line++;
+        lexer->lineStart = p + 1;
     }
 
-    if (*p != '\'') {
+    if (p == lexer->endBuffer || *p != '\'') {
         return kASCIIPListLexerUnterminatedQuotedString;
     }
 
@@ -164,16 +333,17 @@ ASCIIPListLexerReadDoubleQuotedString(ASCIIPListLexer *lexer)
     char const *b, *p = lexer->pointer + 1;
 
     lexer->tokenBegin = (p - lexer->inputBuffer);
-    for (b = p; *p != '\"' && *p != '\0'; p++) {
+    for (b = p; (p = ASCIIPListLexerScan(lexer, p, '\"', '\0', '\n', '\\')) < lexer->endBuffer && *p != '\"' && *p != '\0'; p++) {
         if (*p == '\n') {
             lexer->line++;
             lexer->lineStart = p + 1;
-        } else if (*p == '\\') {
+        } else if (p + 1 < lexer->endBuffer) {
+            /* Skip the escaped character. */
             p++;
         }
     }
 
-    if (*p != '\"') {
+    if (p == lexer->endBuffer || *p != '\"') {
         return kASCIIPListLexerUnterminatedQuotedString;
     }
 
@@ -189,7 +359,7 @@ ASCIIPListLexerReadData(ASCIIPListLexer *lexer)
     char const *b, *p = lexer->pointer + 1;
 
     lexer->tokenBegin = (p - lexer->inputBuffer);
-    for (b = p; *p != '>' && *p != '\0'; p++) {
+    for (b = p; p < lexer->endBuffer && *p != '>' && *p != '\0'; p++) {
         if (*p == '\n') {
             lexer->line++;
             lexer->lineStart = p + 1;
@@ -203,7 +373,7 @@ ASCIIPListLexerReadData(ASCIIPListLexer *lexer)
         }
     }
 
-    if (*p != '>')
+    if (p == lexer->endBuffer || *p != '>')
         return kASCIIPListLexerUnterminatedData;
 
     lexer->tokenLength = p - b;
@@ -233,15 +403,15 @@ ASCIIPListLexerReadJSONNumber(ASCIIPListLexer *lexer)
 
     lexer->tokenBegin = (p - lexer->inputBuffer);
 
-    if (*p == '-') {
+    if (peekchar(lexer, p) == '-') {
         p++;
     }
 
-    if (!isdigit(*p)) {
+    if (!isdigit(peekchar(lexer, p))) {
         return kASCIIPListLexerInvalidToken;
     }
     bool zero = (*p == '0');
-    while (isdigit(*p)) {
+    while (isdigit(peekchar(lexer, p))) {
         /* Numbers cannot start with zero. */
         if (zero && *p != '0') {
             return kASCIIPListLexerInvalidToken;
@@ -250,36 +420,36 @@ ASCIIPListLexerReadJSONNumber(ASCIIPListLexer *lexer)
         p++;
     }
 
-    if (*p == '.') {
+    if (peekchar(lexer, p) == '.') {
         integer = false;
 
         p++;
 
-        if (!isdigit(*p)) {
+        if (!isdigit(peekchar(lexer, p))) {
             return kASCIIPListLexerInvalidToken;
         }
-        while (isdigit(*p)) {
+        while (isdigit(peekchar(lexer, p))) {
             p++;
         }
     }
 
-    if (*p == 'e' || *p == 'E') {
+    if (peekchar(lexer, p) == 'e' || peekchar(lexer, p) == 'E') {
         integer = false;
 
         p++;
-        if (*p == '+' || *p == '-') {
+        if (peekchar(lexer, p) == '+' || peekchar(lexer, p) == '-') {
             p++;
         }
 
-        if (!isdigit(*p)) {
+        if (!isdigit(peekchar(lexer, p))) {
             return kASCIIPListLexerInvalidToken;
         }
-        while (isdigit(*p)) {
+        while (isdigit(peekchar(lexer, p))) {
             p++;
         }
     }
 
-    if (istokenseparator(*p, lexer)) {
+    if (istokenseparator(peekchar(lexer, p), lexer)) {
         lexer->tokenLength = p - b;
         lexer->pointer = p;
         return (integer ? kASCIIPListLexerTokenNumberInteger : kASCIIPListLexerTokenNumberReal);
@@ -298,32 +468,19 @@ ASCIIPListLexerReadKeyword(ASCIIPListLexer *lexer)
     lexer->tokenBegin = p - lexer->inputBuffer;
 
     if (lexer->style == kASCIIPListLexerStyleJSON) {
-        if (*p == 't' && strncmp(p, "true", 4) == 0 &&
-            istokenseparator(*(p + 4), lexer)) {
+        if (iskeyword(lexer, p, "true", 4)) {
             p += 4;
             rc = kASCIIPListLexerTokenBoolTrue;
-        } else if (*p == 'f' && strncmp(p, "false", 5) == 0 &&
-                   istokenseparator(*(p + 5), lexer)) {
+        } else if (iskeyword(lexer, p, "false", 5)) {
             p += 5;
             rc = kASCIIPListLexerTokenBoolFalse;
-        } else if (*p == 'n' && strncmp(p, "null", 4) == 0 &&
-                   istokenseparator(*(p + 4), lexer)) {
+        } else if (iskeyword(lexer, p, "null", 4)) {
             p += 4;
             rc = kASCIIPListLexerTokenNull;
         }
     } else if (lexer->style == kASCIIPListLexerStyleASCII) {
         rc = kASCIIPListLexerTokenUnquotedString;
-        /*
-            * '$' is encountered in pbxproj files.
-            */
-        while (isalnum(*p) || *p == '_' || *p == '.' || *p == '$' ||
-                              *p == '-' || *p == ':' || *p == '/') {
-            if (*p & 0x80) {
-                rc = kASCIIPListLexerInvalidToken;
-                break;
-            }
-            p++;
-        }
+        p = ASCIIPListLexerScanUnquoted(lexer, p);
     } else {
         rc = kASCIIPListLexerInvalidToken;
     }
@@ -341,10 +498,10 @@ ASCIIPListLexerReadToken(ASCIIPListLexer *lexer)
     while (p < lexer->endBuffer) {
         switch (*p) {
             case '/': /* Comments */
-                if (p[1] == '/') {
+                if (peekchar(lexer, p + 1) == '/') {
                     lexer->pointer = p;
                     return ASCIIPListLexerReadInlineComment(lexer);
-                } else if (p[1] == '*') {
+                } else if (peekchar(lexer, p + 1) == '*') {
                     lexer->pointer = p;
                     return ASCIIPListLexerReadLongComment(lexer);
                 } else {
@@ -485,9 +642,10 @@ ASCIIPListLexerInit(ASCIIPListLexer *lexer, char const *buffer, int length,
 
 /* Convert sequence \xXX */
 static inline bool
-dehexify(char *p, int avail, int *eat)
+dehexify(char **pp, int avail, int *eat)
 {
     uint8_t  byte = 0;
+    char    *p = *pp;
     char    *rep  = p;
 
     p += 2, (*eat)++, avail -= 2; /* Remove '\x' */
@@ -502,15 +660,19 @@ dehexify(char *p, int avail, int *eat)
         byte |= hex2bin(*p++);
         (*eat)++, avail--;
     }
-    *rep = byte;
+    *rep++ = byte;
+    (*eat)--;
+
+    *pp = rep;
     return true;
 }
 
 /* Convert sequence \0XXXX */
 static inline bool
-deoctify(char *p, int avail, int *eat)
+deoctify(char **pp, int avail, int *eat)
 {
     uint8_t  byte;
+    char    *p = *pp;
     char    *rep = p;
 
     p += 2, (*eat)++, avail -= 2; /* Remove '\0' */
@@ -538,7 +700,10 @@ deoctify(char *p, int avail, int *eat)
         byte |= dec2bin(*p++);
         (*eat)++, avail--;
     }
-    *rep = byte;
+    *rep++ = byte;
+    (*eat)--;
+
+    *pp = rep;
     return true;
 }
 
@@ -551,7 +716,7 @@ deunicodify(char **pp, int avail, int *eat)
     char    *p = *pp;
     char    *rep = p;
 
-    p++; /* Remove '\' */
+    p++, avail--; /* Remove '\' */
     utf32 = (*p == 'U');
     p++, (*eat)++, avail--; /* Remove 'u' */
     if (avail >= 1) {
@@ -603,9 +768,10 @@ deunicodify(char **pp, int avail, int *eat)
     if (codepoint >= 0x110000)
         codepoint = 0xfffe;
 
-    if (codepoint <= 0x7f)
-        *rep = codepoint;
-    else if (codepoint <= 0x7ff) {
+    if (codepoint <= 0x7f) {
+        *rep++ = codepoint;
+        (*eat) -= 1;
+    } else if (codepoint <= 0x7ff) {
         *rep++ = 0xc0 | (codepoint >> 6);
         *rep++ = 0x80 | (codepoint & 0x3f);
         (*eat) -= 2;
@@ -647,7 +813,7 @@ ASCIIPListCopyUnquotedString(ASCIIPListLexer const *lexer, int lossByte)
         int eat = 1;
 
         /* Keep quoting char if it's at the end of the string. */
-        if ((p - end) == 0)
+        if ((end - p) == 1)
             break;
 
         switch (p[1]) {
@@ -659,7 +825,7 @@ ASCIIPListCopyUnquotedString(ASCIIPListLexer const *lexer, int lossByte)
             case 't':  *p++ = '\t'; break;
             case '\\': ++p; break;
             case 'x':
-                if (!dehexify(p, p - end, &eat)) {
+                if (!dehexify(&p, end - p, &eat)) {
                     if (lossByte <= 0)
                         goto fail;
                     else
@@ -667,8 +833,8 @@ ASCIIPListCopyUnquotedString(ASCIIPListLexer const *lexer, int lossByte)
                 }
                 break;
             case '0':
-                if ((p - end) >= 2 && isdigit(p[2])) {
-                    if (!deoctify(p, p - end, &eat)) {
+                if ((end - p) > 2 && isdigit(p[2])) {
+                    if (!deoctify(&p, end - p, &eat)) {
                         if (lossByte <= 0)
                             goto fail;
                         else
@@ -681,7 +847,7 @@ ASCIIPListCopyUnquotedString(ASCIIPListLexer const *lexer, int lossByte)
 
             case 'u':
             case 'U':
-                if ((end - p) >= 2 && isxdigit(p[2])) {
+                if ((end - p) > 2 && isxdigit(p[2])) {
                     if (!deunicodify(&p, end - p, &eat)) {
                         if (lossByte <= 0)
                             goto fail;
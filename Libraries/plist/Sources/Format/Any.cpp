@@ -57,7 +57,7 @@ namespace plist { namespace Format {
 
 template<typename T>
 static std::unique_ptr<Any>
-IdentifyImpl(std::vector<uint8_t> const &contents)
+IdentifyImpl(ext::span<uint8_t const> contents)
 {
     std::unique_ptr<T> format = T::Identify(contents);
     if (format != nullptr) {
@@ -69,7 +69,7 @@ IdentifyImpl(std::vector<uint8_t> const &contents)
 
 template<>
 std::unique_ptr<Any> Format<Any>::
-Identify(std::vector<uint8_t> const &contents)
+Identify(ext::span<uint8_t const> contents)
 {
 #define FORMAT(T) \
     { \
@@ -90,14 +90,14 @@ Identify(std::vector<uint8_t> const &contents)
 
 template<typename T>
 static std::pair<std::unique_ptr<Object>, std::string>
-DeserializeImpl(std::vector<uint8_t> const &contents, Any const &format)
+DeserializeImpl(ext::span<uint8_t const> contents, Any const &format)
 {
     return T::Deserialize(contents, *format.format<T>());
 }
 
 template<>
 std::pair<std::unique_ptr<Object>, std::string> Format<Any>::
-Deserialize(std::vector<uint8_t> const &contents, Any const &format)
+Deserialize(ext::span<uint8_t const> contents, Any const &format)
 {
     switch (format.type()) {
         case Type::Binary:
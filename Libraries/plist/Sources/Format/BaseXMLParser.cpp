@@ -83,12 +83,12 @@ CreateXmlReaderImpl(IMalloc *pMalloc)
 #endif
 
 bool BaseXMLParser::
-parse(std::vector<uint8_t> const &contents)
+parse(ext::span<uint8_t const> contents)
 {
     _errored = false;
 
 #if _WIN32
-    std::vector<uint8_t> contents_ = contents;
+    std::vector<uint8_t> contents_ = std::vector<uint8_t>(contents.begin(), contents.end());
 
     bool wine = (GetProcAddress(GetModuleHandle("ntdll.dll"), "wine_get_version") != nullptr);
     if (wine) {
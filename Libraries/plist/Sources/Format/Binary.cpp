@@ -36,7 +36,7 @@ namespace plist { namespace Format {
 
 template<>
 std::unique_ptr<Binary> Format<Binary>::
-Identify(std::vector<uint8_t> const &contents)
+Identify(ext::span<uint8_t const> contents)
 {
     size_t length = strlen(ABPLIST_MAGIC ABPLIST_VERSION);
 
@@ -53,9 +53,9 @@ Identify(std::vector<uint8_t> const &contents)
 
 template<>
 std::pair<std::unique_ptr<Object>, std::string> Format<Binary>::
-Deserialize(std::vector<uint8_t> const &contents, Binary const &format)
+Deserialize(ext::span<uint8_t const> contents, Binary const &format)
 {
-    ABPReader reader = ABPReader(&contents);
+    ABPReader reader = ABPReader(contents);
 
     std::unique_ptr<Object> object = nullptr;
     if (reader.open()) {
@@ -108,3 +108,27 @@ Create()
 {
     return Binary();
 }
+
+std::pair<bool, std::string> Binary::
+Serialize(Object const *object, Binary const &format, int descriptor)
+{
+    ABPWriter writer = ABPWriter(descriptor);
+
+    if (!writer.open()) {
+        return std::make_pair(false, "open failed");
+    }
+
+    if (!writer.writeTopLevelObject(object)) {
+        return std::make_pair(false, "write failed");
+    }
+
+    if (!writer.finalize()) {
+        return std::make_pair(false, "finalize failed");
+    }
+
+    if (!writer.close()) {
+        return std::make_pair(false, "close failed");
+    }
+
+    return std::make_pair(true, std::string());
+}
@@ -0,0 +1,501 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <plist/Format/BinaryView.h>
+#include <plist/Format/ABPRecordType.h>
+#include <plist/Format/Encoding.h>
+#include <plist/Format/abplist-format.h>
+#include <plist/Objects.h>
+
+#include <cstring>
+
+using plist::Format::BinaryView;
+using plist::Object;
+using plist::ObjectType;
+
+/*
+ * Containers nested deeper than this are treated as corrupted, since a
+ * reference cycle would otherwise never finish decoding.
+ */
+static size_t const MaximumDepth = 512;
+
+struct BinaryView::Record {
+    ABPRecordType type;
+    uint8_t       marker;
+    size_t        count;
+    size_t        offset;
+};
+
+static bool
+ReadWord(ext::span<uint8_t const> contents, size_t offset, size_t nbytes, uint64_t *result)
+{
+    if (nbytes > sizeof(uint64_t) || offset > contents.size() || contents.size() - offset < nbytes) {
+        return false;
+    }
+
+    uint64_t value = 0;
+    for (size_t n = 0; n < nbytes; n++) {
+        value = (value << 8) | contents[offset + n];
+    }
+
+    *result = value;
+    return true;
+}
+
+BinaryView::
+BinaryView(
+    ext::span<uint8_t const> contents,
+    size_t offsetIntByteSize,
+    size_t objectRefByteSize,
+    uint64_t objectsCount,
+    uint64_t topLevelObject,
+    size_t offsetTableOffset) :
+    _contents         (contents),
+    _offsetIntByteSize(offsetIntByteSize),
+    _objectRefByteSize(objectRefByteSize),
+    _objectsCount     (objectsCount),
+    _topLevelObject   (topLevelObject),
+    _offsetTableOffset(offsetTableOffset)
+{
+}
+
+ext::optional<BinaryView::Record> BinaryView::
+record(uint64_t reference) const
+{
+    if (reference >= _objectsCount) {
+        return ext::nullopt;
+    }
+
+    uint64_t offset;
+    if (!ReadWord(_contents, _offsetTableOffset + static_cast<size_t>(reference) * _offsetIntByteSize, _offsetIntByteSize, &offset)) {
+        return ext::nullopt;
+    }
+
+    /* Skip any fill bytes before the object. */
+    size_t position = static_cast<size_t>(offset);
+    while (position < _offsetTableOffset && __ABPByteToRecordType(_contents[position]) == kABPRecordTypeFill) {
+        position++;
+    }
+    if (position >= _offsetTableOffset) {
+        return ext::nullopt;
+    }
+
+    Record record;
+    record.marker = _contents[position++];
+    record.type = __ABPByteToRecordType(record.marker);
+    record.count = (record.marker & 0x0f);
+
+    /* Size of each item, for records that have a length. */
+    size_t itemSize = 0;
+    switch (record.type) {
+        case kABPRecordTypeInvalid:
+            return ext::nullopt;
+        case kABPRecordTypeData:
+        case kABPRecordTypeStringASCII:
+            itemSize = 1;
+            break;
+        case kABPRecordTypeStringUnicode:
+            itemSize = 2;
+            break;
+        case kABPRecordTypeArray:
+            itemSize = _objectRefByteSize;
+            break;
+        case kABPRecordTypeDictionary:
+            itemSize = _objectRefByteSize * 2;
+            break;
+        case kABPRecordTypeInteger:
+        case kABPRecordTypeReal:
+            record.count = (1 << record.count);
+            break;
+        case kABPRecordTypeUid:
+            record.count = record.count + 1;
+            break;
+        case kABPRecordTypeDate:
+            record.count = 8;
+            break;
+        default:
+            record.count = 0;
+            break;
+    }
+
+    if (itemSize != 0 && record.count == 0x0f) {
+        /* Longer lengths follow the marker as an integer record. */
+        if (position >= _offsetTableOffset || (_contents[position] & 0xf0) != 0x10) {
+            return ext::nullopt;
+        }
+
+        size_t nbytes = (1 << (_contents[position] & 0x0f));
+        uint64_t count;
+        if (!ReadWord(_contents, position + 1, nbytes, &count)) {
+            return ext::nullopt;
+        }
+
+        record.count = static_cast<size_t>(count);
+        position += 1 + nbytes;
+    }
+
+    /* Ensure the whole record is in bounds. */
+    size_t size = (itemSize != 0 ? itemSize : 1);
+    size_t remaining = _offsetTableOffset - position;
+    if (record.count > remaining / size) {
+        return ext::nullopt;
+    }
+
+    record.offset = position;
+    return record;
+}
+
+ext::optional<uint64_t> BinaryView::
+itemReference(Record const &record, size_t index) const
+{
+    uint64_t reference;
+    if (!ReadWord(_contents, record.offset + index * _objectRefByteSize, _objectRefByteSize, &reference)) {
+        return ext::nullopt;
+    }
+
+    return reference;
+}
+
+static ext::optional<std::string>
+DecodeString(ext::span<uint8_t const> contents, ABPRecordType type, size_t offset, size_t count)
+{
+    if (type == kABPRecordTypeStringASCII) {
+        return std::string(reinterpret_cast<char const *>(contents.data() + offset), count);
+    } else if (type == kABPRecordTypeStringUnicode) {
+        std::vector<uint8_t> buffer = std::vector<uint8_t>(contents.begin() + offset, contents.begin() + offset + count * 2);
+        buffer = plist::Format::Encodings::Convert(buffer, plist::Format::Encoding::UTF16BE, plist::Format::Encoding::UTF8);
+        return std::string(buffer.begin(), buffer.end());
+    } else {
+        return ext::nullopt;
+    }
+}
+
+Object const *BinaryView::
+decode(uint64_t reference, size_t depth) const
+{
+    /* Every decoded object is kept, so objects shared by references decode once. */
+    auto it = _objects.find(reference);
+    if (it != _objects.end()) {
+        return it->second.get();
+    }
+
+    std::unique_ptr<Object> object = this->decodeUncached(reference, depth);
+    if (object == nullptr) {
+        return nullptr;
+    }
+
+    Object const *result = object.get();
+    _objects.insert({ reference, std::move(object) });
+    return result;
+}
+
+std::unique_ptr<Object> BinaryView::
+decodeUncached(uint64_t reference, size_t depth) const
+{
+    ext::optional<Record> record = this->record(reference);
+    if (!record || depth > MaximumDepth) {
+        return nullptr;
+    }
+
+    switch (record->type) {
+        case kABPRecordTypeNull:
+            return plist::Null::New();
+        case kABPRecordTypeBoolFalse:
+            return plist::Boolean::New(false);
+        case kABPRecordTypeBoolTrue:
+            return plist::Boolean::New(true);
+        case kABPRecordTypeInteger: {
+            uint64_t value;
+            if (!ReadWord(_contents, record->offset, record->count, &value)) {
+                return nullptr;
+            }
+            return plist::Integer::New(static_cast<int64_t>(value));
+        }
+        case kABPRecordTypeReal: {
+            uint64_t value;
+            if (!ReadWord(_contents, record->offset, record->count, &value)) {
+                return nullptr;
+            }
+
+            if (record->count == sizeof(float)) {
+                uint32_t bits = static_cast<uint32_t>(value);
+                float converted;
+                memcpy(&converted, &bits, sizeof(converted));
+                return plist::Real::New(converted);
+            } else if (record->count == sizeof(double)) {
+                double converted;
+                memcpy(&converted, &value, sizeof(converted));
+                return plist::Real::New(converted);
+            } else {
+                return nullptr;
+            }
+        }
+        case kABPRecordTypeDate: {
+            uint64_t value;
+            if (!ReadWord(_contents, record->offset, record->count, &value)) {
+                return nullptr;
+            }
+
+            /* Reference time is 2001/1/1 */
+            static uint64_t const ReferenceTimestamp = 978307200;
+            double at;
+            memcpy(&at, &value, sizeof(at));
+            return plist::Date::New(static_cast<uint64_t>(static_cast<int64_t>(at) + ReferenceTimestamp));
+        }
+        case kABPRecordTypeData: {
+            auto begin = _contents.begin() + record->offset;
+            return plist::Data::New(std::vector<uint8_t>(begin, begin + record->count));
+        }
+        case kABPRecordTypeStringASCII:
+        case kABPRecordTypeStringUnicode: {
+            ext::optional<std::string> string = DecodeString(_contents, record->type, record->offset, record->count);
+            return plist::String::New(std::move(*string));
+        }
+        case kABPRecordTypeUid: {
+            uint64_t value;
+            if (record->count > sizeof(uint32_t) || !ReadWord(_contents, record->offset, record->count, &value)) {
+                return nullptr;
+            }
+            return plist::UID::New(static_cast<uint32_t>(value));
+        }
+        case kABPRecordTypeArray: {
+            auto array = plist::Array::New();
+            for (size_t n = 0; n < record->count; n++) {
+                ext::optional<uint64_t> item = this->itemReference(*record, n);
+                if (!item) {
+                    return nullptr;
+                }
+
+                Object const *object = this->decode(*item, depth + 1);
+                if (object == nullptr) {
+                    return nullptr;
+                }
+
+                array->append(object->copy());
+            }
+            return std::move(array);
+        }
+        case kABPRecordTypeDictionary: {
+            auto dict = plist::Dictionary::New();
+            for (size_t n = 0; n < record->count; n++) {
+                ext::optional<uint64_t> keyReference = this->itemReference(*record, n);
+                ext::optional<uint64_t> valueReference = this->itemReference(*record, record->count + n);
+                if (!keyReference || !valueReference) {
+                    return nullptr;
+                }
+
+                ext::optional<Record> key = this->record(*keyReference);
+                if (!key) {
+                    return nullptr;
+                }
+
+                ext::optional<std::string> string = DecodeString(_contents, key->type, key->offset, key->count);
+                if (!string) {
+                    return nullptr;
+                }
+
+                Object const *object = this->decode(*valueReference, depth + 1);
+                if (object == nullptr) {
+                    return nullptr;
+                }
+
+                dict->set(*string, object->copy());
+            }
+            return std::move(dict);
+        }
+        default:
+            return nullptr;
+    }
+}
+
+BinaryView::Value::
+Value(BinaryView const *view, uint64_t reference) :
+    _view     (view),
+    _reference(reference)
+{
+}
+
+ObjectType BinaryView::Value::
+type() const
+{
+    ext::optional<Record> record = _view->record(_reference);
+    if (!record) {
+        return ObjectType::None;
+    }
+
+    switch (record->type) {
+        case kABPRecordTypeNull:          return ObjectType::Null;
+        case kABPRecordTypeBoolTrue:      return ObjectType::Boolean;
+        case kABPRecordTypeBoolFalse:     return ObjectType::Boolean;
+        case kABPRecordTypeDate:          return ObjectType::Date;
+        case kABPRecordTypeInteger:       return ObjectType::Integer;
+        case kABPRecordTypeReal:          return ObjectType::Real;
+        case kABPRecordTypeData:          return ObjectType::Data;
+        case kABPRecordTypeStringASCII:   return ObjectType::String;
+        case kABPRecordTypeStringUnicode: return ObjectType::String;
+        case kABPRecordTypeUid:           return ObjectType::UID;
+        case kABPRecordTypeArray:         return ObjectType::Array;
+        case kABPRecordTypeDictionary:    return ObjectType::Dictionary;
+        default:                          return ObjectType::None;
+    }
+}
+
+ext::optional<size_t> BinaryView::Value::
+count() const
+{
+    ext::optional<Record> record = _view->record(_reference);
+    if (!record || (record->type != kABPRecordTypeArray && record->type != kABPRecordTypeDictionary)) {
+        return ext::nullopt;
+    }
+
+    return record->count;
+}
+
+ext::optional<BinaryView::Value> BinaryView::Value::
+value(size_t index) const
+{
+    ext::optional<Record> record = _view->record(_reference);
+    if (!record || (record->type != kABPRecordTypeArray && record->type != kABPRecordTypeDictionary) || index >= record->count) {
+        return ext::nullopt;
+    }
+
+    /* Dictionary values follow all of the keys. */
+    if (record->type == kABPRecordTypeDictionary) {
+        index += record->count;
+    }
+
+    ext::optional<uint64_t> reference = _view->itemReference(*record, index);
+    if (!reference) {
+        return ext::nullopt;
+    }
+
+    return Value(_view, *reference);
+}
+
+ext::optional<std::string> BinaryView::Value::
+key(size_t index) const
+{
+    ext::optional<Record> record = _view->record(_reference);
+    if (!record || record->type != kABPRecordTypeDictionary || index >= record->count) {
+        return ext::nullopt;
+    }
+
+    ext::optional<uint64_t> reference = _view->itemReference(*record, index);
+    if (!reference) {
+        return ext::nullopt;
+    }
+
+    ext::optional<Record> key = _view->record(*reference);
+    if (!key) {
+        return ext::nullopt;
+    }
+
+    return DecodeString(_view->_contents, key->type, key->offset, key->count);
+}
+
+ext::optional<BinaryView::Value> BinaryView::Value::
+value(std::string const &key) const
+{
+    ext::optional<Record> record = _view->record(_reference);
+    if (!record || record->type != kABPRecordTypeDictionary) {
+        return ext::nullopt;
+    }
+
+    /* Only converted if the dictionary has non-ASCII keys. */
+    ext::optional<std::vector<uint8_t>> unicode;
+
+    for (size_t n = 0; n < record->count; n++) {
+        ext::optional<uint64_t> reference = _view->itemReference(*record, n);
+        if (!reference) {
+            return ext::nullopt;
+        }
+
+        ext::optional<Record> candidate = _view->record(*reference);
+        if (!candidate) {
+            return ext::nullopt;
+        }
+
+        uint8_t const *bytes = _view->_contents.data() + candidate->offset;
+        bool matches = false;
+        if (candidate->type == kABPRecordTypeStringASCII) {
+            matches = (candidate->count == key.size() && memcmp(bytes, key.data(), key.size()) == 0);
+        } else if (candidate->type == kABPRecordTypeStringUnicode) {
+            if (!unicode) {
+                std::vector<uint8_t> buffer = std::vector<uint8_t>(key.begin(), key.end());
+                unicode = plist::Format::Encodings::Convert(buffer, plist::Format::Encoding::UTF8, plist::Format::Encoding::UTF16BE);
+            }
+            matches = (candidate->count * 2 == unicode->size() && memcmp(bytes, unicode->data(), unicode->size()) == 0);
+        }
+
+        if (matches) {
+            ext::optional<uint64_t> value = _view->itemReference(*record, record->count + n);
+            if (!value) {
+                return ext::nullopt;
+            }
+
+            return Value(_view, *value);
+        }
+    }
+
+    return ext::nullopt;
+}
+
+Object const *BinaryView::Value::
+object() const
+{
+    return _view->decode(_reference, 0);
+}
+
+std::unique_ptr<Object> BinaryView::Value::
+copy() const
+{
+    Object const *object = _view->decode(_reference, 0);
+    return (object != nullptr ? object->copy() : nullptr);
+}
+
+std::pair<std::unique_ptr<BinaryView>, std::string> BinaryView::
+Open(ext::span<uint8_t const> contents)
+{
+    size_t headerSize = sizeof(abplist_header_t);
+    size_t trailerSize = sizeof(abplist_trailer_t);
+
+    if (contents.size() < headerSize + trailerSize ||
+        memcmp(contents.data(), ABPLIST_MAGIC ABPLIST_VERSION, headerSize) != 0) {
+        return std::make_pair(nullptr, "not a binary property list or corrupted header");
+    }
+
+    size_t trailer = contents.size() - trailerSize;
+    size_t offsetIntByteSize = contents[trailer + 6];
+    size_t objectRefByteSize = contents[trailer + 7];
+
+    uint64_t objectsCount;
+    uint64_t topLevelObject;
+    if (!ReadWord(contents, trailer + 8, 8, &objectsCount) ||
+        !ReadWord(contents, trailer + 16, 8, &topLevelObject) ||
+        offsetIntByteSize == 0 || offsetIntByteSize > sizeof(uint64_t) ||
+        objectRefByteSize == 0 || objectRefByteSize > sizeof(uint64_t) ||
+        topLevelObject >= objectsCount) {
+        return std::make_pair(nullptr, "corrupted trailer");
+    }
+
+    /* The offset table immediately precedes the trailer. */
+    if (objectsCount > (trailer - headerSize) / offsetIntByteSize) {
+        return std::make_pair(nullptr, "corrupted offsets table");
+    }
+    size_t offsetTableOffset = trailer - static_cast<size_t>(objectsCount) * offsetIntByteSize;
+
+    auto view = std::unique_ptr<BinaryView>(new BinaryView(
+        contents,
+        offsetIntByteSize,
+        objectRefByteSize,
+        objectsCount,
+        topLevelObject,
+        offsetTableOffset));
+    return std::make_pair(std::move(view), std::string());
+}
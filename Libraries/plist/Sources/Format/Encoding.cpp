@@ -20,7 +20,7 @@ using plist::Format::Encoding;
 using plist::Format::Encodings;
 
 Encoding Encodings::
-Detect(std::vector<uint8_t> const &contents)
+Detect(ext::span<uint8_t const> contents)
 {
     /*
      * Check for a UTF-32 BOM. First as bytes overlap with UTF-16 LE.
@@ -133,16 +133,16 @@ EndianSwapBuffer(std::vector<uint8_t> *buffer, Endian src, Endian dest)
 }
 
 std::vector<uint8_t> Encodings::
-Convert(std::vector<uint8_t> const &contents, Encoding from, Encoding to)
+Convert(ext::span<uint8_t const> contents, Encoding from, Encoding to)
 {
-    std::vector<uint8_t> input = contents;
-
     /* Remove any BOM at the start. */
     std::vector<uint8_t> BOM = Encodings::BOM(from);
-    if (input.size() >= BOM.size() && std::equal(BOM.begin(), BOM.end(), contents.begin())) {
-        input.erase(input.begin(), input.begin() + BOM.size());
+    if (contents.size() >= BOM.size() && std::equal(BOM.begin(), BOM.end(), contents.begin())) {
+        contents = contents.subspan(BOM.size());
     }
 
+    std::vector<uint8_t> input = std::vector<uint8_t>(contents.begin(), contents.end());
+
     /* No conversion needed, just byte swap if necessary. */
     if (from == to) {
         return input;
@@ -219,3 +219,20 @@ Convert(std::vector<uint8_t> const &contents, Encoding from, Encoding to)
         return result;
     }
 }
+
+ext::span<uint8_t const> Encodings::
+ConvertUTF8(ext::span<uint8_t const> contents, Encoding from, std::vector<uint8_t> *storage)
+{
+    if (from != Encoding::UTF8) {
+        *storage = Encodings::Convert(contents, from, Encoding::UTF8);
+        return *storage;
+    }
+
+    /* Remove any BOM at the start. */
+    std::vector<uint8_t> BOM = Encodings::BOM(from);
+    if (contents.size() >= BOM.size() && std::equal(BOM.begin(), BOM.end(), contents.begin())) {
+        contents = contents.subspan(BOM.size());
+    }
+
+    return contents;
+}
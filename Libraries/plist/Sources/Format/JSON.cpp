@@ -27,7 +27,7 @@ namespace plist { namespace Format {
 
 template<>
 std::unique_ptr<JSON> Format<JSON>::
-Identify(std::vector<uint8_t> const &contents)
+Identify(ext::span<uint8_t const> contents)
 {
     /* JSON is not a standard format. */
     return nullptr;
@@ -35,7 +35,7 @@ Identify(std::vector<uint8_t> const &contents)
 
 template<>
 std::pair<std::unique_ptr<Object>, std::string> Format<JSON>::
-Deserialize(std::vector<uint8_t> const &contents, JSON const &format)
+Deserialize(ext::span<uint8_t const> contents, JSON const &format)
 {
     std::unique_ptr<Object> root = nullptr;
     std::string             error;
@@ -26,7 +26,7 @@ namespace plist { namespace Format {
 
 template<>
 std::unique_ptr<SimpleXML> Format<SimpleXML>::
-Identify(std::vector<uint8_t> const &contents)
+Identify(ext::span<uint8_t const> contents)
 {
     /*
      * To identify XML document, we look for a <? or <!, ignoring
@@ -74,9 +74,10 @@ Identify(std::vector<uint8_t> const &contents)
 
 template<>
 std::pair<std::unique_ptr<Object>, std::string> Format<SimpleXML>::
-Deserialize(std::vector<uint8_t> const &contents, SimpleXML const &format)
+Deserialize(ext::span<uint8_t const> contents, SimpleXML const &format)
 {
-    std::vector<uint8_t> const data = Encodings::Convert(contents, format.encoding(), Encoding::UTF8);
+    std::vector<uint8_t> converted;
+    ext::span<uint8_t const> data = Encodings::ConvertUTF8(contents, format.encoding(), &converted);
 
     SimpleXMLParser parser;
     std::unique_ptr<Object> root = std::unique_ptr<Object>(parser.parse(data));
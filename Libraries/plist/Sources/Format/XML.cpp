@@ -35,7 +35,7 @@ namespace plist { namespace Format {
 
 template<>
 std::unique_ptr<XML> Format<XML>::
-Identify(std::vector<uint8_t> const &contents)
+Identify(ext::span<uint8_t const> contents)
 {
     /*
      * To identify XML document, we look for a <? or <!, ignoring
@@ -83,9 +83,10 @@ Identify(std::vector<uint8_t> const &contents)
 
 template<>
 std::pair<std::unique_ptr<Object>, std::string> Format<XML>::
-Deserialize(std::vector<uint8_t> const &contents, XML const &format)
+Deserialize(ext::span<uint8_t const> contents, XML const &format)
 {
-    std::vector<uint8_t> const data = Encodings::Convert(contents, format.encoding(), Encoding::UTF8);
+    std::vector<uint8_t> converted;
+    ext::span<uint8_t const> data = Encodings::ConvertUTF8(contents, format.encoding(), &converted);
 
     XMLParser parser;
     std::unique_ptr<Object> root = std::unique_ptr<Object>(parser.parse(data));
@@ -21,7 +21,7 @@ XMLParser::XMLParser() :
 }
 
 Object *XMLParser::
-parse(std::vector<uint8_t> const &contents)
+parse(ext::span<uint8_t const> contents)
 {
     if (_root != nullptr)
         return nullptr;
@@ -8,8 +8,66 @@
  */
 
 #include <plist/Object.h>
+#include <plist/Arena.h>
+
+#include <new>
 
 using plist::Object;
+using plist::Arena;
+
+/*
+ * The object on this thread that was last destroyed, if it is in an arena.
+ * Deleting an object destroys it and then releases its memory, so this
+ * tells releasing memory that the memory belongs to an arena.
+ */
+static thread_local void const *DestroyedArenaObject = nullptr;
+
+Object::
+Object() :
+    _arena(Arena::Current() != nullptr)
+{
+}
+
+Object::
+Object(Object const &object) :
+    _arena(Arena::Current() != nullptr)
+{
+}
+
+Object &Object::
+operator=(Object const &object)
+{
+    /* Where an object is allocated doesn't change. */
+    return *this;
+}
+
+Object::
+~Object()
+{
+    DestroyedArenaObject = (_arena ? this : nullptr);
+}
+
+void *Object::
+operator new(size_t size)
+{
+    if (Arena *arena = Arena::Current()) {
+        return arena->allocate(size);
+    } else {
+        return ::operator new(size);
+    }
+}
+
+void Object::
+operator delete(void *pointer)
+{
+    if (pointer != nullptr && pointer == DestroyedArenaObject) {
+        /* Memory in an arena is released with the arena. */
+        DestroyedArenaObject = nullptr;
+        return;
+    }
+
+    ::operator delete(pointer);
+}
 
 std::unique_ptr<Object> Object::
 Coerce(Object const *obj)
@@ -0,0 +1,157 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <gtest/gtest.h>
+#include <plist/Format/ASCIIPListLexer.h>
+
+#include <cstdlib>
+#include <string>
+#include <tuple>
+#include <vector>
+
+typedef std::tuple<int, int, int, int> Token;
+
+static std::vector<Token>
+Lex(std::string const &contents, int style, bool scalar)
+{
+    ASCIIPListLexer lexer;
+    ASCIIPListLexerInit(&lexer, contents.data(), contents.size(), style);
+    lexer.scalar = scalar;
+
+    std::vector<Token> tokens;
+    for (;;) {
+        char const *pointer = lexer.pointer;
+        int token = ASCIIPListLexerReadToken(&lexer);
+        tokens.push_back(Token(token, lexer.tokenBegin, lexer.tokenLength, lexer.line));
+
+        /* Invalid characters produce empty tokens without advancing. */
+        if (token < 0 || lexer.pointer == pointer) {
+            break;
+        }
+    }
+    return tokens;
+}
+
+/*
+ * Lex the first token of the start of the contents. The rest of the contents
+ * is still in memory after the end of the buffer, but must not be read.
+ */
+static Token
+LexPrefix(std::string const &contents, size_t length, int style)
+{
+    ASCIIPListLexer lexer;
+    ASCIIPListLexerInit(&lexer, contents.data(), length, style);
+
+    int token = ASCIIPListLexerReadToken(&lexer);
+    return Token(token, lexer.tokenBegin, lexer.tokenLength, lexer.line);
+}
+
+static std::string
+CopyUnquotedString(std::string const &contents)
+{
+    ASCIIPListLexer lexer;
+    ASCIIPListLexerInit(&lexer, contents.data(), contents.size(), kASCIIPListLexerStyleASCII);
+    if (ASCIIPListLexerReadToken(&lexer) != kASCIIPListLexerTokenQuotedString) {
+        return std::string();
+    }
+
+    char *copy = ASCIIPListCopyUnquotedString(&lexer, '?');
+    std::string result = std::string(copy);
+    free(copy);
+    return result;
+}
+
+static void
+ExpectSameTokens(std::string const &contents, int style = kASCIIPListLexerStyleASCII)
+{
+    std::vector<Token> scalar = Lex(contents, style, true);
+    std::vector<Token> vector = Lex(contents, style, false);
+    EXPECT_EQ(scalar, vector) << contents;
+}
+
+TEST(ASCIIPListLexer, QuotedString)
+{
+    std::vector<Token> tokens = Lex("\"a \\\" b\" 'c\nd'", kASCIIPListLexerStyleASCII, false);
+    ASSERT_EQ(3, tokens.size());
+    EXPECT_EQ(Token(kASCIIPListLexerTokenQuotedString, 1, 6, 1), tokens[0]);
+    EXPECT_EQ(Token(kASCIIPListLexerTokenQuotedString, 10, 3, 2), tokens[1]);
+    EXPECT_EQ(kASCIIPListLexerEndOfFile, std::get<0>(tokens[2]));
+
+    /* Unterminated, even if the escape is the last character. */
+    EXPECT_EQ(kASCIIPListLexerUnterminatedQuotedString, std::get<0>(Lex("\"abc", kASCIIPListLexerStyleASCII, false)[0]));
+    EXPECT_EQ(kASCIIPListLexerUnterminatedQuotedString, std::get<0>(Lex("\"abc\\", kASCIIPListLexerStyleASCII, false)[0]));
+}
+
+TEST(ASCIIPListLexer, UnquotedString)
+{
+    std::vector<Token> tokens = Lex("a-b_c.d:e/$f = x;", kASCIIPListLexerStyleASCII, false);
+    ASSERT_LE(2, tokens.size());
+    EXPECT_EQ(Token(kASCIIPListLexerTokenUnquotedString, 0, 12, 1), tokens[0]);
+    EXPECT_EQ(Token(kASCIIPListLexerTokenDictionaryKeyValSeparator, 13, 1, 1), tokens[1]);
+}
+
+TEST(ASCIIPListLexer, ScalarEquivalence)
+{
+    /* Place each interesting character at every offset in a vector. */
+    std::string const specials = std::string("\"'\\\n*/ =;,(){}<>\t\r", 18) + std::string(1, '\0') + "\x80\xff";
+    for (char special : specials) {
+        for (size_t offset = 0; offset < 70; offset++) {
+            std::string filler = std::string(offset, 'a');
+            std::string tail = filler + special + "bcdefghijklmnopqrstuvwxyz0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+            ExpectSameTokens("\"" + tail + "\" x");
+            ExpectSameTokens("'" + tail + "' x");
+            ExpectSameTokens("// " + tail + "\nx");
+            ExpectSameTokens("/* " + tail + " */ x");
+            ExpectSameTokens(tail + " = x;");
+            ExpectSameTokens("\"" + tail + "\"", kASCIIPListLexerStyleJSON);
+        }
+    }
+
+    /* Every byte value as the end of an unquoted string. */
+    for (int byte = 0; byte < 256; byte++) {
+        ExpectSameTokens("abcdefghijklmnopqrstuvwxyz0123456789-./:_$" + std::string(1, static_cast<char>(byte)) + "x");
+    }
+}
+
+TEST(ASCIIPListLexer, Truncated)
+{
+    /* Data. */
+    EXPECT_EQ(kASCIIPListLexerUnterminatedData, std::get<0>(LexPrefix("<0a>", 3, kASCIIPListLexerStyleASCII)));
+
+    /* Numbers. */
+    EXPECT_EQ(Token(kASCIIPListLexerTokenNumberInteger, 0, 2, 1), LexPrefix("123", 2, kASCIIPListLexerStyleJSON));
+    EXPECT_EQ(kASCIIPListLexerInvalidToken, std::get<0>(LexPrefix("-1", 1, kASCIIPListLexerStyleJSON)));
+    EXPECT_EQ(kASCIIPListLexerInvalidToken, std::get<0>(LexPrefix("12.5", 3, kASCIIPListLexerStyleJSON)));
+    EXPECT_EQ(kASCIIPListLexerInvalidToken, std::get<0>(LexPrefix("1e5", 2, kASCIIPListLexerStyleJSON)));
+    EXPECT_EQ(kASCIIPListLexerInvalidToken, std::get<0>(LexPrefix("1e+5", 3, kASCIIPListLexerStyleJSON)));
+
+    /* Keywords. */
+    EXPECT_EQ(Token(kASCIIPListLexerTokenBoolTrue, 0, 4, 1), LexPrefix("true,", 4, kASCIIPListLexerStyleJSON));
+    EXPECT_EQ(kASCIIPListLexerInvalidToken, std::get<0>(LexPrefix("true", 3, kASCIIPListLexerStyleJSON)));
+    EXPECT_EQ(kASCIIPListLexerInvalidToken, std::get<0>(LexPrefix("false", 4, kASCIIPListLexerStyleJSON)));
+    EXPECT_EQ(kASCIIPListLexerInvalidToken, std::get<0>(LexPrefix("null", 2, kASCIIPListLexerStyleJSON)));
+
+    /* Comments. */
+    EXPECT_EQ(Token(kASCIIPListLexerTokenUnquotedString, 0, 1, 1), LexPrefix("//", 1, kASCIIPListLexerStyleASCII));
+    EXPECT_EQ(Token(kASCIIPListLexerTokenUnquotedString, 0, 1, 1), LexPrefix("/*", 1, kASCIIPListLexerStyleASCII));
+    EXPECT_EQ(kASCIIPListLexerUnterminatedLongComment, std::get<0>(LexPrefix("/* */", 4, kASCIIPListLexerStyleASCII)));
+}
+
+TEST(ASCIIPListLexer, CopyUnquotedString)
+{
+    EXPECT_EQ("a\tb", CopyUnquotedString("\"a\\tb\""));
+    EXPECT_EQ("A", CopyUnquotedString("\"\\x41\""));
+    EXPECT_EQ("A", CopyUnquotedString("\"\\0101\""));
+    EXPECT_EQ("A\xc3\xa9", CopyUnquotedString("\"\\u0041\\u00e9\""));
+
+    /* Escapes ending at the end of the string. */
+    EXPECT_EQ("a\x04", CopyUnquotedString("\"a\\x4\""));
+    EXPECT_EQ("a\x01", CopyUnquotedString("\"a\\01\""));
+}
@@ -9,9 +9,13 @@
 
 #include <gtest/gtest.h>
 #include <plist/Format/Binary.h>
+#include <plist/Format/BinaryView.h>
 #include <plist/Objects.h>
 
+#include <cstdio>
+
 using plist::Format::Binary;
+using plist::Format::BinaryView;
 using plist::String;
 using plist::Dictionary;
 
@@ -57,3 +61,60 @@ TEST(Binary, UnicodeString)
     EXPECT_EQ(*serialize.first, contents);
 }
 
+TEST(Binary, SharedValues)
+{
+    auto inner = Dictionary::New();
+    inner->set("Name", String::New("value"));
+    inner->set("Count", plist::Integer::New(1));
+
+    auto dict = Dictionary::New();
+    dict->set("Name", String::New("value"));
+    dict->set("Other", String::New("value"));
+    dict->set("Count", plist::Integer::New(1));
+    dict->set("Real", plist::Real::New(1.0));
+    dict->set("Inner", std::move(inner));
+
+    auto serialize = Binary::Serialize(dict.get(), Binary::Create());
+    ASSERT_NE(serialize.first, nullptr);
+
+    auto view = BinaryView::Open(*serialize.first);
+    ASSERT_NE(view.first, nullptr);
+    BinaryView::Value root = view.first->root();
+    BinaryView::Value nested = *root.value("Inner");
+
+    /* Equal values are written once, including across dictionaries. */
+    EXPECT_EQ(root.value("Name")->reference(), root.value("Other")->reference());
+    EXPECT_EQ(root.value("Name")->reference(), nested.value("Name")->reference());
+    EXPECT_EQ(root.value("Count")->reference(), nested.value("Count")->reference());
+
+    /* Values of different types are not shared. */
+    EXPECT_NE(root.value("Count")->reference(), root.value("Real")->reference());
+
+    auto deserialize = Binary::Deserialize(*serialize.first, Binary::Create());
+    ASSERT_NE(deserialize.first, nullptr);
+    EXPECT_TRUE(deserialize.first->equals(dict.get()));
+}
+
+TEST(Binary, SerializeDescriptor)
+{
+    auto dict = Dictionary::New();
+    for (size_t n = 0; n < 10000; n++) {
+        dict->set("Key" + std::to_string(n), String::New("Value" + std::to_string(n)));
+    }
+
+    auto serialize = Binary::Serialize(dict.get(), Binary::Create());
+    ASSERT_NE(serialize.first, nullptr);
+
+    FILE *file = tmpfile();
+    ASSERT_NE(file, nullptr);
+
+    auto result = Binary::Serialize(dict.get(), Binary::Create(), fileno(file));
+    EXPECT_TRUE(result.first);
+
+    /* Streamed output matches the in-memory output. */
+    std::vector<uint8_t> contents = std::vector<uint8_t>(serialize.first->size() + 1);
+    rewind(file);
+    contents.resize(fread(contents.data(), 1, contents.size(), file));
+    fclose(file);
+    EXPECT_EQ(*serialize.first, contents);
+}
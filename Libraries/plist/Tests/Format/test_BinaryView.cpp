@@ -0,0 +1,132 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <gtest/gtest.h>
+#include <plist/Format/Binary.h>
+#include <plist/Format/BinaryView.h>
+#include <plist/Objects.h>
+
+using plist::Format::Binary;
+using plist::Format::BinaryView;
+using plist::ObjectType;
+
+static std::unique_ptr<plist::Dictionary>
+Sample()
+{
+    auto array = plist::Array::New();
+    array->append(plist::Integer::New(42));
+    array->append(plist::Real::New(1.5));
+    array->append(plist::Boolean::New(true));
+
+    auto dict = plist::Dictionary::New();
+    dict->set("Name", plist::String::New("value"));
+    dict->set("Items", std::move(array));
+    dict->set("Data", plist::Data::New(std::string("bytes")));
+    dict->set("\xc3\xa9t\xc3\xa9", plist::String::New("summer"));
+    return dict;
+}
+
+TEST(BinaryView, Lookup)
+{
+    auto dict = Sample();
+    auto serialize = Binary::Serialize(dict.get(), Binary::Create());
+    ASSERT_NE(nullptr, serialize.first);
+
+    auto open = BinaryView::Open(*serialize.first);
+    ASSERT_NE(nullptr, open.first);
+    BinaryView::Value root = open.first->root();
+    EXPECT_EQ(ObjectType::Dictionary, root.type());
+    EXPECT_EQ(4, *root.count());
+
+    ext::optional<BinaryView::Value> name = root.value("Name");
+    ASSERT_NE(ext::nullopt, name);
+    EXPECT_EQ(ObjectType::String, name->type());
+    EXPECT_TRUE(name->object()->equals(plist::String::New("value").get()));
+
+    /* Non-ASCII keys are stored as UTF-16. */
+    ext::optional<BinaryView::Value> summer = root.value("\xc3\xa9t\xc3\xa9");
+    ASSERT_NE(ext::nullopt, summer);
+    EXPECT_TRUE(summer->object()->equals(plist::String::New("summer").get()));
+
+    ext::optional<BinaryView::Value> items = root.value("Items");
+    ASSERT_NE(ext::nullopt, items);
+    EXPECT_EQ(ObjectType::Array, items->type());
+    EXPECT_EQ(3, *items->count());
+    EXPECT_EQ(ObjectType::Real, items->value(1)->type());
+    EXPECT_EQ(ext::nullopt, items->value(3));
+
+    EXPECT_EQ(ext::nullopt, root.value("Missing"));
+    EXPECT_EQ(ext::nullopt, name->value("Name"));
+
+    /* Keys by index match values by index. */
+    for (size_t n = 0; n < *root.count(); n++) {
+        ext::optional<std::string> key = root.key(n);
+        ASSERT_NE(ext::nullopt, key);
+        EXPECT_EQ(root.value(n)->reference(), root.value(*key)->reference());
+    }
+
+    /* Decoding the whole tree matches the eager reader. */
+    EXPECT_TRUE(root.object()->equals(dict.get()));
+}
+
+TEST(BinaryView, SharedReference)
+{
+    /*
+     * An array containing the same string object twice.
+     */
+    std::vector<uint8_t> contents = {
+        0x62, 0x70, 0x6c, 0x69, 0x73, 0x74, 0x30, 0x30, 0xa2, 0x01, 0x01, 0x52,
+        0x61, 0x62, 0x08, 0x0b, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x01,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0e,
+    };
+
+    auto open = BinaryView::Open(contents);
+    ASSERT_NE(nullptr, open.first);
+    BinaryView::Value root = open.first->root();
+
+    /* Decoding the container decodes the shared string once, for both items. */
+    plist::Array const *array = plist::CastTo<plist::Array>(root.object());
+    ASSERT_NE(nullptr, array);
+    EXPECT_EQ(2, array->count());
+    EXPECT_TRUE(array->value(0)->equals(array->value(1)));
+
+    ext::optional<BinaryView::Value> first = root.value(0);
+    ext::optional<BinaryView::Value> second = root.value(1);
+    ASSERT_NE(ext::nullopt, first);
+    ASSERT_NE(ext::nullopt, second);
+    EXPECT_EQ(first->reference(), second->reference());
+
+    /* Both references decode to the same cached object. */
+    plist::Object const *object = first->object();
+    ASSERT_NE(nullptr, object);
+    EXPECT_EQ(object, second->object());
+    EXPECT_TRUE(object->equals(plist::String::New("ab").get()));
+}
+
+TEST(BinaryView, Corrupted)
+{
+    std::vector<uint8_t> notBinary = { 'b', 'p', 'l', 'i', 's', 't' };
+    EXPECT_EQ(nullptr, BinaryView::Open(notBinary).first);
+
+    /*
+     * Top level object is an array referencing itself.
+     */
+    std::vector<uint8_t> cycle = {
+        0x62, 0x70, 0x6c, 0x69, 0x73, 0x74, 0x30, 0x30, 0xa1, 0x00, 0x08, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0a,
+    };
+
+    auto open = BinaryView::Open(cycle);
+    ASSERT_NE(nullptr, open.first);
+    EXPECT_EQ(ObjectType::Array, open.first->root().type());
+    EXPECT_EQ(nullptr, open.first->root().object());
+}
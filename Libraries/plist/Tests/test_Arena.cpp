@@ -0,0 +1,108 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <gtest/gtest.h>
+#include <plist/Arena.h>
+#include <plist/Objects.h>
+#include <plist/Format/ASCII.h>
+
+using plist::Arena;
+using plist::Dictionary;
+using plist::String;
+
+TEST(Arena, Scope)
+{
+    Arena arena;
+    EXPECT_EQ(nullptr, Arena::Current());
+
+    std::unique_ptr<String> inside;
+    {
+        Arena::Scope scope(&arena);
+        EXPECT_EQ(&arena, Arena::Current());
+        inside = String::New("inside");
+    }
+    EXPECT_EQ(nullptr, Arena::Current());
+
+    auto outside = String::New("outside");
+    EXPECT_TRUE(arena.contains(inside.get()));
+    EXPECT_FALSE(arena.contains(outside.get()));
+
+    /* Objects in the arena can still be deleted normally. */
+    inside.reset();
+}
+
+TEST(Arena, Allocate)
+{
+    Arena arena;
+    void *small = arena.allocate(16);
+    void *large = arena.allocate(1024 * 1024);
+    EXPECT_TRUE(arena.contains(small));
+    EXPECT_TRUE(arena.contains(static_cast<char *>(large) + 1024 * 1024 - 1));
+
+    int local = 0;
+    EXPECT_FALSE(arena.contains(&local));
+}
+
+TEST(Arena, Delete)
+{
+    Arena arena;
+    std::unique_ptr<String> inside;
+    {
+        Arena::Scope scope(&arena);
+        inside = String::New("inside");
+    }
+
+    /* Deleting objects from either place, in any order, is fine. */
+    auto outside = String::New("outside");
+    auto copy = inside->copy();
+    inside.reset();
+    outside.reset();
+    copy.reset();
+}
+
+TEST(Arena, Deserialize)
+{
+    std::string string = "{ a = ( 1, 2, { b = c; } ); d = \"e f\"; }";
+    std::vector<uint8_t> contents = std::vector<uint8_t>(string.begin(), string.end());
+    plist::Format::ASCII format = plist::Format::ASCII::Create(false, plist::Format::Encoding::UTF8);
+
+    auto heap = plist::Format::ASCII::Deserialize(contents, format);
+    ASSERT_NE(nullptr, heap.first);
+
+    Arena arena;
+    std::pair<std::unique_ptr<plist::Object>, std::string> parsed;
+    {
+        Arena::Scope scope(&arena);
+        parsed = plist::Format::ASCII::Deserialize(contents, format);
+    }
+
+    ASSERT_NE(nullptr, parsed.first);
+    EXPECT_TRUE(arena.contains(parsed.first.get()));
+    EXPECT_TRUE(parsed.first->equals(heap.first.get()));
+
+    /* Copies made outside of the scope are on the heap. */
+    auto copy = parsed.first->copy();
+    EXPECT_FALSE(arena.contains(copy.get()));
+    EXPECT_TRUE(copy->equals(heap.first.get()));
+}
+
+TEST(Arena, DictionaryKeys)
+{
+    auto dict = Dictionary::New();
+    dict->set("one", String::New("1"));
+    dict->set("two", String::New("2"));
+    dict->set("three", String::New("3"));
+    dict->remove("two");
+    dict->set("one", String::New("4"));
+
+    std::vector<std::string> keys = std::vector<std::string>(dict->begin(), dict->end());
+    EXPECT_EQ(std::vector<std::string>({ "three", "one" }), keys);
+    EXPECT_EQ("three", dict->key(0));
+    EXPECT_EQ("4", dict->value<String>(1)->value());
+}
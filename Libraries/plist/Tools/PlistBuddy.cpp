@@ -19,11 +19,13 @@
 #include <plist/Format/Any.h>
 #include <plist/Format/ASCII.h>
 #include <plist/Format/Binary.h>
+#include <plist/Format/BinaryView.h>
 #include <plist/Format/Encoding.h>
 #include <plist/Format/XML.h>
 #include <libutil/Options.h>
 #include <libutil/Filesystem.h>
 #include <libutil/DefaultFilesystem.h>
+#include <libutil/MappedFile.h>
 
 #include <iostream>
 #include <iterator>
@@ -350,6 +352,96 @@ Print(plist::Object *object, std::queue<std::string> *keyPath, plist::Format::An
     return true;
 }
 
+static ext::optional<plist::Format::BinaryView::Value>
+GetValueAtKeyPath(plist::Format::BinaryView::Value value, std::queue<std::string> *keyPath)
+{
+    while (!keyPath->empty()) {
+        std::string const &key = keyPath->front();
+
+        ext::optional<plist::Format::BinaryView::Value> next;
+        if (value.type() == plist::ObjectType::Dictionary) {
+            next = value.value(key);
+        } else if (value.type() == plist::ObjectType::Array) {
+            char *end = NULL;
+            long long index = std::strtoll(key.c_str(), &end, 0);
+            if (end == key.c_str() || index < 0 || static_cast<size_t>(index) >= value.count().value_or(0)) {
+                fprintf(stderr, "Invalid array index\n");
+                return ext::nullopt;
+            }
+
+            next = value.value(static_cast<size_t>(index));
+        } else {
+            /* Reached a non-collection object with remaining key path, error. */
+            fprintf(stderr, "Invalid key path (indexing into non-collection object)\n");
+            return ext::nullopt;
+        }
+
+        if (!next) {
+            fprintf(stderr, "Invalid key path (no object at key path)\n");
+            return ext::nullopt;
+        }
+
+        value = *next;
+        keyPath->pop();
+    }
+
+    return value;
+}
+
+/*
+ * Print directly from a binary property list, decoding only the printed
+ * object. Not handled if the command is not a print, or the file is not a
+ * binary property list.
+ */
+static ext::optional<bool>
+PrintBinary(Filesystem const *filesystem, std::string const &path, plist::Format::Any const &format, std::string const &input)
+{
+    std::vector<std::string> tokens;
+    std::stringstream sstream(input);
+    std::copy(std::istream_iterator<std::string>(sstream), std::istream_iterator<std::string>(), std::back_inserter(tokens));
+
+    if (tokens.empty() || tokens[0] != "Print") {
+        return ext::nullopt;
+    }
+
+    ext::optional<libutil::MappedFile> contents = filesystem->map(path);
+    if (!contents || plist::Format::Binary::Identify(contents->contents()) == nullptr) {
+        return ext::nullopt;
+    }
+
+    auto view = plist::Format::BinaryView::Open(contents->contents());
+    if (view.first == nullptr) {
+        fprintf(stderr, "Error: %s\n", view.second.c_str());
+        return false;
+    }
+
+    std::queue<std::string> keyPath;
+    if (tokens.size() > 1) {
+        ParseCommandKeyPathString(tokens[1], &keyPath);
+    }
+
+    ext::optional<plist::Format::BinaryView::Value> value = GetValueAtKeyPath(view.first->root(), &keyPath);
+    if (!value) {
+        return false;
+    }
+
+    plist::Object const *target = value->object();
+    if (target == nullptr) {
+        fprintf(stderr, "Error: failed to read object\n");
+        return false;
+    }
+
+    auto serialize = plist::Format::Any::Serialize(target, format);
+    if (serialize.first == nullptr) {
+        fprintf(stderr, "Error: %s\n", serialize.second.c_str());
+        return false;
+    }
+
+    /* Print. */
+    std::copy(serialize.first->begin(), serialize.first->end(), std::ostream_iterator<char>(std::cout));
+    return true;
+}
+
 static bool
 Revert(std::unique_ptr<plist::Object> *root, Filesystem const *filesystem, std::string const &path, ext::optional<plist::Format::Any> *format = nullptr)
 {
@@ -715,6 +807,28 @@ main(int argc, char **argv)
         return 0;
     }
 
+    /*
+     * Determine format for printing.
+     */
+    ext::optional<plist::Format::Any> printFormat;
+    if (options.xml()) {
+        plist::Format::XML xml = plist::Format::XML::Create(plist::Format::Encoding::UTF8);
+        printFormat = plist::Format::Any::Create<plist::Format::XML>(xml);
+    } else {
+        plist::Format::ASCII ascii = plist::Format::ASCII::Create(false, plist::Format::Encoding::UTF8);
+        printFormat = plist::Format::Any::Create<plist::Format::ASCII>(ascii);
+    }
+
+    /*
+     * Print commands on binary input don't need to read the whole file.
+     */
+    if (options.command() && !options.input().empty() && filesystem.exists(options.input())) {
+        ext::optional<bool> printed = PrintBinary(&filesystem, options.input(), *printFormat, *options.command());
+        if (printed) {
+            return (*printed ? 0 : 1);
+        }
+    }
+
     /*
      * Read input, and determine format for saving.
      */
@@ -737,18 +851,6 @@ main(int argc, char **argv)
         saveFormat = plist::Format::Any::Create<plist::Format::XML>(xml);
     }
 
-    /*
-     * Determine format for printing.
-     */
-    ext::optional<plist::Format::Any> printFormat;
-    if (options.xml()) {
-        plist::Format::XML xml = plist::Format::XML::Create(plist::Format::Encoding::UTF8);
-        printFormat = plist::Format::Any::Create<plist::Format::XML>(xml);
-    } else {
-        plist::Format::ASCII ascii = plist::Format::ASCII::Create(false, plist::Format::Encoding::UTF8);
-        printFormat = plist::Format::Any::Create<plist::Format::ASCII>(ascii);
-    }
-
     bool success = true;
     if (options.command()) {
         /*
@@ -0,0 +1,124 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <plist/Format/ASCIIPListLexer.h>
+#include <libutil/DefaultFilesystem.h>
+#include <libutil/Filesystem.h>
+#include <libutil/MappedFile.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using libutil::DefaultFilesystem;
+
+/*
+ * Lex the contents once, returning the number of tokens, or -1 if the
+ * contents could not be lexed.
+ */
+static long
+Lex(ext::span<uint8_t const> contents, bool scalar, long long *checksum)
+{
+    ASCIIPListLexer lexer;
+    ASCIIPListLexerInit(&lexer, reinterpret_cast<char const *>(contents.data()), contents.size(), kASCIIPListLexerStyleASCII);
+    lexer.scalar = scalar;
+
+    long count = 0;
+    for (;;) {
+        char const *pointer = lexer.pointer;
+        int token = ASCIIPListLexerReadToken(&lexer);
+        if (token == kASCIIPListLexerEndOfFile) {
+            return count;
+        } else if (token < 0 || lexer.pointer == pointer) {
+            return -1;
+        }
+
+        *checksum += token + lexer.tokenBegin + lexer.tokenLength + lexer.line;
+        count++;
+    }
+}
+
+/*
+ * Time lexing the contents, returning the fastest run in seconds.
+ */
+static double
+Measure(ext::span<uint8_t const> contents, bool scalar, int iterations, long *tokens, long long *checksum)
+{
+    double best = 0.0;
+    for (int n = 0; n < iterations; n++) {
+        *checksum = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        *tokens = Lex(contents, scalar, checksum);
+        auto end = std::chrono::steady_clock::now();
+
+        double seconds = std::chrono::duration<double>(end - start).count();
+        if (n == 0 || seconds < best) {
+            best = seconds;
+        }
+    }
+    return best;
+}
+
+int
+main(int argc, char **argv)
+{
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s [-n iterations] project.pbxproj...\n", argv[0]);
+        return 1;
+    }
+
+    DefaultFilesystem filesystem = DefaultFilesystem();
+    int iterations = 10;
+    bool success = true;
+
+    for (int i = 1; i < argc; i++) {
+        std::string path = argv[i];
+        if (path == "-n" && i + 1 < argc) {
+            iterations = std::max(1, atoi(argv[++i]));
+            continue;
+        }
+
+        ext::optional<libutil::MappedFile> file = filesystem.map(path);
+        if (!file) {
+            fprintf(stderr, "error: unable to read %s\n", path.c_str());
+            success = false;
+            continue;
+        }
+
+        ext::span<uint8_t const> contents = file->contents();
+        double megabytes = static_cast<double>(contents.size()) / (1024.0 * 1024.0);
+
+        long scalarTokens, vectorTokens;
+        long long scalarChecksum, vectorChecksum;
+        double scalar = Measure(contents, true, iterations, &scalarTokens, &scalarChecksum);
+        double vector = Measure(contents, false, iterations, &vectorTokens, &vectorChecksum);
+
+        if (scalarTokens < 0 || vectorTokens < 0) {
+            fprintf(stderr, "error: unable to lex %s\n", path.c_str());
+            success = false;
+            continue;
+        }
+
+        if (scalarTokens != vectorTokens || scalarChecksum != vectorChecksum) {
+            fprintf(stderr, "error: scalar and vector tokens differ for %s\n", path.c_str());
+            success = false;
+            continue;
+        }
+
+        printf("%s: %.2f MB, %ld tokens\n", path.c_str(), megabytes, scalarTokens);
+        printf("  scalar: %8.3f ms (%8.1f MB/s)\n", scalar * 1000.0, megabytes / scalar);
+        printf("  vector: %8.3f ms (%8.1f MB/s)\n", vector * 1000.0, megabytes / vector);
+        printf("  speedup: %.2fx\n", scalar / vector);
+    }
+
+    return (success ? 0 : 1);
+}
@@ -639,10 +639,27 @@ Modify(Filesystem *filesystem, Options const &options, std::string const &file,
         } while (end != std::string::npos);
     }
 
+    Options::Format outputFormat = options.convert().value_or(inputFormat);
+    std::string output = OutputPath(options, file);
+
+    /* Stream binary output to stdout, rather than building it in memory. */
+    if (output == "-") {
+        ext::optional<plist::Format::Any> any = outputFormat.any();
+        if (plist::Format::Binary const *binary = (any ? any->format<plist::Format::Binary>() : nullptr)) {
+            std::cout.flush();
+            std::pair<bool, std::string> result = plist::Format::Binary::Serialize(writeObject, *binary, fileno(stdout));
+            if (!result.first) {
+                fprintf(stderr, "error: %s\n", result.second.c_str());
+                return false;
+            }
+
+            return true;
+        }
+    }
+
     /* Convert to desired format. */
     std::pair<std::unique_ptr<std::vector<uint8_t>>, std::string> serialize;
 
-    Options::Format outputFormat = options.convert().value_or(inputFormat);
     if (ext::optional<plist::Format::Any> any = outputFormat.any()) {
         serialize = plist::Format::Any::Serialize(writeObject, *any);
     } else if (ext::optional<plist::Format::JSON> json = outputFormat.json()) {
@@ -657,7 +674,6 @@ Modify(Filesystem *filesystem, Options const &options, std::string const &file,
     }
 
     /* Write to output. */
-    std::string output = OutputPath(options, file);
     if (!Write(filesystem, *serialize.first, output)) {
         fprintf(stderr, "error: unable to write\n");
         return false;
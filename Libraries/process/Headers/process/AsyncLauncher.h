@@ -0,0 +1,157 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef __process_AsyncLauncher_h
+#define __process_AsyncLauncher_h
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include <ext/optional>
+
+namespace libutil { class Filesystem; }
+
+namespace process {
+
+class Context;
+
+/*
+ * Launches processes without waiting for them to finish. Each process's
+ * output and error streams are captured separately from every other
+ * process, so output from processes running at once never interleaves.
+ * A process's error stream can instead be combined into its output, to
+ * keep the order in which the two were written.
+ * Not thread safe; use one launcher from a single thread at a time, but
+ * separate launchers can start processes from different threads at once.
+ */
+class AsyncLauncher {
+public:
+    /*
+     * Identifies a launched process.
+     */
+    typedef uint64_t Identifier;
+
+    /*
+     * Receives a process's output as it is read.
+     */
+    typedef std::function<void(std::string const &)> OutputHandler;
+
+    /*
+     * The result of a finished process.
+     */
+    class Result {
+    private:
+        ext::optional<int> _exitCode;
+        std::string        _output;
+        std::string        _error;
+        uint64_t           _userTime;
+        uint64_t           _systemTime;
+        uint64_t           _maximumResidentSize;
+
+    public:
+        Result(
+            ext::optional<int> const &exitCode,
+            std::string const &output,
+            std::string const &error,
+            uint64_t userTime,
+            uint64_t systemTime,
+            uint64_t maximumResidentSize);
+
+    public:
+        /*
+         * The exit code, if the process exited rather than being killed.
+         */
+        ext::optional<int> const &exitCode() const
+        { return _exitCode; }
+
+    public:
+        /*
+         * Everything the process wrote to its output stream.
+         */
+        std::string const &output() const
+        { return _output; }
+
+        /*
+         * Everything the process wrote to its error stream.
+         */
+        std::string const &error() const
+        { return _error; }
+
+    public:
+        /*
+         * CPU time spent in the process, in microseconds.
+         */
+        uint64_t userTime() const
+        { return _userTime; }
+        uint64_t systemTime() const
+        { return _systemTime; }
+
+        /*
+         * Peak memory use of the process, in bytes.
+         */
+        uint64_t maximumResidentSize() const
+        { return _maximumResidentSize; }
+    };
+
+private:
+    struct Process;
+
+private:
+    Identifier                                      _next;
+    std::map<Identifier, std::unique_ptr<Process>>  _running;
+
+public:
+    AsyncLauncher();
+    ~AsyncLauncher();
+
+private:
+    AsyncLauncher(AsyncLauncher const &) = delete;
+    AsyncLauncher &operator=(AsyncLauncher const &) = delete;
+
+public:
+    /*
+     * Start a process. The filesystem is symbolic, as for Launcher. If
+     * combining the error stream, it is written to the same pipe as the
+     * output, so both are in order in the output and the error is empty.
+     * With an output handler, output is passed to it each time some is
+     * read, rather than kept until the process finishes; the result's
+     * output is then empty.
+     */
+    ext::optional<Identifier> start(libutil::Filesystem *filesystem, Context const *context, bool combineError = false, OutputHandler const &outputHandler = OutputHandler());
+
+    /*
+     * Collect output from running processes without blocking. Returns
+     * any processes that have finished.
+     */
+    std::vector<std::pair<Identifier, Result>> poll();
+
+    /*
+     * Block until any running process finishes. Returns nothing if no
+     * processes are running.
+     */
+    ext::optional<std::pair<Identifier, Result>> wait();
+
+public:
+    /*
+     * The number of processes started but not yet returned as finished.
+     */
+    size_t running() const
+    { return _running.size(); }
+
+private:
+    std::vector<std::pair<Identifier, Result>> collect(int timeout, bool any);
+};
+
+}
+
+#endif  // !__process_AsyncLauncher_h
@@ -0,0 +1,406 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <process/AsyncLauncher.h>
+#include <process/Context.h>
+#include <libutil/Filesystem.h>
+
+#include <mutex>
+
+#if !_WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <spawn.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#if defined(__APPLE__)
+#include <Availability.h>
+#endif
+#endif
+
+/*
+ * Changing directory in the child without forking needs a spawn file
+ * action that is only in newer C libraries.
+ */
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 29))
+#define SPAWN_ADDCHDIR 1
+#elif defined(__APPLE__) && defined(__MAC_10_15) && __MAC_OS_X_VERSION_MIN_REQUIRED >= __MAC_10_15
+#define SPAWN_ADDCHDIR 1
+#else
+#define SPAWN_ADDCHDIR 0
+#endif
+
+using process::AsyncLauncher;
+using process::Context;
+using libutil::Filesystem;
+
+struct AsyncLauncher::Process {
+    int           pid;
+    int           outputDescriptor;
+    int           errorDescriptor;
+    std::string   output;
+    std::string   error;
+    OutputHandler outputHandler;
+};
+
+AsyncLauncher::Result::
+Result(
+    ext::optional<int> const &exitCode,
+    std::string const &output,
+    std::string const &error,
+    uint64_t userTime,
+    uint64_t systemTime,
+    uint64_t maximumResidentSize) :
+    _exitCode           (exitCode),
+    _output             (output),
+    _error              (error),
+    _userTime           (userTime),
+    _systemTime         (systemTime),
+    _maximumResidentSize(maximumResidentSize)
+{
+}
+
+AsyncLauncher::
+AsyncLauncher() :
+    _next(0)
+{
+}
+
+AsyncLauncher::
+~AsyncLauncher()
+{
+#if !_WIN32
+    /* Don't leave zombies behind; the processes are not killed. */
+    for (auto const &entry : _running) {
+        Process const *process = entry.second.get();
+        if (process->outputDescriptor != -1) {
+            ::close(process->outputDescriptor);
+        }
+        if (process->errorDescriptor != -1) {
+            ::close(process->errorDescriptor);
+        }
+
+        int status;
+        while (::waitpid(process->pid, &status, 0) == -1 && errno == EINTR) { }
+    }
+#endif
+}
+
+#if !_WIN32
+static bool
+CreatePipe(int descriptors[2])
+{
+#if defined(__linux__)
+    return ::pipe2(descriptors, O_CLOEXEC) == 0;
+#else
+    /* Not atomic; a child started at the same time by another thread could inherit these. */
+    if (::pipe(descriptors) != 0) {
+        return false;
+    }
+
+    ::fcntl(descriptors[0], F_SETFD, FD_CLOEXEC);
+    ::fcntl(descriptors[1], F_SETFD, FD_CLOEXEC);
+    return true;
+#endif
+}
+
+static int
+Spawn(
+    char const *path,
+    char *const *arguments,
+    char *const *environment,
+    char const *directory,
+    int outputDescriptor,
+    int errorDescriptor)
+{
+#if SPAWN_ADDCHDIR
+    posix_spawn_file_actions_t actions;
+    if (::posix_spawn_file_actions_init(&actions) != 0) {
+        return -1;
+    }
+
+    posix_spawnattr_t attributes;
+    if (::posix_spawnattr_init(&attributes) != 0) {
+        ::posix_spawn_file_actions_destroy(&actions);
+        return -1;
+    }
+
+#if defined(POSIX_SPAWN_CLOEXEC_DEFAULT)
+    /* Avoid leaking descriptors opened by other threads into the child. */
+    ::posix_spawnattr_setflags(&attributes, POSIX_SPAWN_CLOEXEC_DEFAULT);
+    ::posix_spawn_file_actions_addinherit_np(&actions, STDIN_FILENO);
+#endif
+
+    ::posix_spawn_file_actions_adddup2(&actions, outputDescriptor, STDOUT_FILENO);
+    ::posix_spawn_file_actions_adddup2(&actions, errorDescriptor, STDERR_FILENO);
+    ::posix_spawn_file_actions_addchdir_np(&actions, directory);
+
+    pid_t pid;
+    int error = ::posix_spawn(&pid, path, &actions, &attributes, arguments, environment);
+    ::posix_spawnattr_destroy(&attributes);
+    ::posix_spawn_file_actions_destroy(&actions);
+
+    return (error == 0 ? pid : -1);
+#else
+    pid_t pid = ::fork();
+    if (pid == 0) {
+        ::dup2(outputDescriptor, STDOUT_FILENO);
+        ::dup2(errorDescriptor, STDERR_FILENO);
+
+        if (::chdir(directory) == -1) {
+            ::perror("chdir");
+            ::_exit(1);
+        }
+
+        ::execve(path, arguments, environment);
+        ::_exit(-1);
+    }
+
+    return pid;
+#endif
+}
+
+static uint64_t
+Microseconds(struct timeval const &time)
+{
+    return static_cast<uint64_t>(time.tv_sec) * 1000000 + static_cast<uint64_t>(time.tv_usec);
+}
+#endif
+
+ext::optional<AsyncLauncher::Identifier> AsyncLauncher::
+start(Filesystem *filesystem, Context const *context, bool combineError, OutputHandler const &outputHandler)
+{
+#if _WIN32
+    return ext::nullopt;
+#else
+    std::string const &path = context->executablePath();
+    if (!filesystem->isExecutable(path)) {
+        return ext::nullopt;
+    }
+
+    /* Compute command-line arguments. */
+    std::vector<char const *> arguments;
+    arguments.push_back(path.c_str());
+    for (std::string const &argument : context->commandLineArguments()) {
+        arguments.push_back(argument.c_str());
+    }
+    arguments.push_back(nullptr);
+
+    /* Compute environment variables. */
+    std::vector<std::string> environmentValues;
+    for (auto const &value : context->environmentVariables()) {
+        environmentValues.push_back(value.first + "=" + value.second);
+    }
+
+    std::vector<char const *> environment;
+    for (std::string const &value : environmentValues) {
+        environment.push_back(value.c_str());
+    }
+    environment.push_back(nullptr);
+
+    /*
+     * Where pipes can't be created close-on-exec atomically, a process started
+     * by another thread in between could inherit them and hold them open.
+     * Start one process at a time so that can't happen.
+     */
+    static std::mutex *spawnMutex = new std::mutex();
+    std::unique_lock<std::mutex> lock(*spawnMutex);
+
+    /* Separate pipes, so output and error are kept apart, unless combined. */
+    int outputPipe[2];
+    if (!CreatePipe(outputPipe)) {
+        return ext::nullopt;
+    }
+
+    int errorPipe[2] = { -1, -1 };
+    if (!combineError && !CreatePipe(errorPipe)) {
+        ::close(outputPipe[0]);
+        ::close(outputPipe[1]);
+        return ext::nullopt;
+    }
+
+    int pid = Spawn(
+        path.c_str(),
+        const_cast<char *const *>(arguments.data()),
+        const_cast<char *const *>(environment.data()),
+        context->currentDirectory().c_str(),
+        outputPipe[1],
+        (combineError ? outputPipe[1] : errorPipe[1]));
+
+    /* Only the child writes to the pipes. */
+    ::close(outputPipe[1]);
+    if (!combineError) {
+        ::close(errorPipe[1]);
+    }
+    lock.unlock();
+
+    if (pid < 0) {
+        ::close(outputPipe[0]);
+        if (!combineError) {
+            ::close(errorPipe[0]);
+        }
+        return ext::nullopt;
+    }
+
+    ::fcntl(outputPipe[0], F_SETFL, ::fcntl(outputPipe[0], F_GETFL) | O_NONBLOCK);
+    if (!combineError) {
+        ::fcntl(errorPipe[0], F_SETFL, ::fcntl(errorPipe[0], F_GETFL) | O_NONBLOCK);
+    }
+
+    std::unique_ptr<Process> process = std::unique_ptr<Process>(new Process());
+    process->pid = pid;
+    process->outputDescriptor = outputPipe[0];
+    process->errorDescriptor = errorPipe[0];
+    process->outputHandler = outputHandler;
+
+    Identifier identifier = _next++;
+    _running.insert({ identifier, std::move(process) });
+    return identifier;
+#endif
+}
+
+std::vector<std::pair<AsyncLauncher::Identifier, AsyncLauncher::Result>> AsyncLauncher::
+collect(int timeout, bool any)
+{
+    std::vector<std::pair<Identifier, Result>> results;
+
+#if !_WIN32
+    /*
+     * Returns processes that have closed their output and exited. When
+     * waiting for any process, stops after the first.
+     */
+    auto reap = [this, any, &results]() -> bool {
+        bool open = false;
+
+        for (auto it = _running.begin(); it != _running.end();) {
+            Process *process = it->second.get();
+            if (process->outputDescriptor != -1 || process->errorDescriptor != -1) {
+                ++it;
+                continue;
+            }
+
+            int status;
+            struct rusage usage;
+            pid_t pid;
+            while ((pid = ::wait4(process->pid, &status, WNOHANG, &usage)) == -1 && errno == EINTR) { }
+            if (pid == 0) {
+                /* Output is closed but the process is still running. */
+                open = true;
+                ++it;
+                continue;
+            }
+
+            ext::optional<int> exitCode;
+            uint64_t userTime = 0;
+            uint64_t systemTime = 0;
+            uint64_t maximumResidentSize = 0;
+            if (pid == process->pid) {
+                if (WIFEXITED(status)) {
+                    exitCode = WEXITSTATUS(status);
+                }
+
+                userTime = Microseconds(usage.ru_utime);
+                systemTime = Microseconds(usage.ru_stime);
+#if defined(__APPLE__)
+                maximumResidentSize = static_cast<uint64_t>(usage.ru_maxrss);
+#else
+                maximumResidentSize = static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+            }
+
+            results.push_back({ it->first, Result(exitCode, process->output, process->error, userTime, systemTime, maximumResidentSize) });
+            it = _running.erase(it);
+
+            if (any) {
+                break;
+            }
+        }
+
+        return open;
+    };
+
+    while (true) {
+        bool exiting = reap();
+        if (!results.empty() || _running.empty()) {
+            break;
+        }
+
+        std::vector<struct pollfd> descriptors;
+        std::vector<std::pair<std::string *, int *>> targets;
+        std::vector<OutputHandler const *> handlers;
+        for (auto const &entry : _running) {
+            Process *process = entry.second.get();
+            if (process->outputDescriptor != -1) {
+                descriptors.push_back({ process->outputDescriptor, POLLIN, 0 });
+                targets.push_back({ &process->output, &process->outputDescriptor });
+                handlers.push_back(process->outputHandler ? &process->outputHandler : nullptr);
+            }
+            if (process->errorDescriptor != -1) {
+                descriptors.push_back({ process->errorDescriptor, POLLIN, 0 });
+                targets.push_back({ &process->error, &process->errorDescriptor });
+                handlers.push_back(nullptr);
+            }
+        }
+
+        /* Check back soon for processes that closed output but haven't exited. */
+        int wait = (exiting && timeout != 0 ? 10 : timeout);
+        int ready = ::poll(descriptors.data(), descriptors.size(), wait);
+        if (ready < 0 && errno != EINTR) {
+            ::perror("poll");
+            break;
+        }
+
+        for (size_t n = 0; ready > 0 && n < descriptors.size(); n++) {
+            if (descriptors[n].revents == 0) {
+                continue;
+            }
+
+            char buffer[16384];
+            ssize_t size = ::read(descriptors[n].fd, buffer, sizeof(buffer));
+            if (size > 0) {
+                if (handlers[n] != nullptr) {
+                    (*handlers[n])(std::string(buffer, static_cast<size_t>(size)));
+                } else {
+                    targets[n].first->append(buffer, static_cast<size_t>(size));
+                }
+            } else if (size == 0 || (errno != EAGAIN && errno != EINTR)) {
+                /* End of output. */
+                ::close(descriptors[n].fd);
+                *targets[n].second = -1;
+            }
+        }
+
+        if (timeout == 0) {
+            reap();
+            break;
+        }
+    }
+#endif
+
+    return results;
+}
+
+std::vector<std::pair<AsyncLauncher::Identifier, AsyncLauncher::Result>> AsyncLauncher::
+poll()
+{
+    return collect(0, false);
+}
+
+ext::optional<std::pair<AsyncLauncher::Identifier, AsyncLauncher::Result>> AsyncLauncher::
+wait()
+{
+    std::vector<std::pair<Identifier, Result>> results = collect(-1, true);
+    if (results.empty()) {
+        return ext::nullopt;
+    }
+
+    return results.front();
+}
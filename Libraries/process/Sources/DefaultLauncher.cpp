@@ -8,20 +8,17 @@
  */
 
 #include <process/DefaultLauncher.h>
+#include <process/AsyncLauncher.h>
 #include <process/Context.h>
 #include <libutil/Filesystem.h>
 
 #if _WIN32
 #include <windows.h>
-#else
-#include <fcntl.h>
-#include <sys/wait.h>
-#include <unistd.h>
 #endif
 
-// In most cases, size of pipe will be greater than one page,
-#define PIPE_BUFFER_SIZE 4096
+#include <cstdio>
 
+using process::AsyncLauncher;
 using process::DefaultLauncher;
 using process::Context;
 using libutil::Filesystem;
@@ -162,109 +159,40 @@ launch(Filesystem *filesystem, Context const *context)
     }
 #else
     /*
-     * Extract input data for exec, so no C++ is required after fork.
+     * Forward output as it is read, so progress from long-running tools is
+     * shown. Only whole lines are written, so output from processes launched
+     * at the same time from other threads interleaves by line, not within one.
      */
-    std::string path = context->executablePath();
-    if (!filesystem->isExecutable(path)) {
-        return ext::nullopt;
-    }
-    char const *cPath = path.c_str();
-
-    std::string directory = context->currentDirectory();
-    char const *cDirectory = directory.c_str();
-
-    /* Compute command-line arguments. */
-    std::vector<char const *> execArgs;
-    execArgs.push_back(cPath);
+    std::string pending;
+    auto forward = [&pending](std::string const &output) {
+        pending += output;
+
+        std::string::size_type end = pending.rfind('\n');
+        if (end != std::string::npos) {
+            fwrite(pending.data(), end + 1, 1, stdout);
+            fflush(stdout);
+            pending.erase(0, end + 1);
+        }
+    };
 
-    std::vector<std::string> arguments = context->commandLineArguments();
-    for (std::string const &argument : arguments) {
-        execArgs.push_back(argument.c_str());
+    /* Combine error into output in the child, keeping the order they were written. */
+    AsyncLauncher launcher;
+    if (!launcher.start(filesystem, context, true, forward)) {
+        return ext::nullopt;
     }
 
-    execArgs.push_back(nullptr);
-    char *const *cExecArgs = const_cast<char *const *>(execArgs.data());
+    ext::optional<std::pair<AsyncLauncher::Identifier, AsyncLauncher::Result>> result = launcher.wait();
 
-    /* Compute environment variables. */
-    std::vector<std::string> envValues;
-    for (auto const &value : context->environmentVariables()) {
-        envValues.push_back(value.first + "=" + value.second);
+    /* Anything after the last line. */
+    if (!pending.empty()) {
+        fwrite(pending.data(), pending.size(), 1, stdout);
+        fflush(stdout);
     }
 
-    std::vector<char const *> execEnv;
-    for (auto const &value : envValues) {
-        execEnv.push_back(value.c_str());
-    }
-    execEnv.push_back(nullptr);
-    char *const *cExecEnv = const_cast<char *const *>(execEnv.data());
-
-    /* Setup parent-child stdout/stderr pipe. */
-    int pfd[2];
-    bool pipe_setup_success = true;
-    if (pipe(pfd) == -1) {
-        ::perror("pipe");
-        pipe_setup_success = false;
-    }
-
-    /*
-     * Fork new process.
-     */
-    pid_t pid = fork();
-    if (pid < 0) {
-        /* Fork failed. */
+    if (!result) {
         return ext::nullopt;
-    } else if (pid == 0) {
-        /* Fork succeeded, new process. */
-        if (pipe_setup_success) {
-            /* Setup pipe to parent, redirecting both stdout and stderr */
-            dup2(pfd[1], STDOUT_FILENO);
-            dup2(pfd[1], STDERR_FILENO);
-            close(pfd[0]);
-            close(pfd[1]);
-        } else {
-            /* No parent-child pipe setup, just ignore outputs from child */
-            int nullfd = open("/dev/null", O_WRONLY);
-            if (nullfd == -1) {
-                ::perror("open");
-                ::_exit(1);
-            }
-            dup2(nullfd, STDOUT_FILENO);
-            dup2(nullfd, STDERR_FILENO);
-            close(nullfd);
-        }
-
-        if (::chdir(cDirectory) == -1) {
-            ::perror("chdir");
-            ::_exit(1);
-        }
-
-        ::execve(cPath, cExecArgs, cExecEnv);
-        ::_exit(-1);
-
-        return ext::nullopt;
-    } else {
-        /* Fork succeeded, existing process. */
-        if (pipe_setup_success) {
-            close(pfd[1]);
-            /* Read child's stdout/stderr through pipe, and output stdout */
-            while (true) {
-                char pin[PIPE_BUFFER_SIZE];
-                int readlen = read(pfd[0], &pin, sizeof(pin));
-                if (readlen > 0) {
-                    fwrite(pin, readlen, 1, stdout);
-                } else {
-                    if (readlen != 0) {
-                        ::perror("read");
-                    }
-                    break;
-                }
-            }
-            close(pfd[0]);
-        }
-
-        int status;
-        ::waitpid(pid, &status, 0);
-        return WEXITSTATUS(status);
     }
+
+    return result->second.exitCode();
 #endif
 }
@@ -0,0 +1,129 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <gtest/gtest.h>
+#include <process/AsyncLauncher.h>
+#include <process/MemoryContext.h>
+#include <libutil/DefaultFilesystem.h>
+
+using process::AsyncLauncher;
+using process::MemoryContext;
+using libutil::DefaultFilesystem;
+
+static MemoryContext
+Shell(std::string const &script)
+{
+    return MemoryContext("/bin/sh", "/", { "-c", script }, { });
+}
+
+TEST(AsyncLauncher, WaitAny)
+{
+    DefaultFilesystem filesystem;
+    AsyncLauncher launcher;
+
+    /* Both run at once; each keeps its own output and error. */
+    MemoryContext slow = Shell("echo slow; sleep 0.2; echo slow error >&2; exit 3");
+    MemoryContext fast = Shell("echo fast; echo fast error >&2");
+    ext::optional<AsyncLauncher::Identifier> slowIdentifier = launcher.start(&filesystem, &slow);
+    ext::optional<AsyncLauncher::Identifier> fastIdentifier = launcher.start(&filesystem, &fast);
+    ASSERT_TRUE(slowIdentifier);
+    ASSERT_TRUE(fastIdentifier);
+    EXPECT_EQ(2u, launcher.running());
+
+    auto first = launcher.wait();
+    ASSERT_TRUE(first);
+    EXPECT_EQ(*fastIdentifier, first->first);
+    EXPECT_EQ(ext::optional<int>(0), first->second.exitCode());
+    EXPECT_EQ("fast\n", first->second.output());
+    EXPECT_EQ("fast error\n", first->second.error());
+
+    auto second = launcher.wait();
+    ASSERT_TRUE(second);
+    EXPECT_EQ(*slowIdentifier, second->first);
+    EXPECT_EQ(ext::optional<int>(3), second->second.exitCode());
+    EXPECT_EQ("slow\n", second->second.output());
+    EXPECT_EQ("slow error\n", second->second.error());
+    EXPECT_GT(second->second.maximumResidentSize(), 0u);
+
+    /* Nothing left to wait for. */
+    EXPECT_EQ(0u, launcher.running());
+    EXPECT_FALSE(launcher.wait());
+}
+
+TEST(AsyncLauncher, CombineError)
+{
+    DefaultFilesystem filesystem;
+    AsyncLauncher launcher;
+
+    /* Output and error are kept in the order they were written. */
+    MemoryContext context = Shell("echo one; echo two >&2; echo three");
+    ASSERT_TRUE(launcher.start(&filesystem, &context, true));
+
+    auto result = launcher.wait();
+    ASSERT_TRUE(result);
+    EXPECT_EQ(ext::optional<int>(0), result->second.exitCode());
+    EXPECT_EQ("one\ntwo\nthree\n", result->second.output());
+    EXPECT_EQ("", result->second.error());
+}
+
+TEST(AsyncLauncher, OutputHandler)
+{
+    DefaultFilesystem filesystem;
+    AsyncLauncher launcher;
+
+    /* Output reaches the handler as it is written, not when the process finishes. */
+    std::vector<std::string> received;
+    MemoryContext context = Shell("echo one; sleep 0.2; echo two");
+    ASSERT_TRUE(launcher.start(&filesystem, &context, false, [&](std::string const &output) {
+        received.push_back(output);
+    }));
+
+    auto result = launcher.wait();
+    ASSERT_TRUE(result);
+    EXPECT_EQ(ext::optional<int>(0), result->second.exitCode());
+    EXPECT_EQ(std::vector<std::string>({ "one\n", "two\n" }), received);
+    EXPECT_EQ("", result->second.output());
+}
+
+TEST(AsyncLauncher, Poll)
+{
+    DefaultFilesystem filesystem;
+    AsyncLauncher launcher;
+
+    /* Large output must not block the process before it is read. */
+    MemoryContext context = Shell("i=0; while [ $i -lt 2000 ]; do echo 0123456789012345678901234567890123456789; i=$((i+1)); done");
+    ASSERT_TRUE(launcher.start(&filesystem, &context));
+
+    std::vector<std::pair<AsyncLauncher::Identifier, AsyncLauncher::Result>> results;
+    while (results.empty()) {
+        results = launcher.poll();
+    }
+
+    ASSERT_EQ(1u, results.size());
+    EXPECT_EQ(ext::optional<int>(0), results.front().second.exitCode());
+    EXPECT_EQ(2000u * 41u, results.front().second.output().size());
+}
+
+TEST(AsyncLauncher, Failure)
+{
+    DefaultFilesystem filesystem;
+    AsyncLauncher launcher;
+
+    /* Missing executables can't start. */
+    MemoryContext missing = MemoryContext("/nonexistent/executable", "/", { }, { });
+    EXPECT_FALSE(launcher.start(&filesystem, &missing));
+    EXPECT_EQ(0u, launcher.running());
+
+    /* Killed processes have no exit code. */
+    MemoryContext killed = Shell("kill -9 $$");
+    ASSERT_TRUE(launcher.start(&filesystem, &killed));
+    auto result = launcher.wait();
+    ASSERT_TRUE(result);
+    EXPECT_FALSE(result->second.exitCode());
+}
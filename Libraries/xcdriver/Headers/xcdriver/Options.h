@@ -49,6 +49,9 @@ private:
     ext::optional<std::string> _formatter;
     ext::optional<std::string> _executor;
     ext::optional<bool>        _generate;
+    ext::optional<bool>        _forceRebuild;
+    ext::optional<std::string> _actionCache;
+    ext::optional<int>         _actionCacheSize;
 
 private:
     ext::optional<bool>        _parallelizeTargets;
@@ -158,6 +161,15 @@ public:
     /* Extension. */
     bool generate() const
     { return _generate.value_or(false); }
+    /* Extension. */
+    bool forceRebuild() const
+    { return _forceRebuild.value_or(false); }
+    /* Extension. */
+    ext::optional<std::string> const &actionCache() const
+    { return _actionCache; }
+    /* Extension. */
+    ext::optional<int> actionCacheSize() const
+    { return _actionCacheSize; }
 
 public:
     bool parallelizeTargets() const
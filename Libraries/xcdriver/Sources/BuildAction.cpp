@@ -10,6 +10,7 @@
 #include <xcdriver/BuildAction.h>
 #include <xcdriver/Action.h>
 #include <xcdriver/Options.h>
+#include <xcexecution/ActionCache.h>
 #include <xcexecution/NinjaExecutor.h>
 #include <xcexecution/SimpleExecutor.h>
 #include <xcformatter/DefaultFormatter.h>
@@ -17,6 +18,8 @@
 #include <builtin/Registry.h>
 #include <libutil/Base.h>
 #include <libutil/Filesystem.h>
+#include <libutil/FSUtil.h>
+#include <libutil/WorkQueue.h>
 #include <process/Context.h>
 
 #if !_WIN32
@@ -26,6 +29,7 @@
 using xcdriver::BuildAction;
 using xcdriver::Options;
 using libutil::Filesystem;
+using libutil::FSUtil;
 
 BuildAction::
 BuildAction()
@@ -64,11 +68,18 @@ CreateExecutor(
     ext::optional<std::string> const &executor,
     std::shared_ptr<xcformatter::Formatter> const &formatter,
     bool dryRun,
-    bool generate)
+    bool generate,
+    bool forceRebuild,
+    ext::optional<int> const &jobs,
+    bool parallelizeTargets,
+    std::shared_ptr<xcexecution::ActionCache> const &actionCache)
 {
     if (!executor || *executor == "simple") {
+        /* Like xcodebuild, default to one job per processor. */
+        size_t jobCount = (jobs && *jobs > 0 ? static_cast<size_t>(*jobs) : libutil::WorkQueue::DefaultThreadCount());
+
         auto registry = builtin::Registry::Default();
-        auto executor = xcexecution::SimpleExecutor::Create(formatter, dryRun, registry);
+        auto executor = xcexecution::SimpleExecutor::Create(formatter, dryRun, registry, jobCount, parallelizeTargets, !forceRebuild, actionCache);
         return libutil::static_unique_pointer_cast<xcexecution::Executor>(std::move(executor));
     } else if (*executor == "ninja") {
         auto executor = xcexecution::NinjaExecutor::Create(formatter, dryRun, generate);
@@ -93,8 +104,22 @@ VerifySupportedOptions(Options const &options)
         fprintf(stderr, "warning: destination option not implemented\n");
     }
 
-    if (options.parallelizeTargets() || options.jobs()) {
-        fprintf(stderr, "warning: job control option not implemented\n");
+    if (options.jobs() && *options.jobs() <= 0) {
+        fprintf(stderr, "error: number of jobs must be positive\n");
+        return false;
+    }
+
+    if ((options.parallelizeTargets() || options.jobs()) && options.executor() && *options.executor() != "simple") {
+        fprintf(stderr, "warning: job control option not implemented for executor %s\n", options.executor()->c_str());
+    }
+
+    if (options.actionCacheSize() && *options.actionCacheSize() <= 0) {
+        fprintf(stderr, "error: action cache size must be positive\n");
+        return false;
+    }
+
+    if (options.actionCache() && options.executor() && *options.executor() != "simple") {
+        fprintf(stderr, "warning: action cache not implemented for executor %s\n", options.executor()->c_str());
     }
 
     if (options.enableAddressSanitizer() || options.enableThreadSanitizer() || options.enableCodeCoverage()) {
@@ -144,10 +169,20 @@ Run(process::User const *user, process::Context const *processContext, process::
         return -1;
     }
 
+    /*
+     * Open the action cache, if one is used. Without a size, it is limited to a few gigabytes.
+     */
+    std::shared_ptr<xcexecution::ActionCache> actionCache;
+    if (options.actionCache()) {
+        std::string path = FSUtil::ResolveRelativePath(*options.actionCache(), processContext->currentDirectory());
+        uint64_t megabytes = static_cast<uint64_t>(options.actionCacheSize().value_or(5 * 1024));
+        actionCache = xcexecution::ActionCache::Open(filesystem, path, megabytes * 1024 * 1024);
+    }
+
     /*
      * Create the executor used to perform the build.
      */
-    std::unique_ptr<xcexecution::Executor> executor = CreateExecutor(options.executor(), formatter, options.dryRun(), options.generate());
+    std::unique_ptr<xcexecution::Executor> executor = CreateExecutor(options.executor(), formatter, options.dryRun(), options.generate(), options.forceRebuild(), options.jobs(), options.parallelizeTargets(), actionCache);
     if (executor == nullptr) {
         fprintf(stderr, "error: unknown executor '%s'\n", options.executor()->c_str());
         return -1;
@@ -162,6 +197,9 @@ Run(process::User const *user, process::Context const *processContext, process::
         return -1;
     }
 
+    /* Only builds write the specification cache; other actions only read it. */
+    buildEnvironment->saveSpecificationCache(filesystem);
+
     /* The build settings passed in on the command line override all others. */
     std::vector<pbxsetting::Level> overrideLevels = Action::CreateOverrideLevels(
         processContext,
@@ -72,6 +72,20 @@ Run(process::Context const *processContext)
         "    -generate                                   "
         "specify that an execution engine based on generating another build "
         "language should regenerate\n");
+    fprintf(
+        stdout,
+        "    -forceRebuild                               "
+        "run every build task, even if its outputs are up to date\n");
+    fprintf(
+        stdout,
+        "    -actionCache PATH                           "
+        "restore the outputs of build tasks from, and store them in, the "
+        "cache at PATH\n");
+    fprintf(
+        stdout,
+        "    -actionCacheSize MEGABYTES                  "
+        "limit the action cache to MEGABYTES, removing the least recently "
+        "used outputs first\n");
     fprintf(
         stdout,
         "    -project NAME                               "
@@ -125,11 +139,11 @@ Run(process::Context const *processContext)
     fprintf(
         stdout,
         "    -parallelizeTargets                         "
-        "not yet implemented\n");
+        "build independent targets in parallel\n");
     fprintf(
         stdout,
         "    -jobs NUMBER                                "
-        "not yet implemented\n");
+        "run at most NUMBER build tasks at once\n");
     fprintf(
         stdout,
         "    -dry-run                                    "
@@ -0,0 +1,199 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef __xcexecution_ActionCache_h
+#define __xcexecution_ActionCache_h
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <ext/optional>
+
+namespace libutil { class Filesystem; }
+namespace pbxbuild { namespace Tool { class Invocation; } }
+
+namespace xcexecution {
+
+/*
+ * Local, content-addressed cache of invocation outputs. An invocation is
+ * keyed on its signature and the contents of its inputs; the contents of
+ * its outputs are stored once each, by hash, in the cache directory. When
+ * the cache grows past its maximum size, the least recently used entries
+ * are removed.
+ *
+ * Paths within an invocation's working directory, the source root of its
+ * project, are keyed and stored relative to it, so sources checked out in
+ * different places share entries.
+ */
+class ActionCache {
+public:
+    /*
+     * The outputs produced for a key, and the inputs the invocation
+     * discovered through its dependency info when it ran.
+     */
+    class Entry {
+    private:
+        uint64_t                                     _used;
+        uint64_t                                     _size;
+        std::unordered_map<std::string, std::string> _outputs;
+        std::vector<std::string>                     _executableOutputs;
+        std::unordered_map<std::string, std::string> _dependencyInputs;
+
+    public:
+        Entry(
+            uint64_t used,
+            uint64_t size,
+            std::unordered_map<std::string, std::string> const &outputs,
+            std::vector<std::string> const &executableOutputs,
+            std::unordered_map<std::string, std::string> const &dependencyInputs);
+
+    public:
+        /*
+         * When the entry was last stored or restored. Larger is more recent.
+         */
+        uint64_t used() const
+        { return _used; }
+        uint64_t &used()
+        { return _used; }
+
+        /*
+         * Total size of the outputs.
+         */
+        uint64_t size() const
+        { return _size; }
+
+    public:
+        /*
+         * Output paths, and the hashes of their contents.
+         */
+        std::unordered_map<std::string, std::string> const &outputs() const
+        { return _outputs; }
+
+        /*
+         * Outputs that should be made executable when restored.
+         */
+        std::vector<std::string> const &executableOutputs() const
+        { return _executableOutputs; }
+
+        /*
+         * Inputs found in dependency info, and the hashes of their contents.
+         */
+        std::unordered_map<std::string, std::string> const &dependencyInputs() const
+        { return _dependencyInputs; }
+    };
+
+private:
+    /*
+     * The hash of a file's contents, valid while its modification time
+     * and size are unchanged.
+     */
+    struct FileHash {
+        uint64_t    modificationTime;
+        uint64_t    size;
+        std::string hash;
+    };
+
+private:
+    std::string                            _path;
+    uint64_t                               _maximumSize;
+    std::mutex                             _mutex;
+    std::unordered_map<std::string, Entry> _entries;
+    uint64_t                               _used;
+    uint64_t                               _size;
+    bool                                   _modified;
+
+private:
+    mutable std::mutex                                _hashesMutex;
+    mutable std::unordered_map<std::string, FileHash> _hashes;
+
+public:
+    ActionCache(std::string const &path, uint64_t maximumSize);
+
+public:
+    /*
+     * The directory the cache is stored in.
+     */
+    std::string const &path() const
+    { return _path; }
+
+    /*
+     * The size the cache is trimmed to when it grows larger.
+     */
+    uint64_t maximumSize() const
+    { return _maximumSize; }
+
+public:
+    /*
+     * Hash the contents of a file. Files are only read again when their
+     * modification time or size changes. Not available for directories.
+     */
+    ext::optional<std::string>
+    hashFile(libutil::Filesystem const *filesystem, std::string const &path) const;
+
+public:
+    /*
+     * The cache key for an invocation, run as the executable found for it
+     * with its full environment. Covers the contents of its inputs, input
+     * dependencies, and phony inputs. Not available if the invocation has
+     * no inputs or outputs, if any input is not a readable file, or if any
+     * other input is a directory.
+     */
+    ext::optional<std::string>
+    key(
+        libutil::Filesystem const *filesystem,
+        pbxbuild::Tool::Invocation const &invocation,
+        std::string const &executable,
+        std::unordered_map<std::string, std::string> const &environment) const;
+
+    /*
+     * Restore the outputs stored for a key. Fails if nothing is stored, if
+     * any dependency info input has changed since, or if any stored output
+     * no longer matches its hash. Outputs are restored within the source
+     * root of the invocation. On success, returns the dependency info
+     * inputs recorded when the outputs were stored.
+     */
+    ext::optional<std::vector<std::string>>
+    restore(
+        libutil::Filesystem *filesystem,
+        std::string const &key,
+        pbxbuild::Tool::Invocation const &invocation);
+
+    /*
+     * Store the outputs of an invocation that completed successfully.
+     * Outputs that are not regular files prevent storing anything.
+     */
+    bool
+    store(
+        libutil::Filesystem *filesystem,
+        std::string const &key,
+        pbxbuild::Tool::Invocation const &invocation,
+        std::vector<std::string> const &dependencyInputs);
+
+public:
+    /*
+     * Write the cache index, after merging in entries saved by other
+     * builds and removing least recently used entries until the cache
+     * fits within its maximum size.
+     */
+    bool save(libutil::Filesystem *filesystem);
+
+public:
+    /*
+     * Open the cache in a directory. The directory is created when the
+     * cache is first saved.
+     */
+    static std::shared_ptr<ActionCache>
+    Open(libutil::Filesystem const *filesystem, std::string const &path, uint64_t maximumSize);
+};
+
+}
+
+#endif // !__xcexecution_ActionCache_h
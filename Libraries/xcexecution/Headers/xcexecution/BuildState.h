@@ -0,0 +1,100 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef __xcexecution_BuildState_h
+#define __xcexecution_BuildState_h
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <ext/optional>
+
+namespace pbxbuild { namespace Tool { class Invocation; } }
+
+namespace xcexecution {
+
+/*
+ * Persistent record of the invocations that completed successfully for a
+ * target. Used to skip invocations that are up to date in later builds.
+ */
+class BuildState {
+public:
+    /*
+     * What is known about an invocation from the last time it ran.
+     */
+    class Entry {
+    private:
+        std::string              _signature;
+        std::vector<std::string> _dependencyInputs;
+
+    public:
+        Entry(std::string const &signature, std::vector<std::string> const &dependencyInputs);
+
+    public:
+        /*
+         * Hash of everything that affects what the invocation does, other
+         * than the contents of its inputs. See `Signature()`.
+         */
+        std::string const &signature() const
+        { return _signature; }
+
+        /*
+         * Inputs discovered from the dependency info the invocation wrote.
+         */
+        std::vector<std::string> const &dependencyInputs() const
+        { return _dependencyInputs; }
+    };
+
+private:
+    std::unordered_map<std::string, Entry> _entries;
+
+public:
+    BuildState();
+
+public:
+    /*
+     * The entry for an invocation, if it ran before.
+     */
+    Entry const *entry(pbxbuild::Tool::Invocation const &invocation) const;
+
+    /*
+     * Record an invocation that completed successfully.
+     */
+    void insert(pbxbuild::Tool::Invocation const &invocation, std::vector<std::string> const &dependencyInputs);
+
+    /*
+     * Forget an invocation, so it will run again.
+     */
+    void remove(pbxbuild::Tool::Invocation const &invocation);
+
+public:
+    /*
+     * Serialize the build state.
+     */
+    std::vector<uint8_t> serialize() const;
+
+public:
+    /*
+     * Load build state from serialized data.
+     */
+    static ext::optional<BuildState>
+    Deserialize(std::vector<uint8_t> const &contents);
+
+public:
+    /*
+     * Hash of an invocation's executable, arguments, environment, and
+     * working directory. If any change, the invocation must run again.
+     */
+    static std::string
+    Signature(pbxbuild::Tool::Invocation const &invocation);
+};
+
+}
+
+#endif // !__xcexecution_BuildState_h
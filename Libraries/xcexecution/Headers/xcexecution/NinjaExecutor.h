@@ -15,6 +15,8 @@
 #include <pbxbuild/Tool/Invocation.h>
 #include <pbxbuild/DirectedGraph.h>
 
+#include <set>
+
 namespace ninja { class Writer; }
 
 namespace xcexecution {
@@ -59,7 +61,9 @@ private:
         pbxproj::PBX::Target::shared_ptr const &target,
         pbxbuild::Target::Environment const &targetEnvironment,
         std::vector<pbxbuild::Tool::AuxiliaryFile> const &auxiliaryFiles,
-        std::vector<pbxbuild::Tool::Invocation> const &invocations);
+        std::vector<pbxbuild::Tool::Invocation> const &invocations,
+        std::vector<std::string> const &scannedDirectories,
+        std::set<std::string> *directories);
 
 private:
     bool buildAuxiliaryFile(
@@ -70,11 +74,14 @@ private:
         std::map<std::string, pbxbuild::Tool::AuxiliaryFile::Chunk const *> &auxiliaryFileChunks);
     bool buildInvocation(
         ninja::Writer *writer,
+        libutil::Filesystem const *filesystem,
         pbxbuild::Tool::Invocation const &invocation,
         std::string const &executablePath,
         std::string const &dependencyInfoToolPath,
         std::string const &temporaryDirectory,
-        std::string const &after);
+        std::vector<std::string> const &buildRoots,
+        std::string const &after,
+        std::set<std::string> *directories);
 
 public:
     static std::unique_ptr<NinjaExecutor>
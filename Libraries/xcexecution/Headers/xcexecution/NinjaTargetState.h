@@ -0,0 +1,93 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef __xcexecution_NinjaTargetState_h
+#define __xcexecution_NinjaTargetState_h
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace libutil { class Filesystem; }
+
+namespace xcexecution {
+
+/*
+ * What a target's Ninja file was generated from, and where it was written.
+ * While none of that changes, the Ninja file can be used again as-is.
+ */
+class NinjaTargetState {
+private:
+    std::string              _hash;
+    std::string              _ninja;
+    std::vector<std::string> _directories;
+
+public:
+    NinjaTargetState(std::string const &hash, std::string const &ninja, std::vector<std::string> const &directories);
+
+public:
+    /*
+     * Hash of everything the Ninja file was generated from.
+     */
+    std::string const &hash() const
+    { return _hash; }
+
+    /*
+     * Path to the Ninja file.
+     */
+    std::string const &ninja() const
+    { return _ninja; }
+
+    /*
+     * Directories whose contents are reflected in the Ninja file.
+     */
+    std::vector<std::string> const &directories() const
+    { return _directories; }
+
+public:
+    /*
+     * Hash of what every target's Ninja file depends on: the generator and
+     * its parameters, the process environment, and the developer paths the
+     * SDKs, toolchains, and specifications are loaded from.
+     */
+    static std::string
+    GeneratorHash(
+        libutil::Filesystem const *filesystem,
+        std::string const &executablePath,
+        std::string const &parametersHash,
+        std::unordered_map<std::string, std::string> const &environmentVariables,
+        std::vector<std::string> const &developerPaths);
+
+    /*
+     * Hash of a target's inputs, combined with the current contents of the
+     * directories its Ninja file reflects. Directories are not recursed into.
+     */
+    static std::string
+    Hash(
+        libutil::Filesystem const *filesystem,
+        std::string const &inputsHash,
+        std::vector<std::string> const &directories);
+
+public:
+    /*
+     * Read the state of each target, by key. Missing or invalid state is empty.
+     */
+    static std::unordered_map<std::string, NinjaTargetState>
+    Read(libutil::Filesystem const *filesystem, std::string const &path);
+
+    /*
+     * Write the state of each target, by key.
+     */
+    static bool
+    Write(libutil::Filesystem *filesystem, std::unordered_map<std::string, NinjaTargetState> const &state, std::string const &path);
+};
+
+}
+
+#endif // !__xcexecution_NinjaTargetState_h
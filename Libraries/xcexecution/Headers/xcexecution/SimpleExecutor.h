@@ -11,21 +11,48 @@
 #define __xcexecution_SimpleExecutor_h
 
 #include <xcexecution/Executor.h>
+#include <pbxbuild/DirectedGraph.h>
 #include <pbxbuild/Tool/AuxiliaryFile.h>
 #include <builtin/Registry.h>
 
+#include <functional>
+#include <mutex>
+
+namespace libutil { class WorkQueue; }
+
 namespace xcexecution {
 
+class ActionCache;
+class BuildState;
+
 /*
- * Simple executor that simply runs invocations in sequence. Advanced features
- * like incremental builds, dependency info, and such are not supported.
+ * Simple executor that runs invocations as soon as the invocations they
+ * depend on have finished, up to `jobs` at once. With `parallelizeTargets`,
+ * independent targets are also built at the same time, sharing the same
+ * job limit. With `incremental`, invocations whose outputs are newer than
+ * their inputs (including inputs from dependency info) are skipped; what
+ * ran is recorded in a build state file in each target's temporary directory.
+ * With an action cache, the outputs of invocations are restored from the cache
+ * when it has them, and stored in the cache after invocations run.
  */
 class SimpleExecutor : public Executor {
 private:
-    builtin::Registry _builtins;
+    class JobSlots;
+    class BuiltinLocks;
+
+private:
+    builtin::Registry                   _builtins;
+    size_t                              _jobs;
+    bool                                _parallelizeTargets;
+    bool                                _incremental;
+    std::shared_ptr<ActionCache>        _actionCache;
+    std::shared_ptr<libutil::WorkQueue> _workQueue;
+    std::shared_ptr<JobSlots>           _jobSlots;
+    std::shared_ptr<std::mutex>         _formatterMutex;
+    std::shared_ptr<BuiltinLocks>       _builtinLocks;
 
 public:
-    SimpleExecutor(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, builtin::Registry const &builtins);
+    SimpleExecutor(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, builtin::Registry const &builtins, size_t jobs, bool parallelizeTargets, bool incremental, std::shared_ptr<ActionCache> const &actionCache);
     ~SimpleExecutor();
 
 public:
@@ -37,17 +64,39 @@ public:
         pbxbuild::Build::Environment const &buildEnvironment,
         Parameters const &buildParameters);
 
+private:
+    /*
+     * Format and print a message. Formatters are not thread safe, so only
+     * one message is formatted at a time.
+     */
+    void print(std::function<std::string()> const &message);
+
+private:
+    bool buildTargets(
+        process::Context const *processContext,
+        process::Launcher *processLauncher,
+        libutil::Filesystem *filesystem,
+        pbxbuild::Build::Environment const &buildEnvironment,
+        pbxbuild::Build::Context const &buildContext,
+        pbxbuild::DirectedGraph<pbxproj::PBX::Target::shared_ptr> const &targetGraph,
+        std::vector<pbxproj::PBX::Target::shared_ptr> const &orderedTargets);
+
 public:
     bool writeAuxiliaryFiles(
         libutil::Filesystem *filesystem,
         std::vector<pbxbuild::Tool::AuxiliaryFile> const &auxiliaryFiles);
+    /*
+     * The filesystem is used from several threads at once, so it must be
+     * safe to share between them, such as a `SynchronizedFilesystem`.
+     */
     std::pair<bool, std::vector<pbxbuild::Tool::Invocation>> performInvocations(
         process::Context const *processContext,
         process::Launcher *processLauncher,
         libutil::Filesystem *filesystem,
         std::vector<std::string> const &executablePaths,
         std::vector<pbxbuild::Tool::Invocation> const &orderedInvocations,
-        bool createProductStructure);
+        bool createProductStructure,
+        BuildState *buildState);
     std::pair<bool, std::vector<pbxbuild::Tool::Invocation>> buildTarget(
         process::Context const *processContext,
         process::Launcher *processLauncher,
@@ -59,7 +108,7 @@ public:
 
 public:
     static std::unique_ptr<SimpleExecutor>
-    Create(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, builtin::Registry const &builtins);
+    Create(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, builtin::Registry const &builtins, size_t jobs, bool parallelizeTargets, bool incremental, std::shared_ptr<ActionCache> const &actionCache);
 };
 
 }
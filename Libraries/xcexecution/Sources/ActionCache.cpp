@@ -0,0 +1,647 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <xcexecution/ActionCache.h>
+#include <pbxbuild/Tool/Invocation.h>
+#include <plist/Array.h>
+#include <plist/Dictionary.h>
+#include <plist/Integer.h>
+#include <plist/String.h>
+#include <plist/Format/Binary.h>
+#include <libutil/Filesystem.h>
+#include <libutil/FSUtil.h>
+#include <libutil/md5.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <unordered_set>
+
+using xcexecution::ActionCache;
+using libutil::Filesystem;
+using libutil::FSUtil;
+using libutil::Permissions;
+
+/*
+ * Incremented when the index format changes; older indexes are ignored.
+ */
+static int64_t const ActionCacheVersion = 2;
+
+ActionCache::Entry::
+Entry(
+    uint64_t used,
+    uint64_t size,
+    std::unordered_map<std::string, std::string> const &outputs,
+    std::vector<std::string> const &executableOutputs,
+    std::unordered_map<std::string, std::string> const &dependencyInputs) :
+    _used             (used),
+    _size             (size),
+    _outputs          (outputs),
+    _executableOutputs(executableOutputs),
+    _dependencyInputs (dependencyInputs)
+{
+}
+
+ActionCache::
+ActionCache(std::string const &path, uint64_t maximumSize) :
+    _path       (path),
+    _maximumSize(maximumSize),
+    _used       (0),
+    _size       (0),
+    _modified   (false)
+{
+}
+
+static std::string
+Hash(uint8_t const *data, size_t size)
+{
+    md5_state_t state;
+    md5_init(&state);
+    md5_append(&state, reinterpret_cast<md5_byte_t const *>(data), size);
+
+    uint8_t digest[16];
+    md5_finish(&state, reinterpret_cast<md5_byte_t *>(&digest));
+
+    std::ostringstream ss;
+    ss << std::hex << std::setfill('0');
+    for (uint8_t byte : digest) {
+        ss << std::setw(2) << static_cast<int>(byte);
+    }
+    return ss.str();
+}
+
+ext::optional<std::string> ActionCache::
+hashFile(Filesystem const *filesystem, std::string const &path) const
+{
+    if (filesystem->type(path) == Filesystem::Type::Directory) {
+        return ext::nullopt;
+    }
+
+    ext::optional<uint64_t> modificationTime = filesystem->modificationTime(path);
+    ext::optional<uint64_t> size = filesystem->size(path);
+    if (modificationTime && size) {
+        std::lock_guard<std::mutex> lock(_hashesMutex);
+
+        auto it = _hashes.find(path);
+        if (it != _hashes.end() && it->second.modificationTime == *modificationTime && it->second.size == *size) {
+            return it->second.hash;
+        }
+    }
+
+    std::vector<uint8_t> contents;
+    if (!filesystem->read(&contents, path)) {
+        return ext::nullopt;
+    }
+
+    std::string hash = Hash(contents.data(), contents.size());
+    if (modificationTime && size) {
+        std::lock_guard<std::mutex> lock(_hashesMutex);
+        _hashes[path] = { *modificationTime, *size, hash };
+    }
+
+    return hash;
+}
+
+/*
+ * Stands in for the source root in keys and stored paths.
+ */
+static std::string const SourceRootPlaceholder = "$(SRCROOT)";
+
+/*
+ * Replace the source root wherever it appears in a string, such as an
+ * argument or environment value, so the key doesn't depend on it.
+ */
+static std::string
+SourceRelativeString(std::string const &string, std::string const &sourceRoot)
+{
+    if (sourceRoot.empty()) {
+        return string;
+    }
+
+    std::string result;
+    size_t start = 0;
+    size_t found = string.find(sourceRoot);
+    while (found != std::string::npos) {
+        size_t end = found + sourceRoot.size();
+        if (end == string.size() || string[end] == '/') {
+            result.append(string, start, found - start);
+            result += SourceRootPlaceholder;
+            start = end;
+            found = string.find(sourceRoot, end);
+        } else {
+            found = string.find(sourceRoot, found + 1);
+        }
+    }
+
+    result.append(string, start, std::string::npos);
+    return result;
+}
+
+/*
+ * A path within the source root, relative to the placeholder.
+ */
+static std::string
+SourceRelativePath(std::string const &path, std::string const &sourceRoot)
+{
+    if (!sourceRoot.empty() && path.compare(0, sourceRoot.size(), sourceRoot) == 0 && (path.size() == sourceRoot.size() || path[sourceRoot.size()] == '/')) {
+        return SourceRootPlaceholder + path.substr(sourceRoot.size());
+    }
+
+    return path;
+}
+
+/*
+ * The path for a stored path within the current source root.
+ */
+static std::string
+SourceAbsolutePath(std::string const &path, std::string const &sourceRoot)
+{
+    if (path.compare(0, SourceRootPlaceholder.size(), SourceRootPlaceholder) == 0) {
+        return sourceRoot + path.substr(SourceRootPlaceholder.size());
+    }
+
+    return path;
+}
+
+static std::string
+ObjectPath(std::string const &path, std::string const &hash)
+{
+    /* Spread objects across directories to keep each one small. */
+    return path + "/" + "objects" + "/" + hash.substr(0, 2) + "/" + hash;
+}
+
+static std::string
+IndexPath(std::string const &path)
+{
+    return path + "/" + "index.plist";
+}
+
+/*
+ * Append an input that is only sometimes present to a key. Missing inputs
+ * are recorded as such; directories can't be captured by their contents.
+ */
+static bool
+AppendOptionalInput(ActionCache const *cache, Filesystem const *filesystem, std::string const &path, std::string const &sourceRoot, std::string *key)
+{
+    ext::optional<Filesystem::Type> type = filesystem->type(path);
+    if (!type) {
+        *key += SourceRelativePath(path, sourceRoot);
+        *key += '\0';
+        *key += '\0';
+        return true;
+    }
+
+    ext::optional<std::string> hash = cache->hashFile(filesystem, path);
+    if (!hash) {
+        return false;
+    }
+
+    *key += SourceRelativePath(path, sourceRoot);
+    *key += '\0';
+    *key += *hash;
+    *key += '\0';
+    return true;
+}
+
+ext::optional<std::string> ActionCache::
+key(
+    Filesystem const *filesystem,
+    pbxbuild::Tool::Invocation const &invocation,
+    std::string const &executable,
+    std::unordered_map<std::string, std::string> const &environment) const
+{
+    /* Without both, what the invocation does can't be captured. */
+    if (invocation.inputs().empty() || invocation.outputs().empty()) {
+        return ext::nullopt;
+    }
+
+    std::string const &sourceRoot = invocation.workingDirectory();
+
+    /* What the invocation runs, and how. */
+    std::string key;
+    if (invocation.executable()) {
+        key += invocation.executable()->builtin().value_or(std::string());
+        key += '\0';
+        key += SourceRelativeString(invocation.executable()->external().value_or(std::string()), sourceRoot);
+        key += '\0';
+    }
+    for (std::string const &argument : invocation.arguments()) {
+        key += SourceRelativeString(argument, sourceRoot);
+        key += '\0';
+    }
+    key += '\0';
+
+    /* The tool found to run, and when it last changed. */
+    key += SourceRelativePath(executable, sourceRoot);
+    key += '\0';
+    if (FSUtil::IsAbsolutePath(executable)) {
+        if (ext::optional<uint64_t> modificationTime = filesystem->modificationTime(executable)) {
+            key += std::to_string(*modificationTime);
+        }
+    }
+    key += '\0';
+
+    /* The full environment the tool runs with, including inherited variables. */
+    std::map<std::string, std::string> sortedEnvironment = std::map<std::string, std::string>(environment.begin(), environment.end());
+    for (auto const &pair : sortedEnvironment) {
+        key += pair.first;
+        key += '=';
+        key += SourceRelativeString(pair.second, sourceRoot);
+        key += '\0';
+    }
+    key += '\0';
+
+    for (std::string const &input : invocation.inputs()) {
+        ext::optional<std::string> hash = hashFile(filesystem, input);
+        if (!hash) {
+            return ext::nullopt;
+        }
+
+        key += SourceRelativePath(input, sourceRoot);
+        key += '\0';
+        key += *hash;
+        key += '\0';
+    }
+    key += '\0';
+
+    /* Dependencies that are not arguments can still change what is produced. */
+    for (std::string const &inputDependency : invocation.inputDependencies()) {
+        if (!AppendOptionalInput(this, filesystem, inputDependency, sourceRoot, &key)) {
+            return ext::nullopt;
+        }
+    }
+    key += '\0';
+
+    for (std::string const &phonyInput : invocation.phonyInputs()) {
+        if (!AppendOptionalInput(this, filesystem, phonyInput, sourceRoot, &key)) {
+            return ext::nullopt;
+        }
+    }
+    key += '\0';
+
+    /* Outputs are part of the key; the same inputs can produce different outputs. */
+    for (std::string const &output : invocation.outputs()) {
+        key += SourceRelativePath(output, sourceRoot);
+        key += '\0';
+    }
+
+    return Hash(reinterpret_cast<uint8_t const *>(key.data()), key.size());
+}
+
+ext::optional<std::vector<std::string>> ActionCache::
+restore(Filesystem *filesystem, std::string const &key, pbxbuild::Tool::Invocation const &invocation)
+{
+    std::string const &sourceRoot = invocation.workingDirectory();
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto it = _entries.find(key);
+    if (it == _entries.end()) {
+        return ext::nullopt;
+    }
+    Entry &entry = it->second;
+
+    /* Headers and other discovered inputs aren't part of the key. */
+    std::vector<std::string> dependencyInputs;
+    for (auto const &pair : entry.dependencyInputs()) {
+        std::string path = SourceAbsolutePath(pair.first, sourceRoot);
+        ext::optional<std::string> hash = hashFile(filesystem, path);
+        if (!hash || *hash != pair.second) {
+            return ext::nullopt;
+        }
+
+        dependencyInputs.push_back(path);
+    }
+
+    /*
+     * Objects can be truncated by a crash, or removed by another build
+     * trimming the cache. Check every object before writing any output,
+     * and forget entries whose objects are no longer intact.
+     */
+    std::vector<std::pair<std::string, std::vector<uint8_t>>> outputs;
+    for (auto const &pair : entry.outputs()) {
+        std::string objectPath = ObjectPath(_path, pair.second);
+
+        std::vector<uint8_t> contents;
+        if (!filesystem->read(&contents, objectPath) || Hash(contents.data(), contents.size()) != pair.second) {
+            filesystem->removeFile(objectPath);
+
+            _size -= entry.size();
+            _entries.erase(it);
+            _modified = true;
+            return ext::nullopt;
+        }
+
+        outputs.push_back({ SourceAbsolutePath(pair.first, sourceRoot), std::move(contents) });
+    }
+
+    /*
+     * Outputs are copied, not linked: tools may modify their outputs in
+     * place, which would change the contents stored in the cache.
+     */
+    for (auto const &output : outputs) {
+        if (!filesystem->createDirectory(FSUtil::GetDirectoryName(output.first), true)) {
+            return ext::nullopt;
+        }
+
+        if (!filesystem->write(output.second, output.first)) {
+            return ext::nullopt;
+        }
+    }
+
+    for (std::string const &executableOutput : entry.executableOutputs()) {
+        std::string output = SourceAbsolutePath(executableOutput, sourceRoot);
+        Permissions permissions = Permissions(
+            { Permissions::Permission::Read, Permissions::Permission::Write, Permissions::Permission::Execute },
+            { Permissions::Permission::Read, Permissions::Permission::Execute },
+            { Permissions::Permission::Read, Permissions::Permission::Execute });
+        if (!filesystem->writeFilePermissions(output, Permissions::Operation::Set, permissions)) {
+            return ext::nullopt;
+        }
+    }
+
+    entry.used() = ++_used;
+    _modified = true;
+
+    return dependencyInputs;
+}
+
+bool ActionCache::
+store(
+    Filesystem *filesystem,
+    std::string const &key,
+    pbxbuild::Tool::Invocation const &invocation,
+    std::vector<std::string> const &dependencyInputs)
+{
+    /* Dependency info is stored alongside the outputs, if it was written. */
+    std::vector<std::string> paths = invocation.outputs();
+    for (pbxbuild::Tool::Invocation::DependencyInfo const &dependencyInfo : invocation.dependencyInfo()) {
+        std::string path = FSUtil::ResolveRelativePath(dependencyInfo.path(), invocation.workingDirectory());
+        if (filesystem->type(path) == Filesystem::Type::File && std::find(paths.begin(), paths.end(), path) == paths.end()) {
+            paths.push_back(path);
+        }
+    }
+
+    std::unordered_map<std::string, std::string> outputs;
+    std::vector<std::string> executableOutputs;
+    uint64_t size = 0;
+
+    for (std::string const &output : paths) {
+        if (filesystem->type(output) != Filesystem::Type::File) {
+            return false;
+        }
+
+        std::vector<uint8_t> contents;
+        if (!filesystem->read(&contents, output)) {
+            return false;
+        }
+
+        std::string hash = Hash(contents.data(), contents.size());
+        std::string objectPath = ObjectPath(_path, hash);
+        if (!filesystem->exists(objectPath)) {
+            /* Written aside and moved in, so a partial object is never seen. */
+            if (!filesystem->createDirectory(FSUtil::GetDirectoryName(objectPath), true) || !filesystem->writeAtomic(contents, objectPath)) {
+                return false;
+            }
+        }
+
+        outputs.insert({ SourceRelativePath(output, invocation.workingDirectory()), hash });
+        if (filesystem->isExecutable(output)) {
+            executableOutputs.push_back(SourceRelativePath(output, invocation.workingDirectory()));
+        }
+        size += contents.size();
+    }
+
+    std::unordered_map<std::string, std::string> dependencyInputHashes;
+    for (std::string const &input : dependencyInputs) {
+        ext::optional<std::string> hash = hashFile(filesystem, input);
+        if (!hash) {
+            return false;
+        }
+
+        dependencyInputHashes.insert({ SourceRelativePath(input, invocation.workingDirectory()), *hash });
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto it = _entries.find(key);
+    if (it != _entries.end()) {
+        _size -= it->second.size();
+        _entries.erase(it);
+    }
+
+    _entries.insert({ key, Entry(++_used, size, outputs, executableOutputs, dependencyInputHashes) });
+    _size += size;
+    _modified = true;
+
+    return true;
+}
+
+static std::unique_ptr<plist::Dictionary>
+SerializeHashes(std::unordered_map<std::string, std::string> const &hashes)
+{
+    auto dict = plist::Dictionary::New();
+    for (auto const &pair : hashes) {
+        dict->set(pair.first, plist::String::New(pair.second));
+    }
+    return dict;
+}
+
+static ext::optional<std::unordered_map<std::string, std::string>>
+DeserializeHashes(plist::Dictionary const *dict)
+{
+    if (dict == nullptr) {
+        return ext::nullopt;
+    }
+
+    std::unordered_map<std::string, std::string> hashes;
+    for (size_t n = 0; n < dict->count(); n++) {
+        auto hash = dict->value<plist::String>(n);
+        if (hash == nullptr) {
+            return ext::nullopt;
+        }
+
+        hashes.insert({ dict->key(n), hash->value() });
+    }
+    return hashes;
+}
+
+static bool
+ReadIndex(Filesystem const *filesystem, std::string const &path, std::unordered_map<std::string, ActionCache::Entry> *entries)
+{
+    std::vector<uint8_t> contents;
+    if (!filesystem->read(&contents, IndexPath(path))) {
+        return false;
+    }
+
+    auto deserialize = plist::Format::Binary::Deserialize(contents, plist::Format::Binary::Create());
+    if (deserialize.first == nullptr) {
+        return false;
+    }
+
+    auto root = plist::CastTo<plist::Dictionary>(deserialize.first.get());
+    if (root == nullptr) {
+        return false;
+    }
+
+    auto version = root->value<plist::Integer>("version");
+    auto index = root->value<plist::Dictionary>("entries");
+    if (version == nullptr || version->value() != ActionCacheVersion || index == nullptr) {
+        return false;
+    }
+
+    std::unordered_map<std::string, ActionCache::Entry> loaded;
+    for (size_t n = 0; n < index->count(); n++) {
+        auto entry = index->value<plist::Dictionary>(n);
+        if (entry == nullptr) {
+            return false;
+        }
+
+        auto used = entry->value<plist::Integer>("used");
+        auto size = entry->value<plist::Integer>("size");
+        auto outputs = DeserializeHashes(entry->value<plist::Dictionary>("outputs"));
+        auto executableOutputs = entry->value<plist::Array>("executableOutputs");
+        auto dependencyInputs = DeserializeHashes(entry->value<plist::Dictionary>("dependencyInputs"));
+        if (used == nullptr || size == nullptr || !outputs || executableOutputs == nullptr || !dependencyInputs) {
+            return false;
+        }
+
+        std::vector<std::string> executables;
+        for (size_t m = 0; m < executableOutputs->count(); m++) {
+            auto output = executableOutputs->value<plist::String>(m);
+            if (output == nullptr) {
+                return false;
+            }
+
+            executables.push_back(output->value());
+        }
+
+        loaded.insert({ index->key(n), ActionCache::Entry(used->value(), size->value(), *outputs, executables, *dependencyInputs) });
+    }
+
+    *entries = std::move(loaded);
+    return true;
+}
+
+bool ActionCache::
+save(Filesystem *filesystem)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (!_modified) {
+        return true;
+    }
+
+    /*
+     * Other builds may have saved the index since it was read. Keep their
+     * entries, so objects they still use are not removed as unreferenced.
+     * Objects stored by a build that has not saved yet can still be removed;
+     * restoring checks every object, so that only causes a cache miss.
+     */
+    std::unordered_map<std::string, Entry> saved;
+    if (ReadIndex(filesystem, _path, &saved)) {
+        for (auto const &pair : saved) {
+            auto it = _entries.find(pair.first);
+            if (it != _entries.end()) {
+                it->second.used() = std::max(it->second.used(), pair.second.used());
+            } else {
+                _entries.insert(pair);
+                _size += pair.second.size();
+            }
+            _used = std::max(_used, pair.second.used());
+        }
+    }
+
+    if (_size > _maximumSize) {
+        /* Remove entries starting from the least recently used. */
+        std::vector<std::pair<uint64_t, std::string>> used;
+        for (auto const &pair : _entries) {
+            used.push_back({ pair.second.used(), pair.first });
+        }
+        std::sort(used.begin(), used.end());
+
+        std::unordered_set<std::string> removedObjects;
+        for (auto const &pair : used) {
+            if (_size <= _maximumSize) {
+                break;
+            }
+
+            auto it = _entries.find(pair.second);
+            for (auto const &output : it->second.outputs()) {
+                removedObjects.insert(output.second);
+            }
+
+            _size -= it->second.size();
+            _entries.erase(it);
+        }
+
+        /* Objects can be shared between entries; only remove unused ones. */
+        for (auto const &pair : _entries) {
+            for (auto const &output : pair.second.outputs()) {
+                removedObjects.erase(output.second);
+            }
+        }
+
+        for (std::string const &hash : removedObjects) {
+            filesystem->removeFile(ObjectPath(_path, hash));
+        }
+    }
+
+    auto entries = plist::Dictionary::New();
+    for (auto const &pair : _entries) {
+        auto executableOutputs = plist::Array::New();
+        for (std::string const &output : pair.second.executableOutputs()) {
+            executableOutputs->append(plist::String::New(output));
+        }
+
+        auto entry = plist::Dictionary::New();
+        entry->set("used", plist::Integer::New(pair.second.used()));
+        entry->set("size", plist::Integer::New(pair.second.size()));
+        entry->set("outputs", SerializeHashes(pair.second.outputs()));
+        entry->set("executableOutputs", std::move(executableOutputs));
+        entry->set("dependencyInputs", SerializeHashes(pair.second.dependencyInputs()));
+        entries->set(pair.first, std::move(entry));
+    }
+
+    auto root = plist::Dictionary::New();
+    root->set("version", plist::Integer::New(ActionCacheVersion));
+    root->set("entries", std::move(entries));
+
+    auto serialize = plist::Format::Binary::Serialize(root.get(), plist::Format::Binary::Create());
+    if (serialize.first == nullptr) {
+        return false;
+    }
+
+    if (!filesystem->createDirectory(_path, true) || !filesystem->writeAtomic(*serialize.first, IndexPath(_path))) {
+        return false;
+    }
+
+    _modified = false;
+    return true;
+}
+
+std::shared_ptr<ActionCache> ActionCache::
+Open(Filesystem const *filesystem, std::string const &path, uint64_t maximumSize)
+{
+    auto cache = std::make_shared<ActionCache>(path, maximumSize);
+
+    /* A missing or invalid index leaves the cache empty. */
+    std::unordered_map<std::string, Entry> entries;
+    if (!ReadIndex(filesystem, path, &entries)) {
+        return cache;
+    }
+
+    for (auto const &pair : entries) {
+        cache->_used = std::max<uint64_t>(cache->_used, pair.second.used());
+        cache->_size += pair.second.size();
+    }
+    cache->_entries = std::move(entries);
+    return cache;
+}
@@ -0,0 +1,200 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <xcexecution/BuildState.h>
+#include <pbxbuild/Tool/Invocation.h>
+#include <plist/Array.h>
+#include <plist/Dictionary.h>
+#include <plist/Integer.h>
+#include <plist/String.h>
+#include <plist/Format/Binary.h>
+#include <libutil/md5.h>
+
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+using xcexecution::BuildState;
+
+/*
+ * Incremented when the serialized format changes; older state is ignored.
+ */
+static int64_t const BuildStateVersion = 1;
+
+BuildState::Entry::
+Entry(std::string const &signature, std::vector<std::string> const &dependencyInputs) :
+    _signature       (signature),
+    _dependencyInputs(dependencyInputs)
+{
+}
+
+BuildState::
+BuildState()
+{
+}
+
+static std::string
+InvocationKey(pbxbuild::Tool::Invocation const &invocation)
+{
+    /* An invocation is identified by the outputs it produces. */
+    std::string key;
+    for (std::string const &output : invocation.outputs()) {
+        key += output;
+        key += '\0';
+    }
+    return key;
+}
+
+BuildState::Entry const *BuildState::
+entry(pbxbuild::Tool::Invocation const &invocation) const
+{
+    auto it = _entries.find(InvocationKey(invocation));
+    if (it == _entries.end()) {
+        return nullptr;
+    }
+
+    return &it->second;
+}
+
+void BuildState::
+insert(pbxbuild::Tool::Invocation const &invocation, std::vector<std::string> const &dependencyInputs)
+{
+    std::string key = InvocationKey(invocation);
+    _entries.erase(key);
+    _entries.insert({ key, Entry(Signature(invocation), dependencyInputs) });
+}
+
+void BuildState::
+remove(pbxbuild::Tool::Invocation const &invocation)
+{
+    _entries.erase(InvocationKey(invocation));
+}
+
+std::vector<uint8_t> BuildState::
+serialize() const
+{
+    auto entries = plist::Dictionary::New();
+    for (auto const &pair : _entries) {
+        auto dependencyInputs = plist::Array::New();
+        for (std::string const &input : pair.second.dependencyInputs()) {
+            dependencyInputs->append(plist::String::New(input));
+        }
+
+        auto entry = plist::Dictionary::New();
+        entry->set("signature", plist::String::New(pair.second.signature()));
+        entry->set("dependencyInputs", std::move(dependencyInputs));
+        entries->set(pair.first, std::move(entry));
+    }
+
+    auto root = plist::Dictionary::New();
+    root->set("version", plist::Integer::New(BuildStateVersion));
+    root->set("entries", std::move(entries));
+
+    auto serialize = plist::Format::Binary::Serialize(root.get(), plist::Format::Binary::Create());
+    if (serialize.first == nullptr) {
+        return std::vector<uint8_t>();
+    }
+
+    return *serialize.first;
+}
+
+ext::optional<BuildState> BuildState::
+Deserialize(std::vector<uint8_t> const &contents)
+{
+    auto deserialize = plist::Format::Binary::Deserialize(contents, plist::Format::Binary::Create());
+    if (deserialize.first == nullptr) {
+        return ext::nullopt;
+    }
+
+    auto root = plist::CastTo<plist::Dictionary>(deserialize.first.get());
+    if (root == nullptr) {
+        return ext::nullopt;
+    }
+
+    auto version = root->value<plist::Integer>("version");
+    if (version == nullptr || version->value() != BuildStateVersion) {
+        return ext::nullopt;
+    }
+
+    auto entries = root->value<plist::Dictionary>("entries");
+    if (entries == nullptr) {
+        return ext::nullopt;
+    }
+
+    BuildState state;
+    for (size_t n = 0; n < entries->count(); n++) {
+        auto entry = entries->value<plist::Dictionary>(n);
+        if (entry == nullptr) {
+            return ext::nullopt;
+        }
+
+        auto signature = entry->value<plist::String>("signature");
+        auto dependencyInputs = entry->value<plist::Array>("dependencyInputs");
+        if (signature == nullptr || dependencyInputs == nullptr) {
+            return ext::nullopt;
+        }
+
+        std::vector<std::string> inputs;
+        for (size_t m = 0; m < dependencyInputs->count(); m++) {
+            auto input = dependencyInputs->value<plist::String>(m);
+            if (input == nullptr) {
+                return ext::nullopt;
+            }
+
+            inputs.push_back(input->value());
+        }
+
+        state._entries.insert({ entries->key(n), Entry(signature->value(), inputs) });
+    }
+
+    return state;
+}
+
+static void
+AppendString(md5_state_t *state, std::string const &string)
+{
+    /* Include the terminator so adjacent strings can't run together. */
+    md5_append(state, reinterpret_cast<md5_byte_t const *>(string.c_str()), string.size() + 1);
+}
+
+std::string BuildState::
+Signature(pbxbuild::Tool::Invocation const &invocation)
+{
+    md5_state_t state;
+    md5_init(&state);
+
+    if (invocation.executable()) {
+        AppendString(&state, invocation.executable()->builtin().value_or(std::string()));
+        AppendString(&state, invocation.executable()->external().value_or(std::string()));
+    }
+
+    for (std::string const &argument : invocation.arguments()) {
+        AppendString(&state, argument);
+    }
+
+    /* Sort the environment so the hash is stable. */
+    std::unordered_map<std::string, std::string> completeEnvironment = invocation.completeEnvironment();
+    std::map<std::string, std::string> environment = std::map<std::string, std::string>(completeEnvironment.begin(), completeEnvironment.end());
+    for (auto const &pair : environment) {
+        AppendString(&state, pair.first);
+        AppendString(&state, pair.second);
+    }
+
+    AppendString(&state, invocation.workingDirectory());
+
+    uint8_t digest[16];
+    md5_finish(&state, reinterpret_cast<md5_byte_t *>(&digest));
+
+    std::ostringstream ss;
+    ss << std::hex << std::setfill('0');
+    for (uint8_t byte : digest) {
+        ss << std::setw(2) << static_cast<int>(byte);
+    }
+    return ss.str();
+}
@@ -8,33 +8,45 @@
  */
 
 #include <xcexecution/NinjaExecutor.h>
+#include <xcexecution/NinjaTargetState.h>
 
 #include <xcexecution/Parameters.h>
 #include <pbxbuild/Phase/Environment.h>
 #include <pbxbuild/Phase/PhaseInvocations.h>
 #include <ninja/Writer.h>
 #include <ninja/Value.h>
+#include <dependency/DependencyInfo.h>
+#include <dependency/DirectoryDependencyInfo.h>
+#include <dependency/MakefileDependencyInfo.h>
 #include <plist/Data.h>
 #include <libutil/Escape.h>
 #include <libutil/Filesystem.h>
 #include <libutil/FSUtil.h>
+#include <libutil/SynchronizedFilesystem.h>
+#include <libutil/WorkQueue.h>
 #include <process/Context.h>
 #include <process/MemoryContext.h>
 #include <process/Launcher.h>
 #include <process/User.h>
 #include <libutil/md5.h>
 
+#include <algorithm>
 #include <sstream>
 #include <iomanip>
+#include <mutex>
+#include <set>
+#include <tuple>
 
 #include <sys/types.h>
 #include <sys/stat.h>
 
 using xcexecution::NinjaExecutor;
+using xcexecution::NinjaTargetState;
 using xcexecution::Parameters;
 using libutil::Escape;
 using libutil::Filesystem;
 using libutil::FSUtil;
+using libutil::SynchronizedFilesystem;
 
 NinjaExecutor::
 NinjaExecutor(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, bool generate) :
@@ -97,6 +109,12 @@ NinjaRuleName()
     return "invoke";
 }
 
+static std::string
+NinjaDependencyInfoRuleName()
+{
+    return "invoke-dependency-info";
+}
+
 static std::string
 NinjaDescription(std::string const &description)
 {
@@ -296,22 +314,234 @@ WriteNinja(Filesystem *filesystem, ninja::Writer const &writer, std::string cons
     return true;
 }
 
+static bool
+WriteIfChanged(Filesystem *filesystem, std::vector<uint8_t> const &contents, std::string const &path)
+{
+    /* Leave unchanged files alone, so anything depending on them is not rebuilt. */
+    std::vector<uint8_t> existing;
+    if (filesystem->read(&existing, path) && existing == contents) {
+        return true;
+    }
+
+    if (!filesystem->createDirectory(FSUtil::GetDirectoryName(path), true)) {
+        return false;
+    }
+
+    return filesystem->write(contents, path);
+}
+
+static bool
+WriteNinjaIfChanged(Filesystem *filesystem, ninja::Writer const &writer, std::string const &path)
+{
+    std::string contents = writer.serialize();
+    return WriteIfChanged(filesystem, std::vector<uint8_t>(contents.begin(), contents.end()), path);
+}
+
+/*
+ * Write a Ninja rule to list the contents of directories into a file. The listing is only
+ * written when it changes, so writing to a directory without adding or removing anything,
+ * such as replacing a file, doesn't make what depends on the listing out of date.
+ */
+static bool
+WriteNinjaDirectories(
+    ninja::Writer *writer,
+    Filesystem *filesystem,
+    std::string const &dependencyInfoToolPath,
+    std::string const &workingDirectory,
+    std::string const &directoriesPath,
+    std::set<std::string> const &directories)
+{
+    std::vector<std::string> arguments = {
+        "--shallow",
+        "--name", directoriesPath,
+        "--output", directoriesPath,
+    };
+
+    /*
+     * List the directories now as well, the same way as the dependency info tool, so the
+     * listing is already up to date when Ninja first checks it.
+     */
+    dependency::DependencyInfo listing;
+    listing.outputs() = { directoriesPath };
+
+    std::vector<ninja::Value> inputs;
+    for (std::string const &directory : directories) {
+        arguments.push_back("directory:" + directory);
+        inputs.push_back(ninja::Value::String(directory));
+
+        ext::optional<dependency::DirectoryDependencyInfo> info = dependency::DirectoryDependencyInfo::Deserialize(filesystem, directory, false);
+        if (info) {
+            for (std::string const &input : info->dependencyInfo().inputs()) {
+                listing.inputs().push_back(FSUtil::ResolveRelativePath(input, workingDirectory));
+            }
+        }
+    }
+
+    dependency::MakefileDependencyInfo makefileInfo;
+    makefileInfo.dependencyInfo() = { listing };
+    std::string contents = makefileInfo.serialize();
+    if (!WriteIfChanged(filesystem, std::vector<uint8_t>(contents.begin(), contents.end()), directoriesPath)) {
+        return false;
+    }
+
+    std::string exec = Escape::Shell(dependencyInfoToolPath);
+    for (std::string const &arg : arguments) {
+        exec += " " + Escape::Shell(arg);
+    }
+
+    std::string ruleName = "list-directories";
+    writer->rule(ruleName, ninja::Value::Expression("$exec"), {
+        /* When the listing is unchanged, what depends on it is still up to date. */
+        { "restat", ninja::Value::String("1") },
+    });
+    writer->build({ ninja::Value::String(directoriesPath) }, ruleName, inputs, {
+        { "exec", ninja::Value::String(exec) },
+        { "description", ninja::Value::String("Checking directories...") },
+    });
+
+    return true;
+}
+
 static bool
 WriteAuxiliaryFiles(Filesystem *filesystem, std::map<std::string, pbxbuild::Tool::AuxiliaryFile::Chunk const *> &auxiliaryFileChunks)
 {
     for (auto it : auxiliaryFileChunks) {
-        if (!filesystem->createDirectory(FSUtil::GetDirectoryName(it.first), true)) {
+        if (!WriteIfChanged(filesystem, *it.second->data(), it.first)) {
             return false;
         }
+    }
 
-        if (!filesystem->write(*it.second->data(), it.first)) {
-            return false;
+    return true;
+}
+
+static std::string
+TargetStateKey(pbxproj::PBX::Target::shared_ptr const &target)
+{
+    return target->project()->projectFile() + ":" + target->blueprintIdentifier();
+}
+
+static std::vector<std::string>
+DeveloperPaths(pbxbuild::Build::Environment const &buildEnvironment)
+{
+    /* Specifications are loaded from the developer directory and from these. */
+    std::shared_ptr<xcsdk::SDK::Manager> const &sdkManager = buildEnvironment.sdkManager();
+
+    std::vector<std::string> paths = { sdkManager->path() };
+    for (xcsdk::SDK::Platform::shared_ptr const &platform : sdkManager->platforms()) {
+        paths.push_back(platform->path());
+        for (xcsdk::SDK::Target::shared_ptr const &sdk : platform->targets()) {
+            paths.push_back(sdk->path());
         }
     }
+    for (xcsdk::SDK::Toolchain::shared_ptr const &toolchain : sdkManager->toolchains()) {
+        paths.push_back(toolchain->path());
+    }
 
-    return true;
+    return paths;
+}
+
+static void
+InsertConfigPaths(pbxsetting::XC::Config const &config, std::set<std::string> *paths)
+{
+    paths->insert(config.path());
+
+    for (pbxsetting::XC::Config::Entry const &entry : config.contents()) {
+        if (entry.config() != nullptr) {
+            InsertConfigPaths(*entry.config(), paths);
+        }
+    }
+}
+
+static void
+InsertConfigurationListPaths(pbxbuild::WorkspaceContext const &workspaceContext, pbxproj::XC::ConfigurationList::shared_ptr const &configurationList, std::set<std::string> *paths)
+{
+    if (configurationList == nullptr) {
+        return;
+    }
+
+    for (pbxproj::XC::BuildConfiguration::shared_ptr const &buildConfiguration : configurationList->buildConfigurations()) {
+        auto it = workspaceContext.configs().find(buildConfiguration);
+        if (it != workspaceContext.configs().end()) {
+            InsertConfigPaths(it->second, paths);
+        }
+    }
+}
+
+static std::set<std::string> const &
+TargetInputs(
+    pbxbuild::WorkspaceContext const &workspaceContext,
+    pbxbuild::DirectedGraph<pbxproj::PBX::Target::shared_ptr> const &targetGraph,
+    pbxproj::PBX::Target::shared_ptr const &target,
+    std::unordered_map<pbxproj::PBX::Target::shared_ptr, std::set<std::string>> *targetInputs)
+{
+    auto it = targetInputs->find(target);
+    if (it != targetInputs->end()) {
+        return it->second;
+    }
+
+    /* Inserted first, in case of cycles. */
+    std::set<std::string> *inputs = &(*targetInputs)[target];
+
+    /* The project and configuration files the target's settings come from. */
+    std::set<std::string> paths;
+    paths.insert(target->project()->dataFile());
+    InsertConfigurationListPaths(workspaceContext, target->project()->buildConfigurationList(), &paths);
+    InsertConfigurationListPaths(workspaceContext, target->buildConfigurationList(), &paths);
+
+    /* Targets can use the settings of targets they depend on, such as product paths. */
+    for (pbxproj::PBX::Target::shared_ptr const &dependency : targetGraph.adjacent(target)) {
+        std::set<std::string> const &dependencyPaths = TargetInputs(workspaceContext, targetGraph, dependency, targetInputs);
+        paths.insert(dependencyPaths.begin(), dependencyPaths.end());
+    }
+
+    *inputs = paths;
+    return *inputs;
 }
 
+static std::string
+TargetInputsHash(
+    Filesystem const *filesystem,
+    pbxbuild::WorkspaceContext const &workspaceContext,
+    pbxbuild::DirectedGraph<pbxproj::PBX::Target::shared_ptr> const &targetGraph,
+    pbxproj::PBX::Target::shared_ptr const &target,
+    std::string const &generatorHash,
+    std::unordered_map<std::string, std::string> *fileHashes,
+    std::unordered_map<pbxproj::PBX::Target::shared_ptr, std::set<std::string>> *targetInputs)
+{
+    std::string key = generatorHash + "\n";
+
+    for (std::string const &path : TargetInputs(workspaceContext, targetGraph, target, targetInputs)) {
+        /* Input files are shared between many targets, so only hash each once. */
+        auto it = fileHashes->find(path);
+        if (it == fileHashes->end()) {
+            std::vector<uint8_t> contents;
+            std::string hash = (filesystem->read(&contents, path) ? NinjaHash(reinterpret_cast<char const *>(contents.data()), contents.size()) : std::string());
+            it = fileHashes->insert({ path, hash }).first;
+        }
+
+        key += path + "\n" + it->second + "\n";
+    }
+
+    return NinjaHash(key.data(), key.size());
+}
+
+static bool
+PathWithin(std::string const &path, std::string const &directory)
+{
+    return !directory.empty() && path.size() > directory.size() && path.compare(0, directory.size(), directory) == 0 && path[directory.size()] == '/';
+}
+
+static void
+InsertDirectoryTree(Filesystem const *filesystem, std::string const &directory, std::set<std::string> *paths)
+{
+    paths->insert(directory);
+    filesystem->readDirectory(directory, true, [&](std::string const &path) {
+        std::string full = directory + "/" + path;
+        if (filesystem->type(full) == Filesystem::Type::Directory) {
+            paths->insert(full);
+        }
+    });
+}
 
 static bool
 ShouldGenerateNinja(Filesystem const *filesystem, bool generate, Parameters const &buildParameters, std::string const &ninjaPath, std::string const &configurationHashPath)
@@ -555,9 +785,35 @@ buildAction(
     /*
      * Since invocations are already resolved at this point, we can't use more specific
      * rules at the Ninja level. Instead, add a single rule that just passes through from
-     * the build command that calls it.
+     * the build command that calls it. Invocations with dependency info Ninja can't read
+     * directly use a second rule that converts it after the build command finishes.
      */
-    writer.rule(NinjaRuleName(), ninja::Value::Expression("cd $dir && env $env $exec && $depexec"));
+    writer.rule(NinjaRuleName(), ninja::Value::Expression("cd $dir && env $env $exec"));
+    writer.rule(NinjaDependencyInfoRuleName(), ninja::Value::Expression("cd $dir && env $env $exec && $depexec"));
+
+    /*
+     * Load which inputs each target's Ninja file was generated from last time. Each target
+     * is only regenerated if those changed, or if the generator or parameters changed.
+     */
+    std::string targetStatePath = intermediatesDirectory + "/" + ".ninja-targets";
+    std::unordered_map<std::string, NinjaTargetState> previousTargetState = NinjaTargetState::Read(filesystem, targetStatePath);
+    std::unordered_map<std::string, NinjaTargetState> targetState;
+    std::unordered_map<std::string, std::tuple<std::string, std::string, std::shared_ptr<std::set<std::string>>>> generatedTargets;
+
+    std::string generatorHash = NinjaTargetState::GeneratorHash(
+        filesystem,
+        processContext->executablePath(),
+        buildParameters.canonicalHash(),
+        processContext->environmentVariables(),
+        DeveloperPaths(buildEnvironment));
+    std::unordered_map<std::string, std::string> fileHashes;
+    std::unordered_map<pbxproj::PBX::Target::shared_ptr, std::set<std::string>> targetInputs;
+
+    /* Target Ninja files are written while later targets are planned, so share the filesystem. */
+    SynchronizedFilesystem synchronizedFilesystem(filesystem);
+    std::unique_ptr<libutil::WorkQueue> workQueue = std::unique_ptr<libutil::WorkQueue>(new libutil::WorkQueue(libutil::WorkQueue::DefaultThreadCount()));
+    std::mutex failedMutex;
+    bool failed = false;
 
     /*
      * Go over each target and write out Ninja targets for the start and end of each.
@@ -582,18 +838,6 @@ buildAction(
          * previous targets.
          */
 
-        /*
-         * Resolve this target and generate its invocations.
-         */
-        ext::optional<pbxbuild::Target::Environment> targetEnvironment = buildContext.targetEnvironment(buildEnvironment, target);
-        if (!targetEnvironment) {
-            fprintf(stderr, "error: couldn't create target environment for %s\n", target->name().c_str());
-            continue;
-        }
-
-        pbxbuild::Phase::Environment phaseEnvironment = pbxbuild::Phase::Environment(buildEnvironment, buildContext, target, *targetEnvironment);
-        pbxbuild::Phase::PhaseInvocations phaseInvocations = pbxbuild::Phase::PhaseInvocations::Create(phaseEnvironment, target);
-
         /*
          * As described above, the target's begin depends on all of the target dependencies.
          */
@@ -604,28 +848,38 @@ buildAction(
         }
 
         /*
-         * Add the phony target for beginning this target's build.
+         * If nothing the target's Ninja file was generated from has changed, use it as-is.
+         * When explicitly asked to generate, every target is generated again.
          */
-        std::string targetBegin = TargetNinjaBegin(target);
-        writer.build({ ninja::Value::String(targetBegin) }, "phony", dependenciesFinished);
+        std::string targetKey = TargetStateKey(target);
+        std::string targetInputsHash = TargetInputsHash(&synchronizedFilesystem, buildContext.workspaceContext(), targetGraph, target, generatorHash, &fileHashes, &targetInputs);
+
+        auto previous = previousTargetState.find(targetKey);
+        if (!_generate && previous != previousTargetState.end() && previous->second.hash() == NinjaTargetState::Hash(&synchronizedFilesystem, targetInputsHash, previous->second.directories()) && synchronizedFilesystem.exists(previous->second.ninja())) {
+            writer.build({ ninja::Value::String(TargetNinjaBegin(target)) }, "phony", dependenciesFinished);
+            writer.subninja(ninja::Value::String(previous->second.ninja()));
+            targetState.insert({ targetKey, previous->second });
+            continue;
+        }
 
         /*
-         * Add the phony target for the checkpoint after writing auxiliary files.
+         * Resolve this target and generate its invocations.
          */
-        std::string targetWriteAuxiliaryFiles = TargetNinjaWriteAuxiliaryFiles(target);
-        std::vector<ninja::Value> auxiliaryFileOutputs = { ninja::Value::String(targetBegin) };
-        for (pbxbuild::Tool::AuxiliaryFile const &auxiliaryFile : phaseInvocations.auxiliaryFiles()) {
-            auxiliaryFileOutputs.push_back(ninja::Value::String(auxiliaryFile.path()));
+        ext::optional<pbxbuild::Target::Environment> resolvedEnvironment = buildContext.targetEnvironment(buildEnvironment, target);
+        if (!resolvedEnvironment) {
+            fprintf(stderr, "error: couldn't create target environment for %s\n", target->name().c_str());
+            continue;
         }
-        writer.build({ ninja::Value::String(targetWriteAuxiliaryFiles) }, "phony", auxiliaryFileOutputs);
+
+        /* Shared with the work queue below, rather than copied into it. */
+        auto targetEnvironment = std::make_shared<pbxbuild::Target::Environment const>(std::move(*resolvedEnvironment));
+        pbxbuild::Phase::Environment phaseEnvironment = pbxbuild::Phase::Environment(buildEnvironment, buildContext, target, *targetEnvironment);
+        auto phaseInvocations = std::make_shared<pbxbuild::Phase::PhaseInvocations const>(pbxbuild::Phase::PhaseInvocations::Create(phaseEnvironment, target));
 
         /*
-         * Write out the Ninja file to build this target.
+         * Add the phony target for beginning this target's build.
          */
-        if (!buildTargetInvocations(processContext, filesystem, dependencyInfoToolPath, target, *targetEnvironment, phaseInvocations.auxiliaryFiles(), phaseInvocations.invocations())) {
-            fprintf(stderr, "error: failed to build target ninja\n");
-            return false;
-        }
+        writer.build({ ninja::Value::String(TargetNinjaBegin(target)) }, "phony", dependenciesFinished);
 
         /*
          * Load the Ninja file generated for this target.
@@ -633,43 +887,28 @@ buildAction(
         std::string targetPath = TargetNinjaPath(target, *targetEnvironment);
         writer.subninja(ninja::Value::String(targetPath));
 
-        /*
-         * As described above, the target's finish depends on all of the invocation outputs.
-         */
-        std::unordered_set<std::string> invocationOutputs;
-        for (pbxbuild::Tool::Invocation const &invocation : phaseInvocations.invocations()) {
-            if (!invocation.executable()) {
-                /* No outputs. */
-                continue;
-            }
-
-            std::vector<std::string> outputs = NinjaInvocationOutputs(invocation);
-            invocationOutputs.insert(outputs.begin(), outputs.end());
-        }
+        /* Directories whose contents the target's Ninja file reflects, found as it is written. */
+        std::shared_ptr<std::set<std::string>> directories = std::make_shared<std::set<std::string>>();
+        generatedTargets.insert({ targetKey, std::make_tuple(targetInputsHash, targetPath, directories) });
 
         /*
-         * Add phony rules for input dependencies that we don't know if they exist.
-         * This can come up, for example, for user-specified custom script inputs.
-         * However, avoid adding the phony invocation if a real output *does* include
-         * the phony input, to avoid Ninja complaining about duplicate rules.
+         * Write out the Ninja file to build this target. Planning above shares caches in
+         * the build context so must be done in order, but the Ninja files are independent.
          */
-        for (pbxbuild::Tool::Invocation const &invocation : phaseInvocations.invocations()) {
-            for (std::string const &phonyInput : invocation.phonyInputs()) {
-                if (invocationOutputs.find(phonyInput) == invocationOutputs.end()) {
-                    writer.build({ ninja::Value::String(phonyInput) }, "phony", { });
-                }
+        workQueue->enqueue([this, processContext, &synchronizedFilesystem, &dependencyInfoToolPath, &failedMutex, &failed, target, targetEnvironment, phaseInvocations, directories] {
+            if (!buildTargetInvocations(processContext, &synchronizedFilesystem, dependencyInfoToolPath, target, *targetEnvironment, phaseInvocations->auxiliaryFiles(), phaseInvocations->invocations(), phaseInvocations->scannedDirectories(), directories.get())) {
+                std::lock_guard<std::mutex> lock(failedMutex);
+                failed = true;
             }
-        }
+        });
+    }
 
-        /*
-         * Add the phony target for ending this target's build.
-         */
-        uint32_t maxInvocationPriority = 0;
-        for (pbxbuild::Tool::Invocation const &invocation : phaseInvocations.invocations()) {
-            maxInvocationPriority = std::max(maxInvocationPriority, invocation.priority());
-        }
-        std::string targetFinish = TargetNinjaFinish(target);
-        writer.build({ ninja::Value::String(targetFinish) }, "phony", { ninja::Value::String(TargetPhaseNinjaFinish(target, maxInvocationPriority)) });
+    /* Wait for target Ninja files to be written. */
+    workQueue.reset();
+
+    if (failed) {
+        fprintf(stderr, "error: failed to build target ninja\n");
+        return false;
     }
 
     /*
@@ -677,6 +916,35 @@ buildAction(
      */
     std::vector<std::string> inputPaths = buildContext.workspaceContext().loadedFilePaths();
 
+    /*
+     * Directory contents are part of what target Ninja files were generated from, so record
+     * them with each target. Adding or removing a file must regenerate its target.
+     */
+    for (auto const &pair : generatedTargets) {
+        std::vector<std::string> directories = std::vector<std::string>(std::get<2>(pair.second)->begin(), std::get<2>(pair.second)->end());
+        std::string hash = NinjaTargetState::Hash(filesystem, std::get<0>(pair.second), directories);
+        targetState.insert({ pair.first, NinjaTargetState(hash, std::get<1>(pair.second), directories) });
+    }
+
+    std::set<std::string> directoryPaths;
+    for (auto const &pair : targetState) {
+        directoryPaths.insert(pair.second.directories().begin(), pair.second.directories().end());
+    }
+
+    /*
+     * Rather than depending on the directories, which change whenever anything in them is
+     * written, depend on a listing of them that changes only when their contents do.
+     */
+    if (!directoryPaths.empty()) {
+        std::string directoriesPath = intermediatesDirectory + "/" + ".ninja-directories";
+        if (!WriteNinjaDirectories(&writer, filesystem, dependencyInfoToolPath, intermediatesDirectory, directoriesPath, directoryPaths)) {
+            fprintf(stderr, "error: failed to write directory listing to %s\n", directoriesPath.c_str());
+            return false;
+        }
+
+        inputPaths.push_back(directoriesPath);
+    }
+
     /*
      * Add a Ninja rule to regenerate the build.ninja file itself.
      */
@@ -697,6 +965,13 @@ buildAction(
         return false;
     }
 
+    /*
+     * Record what each target's Ninja file was generated from, for next time.
+     */
+    if (!NinjaTargetState::Write(filesystem, targetState, targetStatePath)) {
+        fprintf(stderr, "warning: failed to write Ninja target state to %s\n", targetStatePath.c_str());
+    }
+
     /*
      * Note where the Ninja file is written.
      */
@@ -713,7 +988,9 @@ buildTargetInvocations(
     pbxproj::PBX::Target::shared_ptr const &target,
     pbxbuild::Target::Environment const &targetEnvironment,
     std::vector<pbxbuild::Tool::AuxiliaryFile> const &auxiliaryFiles,
-    std::vector<pbxbuild::Tool::Invocation> const &invocations)
+    std::vector<pbxbuild::Tool::Invocation> const &invocations,
+    std::vector<std::string> const &scannedDirectories,
+    std::set<std::string> *directories)
 {
     /*
      * Start building the Ninja file for this target.
@@ -729,6 +1006,28 @@ buildTargetInvocations(
     pbxsetting::Environment const &environment = targetEnvironment.environment();
     std::string temporaryDirectory = environment.resolve("TARGET_TEMP_DIR");
 
+    /*
+     * Directories under these can be written by the build, so aren't listed ahead of it.
+     */
+    std::vector<std::string> buildRoots = {
+        environment.resolve("OBJROOT"),
+        environment.resolve("SYMROOT"),
+        environment.resolve("DSTROOT"),
+    };
+
+    /*
+     * Planning listed these, such as to find headers for the headermap.
+     */
+    for (std::string const &directory : scannedDirectories) {
+        bool built = std::any_of(buildRoots.begin(), buildRoots.end(), [&](std::string const &root) {
+            return directory == root || PathWithin(directory, root);
+        });
+
+        if (!built && filesystem->type(directory) == Filesystem::Type::Directory) {
+            directories->insert(directory);
+        }
+    }
+
     /*
      * Write auxiliary files to run first.
      */
@@ -790,17 +1089,65 @@ buildTargetInvocations(
             }
 
             /* Write invocations to run after auxiliary files. */
-            if (!buildInvocation(&writer, invocation, *executablePath, dependencyInfoToolPath, temporaryDirectory, TargetPhaseNinjaBegin(target, invocation.priority()))) {
+            if (!buildInvocation(&writer, filesystem, invocation, *executablePath, dependencyInfoToolPath, temporaryDirectory, buildRoots, TargetPhaseNinjaBegin(target, invocation.priority()), directories)) {
                 return false;
             }
         }
     }
 
     /*
-     * Serialize the Ninja file into the build root.
+     * Add the phony target for the checkpoint after writing auxiliary files.
+     */
+    std::vector<ninja::Value> auxiliaryFileOutputs = { ninja::Value::String(targetBegin) };
+    for (pbxbuild::Tool::AuxiliaryFile const &auxiliaryFile : auxiliaryFiles) {
+        auxiliaryFileOutputs.push_back(ninja::Value::String(auxiliaryFile.path()));
+    }
+    writer.build({ ninja::Value::String(targetWriteAuxiliaryFiles) }, "phony", auxiliaryFileOutputs);
+
+    /*
+     * The target's finish depends on all of the invocation outputs.
+     */
+    std::unordered_set<std::string> invocationOutputs;
+    for (pbxbuild::Tool::Invocation const &invocation : invocations) {
+        if (!invocation.executable()) {
+            /* No outputs. */
+            continue;
+        }
+
+        std::vector<std::string> outputs = NinjaInvocationOutputs(invocation);
+        invocationOutputs.insert(outputs.begin(), outputs.end());
+    }
+
+    /*
+     * Add phony rules for input dependencies that we don't know if they exist.
+     * This can come up, for example, for user-specified custom script inputs.
+     * However, avoid adding the phony invocation if a real output *does* include
+     * the phony input, to avoid Ninja complaining about duplicate rules.
+     */
+    for (pbxbuild::Tool::Invocation const &invocation : invocations) {
+        for (std::string const &phonyInput : invocation.phonyInputs()) {
+            if (invocationOutputs.find(phonyInput) == invocationOutputs.end()) {
+                writer.build({ ninja::Value::String(phonyInput) }, "phony", { });
+            }
+        }
+    }
+
+    /*
+     * Add the phony target for ending this target's build.
+     */
+    uint32_t maxInvocationPriority = 0;
+    for (pbxbuild::Tool::Invocation const &invocation : invocations) {
+        maxInvocationPriority = std::max(maxInvocationPriority, invocation.priority());
+    }
+    std::string targetFinish = TargetNinjaFinish(target);
+    writer.build({ ninja::Value::String(targetFinish) }, "phony", { ninja::Value::String(TargetPhaseNinjaFinish(target, maxInvocationPriority)) });
+
+    /*
+     * Serialize the Ninja file into the build root. If it is unchanged, leave it
+     * alone so Ninja doesn't need to load it again.
      */
     std::string path = TargetNinjaPath(target, targetEnvironment);
-    if (!WriteNinja(filesystem, writer, path)) {
+    if (!WriteNinjaIfChanged(filesystem, writer, path)) {
         fprintf(stderr, "error: unable to write target ninja: %s\n", path.c_str());
         return false;
     }
@@ -867,7 +1214,6 @@ buildAuxiliaryFile(
         { "description", ninja::Value::String(description) },
         { "dir", ninja::Value::String("/") },
         { "exec", ninja::Value::String(exec) },
-        { "depexec", ninja::Value::String("true") },
     };
     writer->build(outputs, NinjaRuleName(), inputs, bindings, { }, orderDependencies);
 
@@ -877,11 +1223,14 @@ buildAuxiliaryFile(
 bool NinjaExecutor::
 buildInvocation(
     ninja::Writer *writer,
+    Filesystem const *filesystem,
     pbxbuild::Tool::Invocation const &invocation,
     std::string const &executablePath,
     std::string const &dependencyInfoToolPath,
     std::string const &temporaryDirectory,
-    std::string const &after)
+    std::vector<std::string> const &buildRoots,
+    std::string const &after,
+    std::set<std::string> *directories)
 {
     /*
      * Build the invocation arguments. Must escape for shell arguments as Ninja passes
@@ -898,8 +1247,9 @@ buildInvocation(
      * don't allow setting "UID"). Intentionally add to, not replace, the process environment.
      */
     std::string environment;
-    for (auto it = invocation.environment().begin(); it != invocation.environment().end(); ++it) {
-        if (it != invocation.environment().begin()) {
+    std::unordered_map<std::string, std::string> completeEnvironment = invocation.completeEnvironment();
+    for (auto it = completeEnvironment.begin(); it != completeEnvironment.end(); ++it) {
+        if (it != completeEnvironment.begin()) {
             environment += " ";
         }
         environment += it->first + "=" + Escape::Shell(it->second);
@@ -917,7 +1267,35 @@ buildInvocation(
     std::string dependencyInfoFile;
     std::string dependencyInfoExec;
 
-    if (!invocation.dependencyInfo().empty()) {
+    /*
+     * Directories that exist before the build are listed here, rather than by running
+     * the converter after every invocation. Their contents become input dependencies.
+     */
+    std::vector<std::string> directoryInputs;
+    std::vector<pbxbuild::Tool::Invocation::DependencyInfo> dependencyInfos;
+    for (pbxbuild::Tool::Invocation::DependencyInfo const &dependencyInfo : invocation.dependencyInfo()) {
+        if (dependencyInfo.format() == dependency::DependencyInfoFormat::Directory) {
+            std::string directory = FSUtil::ResolveRelativePath(dependencyInfo.path(), invocation.workingDirectory());
+            bool built = std::any_of(buildRoots.begin(), buildRoots.end(), [&](std::string const &root) {
+                return PathWithin(directory, root);
+            });
+
+            if (!built) {
+                if (ext::optional<dependency::DirectoryDependencyInfo> info = dependency::DirectoryDependencyInfo::Deserialize(filesystem, directory, true)) {
+                    directoryInputs.insert(directoryInputs.end(), info->dependencyInfo().inputs().begin(), info->dependencyInfo().inputs().end());
+                    InsertDirectoryTree(filesystem, directory, directories);
+                    continue;
+                }
+            }
+        }
+
+        dependencyInfos.push_back(dependencyInfo);
+    }
+
+    if (dependencyInfos.size() == 1 && dependencyInfos.front().format() == dependency::DependencyInfoFormat::Makefile) {
+        /* Ninja reads Makefile dependency info itself, so no conversion is needed. */
+        dependencyInfoFile = FSUtil::ResolveRelativePath(dependencyInfos.front().path(), invocation.workingDirectory());
+    } else if (!dependencyInfos.empty()) {
         /* Determine the first output; Ninja expects that as the Makefile rule. */
         std::string output = NinjaInvocationOutputs(invocation).front();
 
@@ -930,8 +1308,8 @@ buildInvocation(
             "--output", dependencyInfoFile,
         };
 
-        /* Add the input for each dependency info. */
-        for (pbxbuild::Tool::Invocation::DependencyInfo const &dependencyInfo : invocation.dependencyInfo()) {
+        /* Add the input for each dependency info; all are converted by one process. */
+        for (pbxbuild::Tool::Invocation::DependencyInfo const &dependencyInfo : dependencyInfos) {
             std::string formatName;
             if (!dependency::DependencyInfoFormats::Name(dependencyInfo.format(), &formatName)) {
                 return false;
@@ -945,9 +1323,6 @@ buildInvocation(
         for (std::string const &arg : dependencyInfoArguments) {
             dependencyInfoExec += " " + Escape::Shell(arg);
         }
-    } else {
-        // TODO(grp): Avoid the need for an empty dependency info command if not used.
-        dependencyInfoExec = "true";
     }
 
     /*
@@ -966,6 +1341,14 @@ buildInvocation(
     }
     if (!dependencyInfoFile.empty()) {
         bindings.push_back({ "depfile", ninja::Value::String(dependencyInfoFile) });
+
+        /*
+         * Ninja records the dependencies in its log and deletes the file. Only do that for
+         * converted dependency info: a tool's own file can be an output others depend on.
+         */
+        if (!dependencyInfoExec.empty()) {
+            bindings.push_back({ "deps", ninja::Value::String("gcc") });
+        }
     }
 
     /*
@@ -991,6 +1374,9 @@ buildInvocation(
     for (std::string const &inputDependency : invocation.inputDependencies()) {
         inputDependencies.push_back(ninja::Value::String(inputDependency));
     }
+    for (std::string const &directoryInput : directoryInputs) {
+        inputDependencies.push_back(ninja::Value::String(directoryInput));
+    }
 
     /*
      * Build up order dependencies as literal Ninja values.
@@ -1008,7 +1394,8 @@ buildInvocation(
     /*
      * Add the rule to build this invocation.
      */
-    writer->build(outputs, NinjaRuleName(), inputs, bindings, inputDependencies, orderDependencies);
+    std::string rule = (!dependencyInfoExec.empty() ? NinjaDependencyInfoRuleName() : NinjaRuleName());
+    writer->build(outputs, rule, inputs, bindings, inputDependencies, orderDependencies);
 
     return true;
 }
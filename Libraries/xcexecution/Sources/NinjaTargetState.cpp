@@ -0,0 +1,184 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <xcexecution/NinjaTargetState.h>
+#include <plist/Array.h>
+#include <plist/Dictionary.h>
+#include <plist/String.h>
+#include <plist/Format/Binary.h>
+#include <libutil/Filesystem.h>
+#include <libutil/FSUtil.h>
+#include <libutil/md5.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+using xcexecution::NinjaTargetState;
+using libutil::Filesystem;
+using libutil::FSUtil;
+
+NinjaTargetState::
+NinjaTargetState(std::string const &hash, std::string const &ninja, std::vector<std::string> const &directories) :
+    _hash       (hash),
+    _ninja      (ninja),
+    _directories(directories)
+{
+}
+
+static std::string
+Hash(std::string const &key)
+{
+    md5_state_t state;
+    md5_init(&state);
+    md5_append(&state, reinterpret_cast<md5_byte_t const *>(key.data()), key.size());
+
+    uint8_t digest[16];
+    md5_finish(&state, reinterpret_cast<md5_byte_t *>(&digest));
+
+    std::ostringstream ss;
+    ss << std::hex << std::setfill('0');
+    for (uint8_t byte : digest) {
+        ss << std::setw(2) << static_cast<int>(byte);
+    }
+    return ss.str();
+}
+
+std::string NinjaTargetState::
+GeneratorHash(
+    Filesystem const *filesystem,
+    std::string const &executablePath,
+    std::string const &parametersHash,
+    std::unordered_map<std::string, std::string> const &environmentVariables,
+    std::vector<std::string> const &developerPaths)
+{
+    std::string key = parametersHash + "\n";
+
+    /* A different generator can generate anything differently. */
+    key += executablePath + "\n";
+    if (ext::optional<uint64_t> modificationTime = filesystem->modificationTime(executablePath)) {
+        key += std::to_string(*modificationTime);
+    }
+    key += "\n";
+
+    /* Environment variables are build settings. */
+    std::map<std::string, std::string> sortedEnvironmentVariables = std::map<std::string, std::string>(environmentVariables.begin(), environmentVariables.end());
+    for (auto const &pair : sortedEnvironmentVariables) {
+        key += pair.first + "=" + pair.second + "\n";
+    }
+    key += "\n";
+
+    /* Updating or switching the developer directory can change SDKs, tools, and specifications. */
+    for (std::string const &path : developerPaths) {
+        key += path + "\n";
+        if (ext::optional<uint64_t> modificationTime = filesystem->modificationTime(path)) {
+            key += std::to_string(*modificationTime);
+        }
+        key += "\n";
+    }
+
+    return ::Hash(key);
+}
+
+std::string NinjaTargetState::
+Hash(Filesystem const *filesystem, std::string const &inputsHash, std::vector<std::string> const &directories)
+{
+    std::string key = inputsHash + "\n";
+
+    for (std::string const &directory : directories) {
+        std::vector<std::string> names;
+        filesystem->readDirectory(directory, false, [&](std::string const &name) {
+            names.push_back(name);
+        });
+        std::sort(names.begin(), names.end());
+
+        key += directory + "\n";
+        for (std::string const &name : names) {
+            key += " " + name + "\n";
+        }
+    }
+
+    return ::Hash(key);
+}
+
+std::unordered_map<std::string, NinjaTargetState> NinjaTargetState::
+Read(Filesystem const *filesystem, std::string const &path)
+{
+    std::unordered_map<std::string, NinjaTargetState> state;
+
+    std::vector<uint8_t> contents;
+    if (!filesystem->read(&contents, path)) {
+        return state;
+    }
+
+    auto deserialize = plist::Format::Binary::Deserialize(contents, plist::Format::Binary::Create());
+    if (deserialize.first == nullptr) {
+        return state;
+    }
+
+    auto root = plist::CastTo<plist::Dictionary>(deserialize.first.get());
+    if (root == nullptr) {
+        return state;
+    }
+
+    for (size_t n = 0; n < root->count(); n++) {
+        auto entry = root->value<plist::Dictionary>(n);
+        if (entry == nullptr) {
+            continue;
+        }
+
+        auto hash = entry->value<plist::String>("hash");
+        auto ninja = entry->value<plist::String>("ninja");
+        auto directories = entry->value<plist::Array>("directories");
+        if (hash == nullptr || ninja == nullptr || directories == nullptr) {
+            continue;
+        }
+
+        std::vector<std::string> paths;
+        for (size_t m = 0; m < directories->count(); m++) {
+            if (auto directory = directories->value<plist::String>(m)) {
+                paths.push_back(directory->value());
+            }
+        }
+
+        state.insert({ root->key(n), NinjaTargetState(hash->value(), ninja->value(), paths) });
+    }
+
+    return state;
+}
+
+bool NinjaTargetState::
+Write(Filesystem *filesystem, std::unordered_map<std::string, NinjaTargetState> const &state, std::string const &path)
+{
+    auto root = plist::Dictionary::New();
+    for (auto const &pair : state) {
+        auto directories = plist::Array::New();
+        for (std::string const &directory : pair.second.directories()) {
+            directories->append(plist::String::New(directory));
+        }
+
+        auto entry = plist::Dictionary::New();
+        entry->set("hash", plist::String::New(pair.second.hash()));
+        entry->set("ninja", plist::String::New(pair.second.ninja()));
+        entry->set("directories", std::move(directories));
+        root->set(pair.first, std::move(entry));
+    }
+
+    auto serialize = plist::Format::Binary::Serialize(root.get(), plist::Format::Binary::Create());
+    if (serialize.first == nullptr) {
+        return false;
+    }
+
+    if (!filesystem->createDirectory(FSUtil::GetDirectoryName(path), true)) {
+        return false;
+    }
+
+    return filesystem->writeAtomic(*serialize.first, path);
+}
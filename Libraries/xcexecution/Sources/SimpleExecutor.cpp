@@ -9,12 +9,19 @@
 
 #include <xcexecution/SimpleExecutor.h>
 
+#include <xcexecution/ActionCache.h>
+#include <xcexecution/BuildState.h>
 #include <xcexecution/Parameters.h>
 #include <builtin/Driver.h>
+#include <dependency/BinaryDependencyInfo.h>
+#include <dependency/DirectoryDependencyInfo.h>
+#include <dependency/MakefileDependencyInfo.h>
 #include <pbxbuild/Phase/Environment.h>
 #include <pbxbuild/Phase/PhaseInvocations.h>
 #include <libutil/Filesystem.h>
 #include <libutil/FSUtil.h>
+#include <libutil/SynchronizedFilesystem.h>
+#include <libutil/WorkQueue.h>
 #include <process/Context.h>
 #include <process/MemoryContext.h>
 #include <process/Launcher.h>
@@ -23,18 +30,91 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <limits>
+#include <map>
+#include <mutex>
 #include <set>
+#include <thread>
+#include <unordered_map>
 
 using xcexecution::SimpleExecutor;
 using xcexecution::Parameters;
+using xcexecution::ActionCache;
+using xcexecution::BuildState;
 using libutil::Filesystem;
 using libutil::FSUtil;
 using libutil::Permissions;
+using libutil::SynchronizedFilesystem;
+
+/*
+ * Jobs available to run, shared by every target so that targets built at
+ * the same time stay within the job limit together.
+ */
+class SimpleExecutor::JobSlots {
+private:
+    std::mutex              _mutex;
+    std::condition_variable _condition;
+    size_t                  _available;
+
+public:
+    explicit JobSlots(size_t jobs) :
+        _available(jobs)
+    {
+    }
+
+public:
+    void acquire()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _condition.wait(lock, [this] { return _available > 0; });
+        _available--;
+    }
+
+    void release()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _available++;
+        _condition.notify_one();
+    }
+};
+
+/*
+ * Builtin tools are not written to run at the same time as themselves, but
+ * different builtin tools can run at the same time. Each has its own lock.
+ */
+class SimpleExecutor::BuiltinLocks {
+private:
+    std::mutex                                                   _mutex;
+    std::unordered_map<std::string, std::shared_ptr<std::mutex>> _locks;
+
+public:
+    std::shared_ptr<std::mutex> lock(std::string const &name)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+
+        std::shared_ptr<std::mutex> &result = _locks[name];
+        if (result == nullptr) {
+            result = std::make_shared<std::mutex>();
+        }
+        return result;
+    }
+};
 
 SimpleExecutor::
-SimpleExecutor(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, builtin::Registry const &builtins) :
-    Executor (formatter, dryRun, false),
-    _builtins(builtins)
+SimpleExecutor(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, builtin::Registry const &builtins, size_t jobs, bool parallelizeTargets, bool incremental, std::shared_ptr<ActionCache> const &actionCache) :
+    Executor           (formatter, dryRun, false),
+    _builtins          (builtins),
+    _jobs              (jobs > 0 ? jobs : 1),
+    _parallelizeTargets(parallelizeTargets),
+    _incremental       (incremental),
+    _actionCache       (actionCache),
+    _workQueue         (std::make_shared<libutil::WorkQueue>(_jobs)),
+    _jobSlots          (std::make_shared<JobSlots>(_jobs)),
+    _formatterMutex    (std::make_shared<std::mutex>()),
+    _builtinLocks      (std::make_shared<BuiltinLocks>())
 {
 }
 
@@ -43,6 +123,13 @@ SimpleExecutor::
 {
 }
 
+void SimpleExecutor::
+print(std::function<std::string()> const &message)
+{
+    std::lock_guard<std::mutex> lock(*_formatterMutex);
+    xcformatter::Formatter::Print(message());
+}
+
 bool SimpleExecutor::
 build(
     process::User const *user,
@@ -62,7 +149,7 @@ build(
         return false;
     }
 
-    xcformatter::Formatter::Print(_formatter->begin(*buildContext));
+    print([&] { return _formatter->begin(*buildContext); });
 
     ext::optional<pbxbuild::DirectedGraph<pbxproj::PBX::Target::shared_ptr>> targetGraph = buildParameters.resolveDependencies(buildEnvironment, *buildContext);
     if (!targetGraph) {
@@ -75,33 +162,135 @@ build(
         return false;
     }
 
-    for (pbxproj::PBX::Target::shared_ptr const &target : *orderedTargets) {
-        xcformatter::Formatter::Print(_formatter->beginTarget(*buildContext, target));
+    bool success = buildTargets(processContext, processLauncher, filesystem, buildEnvironment, *buildContext, *targetGraph, *orderedTargets);
+
+    /* Save what was cached, even on failure, so it can be reused. */
+    if (_actionCache != nullptr && !_dryRun) {
+        if (!_actionCache->save(filesystem)) {
+            fprintf(stderr, "warning: failed to write action cache to %s\n", _actionCache->path().c_str());
+        }
+    }
 
-        ext::optional<pbxbuild::Target::Environment> targetEnvironment = buildContext->targetEnvironment(buildEnvironment, target);
+    if (!success) {
+        return false;
+    }
+
+    print([&] { return _formatter->success(*buildContext); });
+    return true;
+}
+
+bool SimpleExecutor::
+buildTargets(
+    process::Context const *processContext,
+    process::Launcher *processLauncher,
+    Filesystem *filesystem,
+    pbxbuild::Build::Environment const &buildEnvironment,
+    pbxbuild::Build::Context const &buildContext,
+    pbxbuild::DirectedGraph<pbxproj::PBX::Target::shared_ptr> const &targetGraph,
+    std::vector<pbxproj::PBX::Target::shared_ptr> const &orderedTargets)
+{
+    /* Targets built at the same time share the filesystem. */
+    SynchronizedFilesystem synchronizedFilesystem(filesystem);
+    filesystem = &synchronizedFilesystem;
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::unordered_set<pbxproj::PBX::Target::shared_ptr> unfinished = std::unordered_set<pbxproj::PBX::Target::shared_ptr>(orderedTargets.begin(), orderedTargets.end());
+    std::vector<std::thread> threads;
+    bool failed = false;
+
+    auto execute = [&](pbxproj::PBX::Target::shared_ptr const &target, pbxbuild::Target::Environment const &targetEnvironment, pbxbuild::Phase::PhaseInvocations const &phaseInvocations) -> bool {
+        auto result = buildTarget(processContext, processLauncher, filesystem, target, targetEnvironment, phaseInvocations.auxiliaryFiles(), phaseInvocations.invocations());
+        if (!result.first) {
+            print([&] { return _formatter->finishTarget(buildContext, target); });
+            print([&] { return _formatter->failure(buildContext, result.second); });
+            return false;
+        }
+
+        print([&] { return _formatter->finishTarget(buildContext, target); });
+        return true;
+    };
+
+    /*
+     * Targets are planned on this thread, in order, because planning shares
+     * caches in the build context. With `parallelizeTargets`, each planned
+     * target is then built on its own thread, and the next target to plan is
+     * the first one whose dependencies have all finished building.
+     */
+    std::vector<pbxproj::PBX::Target::shared_ptr> pending = orderedTargets;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!pending.empty() && !failed) {
+        auto ready = pending.end();
+        condition.wait(lock, [&] {
+            ready = std::find_if(pending.begin(), pending.end(), [&](pbxproj::PBX::Target::shared_ptr const &target) -> bool {
+                for (pbxproj::PBX::Target::shared_ptr const &dependency : targetGraph.adjacent(target)) {
+                    if (unfinished.find(dependency) != unfinished.end()) {
+                        return false;
+                    }
+                }
+                return true;
+            });
+            return failed || ready != pending.end();
+        });
+        if (failed) {
+            break;
+        }
+
+        pbxproj::PBX::Target::shared_ptr target = *ready;
+        pending.erase(ready);
+        lock.unlock();
+
+        print([&] { return _formatter->beginTarget(buildContext, target); });
+
+        ext::optional<pbxbuild::Target::Environment> targetEnvironment = buildContext.targetEnvironment(buildEnvironment, target);
         if (!targetEnvironment) {
             fprintf(stderr, "error: couldn't create target environment for %s\n", target->name().c_str());
-            xcformatter::Formatter::Print(_formatter->finishTarget(*buildContext, target));
-            return false;
+            print([&] { return _formatter->finishTarget(buildContext, target); });
+
+            lock.lock();
+            failed = true;
+            break;
         }
 
-        xcformatter::Formatter::Print(_formatter->beginCheckDependencies(target));
-        pbxbuild::Phase::Environment phaseEnvironment = pbxbuild::Phase::Environment(buildEnvironment, *buildContext, target, *targetEnvironment);
+        print([&] { return _formatter->beginCheckDependencies(target); });
+        pbxbuild::Phase::Environment phaseEnvironment = pbxbuild::Phase::Environment(buildEnvironment, buildContext, target, *targetEnvironment);
         pbxbuild::Phase::PhaseInvocations phaseInvocations = pbxbuild::Phase::PhaseInvocations::Create(phaseEnvironment, target);
-        xcformatter::Formatter::Print(_formatter->finishCheckDependencies(target));
+        print([&] { return _formatter->finishCheckDependencies(target); });
 
-        auto result = buildTarget(processContext, processLauncher, filesystem, target, *targetEnvironment, phaseInvocations.auxiliaryFiles(), phaseInvocations.invocations());
-        if (!result.first) {
-            xcformatter::Formatter::Print(_formatter->finishTarget(*buildContext, target));
-            xcformatter::Formatter::Print(_formatter->failure(*buildContext, result.second));
-            return false;
+        if (_parallelizeTargets) {
+            threads.push_back(std::thread([&, target, targetEnvironment, phaseInvocations] {
+                bool success = execute(target, *targetEnvironment, phaseInvocations);
+
+                std::unique_lock<std::mutex> targetLock(mutex);
+                if (success) {
+                    unfinished.erase(target);
+                } else {
+                    failed = true;
+                }
+                condition.notify_all();
+            }));
+
+            lock.lock();
+        } else {
+            bool success = execute(target, *targetEnvironment, phaseInvocations);
+
+            lock.lock();
+            if (success) {
+                unfinished.erase(target);
+            } else {
+                failed = true;
+            }
         }
+    }
+    lock.unlock();
 
-        xcformatter::Formatter::Print(_formatter->finishTarget(*buildContext, target));
+    /* Let targets already building finish, even after a failure. */
+    for (std::thread &thread : threads) {
+        thread.join();
     }
 
-    xcformatter::Formatter::Print(_formatter->success(*buildContext));
-    return true;
+    return !failed;
 }
 
 static ext::optional<std::vector<pbxbuild::Tool::Invocation>>
@@ -171,7 +360,7 @@ writeAuxiliaryFiles(
     for (pbxbuild::Tool::AuxiliaryFile const &auxiliaryFile : auxiliaryFiles) {
         std::string directory = FSUtil::GetDirectoryName(auxiliaryFile.path());
         if (filesystem->type(directory) != Filesystem::Type::Directory) {
-            xcformatter::Formatter::Print(_formatter->createAuxiliaryDirectory(directory));
+            print([&] { return _formatter->createAuxiliaryDirectory(directory); });
 
             if (!_dryRun) {
                 if (!filesystem->createDirectory(directory, true)) {
@@ -180,7 +369,7 @@ writeAuxiliaryFiles(
             }
         }
 
-        xcformatter::Formatter::Print(_formatter->writeAuxiliaryFile(auxiliaryFile.path()));
+        print([&] { return _formatter->writeAuxiliaryFile(auxiliaryFile.path()); });
 
         if (!_dryRun) {
             std::vector<uint8_t> data;
@@ -203,13 +392,17 @@ writeAuxiliaryFiles(
                 }
             }
 
-            if (!filesystem->write(data, auxiliaryFile.path())) {
-                return false;
+            /* Leave unchanged files alone, so invocations using them are up to date. */
+            std::vector<uint8_t> existing;
+            if (!filesystem->read(&existing, auxiliaryFile.path()) || existing != data) {
+                if (!filesystem->write(data, auxiliaryFile.path())) {
+                    return false;
+                }
             }
         }
 
         if (auxiliaryFile.executable() && !filesystem->isExecutable(auxiliaryFile.path())) {
-            xcformatter::Formatter::Print(_formatter->setAuxiliaryExecutable(auxiliaryFile.path()));
+            print([&] { return _formatter->setAuxiliaryExecutable(auxiliaryFile.path()); });
 
             if (!_dryRun) {
                 Permissions permissions = Permissions(
@@ -226,6 +419,136 @@ writeAuxiliaryFiles(
     return true;
 }
 
+static bool
+InvocationUpToDate(Filesystem const *filesystem, BuildState const *buildState, pbxbuild::Tool::Invocation const &invocation)
+{
+    /* Without outputs, there's nothing to compare against. */
+    if (invocation.outputs().empty()) {
+        return false;
+    }
+
+    /* Must have completed before, in exactly the same way. */
+    BuildState::Entry const *entry = buildState->entry(invocation);
+    if (entry == nullptr || entry->signature() != BuildState::Signature(invocation)) {
+        return false;
+    }
+
+    /* All outputs must exist. */
+    uint64_t oldestOutput = std::numeric_limits<uint64_t>::max();
+    for (std::string const &output : invocation.outputs()) {
+        ext::optional<uint64_t> modificationTime = filesystem->modificationTime(output);
+        if (!modificationTime) {
+            return false;
+        }
+
+        oldestOutput = std::min(oldestOutput, *modificationTime);
+    }
+
+    /*
+     * No input can be newer than any output. Phony inputs, such as the inputs
+     * declared by a script phase, might not exist; if not, run to be safe.
+     */
+    for (std::vector<std::string> const *inputs : { &invocation.inputs(), &invocation.phonyInputs(), &entry->dependencyInputs() }) {
+        for (std::string const &input : *inputs) {
+            ext::optional<uint64_t> modificationTime = filesystem->modificationTime(input);
+            if (!modificationTime || *modificationTime > oldestOutput) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+static ext::optional<std::vector<std::string>>
+DependencyInputs(Filesystem const *filesystem, pbxbuild::Tool::Invocation const &invocation)
+{
+    std::vector<std::string> inputs;
+
+    for (pbxbuild::Tool::Invocation::DependencyInfo const &dependencyInfo : invocation.dependencyInfo()) {
+        std::string path = FSUtil::ResolveRelativePath(dependencyInfo.path(), invocation.workingDirectory());
+        std::vector<dependency::DependencyInfo> info;
+
+        switch (dependencyInfo.format()) {
+            case dependency::DependencyInfoFormat::Binary: {
+                ext::optional<libutil::MappedFile> contents = filesystem->map(path);
+                if (!contents) {
+                    return ext::nullopt;
+                }
+
+                ext::optional<dependency::BinaryDependencyInfo> binaryInfo = dependency::BinaryDependencyInfo::Deserialize(contents->contents());
+                if (!binaryInfo) {
+                    return ext::nullopt;
+                }
+
+                info.push_back(binaryInfo->dependencyInfo());
+                break;
+            }
+            case dependency::DependencyInfoFormat::Directory: {
+                ext::optional<dependency::DirectoryDependencyInfo> directoryInfo = dependency::DirectoryDependencyInfo::Deserialize(filesystem, path, true);
+                if (!directoryInfo) {
+                    return ext::nullopt;
+                }
+
+                info.push_back(directoryInfo->dependencyInfo());
+                break;
+            }
+            case dependency::DependencyInfoFormat::Makefile: {
+                std::vector<uint8_t> contents;
+                if (!filesystem->read(&contents, path)) {
+                    return ext::nullopt;
+                }
+
+                ext::optional<dependency::MakefileDependencyInfo> makefileInfo = dependency::MakefileDependencyInfo::Deserialize(std::string(contents.begin(), contents.end()));
+                if (!makefileInfo) {
+                    return ext::nullopt;
+                }
+
+                info = makefileInfo->dependencyInfo();
+                break;
+            }
+            default: abort();
+        }
+
+        for (dependency::DependencyInfo const &entry : info) {
+            for (std::string const &input : entry.inputs()) {
+                inputs.push_back(FSUtil::ResolveRelativePath(input, invocation.workingDirectory()));
+            }
+        }
+    }
+
+    return inputs;
+}
+
+/*
+ * Results of invocations run on worker threads, passed back to the thread
+ * scheduling them.
+ */
+class InvocationCompletions {
+private:
+    std::mutex                          _mutex;
+    std::condition_variable             _condition;
+    std::deque<std::pair<size_t, bool>> _completions;
+
+public:
+    void push(size_t index, bool success)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _completions.push_back({ index, success });
+        _condition.notify_one();
+    }
+
+    std::pair<size_t, bool> wait()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _condition.wait(lock, [this] { return !_completions.empty(); });
+
+        std::pair<size_t, bool> completion = _completions.front();
+        _completions.pop_front();
+        return completion;
+    }
+};
+
 std::pair<bool, std::vector<pbxbuild::Tool::Invocation>> SimpleExecutor::
 performInvocations(
     process::Context const *processContext,
@@ -233,87 +556,238 @@ performInvocations(
     Filesystem *filesystem,
     std::vector<std::string> const &executablePaths,
     std::vector<pbxbuild::Tool::Invocation> const &orderedInvocations,
-    bool createProductStructure)
+    bool createProductStructure,
+    BuildState *buildState)
 {
-    for (pbxbuild::Tool::Invocation const &invocation : orderedInvocations) {
-        // TODO(grp): This should perhaps be a separate flag for a 'phony' invocation.
-        if (!invocation.executable()) {
-            continue;
+    if (_dryRun) {
+        return std::make_pair(true, std::vector<pbxbuild::Tool::Invocation>());
+    }
+
+    /*
+     * Find the invocations each invocation depends on through its inputs. Phases
+     * are run one after another, so only dependencies within a phase matter.
+     */
+    std::unordered_map<std::string, size_t> outputToIndex;
+    std::map<uint32_t, std::vector<size_t>> phases;
+    for (size_t i = 0; i < orderedInvocations.size(); ++i) {
+        pbxbuild::Tool::Invocation const &invocation = orderedInvocations[i];
+        for (std::string const &output : invocation.outputs()) {
+            outputToIndex.insert({ output, i });
         }
-        pbxbuild::Tool::Invocation::Executable const &executable = *invocation.executable();
+        phases[invocation.priority()].push_back(i);
+    }
 
-        if (invocation.createsProductStructure() != createProductStructure) {
-            continue;
+    std::vector<size_t> waiting = std::vector<size_t>(orderedInvocations.size(), 0);
+    std::vector<std::vector<size_t>> dependents = std::vector<std::vector<size_t>>(orderedInvocations.size());
+    for (size_t i = 0; i < orderedInvocations.size(); ++i) {
+        pbxbuild::Tool::Invocation const &invocation = orderedInvocations[i];
+
+        std::set<size_t> dependencies;
+        for (std::vector<std::string> const *paths : { &invocation.inputs(), &invocation.phonyInputs(), &invocation.inputDependencies() }) {
+            for (std::string const &path : *paths) {
+                auto it = outputToIndex.find(path);
+                if (it != outputToIndex.end() && it->second != i && orderedInvocations[it->second].priority() == invocation.priority()) {
+                    dependencies.insert(it->second);
+                }
+            }
         }
 
-        if (!_dryRun) {
-            bool success = true;
+        waiting[i] = dependencies.size();
+        for (size_t dependency : dependencies) {
+            dependents[dependency].push_back(i);
+        }
+    }
 
-            for (std::string const &output : invocation.outputs()) {
-                std::string directory = FSUtil::GetDirectoryName(output);
+    std::vector<pbxbuild::Tool::Invocation> failures;
+    InvocationCompletions completions;
 
-                if (!filesystem->createDirectory(directory, true)) {
-                    return std::make_pair(false, std::vector<pbxbuild::Tool::Invocation>({ invocation }));
+    /* Cache keys are found before running, in case inputs change during. */
+    std::unordered_map<size_t, std::string> cacheKeys;
+
+    for (auto const &phase : phases) {
+        /* Ready invocations run in their original order when jobs are limited. */
+        std::set<size_t> ready;
+        for (size_t i : phase.second) {
+            if (waiting[i] == 0) {
+                ready.insert(i);
+            }
+        }
+
+        auto complete = [&](size_t index) {
+            for (size_t dependent : dependents[index]) {
+                if (--waiting[dependent] == 0) {
+                    ready.insert(dependent);
                 }
             }
+        };
 
-            if (ext::optional<std::string> const &builtin = executable.builtin()) {
-                /* Builtin tool, find and run in-process. */
-                if (std::shared_ptr<builtin::Driver> driver = _builtins.driver(*builtin)) {
-                    xcformatter::Formatter::Print(_formatter->beginInvocation(invocation, *builtin, createProductStructure));
+        std::unordered_map<size_t, std::string> running;
+        while (!ready.empty() || !running.empty()) {
+            while (!ready.empty() && failures.empty()) {
+                size_t index = *ready.begin();
+                ready.erase(ready.begin());
 
-                    process::MemoryContext context = process::MemoryContext(
-                        *builtin,
-                        invocation.workingDirectory(),
-                        invocation.arguments(),
-                        invocation.environment());
-                    int exitCode = driver->run(&context, filesystem);
-                    success = (exitCode == 0);
+                pbxbuild::Tool::Invocation const &invocation = orderedInvocations[index];
 
-                    xcformatter::Formatter::Print(_formatter->finishInvocation(invocation, *builtin, createProductStructure));
-                } else {
-                    /* Failed to find builtin tool. */
-                    return std::make_pair(false, std::vector<pbxbuild::Tool::Invocation>({ invocation }));
+                // TODO(grp): This should perhaps be a separate flag for a 'phony' invocation.
+                if (!invocation.executable() || invocation.createsProductStructure() != createProductStructure) {
+                    complete(index);
+                    continue;
                 }
-            } else if (ext::optional<std::string> const &external = executable.external()) {
-                /* External tool, find on the filesystem. */
-                ext::optional<std::string> path;
-                if (FSUtil::IsAbsolutePath(*external)) {
-                    if (filesystem->isExecutable(*external)) {
-                        path = external;
+                pbxbuild::Tool::Invocation::Executable const &executable = *invocation.executable();
+
+                if (buildState != nullptr) {
+                    if (InvocationUpToDate(filesystem, buildState, invocation)) {
+                        complete(index);
+                        continue;
                     }
-                } else {
-                    path = filesystem->findExecutable(*external, executablePaths);
+
+                    /* If interrupted, the outputs can't be trusted. */
+                    buildState->remove(invocation);
                 }
 
-                if (path) {
-                    xcformatter::Formatter::Print(_formatter->beginInvocation(invocation, *path, createProductStructure));
+                /* Find what will run, and its environment; both are part of the cache key. */
+                ext::optional<std::string> path;
+                std::unordered_map<std::string, std::string> environment = invocation.completeEnvironment();
+                if (ext::optional<std::string> const &builtin = executable.builtin()) {
+                    path = *builtin;
+                } else if (ext::optional<std::string> const &external = executable.external()) {
+                    /* External tool, find on the filesystem. */
+                    if (FSUtil::IsAbsolutePath(*external)) {
+                        if (filesystem->isExecutable(*external)) {
+                            path = external;
+                        }
+                    } else {
+                        path = filesystem->findExecutable(*external, executablePaths);
+                    }
+
+                    if (!path) {
+                        /* Failed to find executable. */
+                        failures.push_back(invocation);
+                        break;
+                    }
 
                     /* Create the execution environment from the process and invocation environments, preferring the invocation. */
-                    std::unordered_map<std::string, std::string> environment = invocation.environment();
                     environment.insert(processContext->environmentVariables().begin(), processContext->environmentVariables().end());
+                } else {
+                    abort();
+                }
+
+                if (_actionCache != nullptr) {
+                    if (ext::optional<std::string> key = _actionCache->key(filesystem, invocation, *path, environment)) {
+                        if (ext::optional<std::vector<std::string>> dependencyInputs = _actionCache->restore(filesystem, *key, invocation)) {
+                            if (buildState != nullptr) {
+                                buildState->insert(invocation, *dependencyInputs);
+                            }
 
-                    process::MemoryContext context = process::MemoryContext(
-                        *path,
-                        invocation.workingDirectory(),
-                        invocation.arguments(),
-                        environment);
-                    ext::optional<int> exitCode = processLauncher->launch(filesystem, &context);
-                    success = (exitCode && *exitCode == 0);
+                            complete(index);
+                            continue;
+                        }
 
-                    xcformatter::Formatter::Print(_formatter->finishInvocation(invocation, *path, createProductStructure));
+                        cacheKeys.insert({ index, *key });
+                    }
+                }
+
+                bool created = true;
+                for (std::string const &output : invocation.outputs()) {
+                    std::string directory = FSUtil::GetDirectoryName(output);
+
+                    if (!filesystem->createDirectory(directory, true)) {
+                        created = false;
+                        break;
+                    }
+                }
+                if (!created) {
+                    failures.push_back(invocation);
+                    break;
+                }
+
+                if (ext::optional<std::string> const &builtin = executable.builtin()) {
+                    /* Builtin tool, find and run in-process. */
+                    std::shared_ptr<builtin::Driver> driver = _builtins.driver(*builtin);
+                    if (driver == nullptr) {
+                        /* Failed to find builtin tool. */
+                        failures.push_back(invocation);
+                        break;
+                    }
+
+                    _jobSlots->acquire();
+                    print([&] { return _formatter->beginInvocation(invocation, *builtin, createProductStructure); });
+                    running.insert({ index, *builtin });
+
+                    std::shared_ptr<JobSlots> jobSlots = _jobSlots;
+                    std::shared_ptr<std::mutex> builtinMutex = _builtinLocks->lock(*builtin);
+                    _workQueue->enqueue([&completions, &invocation, filesystem, driver, builtin, jobSlots, builtinMutex, index] {
+                        process::MemoryContext context = process::MemoryContext(
+                            *builtin,
+                            invocation.workingDirectory(),
+                            invocation.arguments(),
+                            invocation.completeEnvironment());
+
+                        int exitCode;
+                        {
+                            std::lock_guard<std::mutex> lock(*builtinMutex);
+                            exitCode = driver->run(&context, filesystem);
+                        }
+
+                        jobSlots->release();
+                        completions.push(index, exitCode == 0);
+                    });
                 } else {
-                    /* Failed to find executable. */
-                    return std::make_pair(false, std::vector<pbxbuild::Tool::Invocation>({ invocation }));
+                    /* External tool, found above. */
+                    _jobSlots->acquire();
+                    print([&] { return _formatter->beginInvocation(invocation, *path, createProductStructure); });
+                    running.insert({ index, *path });
+
+                    std::shared_ptr<JobSlots> jobSlots = _jobSlots;
+                    _workQueue->enqueue([&completions, &invocation, filesystem, processLauncher, path, environment, jobSlots, index] {
+                        process::MemoryContext context = process::MemoryContext(
+                            *path,
+                            invocation.workingDirectory(),
+                            invocation.arguments(),
+                            environment);
+                        ext::optional<int> exitCode = processLauncher->launch(filesystem, &context);
+
+                        jobSlots->release();
+                        completions.push(index, exitCode && *exitCode == 0);
+                    });
                 }
-            } else {
-                abort();
             }
 
-            if (!success) {
-                return std::make_pair(false, std::vector<pbxbuild::Tool::Invocation>({ invocation }));
+            if (running.empty()) {
+                break;
+            }
+
+            /* Wait for any running invocation to finish. */
+            std::pair<size_t, bool> completion = completions.wait();
+            pbxbuild::Tool::Invocation const &invocation = orderedInvocations[completion.first];
+
+            auto it = running.find(completion.first);
+            print([&] { return _formatter->finishInvocation(invocation, it->second, createProductStructure); });
+            running.erase(it);
+
+            if (completion.second) {
+                auto key = cacheKeys.find(completion.first);
+                if (buildState != nullptr || key != cacheKeys.end()) {
+                    if (ext::optional<std::vector<std::string>> dependencyInputs = DependencyInputs(filesystem, invocation)) {
+                        if (buildState != nullptr) {
+                            buildState->insert(invocation, *dependencyInputs);
+                        }
+                        if (key != cacheKeys.end()) {
+                            _actionCache->store(filesystem, key->second, invocation, *dependencyInputs);
+                        }
+                    }
+                }
+
+                complete(completion.first);
+            } else {
+                failures.push_back(invocation);
             }
         }
+
+        if (!failures.empty()) {
+            return std::make_pair(false, failures);
+        }
     }
 
     return std::make_pair(true, std::vector<pbxbuild::Tool::Invocation>());
@@ -329,9 +803,9 @@ buildTarget(
     std::vector<pbxbuild::Tool::AuxiliaryFile> const &auxiliaryFiles,
     std::vector<pbxbuild::Tool::Invocation> const &invocations)
 {
-    xcformatter::Formatter::Print(_formatter->beginWriteAuxiliaryFiles(target));
+    print([&] { return _formatter->beginWriteAuxiliaryFiles(target); });
     bool auxiliaryFilesSuccess = this->writeAuxiliaryFiles(filesystem, auxiliaryFiles);
-    xcformatter::Formatter::Print(_formatter->finishWriteAuxiliaryFiles(target));
+    print([&] { return _formatter->finishWriteAuxiliaryFiles(target); });
     if (!auxiliaryFilesSuccess) {
         return std::make_pair(false, std::vector<pbxbuild::Tool::Invocation>());
     }
@@ -342,27 +816,49 @@ buildTarget(
         return std::make_pair(false, std::vector<pbxbuild::Tool::Invocation>());
     }
 
-    xcformatter::Formatter::Print(_formatter->beginCreateProductStructure(target));
-    std::pair<bool, std::vector<pbxbuild::Tool::Invocation>> structureResult = performInvocations(processContext, processLauncher, filesystem, targetEnvironment.executablePaths(), *orderedInvocations, true);
-    xcformatter::Formatter::Print(_formatter->finishCreateProductStructure(target));
-    if (!structureResult.first) {
-        return structureResult;
+    /* Load what was built last time, if building incrementally. */
+    std::string buildStatePath = targetEnvironment.environment().resolve("TARGET_TEMP_DIR") + "/" + "xcbuild-state.plist";
+    ext::optional<BuildState> buildState;
+    if (_incremental && !_dryRun) {
+        std::vector<uint8_t> contents;
+        if (filesystem->read(&contents, buildStatePath)) {
+            buildState = BuildState::Deserialize(contents);
+        }
+        if (!buildState) {
+            buildState = BuildState();
+        }
+    }
+
+    BuildState *buildStatePointer = (buildState ? &*buildState : nullptr);
+
+    print([&] { return _formatter->beginCreateProductStructure(target); });
+    std::pair<bool, std::vector<pbxbuild::Tool::Invocation>> result = performInvocations(processContext, processLauncher, filesystem, targetEnvironment.executablePaths(), *orderedInvocations, true, buildStatePointer);
+    print([&] { return _formatter->finishCreateProductStructure(target); });
+
+    if (result.first) {
+        result = performInvocations(processContext, processLauncher, filesystem, targetEnvironment.executablePaths(), *orderedInvocations, false, buildStatePointer);
     }
 
-    std::pair<bool, std::vector<pbxbuild::Tool::Invocation>> invocationsResult = performInvocations(processContext, processLauncher, filesystem, targetEnvironment.executablePaths(), *orderedInvocations, false);
-    if (!invocationsResult.first) {
-        return invocationsResult;
+    /* Save what was built, even on failure, so it is not built again. */
+    if (buildState) {
+        if (!filesystem->createDirectory(FSUtil::GetDirectoryName(buildStatePath), true) || !filesystem->write(buildState->serialize(), buildStatePath)) {
+            fprintf(stderr, "warning: failed to write build state to %s\n", buildStatePath.c_str());
+        }
     }
 
-    return std::make_pair(true, std::vector<pbxbuild::Tool::Invocation>());
+    return result;
 }
 
 std::unique_ptr<SimpleExecutor> SimpleExecutor::
-Create(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, builtin::Registry const &builtins)
+Create(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, builtin::Registry const &builtins, size_t jobs, bool parallelizeTargets, bool incremental, std::shared_ptr<ActionCache> const &actionCache)
 {
     return std::unique_ptr<SimpleExecutor>(new SimpleExecutor(
         formatter,
         dryRun,
-        builtins
+        builtins,
+        jobs,
+        parallelizeTargets,
+        incremental,
+        actionCache
     ));
 }
@@ -0,0 +1,307 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <gtest/gtest.h>
+#include <xcexecution/ActionCache.h>
+#include <pbxbuild/Tool/Invocation.h>
+#include <libutil/MemoryFilesystem.h>
+
+using xcexecution::ActionCache;
+using libutil::MemoryFilesystem;
+
+static std::vector<uint8_t>
+Contents(std::string const &string)
+{
+    return std::vector<uint8_t>(string.begin(), string.end());
+}
+
+static pbxbuild::Tool::Invocation
+Invocation(MemoryFilesystem const &filesystem, std::string const &input, std::string const &output)
+{
+    auto invocation = pbxbuild::Tool::Invocation();
+    invocation.executable() = pbxbuild::Tool::Invocation::Executable::External("tool");
+    invocation.workingDirectory() = filesystem.path("");
+    invocation.arguments() = { filesystem.path(input), "-o", filesystem.path(output) };
+    invocation.inputs() = { filesystem.path(input) };
+    invocation.outputs() = { filesystem.path(output) };
+    return invocation;
+}
+
+static ext::optional<std::string>
+Key(ActionCache const &cache, MemoryFilesystem const &filesystem, pbxbuild::Tool::Invocation const &invocation)
+{
+    return cache.key(&filesystem, invocation, "tool", { { "PATH", "/usr/bin" } });
+}
+
+TEST(ActionCache, Key)
+{
+    auto filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::File("input", Contents("one")),
+        MemoryFilesystem::Entry::Directory("directory", { }),
+    });
+    ActionCache cache = { filesystem.path("cache"), 1024 };
+
+    auto invocation = Invocation(filesystem, "input", "output");
+    ext::optional<std::string> key = Key(cache, filesystem, invocation);
+    ASSERT_NE(ext::nullopt, key);
+    EXPECT_EQ(key, Key(cache, filesystem, invocation));
+
+    /* Input contents are part of the key. */
+    ASSERT_TRUE(filesystem.write(Contents("two"), filesystem.path("input")));
+    EXPECT_NE(key, Key(cache, filesystem, invocation));
+
+    /* So are the tool that runs and its environment. */
+    EXPECT_NE(key, cache.key(&filesystem, invocation, "other", { { "PATH", "/usr/bin" } }));
+    EXPECT_NE(key, cache.key(&filesystem, invocation, "tool", { { "PATH", "/usr/local/bin" } }));
+
+    /* Missing and directory inputs can't be cached. */
+    EXPECT_EQ(ext::nullopt, Key(cache, filesystem, Invocation(filesystem, "missing", "output")));
+    EXPECT_EQ(ext::nullopt, Key(cache, filesystem, Invocation(filesystem, "directory", "output")));
+}
+
+TEST(ActionCache, StoreRestore)
+{
+    auto filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::File("input", Contents("input")),
+        MemoryFilesystem::Entry::File("header", Contents("header")),
+        MemoryFilesystem::Entry::File("output", Contents("output")),
+    });
+    ActionCache cache = { filesystem.path("cache"), 1024 };
+
+    auto invocation = Invocation(filesystem, "input", "output");
+    ext::optional<std::string> key = Key(cache, filesystem, invocation);
+    ASSERT_NE(ext::nullopt, key);
+    EXPECT_EQ(ext::nullopt, cache.restore(&filesystem, *key, invocation));
+
+    ASSERT_TRUE(cache.store(&filesystem, *key, invocation, { filesystem.path("header") }));
+
+    /* Outputs are restored from the cache. */
+    ASSERT_TRUE(filesystem.removeFile(filesystem.path("output")));
+    ext::optional<std::vector<std::string>> dependencyInputs = cache.restore(&filesystem, *key, invocation);
+    ASSERT_NE(ext::nullopt, dependencyInputs);
+    EXPECT_EQ(std::vector<std::string>({ filesystem.path("header") }), *dependencyInputs);
+
+    std::vector<uint8_t> contents;
+    ASSERT_TRUE(filesystem.read(&contents, filesystem.path("output")));
+    EXPECT_EQ(Contents("output"), contents);
+
+    /* Changed dependency inputs aren't in the key, but prevent restoring. */
+    ASSERT_TRUE(filesystem.write(Contents("changed"), filesystem.path("header")));
+    EXPECT_EQ(ext::nullopt, cache.restore(&filesystem, *key, invocation));
+}
+
+TEST(ActionCache, SaveOpen)
+{
+    auto filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::File("input", Contents("input")),
+        MemoryFilesystem::Entry::File("output", Contents("output")),
+    });
+
+    auto invocation = Invocation(filesystem, "input", "output");
+    {
+        auto cache = ActionCache::Open(&filesystem, filesystem.path("cache"), 1024);
+        ext::optional<std::string> key = Key(*cache, filesystem, invocation);
+        ASSERT_NE(ext::nullopt, key);
+        ASSERT_TRUE(cache->store(&filesystem, *key, invocation, { }));
+        ASSERT_TRUE(cache->save(&filesystem));
+    }
+
+    auto cache = ActionCache::Open(&filesystem, filesystem.path("cache"), 1024);
+    ext::optional<std::string> key = Key(*cache, filesystem, invocation);
+    ASSERT_NE(ext::nullopt, key);
+    EXPECT_NE(ext::nullopt, cache->restore(&filesystem, *key, invocation));
+}
+
+TEST(ActionCache, EvictLeastRecentlyUsed)
+{
+    auto filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::File("input1", Contents("1")),
+        MemoryFilesystem::Entry::File("input2", Contents("2")),
+        MemoryFilesystem::Entry::File("input3", Contents("3")),
+        MemoryFilesystem::Entry::File("output1", Contents("aaaa")),
+        MemoryFilesystem::Entry::File("output2", Contents("bbbb")),
+        MemoryFilesystem::Entry::File("output3", Contents("cccc")),
+    });
+
+    /* Only two outputs fit. */
+    ActionCache cache = { filesystem.path("cache"), 8 };
+
+    std::vector<std::string> keys;
+    std::vector<pbxbuild::Tool::Invocation> invocations;
+    for (char const *n : { "1", "2", "3" }) {
+        auto invocation = Invocation(filesystem, std::string("input") + n, std::string("output") + n);
+        ext::optional<std::string> key = Key(cache, filesystem, invocation);
+        ASSERT_NE(ext::nullopt, key);
+        ASSERT_TRUE(cache.store(&filesystem, *key, invocation, { }));
+        keys.push_back(*key);
+        invocations.push_back(invocation);
+
+        /* Using the first output keeps it in the cache. */
+        if (n == std::string("2")) {
+            ASSERT_NE(ext::nullopt, cache.restore(&filesystem, keys[0], invocations[0]));
+        }
+    }
+
+    ASSERT_TRUE(cache.save(&filesystem));
+    EXPECT_NE(ext::nullopt, cache.restore(&filesystem, keys[0], invocations[0]));
+    EXPECT_EQ(ext::nullopt, cache.restore(&filesystem, keys[1], invocations[1]));
+    EXPECT_NE(ext::nullopt, cache.restore(&filesystem, keys[2], invocations[2]));
+}
+
+TEST(ActionCache, KeyDependencies)
+{
+    auto filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::File("input", Contents("input")),
+        MemoryFilesystem::Entry::File("dependency", Contents("one")),
+        MemoryFilesystem::Entry::Directory("directory", { }),
+    });
+    ActionCache cache = { filesystem.path("cache"), 1024 };
+
+    auto invocation = Invocation(filesystem, "input", "output");
+    invocation.inputDependencies() = { filesystem.path("dependency") };
+    invocation.phonyInputs() = { filesystem.path("phony") };
+    ext::optional<std::string> key = Key(cache, filesystem, invocation);
+    ASSERT_NE(ext::nullopt, key);
+
+    /* Dependencies that aren't inputs are still part of the key. */
+    ASSERT_TRUE(filesystem.write(Contents("two"), filesystem.path("dependency")));
+    ext::optional<std::string> changed = Key(cache, filesystem, invocation);
+    ASSERT_NE(ext::nullopt, changed);
+    EXPECT_NE(key, changed);
+
+    /* Phony inputs can be missing, but their contents count once present. */
+    ASSERT_TRUE(filesystem.write(Contents("phony"), filesystem.path("phony")));
+    ext::optional<std::string> created = Key(cache, filesystem, invocation);
+    ASSERT_NE(ext::nullopt, created);
+    EXPECT_NE(changed, created);
+
+    /* Directory dependencies can't be captured. */
+    invocation.inputDependencies().push_back(filesystem.path("directory"));
+    EXPECT_EQ(ext::nullopt, Key(cache, filesystem, invocation));
+}
+
+TEST(ActionCache, RestoreCorrupted)
+{
+    auto filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::File("input", Contents("input")),
+        MemoryFilesystem::Entry::File("output", Contents("output")),
+    });
+    ActionCache cache = { filesystem.path("cache"), 1024 };
+
+    auto invocation = Invocation(filesystem, "input", "output");
+    ext::optional<std::string> key = Key(cache, filesystem, invocation);
+    ASSERT_NE(ext::nullopt, key);
+    ASSERT_TRUE(cache.store(&filesystem, *key, invocation, { }));
+
+    /* Find the stored object, and truncate it. */
+    std::vector<std::string> objects;
+    ASSERT_TRUE(filesystem.readDirectory(filesystem.path("cache/objects"), true, [&](std::string const &path) {
+        if (filesystem.type(filesystem.path("cache/objects/" + path)) == libutil::Filesystem::Type::File) {
+            objects.push_back(filesystem.path("cache/objects/" + path));
+        }
+    }));
+    ASSERT_EQ(1u, objects.size());
+    ASSERT_TRUE(filesystem.write(Contents("out"), objects[0]));
+
+    /* A damaged object is a miss, and leaves the output alone. */
+    ASSERT_TRUE(filesystem.write(Contents("previous"), filesystem.path("output")));
+    EXPECT_EQ(ext::nullopt, cache.restore(&filesystem, *key, invocation));
+
+    std::vector<uint8_t> contents;
+    ASSERT_TRUE(filesystem.read(&contents, filesystem.path("output")));
+    EXPECT_EQ(Contents("previous"), contents);
+
+    /* Storing again replaces the damaged object. */
+    ASSERT_TRUE(filesystem.write(Contents("output"), filesystem.path("output")));
+    ASSERT_TRUE(cache.store(&filesystem, *key, invocation, { }));
+    EXPECT_NE(ext::nullopt, cache.restore(&filesystem, *key, invocation));
+}
+
+TEST(ActionCache, SaveMerge)
+{
+    auto filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::File("input1", Contents("1")),
+        MemoryFilesystem::Entry::File("input2", Contents("2")),
+        MemoryFilesystem::Entry::File("output1", Contents("aaaa")),
+        MemoryFilesystem::Entry::File("output2", Contents("bbbb")),
+    });
+
+    /* Two builds open the cache before either saves. */
+    auto first = ActionCache::Open(&filesystem, filesystem.path("cache"), 1024);
+    auto second = ActionCache::Open(&filesystem, filesystem.path("cache"), 1024);
+
+    auto invocation1 = Invocation(filesystem, "input1", "output1");
+    ext::optional<std::string> key1 = Key(*first, filesystem, invocation1);
+    ASSERT_NE(ext::nullopt, key1);
+    ASSERT_TRUE(first->store(&filesystem, *key1, invocation1, { }));
+    ASSERT_TRUE(first->save(&filesystem));
+
+    auto invocation2 = Invocation(filesystem, "input2", "output2");
+    ext::optional<std::string> key2 = Key(*second, filesystem, invocation2);
+    ASSERT_NE(ext::nullopt, key2);
+    ASSERT_TRUE(second->store(&filesystem, *key2, invocation2, { }));
+    ASSERT_TRUE(second->save(&filesystem));
+
+    /* The later save keeps what the earlier one stored. */
+    auto cache = ActionCache::Open(&filesystem, filesystem.path("cache"), 1024);
+    EXPECT_NE(ext::nullopt, cache->restore(&filesystem, *key1, invocation1));
+    EXPECT_NE(ext::nullopt, cache->restore(&filesystem, *key2, invocation2));
+}
+
+TEST(ActionCache, SourceRootRelative)
+{
+    auto filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::Directory("one", {
+            MemoryFilesystem::Entry::File("input", Contents("input")),
+            MemoryFilesystem::Entry::File("header", Contents("header")),
+            MemoryFilesystem::Entry::File("output", Contents("output")),
+        }),
+        MemoryFilesystem::Entry::Directory("two", {
+            MemoryFilesystem::Entry::File("input", Contents("input")),
+            MemoryFilesystem::Entry::File("header", Contents("header")),
+        }),
+    });
+    ActionCache cache = { filesystem.path("cache"), 1024 };
+
+    auto one = Invocation(filesystem, "one/input", "one/output");
+    one.workingDirectory() = filesystem.path("one");
+    auto two = Invocation(filesystem, "two/input", "two/output");
+    two.workingDirectory() = filesystem.path("two");
+
+    /* The same sources in another location have the same key. */
+    ext::optional<std::string> key = Key(cache, filesystem, one);
+    ASSERT_NE(ext::nullopt, key);
+    EXPECT_EQ(key, Key(cache, filesystem, two));
+    ASSERT_TRUE(cache.store(&filesystem, *key, one, { filesystem.path("one/header") }));
+
+    /* Outputs and dependency inputs are restored in the other location. */
+    ext::optional<std::vector<std::string>> dependencyInputs = cache.restore(&filesystem, *key, two);
+    ASSERT_NE(ext::nullopt, dependencyInputs);
+    EXPECT_EQ(std::vector<std::string>({ filesystem.path("two/header") }), *dependencyInputs);
+
+    std::vector<uint8_t> contents;
+    ASSERT_TRUE(filesystem.read(&contents, filesystem.path("two/output")));
+    EXPECT_EQ(Contents("output"), contents);
+}
+
+TEST(ActionCache, HashFile)
+{
+    auto filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::File("input", Contents("one")),
+    });
+    ActionCache cache = { filesystem.path("cache"), 1024 };
+
+    ext::optional<std::string> hash = cache.hashFile(&filesystem, filesystem.path("input"));
+    ASSERT_NE(ext::nullopt, hash);
+    EXPECT_EQ(hash, cache.hashFile(&filesystem, filesystem.path("input")));
+
+    /* A changed file is hashed again. */
+    ASSERT_TRUE(filesystem.write(Contents("two"), filesystem.path("input")));
+    EXPECT_NE(hash, cache.hashFile(&filesystem, filesystem.path("input")));
+}
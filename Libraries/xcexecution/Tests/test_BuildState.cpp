@@ -0,0 +1,70 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <gtest/gtest.h>
+#include <xcexecution/BuildState.h>
+#include <pbxbuild/Tool/Invocation.h>
+
+using xcexecution::BuildState;
+
+static pbxbuild::Tool::Invocation
+Invocation(std::string const &output, std::vector<std::string> const &arguments)
+{
+    auto invocation = pbxbuild::Tool::Invocation();
+    invocation.executable() = pbxbuild::Tool::Invocation::Executable::External("tool");
+    invocation.arguments() = arguments;
+    invocation.outputs() = { output };
+    return invocation;
+}
+
+TEST(BuildState, Entries)
+{
+    auto first = Invocation("/first", { "-a" });
+    auto second = Invocation("/second", { "-b" });
+
+    BuildState state;
+    EXPECT_EQ(nullptr, state.entry(first));
+
+    state.insert(first, { "/header.h" });
+    ASSERT_NE(nullptr, state.entry(first));
+    EXPECT_EQ(BuildState::Signature(first), state.entry(first)->signature());
+    EXPECT_EQ(std::vector<std::string>({ "/header.h" }), state.entry(first)->dependencyInputs());
+    EXPECT_EQ(nullptr, state.entry(second));
+
+    state.remove(first);
+    EXPECT_EQ(nullptr, state.entry(first));
+}
+
+TEST(BuildState, Signature)
+{
+    EXPECT_EQ(BuildState::Signature(Invocation("/output", { "-a" })), BuildState::Signature(Invocation("/output", { "-a" })));
+    EXPECT_NE(BuildState::Signature(Invocation("/output", { "-a" })), BuildState::Signature(Invocation("/output", { "-b" })));
+
+    /* Arguments can't run together. */
+    EXPECT_NE(BuildState::Signature(Invocation("/output", { "ab", "c" })), BuildState::Signature(Invocation("/output", { "a", "bc" })));
+}
+
+TEST(BuildState, Serialize)
+{
+    auto first = Invocation("/first", { "-a" });
+    auto second = Invocation("/second", { "-b" });
+
+    BuildState state;
+    state.insert(first, { "/header1.h", "/header2.h" });
+    state.insert(second, { });
+
+    ext::optional<BuildState> loaded = BuildState::Deserialize(state.serialize());
+    ASSERT_NE(ext::nullopt, loaded);
+    ASSERT_NE(nullptr, loaded->entry(first));
+    EXPECT_EQ(std::vector<std::string>({ "/header1.h", "/header2.h" }), loaded->entry(first)->dependencyInputs());
+    ASSERT_NE(nullptr, loaded->entry(second));
+    EXPECT_EQ(BuildState::Signature(second), loaded->entry(second)->signature());
+
+    EXPECT_EQ(ext::nullopt, BuildState::Deserialize(std::vector<uint8_t>({ 'x' })));
+}
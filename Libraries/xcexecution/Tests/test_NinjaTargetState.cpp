@@ -0,0 +1,98 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <gtest/gtest.h>
+#include <xcexecution/NinjaTargetState.h>
+#include <libutil/MemoryFilesystem.h>
+
+using xcexecution::NinjaTargetState;
+using libutil::MemoryFilesystem;
+
+static std::vector<uint8_t>
+Contents(std::string const &string)
+{
+    return std::vector<uint8_t>(string.begin(), string.end());
+}
+
+TEST(NinjaTargetState, GeneratorHash)
+{
+    auto filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::File("xcbuild", Contents("")),
+        MemoryFilesystem::Entry::Directory("Developer", { }),
+        MemoryFilesystem::Entry::Directory("Other", { }),
+    });
+
+    std::unordered_map<std::string, std::string> environment = { { "DEVELOPER_DIR", filesystem.path("Developer") } };
+    std::vector<std::string> developerPaths = { filesystem.path("Developer") };
+    std::string hash = NinjaTargetState::GeneratorHash(&filesystem, filesystem.path("xcbuild"), "parameters", environment, developerPaths);
+    EXPECT_EQ(hash, NinjaTargetState::GeneratorHash(&filesystem, filesystem.path("xcbuild"), "parameters", environment, developerPaths));
+
+    /* Parameters and environment variables can change any setting. */
+    EXPECT_NE(hash, NinjaTargetState::GeneratorHash(&filesystem, filesystem.path("xcbuild"), "other", environment, developerPaths));
+    EXPECT_NE(hash, NinjaTargetState::GeneratorHash(&filesystem, filesystem.path("xcbuild"), "parameters", { { "DEVELOPER_DIR", filesystem.path("Other") } }, developerPaths));
+    EXPECT_NE(hash, NinjaTargetState::GeneratorHash(&filesystem, filesystem.path("xcbuild"), "parameters", { }, developerPaths));
+
+    /* So can the SDKs and specifications found. */
+    EXPECT_NE(hash, NinjaTargetState::GeneratorHash(&filesystem, filesystem.path("xcbuild"), "parameters", environment, { filesystem.path("Other") }));
+    EXPECT_NE(hash, NinjaTargetState::GeneratorHash(&filesystem, filesystem.path("xcbuild"), "parameters", environment, { filesystem.path("Developer"), filesystem.path("Other") }));
+}
+
+TEST(NinjaTargetState, Hash)
+{
+    auto filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::Directory("Headers", {
+            MemoryFilesystem::Entry::File("A.h", Contents("a")),
+            MemoryFilesystem::Entry::Directory("Nested", { }),
+        }),
+    });
+
+    std::vector<std::string> directories = { filesystem.path("Headers") };
+    std::string hash = NinjaTargetState::Hash(&filesystem, "inputs", directories);
+    EXPECT_EQ(hash, NinjaTargetState::Hash(&filesystem, "inputs", directories));
+    EXPECT_NE(hash, NinjaTargetState::Hash(&filesystem, "other", directories));
+
+    /* Changed contents don't change what is listed. */
+    ASSERT_TRUE(filesystem.write(Contents("changed"), filesystem.path("Headers/A.h")));
+    EXPECT_EQ(hash, NinjaTargetState::Hash(&filesystem, "inputs", directories));
+
+    /* Adding a file does, such as a header found for the headermap. */
+    ASSERT_TRUE(filesystem.write(Contents("b"), filesystem.path("Headers/B.h")));
+    std::string added = NinjaTargetState::Hash(&filesystem, "inputs", directories);
+    EXPECT_NE(hash, added);
+
+    /* Nested directories are only covered when listed themselves. */
+    ASSERT_TRUE(filesystem.write(Contents("c"), filesystem.path("Headers/Nested/C.h")));
+    EXPECT_EQ(added, NinjaTargetState::Hash(&filesystem, "inputs", directories));
+    directories.push_back(filesystem.path("Headers/Nested"));
+    std::string nested = NinjaTargetState::Hash(&filesystem, "inputs", directories);
+    ASSERT_TRUE(filesystem.removeFile(filesystem.path("Headers/Nested/C.h")));
+    EXPECT_NE(nested, NinjaTargetState::Hash(&filesystem, "inputs", directories));
+}
+
+TEST(NinjaTargetState, WriteRead)
+{
+    auto filesystem = MemoryFilesystem({ });
+
+    std::unordered_map<std::string, NinjaTargetState> state = {
+        { "project:target", NinjaTargetState("hash", filesystem.path("target.ninja"), { filesystem.path("Resources") }) },
+    };
+    ASSERT_TRUE(NinjaTargetState::Write(&filesystem, state, filesystem.path("build/.ninja-targets")));
+
+    std::unordered_map<std::string, NinjaTargetState> read = NinjaTargetState::Read(&filesystem, filesystem.path("build/.ninja-targets"));
+    ASSERT_EQ(1u, read.size());
+
+    auto it = read.find("project:target");
+    ASSERT_NE(read.end(), it);
+    EXPECT_EQ("hash", it->second.hash());
+    EXPECT_EQ(filesystem.path("target.ninja"), it->second.ninja());
+    EXPECT_EQ(std::vector<std::string>({ filesystem.path("Resources") }), it->second.directories());
+
+    /* Missing state is empty. */
+    EXPECT_TRUE(NinjaTargetState::Read(&filesystem, filesystem.path("missing")).empty());
+}
@@ -9,6 +9,8 @@
 
 #include <gtest/gtest.h>
 #include <xcexecution/SimpleExecutor.h>
+#include <xcexecution/ActionCache.h>
+#include <xcexecution/BuildState.h>
 #include <xcformatter/NullFormatter.h>
 #include <pbxbuild/Tool/Invocation.h>
 #include <builtin/Driver.h>
@@ -16,10 +18,17 @@
 #include <process/MemoryContext.h>
 #include <process/MemoryLauncher.h>
 #include <libutil/MemoryFilesystem.h>
+#include <libutil/SynchronizedFilesystem.h>
+
+#include <algorithm>
+#include <mutex>
 
 using xcexecution::SimpleExecutor;
+using xcexecution::ActionCache;
+using xcexecution::BuildState;
 using libutil::Filesystem;
 using libutil::MemoryFilesystem;
+using libutil::SynchronizedFilesystem;
 
 class Driver : public builtin::Driver {
 public:
@@ -91,7 +100,7 @@ TEST(SimpleExecutor, PropagateToolResult)
     /* Create test executor. */
     auto formatter = xcformatter::NullFormatter::Create();
     std::vector<std::string> const executablePaths = { filesystem.path("") };
-    SimpleExecutor executor = SimpleExecutor(formatter, false, registry);
+    SimpleExecutor executor = SimpleExecutor(formatter, false, registry, 1, false, false, nullptr);
 
     /* Succeed if all tools succeed. */
     auto success = executor.performInvocations(
@@ -103,7 +112,8 @@ TEST(SimpleExecutor, PropagateToolResult)
             builtinSuccess,
             externalSuccess,
         },
-        false);
+        false,
+        nullptr);
     ASSERT_TRUE(success.first);
     EXPECT_EQ(success.second.size(), 0);
 
@@ -118,7 +128,8 @@ TEST(SimpleExecutor, PropagateToolResult)
             builtinSuccess,
             externalSuccess,
         },
-        false);
+        false,
+        nullptr);
     ASSERT_FALSE(fail1.first);
     EXPECT_EQ(fail1.second.size(), 1);
 
@@ -134,8 +145,258 @@ TEST(SimpleExecutor, PropagateToolResult)
             externalSuccess,
             externalFail,
         },
-        false);
+        false,
+        nullptr);
     ASSERT_FALSE(fail2.first);
     EXPECT_EQ(fail2.second.size(), 1);
 }
 
+
+TEST(SimpleExecutor, ParallelRespectsDependencies)
+{
+    /* Create in-memory execution environment. */
+    auto filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::Directory("output", { }),
+    });
+    auto launcher = process::MemoryLauncher({ });
+
+    std::mutex mutex;
+    std::vector<std::string> order;
+    auto record = [&mutex, &order](process::Context const *context, Filesystem *filesystem) -> int {
+        std::unique_lock<std::mutex> lock(mutex);
+        order.push_back(context->commandLineArguments().front());
+        return 0;
+    };
+
+    auto registry = builtin::Registry::Create({
+        std::static_pointer_cast<builtin::Driver>(std::make_shared<Driver>("builtin-record", record)),
+    });
+
+    auto context = process::MemoryContext(
+        "",
+        filesystem.path(""),
+        std::vector<std::string>(),
+        std::unordered_map<std::string, std::string>());
+
+    /* Create a chain of dependent invocations alongside independent ones. */
+    std::vector<pbxbuild::Tool::Invocation> invocations;
+    for (char const *name : { "first", "second", "third" }) {
+        auto invocation = pbxbuild::Tool::Invocation();
+        invocation.executable() = pbxbuild::Tool::Invocation::Executable::Builtin("builtin-record");
+        invocation.arguments() = { name };
+        invocation.outputs() = { filesystem.path(std::string("output/") + name) };
+        if (!invocations.empty()) {
+            invocation.inputs() = invocations.back().outputs();
+        }
+        invocations.push_back(invocation);
+    }
+    for (char const *name : { "independent1", "independent2", "independent3" }) {
+        auto invocation = pbxbuild::Tool::Invocation();
+        invocation.executable() = pbxbuild::Tool::Invocation::Executable::Builtin("builtin-record");
+        invocation.arguments() = { name };
+        invocations.push_back(invocation);
+    }
+
+    /* Create test executor running several jobs at once. */
+    auto formatter = xcformatter::NullFormatter::Create();
+    std::vector<std::string> const executablePaths = { filesystem.path("") };
+    SimpleExecutor executor = SimpleExecutor(formatter, false, registry, 4, false, false, nullptr);
+
+    /* Invocations running at the same time share the filesystem. */
+    SynchronizedFilesystem synchronizedFilesystem(&filesystem);
+
+    auto success = executor.performInvocations(
+        &context,
+        &launcher,
+        &synchronizedFilesystem,
+        executablePaths,
+        invocations,
+        false,
+        nullptr);
+    ASSERT_TRUE(success.first);
+    ASSERT_EQ(6, order.size());
+
+    /* Dependent invocations must run in order. */
+    auto first = std::find(order.begin(), order.end(), "first");
+    auto second = std::find(order.begin(), order.end(), "second");
+    auto third = std::find(order.begin(), order.end(), "third");
+    ASSERT_NE(order.end(), third);
+    EXPECT_LT(first, second);
+    EXPECT_LT(second, third);
+}
+
+TEST(SimpleExecutor, IncrementalSkipsUpToDate)
+{
+    /* Create in-memory execution environment. */
+    auto filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::File("input", std::vector<uint8_t>()),
+        MemoryFilesystem::Entry::Directory("output", { }),
+    });
+    auto launcher = process::MemoryLauncher({ });
+
+    int runs = 0;
+    auto registry = builtin::Registry::Create({
+        std::static_pointer_cast<builtin::Driver>(std::make_shared<Driver>("builtin-write", [&runs](process::Context const *context, Filesystem *filesystem) -> int {
+            runs++;
+            return filesystem->write(std::vector<uint8_t>(), context->commandLineArguments().front()) ? 0 : 1;
+        })),
+    });
+
+    auto context = process::MemoryContext(
+        "",
+        filesystem.path(""),
+        std::vector<std::string>(),
+        std::unordered_map<std::string, std::string>());
+
+    auto invocation = pbxbuild::Tool::Invocation();
+    invocation.executable() = pbxbuild::Tool::Invocation::Executable::Builtin("builtin-write");
+    invocation.arguments() = { filesystem.path("output/file") };
+    invocation.inputs() = { filesystem.path("input") };
+    invocation.outputs() = { filesystem.path("output/file") };
+
+    auto formatter = xcformatter::NullFormatter::Create();
+    std::vector<std::string> const executablePaths = { filesystem.path("") };
+    SimpleExecutor executor = SimpleExecutor(formatter, false, registry, 1, false, true, nullptr);
+    BuildState state;
+
+    /* First build runs the invocation. */
+    EXPECT_TRUE(executor.performInvocations(&context, &launcher, &filesystem, executablePaths, { invocation }, false, &state).first);
+    EXPECT_EQ(1, runs);
+
+    /* Nothing changed, so it is skipped. */
+    EXPECT_TRUE(executor.performInvocations(&context, &launcher, &filesystem, executablePaths, { invocation }, false, &state).first);
+    EXPECT_EQ(1, runs);
+
+    /* Input is newer than the output, so it runs again. */
+    ASSERT_TRUE(filesystem.write(std::vector<uint8_t>(), filesystem.path("input")));
+    EXPECT_TRUE(executor.performInvocations(&context, &launcher, &filesystem, executablePaths, { invocation }, false, &state).first);
+    EXPECT_EQ(2, runs);
+
+    /* Arguments changed, so it runs again. */
+    invocation.environment() = { { "KEY", "value" } };
+    EXPECT_TRUE(executor.performInvocations(&context, &launcher, &filesystem, executablePaths, { invocation }, false, &state).first);
+    EXPECT_EQ(3, runs);
+
+    /* State survives serialization. */
+    ext::optional<BuildState> loaded = BuildState::Deserialize(state.serialize());
+    ASSERT_NE(ext::nullopt, loaded);
+    EXPECT_TRUE(executor.performInvocations(&context, &launcher, &filesystem, executablePaths, { invocation }, false, &*loaded).first);
+    EXPECT_EQ(3, runs);
+}
+
+TEST(SimpleExecutor, IncrementalDeclaredInputs)
+{
+    /* Create in-memory execution environment. */
+    auto filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::File("script.sh", std::vector<uint8_t>()),
+        MemoryFilesystem::Entry::File("input", std::vector<uint8_t>()),
+        MemoryFilesystem::Entry::Directory("output", { }),
+    });
+    auto launcher = process::MemoryLauncher({ });
+
+    int runs = 0;
+    auto registry = builtin::Registry::Create({
+        std::static_pointer_cast<builtin::Driver>(std::make_shared<Driver>("builtin-write", [&runs](process::Context const *context, Filesystem *filesystem) -> int {
+            runs++;
+            return filesystem->write(std::vector<uint8_t>(), context->commandLineArguments().front()) ? 0 : 1;
+        })),
+    });
+
+    auto context = process::MemoryContext(
+        "",
+        filesystem.path(""),
+        std::vector<std::string>(),
+        std::unordered_map<std::string, std::string>());
+
+    /* Like a script phase: the script is an input, declared inputs are phony. */
+    auto invocation = pbxbuild::Tool::Invocation();
+    invocation.executable() = pbxbuild::Tool::Invocation::Executable::Builtin("builtin-write");
+    invocation.arguments() = { filesystem.path("output/file") };
+    invocation.inputs() = { filesystem.path("script.sh") };
+    invocation.phonyInputs() = { filesystem.path("input") };
+    invocation.outputs() = { filesystem.path("output/file") };
+
+    auto formatter = xcformatter::NullFormatter::Create();
+    std::vector<std::string> const executablePaths = { filesystem.path("") };
+    SimpleExecutor executor = SimpleExecutor(formatter, false, registry, 1, false, true, nullptr);
+    BuildState state;
+
+    EXPECT_TRUE(executor.performInvocations(&context, &launcher, &filesystem, executablePaths, { invocation }, false, &state).first);
+    EXPECT_TRUE(executor.performInvocations(&context, &launcher, &filesystem, executablePaths, { invocation }, false, &state).first);
+    EXPECT_EQ(1, runs);
+
+    /* Declared input is newer than the output. */
+    ASSERT_TRUE(filesystem.write(std::vector<uint8_t>(), filesystem.path("input")));
+    EXPECT_TRUE(executor.performInvocations(&context, &launcher, &filesystem, executablePaths, { invocation }, false, &state).first);
+    EXPECT_EQ(2, runs);
+
+    /* Script is newer than the output. */
+    ASSERT_TRUE(filesystem.write(std::vector<uint8_t>({ 'x' }), filesystem.path("script.sh")));
+    EXPECT_TRUE(executor.performInvocations(&context, &launcher, &filesystem, executablePaths, { invocation }, false, &state).first);
+    EXPECT_EQ(3, runs);
+
+    /* Declared input is missing. */
+    ASSERT_TRUE(filesystem.removeFile(filesystem.path("input")));
+    EXPECT_TRUE(executor.performInvocations(&context, &launcher, &filesystem, executablePaths, { invocation }, false, &state).first);
+    EXPECT_EQ(4, runs);
+
+    /* Without declared outputs, it always runs. */
+    invocation.phonyInputs() = { };
+    invocation.outputs() = { };
+    EXPECT_TRUE(executor.performInvocations(&context, &launcher, &filesystem, executablePaths, { invocation }, false, &state).first);
+    EXPECT_TRUE(executor.performInvocations(&context, &launcher, &filesystem, executablePaths, { invocation }, false, &state).first);
+    EXPECT_EQ(6, runs);
+}
+
+TEST(SimpleExecutor, ActionCacheRestoresOutputs)
+{
+    /* Create in-memory execution environment. */
+    auto filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::File("input", std::vector<uint8_t>({ 'i' })),
+        MemoryFilesystem::Entry::Directory("output", { }),
+    });
+    auto launcher = process::MemoryLauncher({ });
+
+    int runs = 0;
+    auto registry = builtin::Registry::Create({
+        std::static_pointer_cast<builtin::Driver>(std::make_shared<Driver>("builtin-write", [&runs](process::Context const *context, Filesystem *filesystem) -> int {
+            runs++;
+            return filesystem->write(std::vector<uint8_t>({ 'o' }), context->commandLineArguments().front()) ? 0 : 1;
+        })),
+    });
+
+    auto context = process::MemoryContext(
+        "",
+        filesystem.path(""),
+        std::vector<std::string>(),
+        std::unordered_map<std::string, std::string>());
+
+    auto invocation = pbxbuild::Tool::Invocation();
+    invocation.executable() = pbxbuild::Tool::Invocation::Executable::Builtin("builtin-write");
+    invocation.arguments() = { filesystem.path("output/file") };
+    invocation.inputs() = { filesystem.path("input") };
+    invocation.outputs() = { filesystem.path("output/file") };
+
+    auto formatter = xcformatter::NullFormatter::Create();
+    std::vector<std::string> const executablePaths = { filesystem.path("") };
+    auto actionCache = ActionCache::Open(&filesystem, filesystem.path("cache"), 1024);
+    SimpleExecutor executor = SimpleExecutor(formatter, false, registry, 1, false, false, actionCache);
+
+    /* First build runs the invocation and stores its output. */
+    EXPECT_TRUE(executor.performInvocations(&context, &launcher, &filesystem, executablePaths, { invocation }, false, nullptr).first);
+    EXPECT_EQ(1, runs);
+
+    /* Output is restored from the cache instead of running again. */
+    ASSERT_TRUE(filesystem.removeFile(filesystem.path("output/file")));
+    EXPECT_TRUE(executor.performInvocations(&context, &launcher, &filesystem, executablePaths, { invocation }, false, nullptr).first);
+    EXPECT_EQ(1, runs);
+
+    std::vector<uint8_t> contents;
+    ASSERT_TRUE(filesystem.read(&contents, filesystem.path("output/file")));
+    EXPECT_EQ(std::vector<uint8_t>({ 'o' }), contents);
+
+    /* Input changed, so it runs again. */
+    ASSERT_TRUE(filesystem.write(std::vector<uint8_t>({ 'j' }), filesystem.path("input")));
+    EXPECT_TRUE(executor.performInvocations(&context, &launcher, &filesystem, executablePaths, { invocation }, false, nullptr).first);
+    EXPECT_EQ(2, runs);
+}
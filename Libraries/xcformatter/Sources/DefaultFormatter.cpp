@@ -237,7 +237,8 @@ beginInvocation(pbxbuild::Tool::Invocation const &invocation, std::string const
         message += INDENT + "cd " + invocation.workingDirectory() + "\n";
 
         if (invocation.showEnvironmentInLog()) {
-            std::map<std::string, std::string> sortedEnvironment = std::map<std::string, std::string>(invocation.environment().begin(), invocation.environment().end());
+            std::unordered_map<std::string, std::string> completeEnvironment = invocation.completeEnvironment();
+            std::map<std::string, std::string> sortedEnvironment = std::map<std::string, std::string>(completeEnvironment.begin(), completeEnvironment.end());
             for (std::pair<std::string, std::string> const &entry : sortedEnvironment) {
                 message += INDENT + "export " + entry.first + "=" + entry.second + "\n";
             }
@@ -16,6 +16,7 @@
 
 #include <memory>
 #include <string>
+#include <unordered_set>
 #include <vector>
 #include <ext/optional>
 
@@ -135,7 +136,13 @@ public:
     static Target::shared_ptr Open(libutil::Filesystem const *filesystem, std::shared_ptr<Manager> manager, std::shared_ptr<Platform>, std::string const &path);
 
 private:
-    bool parse(plist::Dictionary const *dict);
+    bool parse(plist::Dictionary const *dict, std::unordered_set<std::string> *seen, bool check);
+
+private:
+    /*
+     * The keys parsing reads from a settings dictionary.
+     */
+    static std::unordered_set<std::string> const &ParsedKeys();
 };
 
 } }
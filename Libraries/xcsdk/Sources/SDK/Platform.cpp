@@ -319,15 +319,15 @@ Open(Filesystem const *filesystem, std::shared_ptr<Manager> manager, std::string
         return nullptr;
     }
 
-    std::vector<uint8_t> contents;
-    if (!filesystem->read(&contents, settingsFileName)) {
+    ext::optional<libutil::MappedFile> contents = filesystem->map(settingsFileName);
+    if (!contents) {
         return nullptr;
     }
 
     /*
      * Parse platform info property list.
      */
-    auto result = plist::Format::Any::Deserialize(contents);
+    auto result = plist::Format::Any::Deserialize(contents->contents());
     if (result.first == nullptr) {
         return nullptr;
     }
@@ -15,6 +15,8 @@
 #include <plist/Dictionary.h>
 #include <plist/String.h>
 #include <plist/Format/Any.h>
+#include <plist/Format/Binary.h>
+#include <plist/Format/BinaryView.h>
 #include <plist/Keys/Unpack.h>
 #include <libutil/Filesystem.h>
 #include <libutil/FSUtil.h>
@@ -62,11 +64,46 @@ executablePaths() const
     return paths;
 }
 
+static pbxsetting::Level
+ParseProperties(plist::Dictionary const *dict)
+{
+    std::vector<pbxsetting::Setting> settings;
+    for (size_t n = 0; n < dict->count(); n++) {
+        auto key = dict->key(n);
+        auto value = dict->value <plist::String> (key);
+
+        if (value != nullptr) {
+            pbxsetting::Setting setting = pbxsetting::Setting::Parse(key, value->value());
+            settings.push_back(setting);
+        }
+    }
+    return pbxsetting::Level(settings);
+}
+
+static pbxsetting::Level
+ParseProperties(plist::Format::BinaryView::Value const &dict)
+{
+    std::vector<pbxsetting::Setting> settings;
+    for (size_t n = 0; n < dict.count().value_or(0); n++) {
+        ext::optional<std::string> key = dict.key(n);
+        ext::optional<plist::Format::BinaryView::Value> value = dict.value(n);
+        if (!key || !value || value->type() != plist::ObjectType::String) {
+            continue;
+        }
+
+        std::unique_ptr<plist::Object> object = value->copy();
+        if (auto string = plist::CastTo<plist::String>(object.get())) {
+            pbxsetting::Setting setting = pbxsetting::Setting::Parse(*key, string->value());
+            settings.push_back(setting);
+        }
+    }
+    return pbxsetting::Level(settings);
+}
+
 bool Target::
-parse(plist::Dictionary const *dict)
+parse(plist::Dictionary const *dict, std::unordered_set<std::string> *seen, bool check)
 {
-    std::unordered_set<std::string> seen;
-    auto unpack = plist::Keys::Unpack("Target", dict, &seen);
+    auto unpack = plist::Keys::Unpack("Target", dict, seen);
 
     auto Ts    = unpack.cast <plist::Array> ("Toolchains");
     auto CN    = unpack.cast <plist::String> ("CanonicalName");
@@ -87,7 +124,7 @@ parse(plist::Dictionary const *dict)
     /* Ignored: seems to be a typo. */
     (void)unpack.cast <plist::String> ("isBaseSDK");
 
-    if (!unpack.complete(true)) {
+    if (!unpack.complete(check)) {
         fprintf(stderr, "%s", unpack.errorText().c_str());
     }
 
@@ -140,31 +177,11 @@ parse(plist::Dictionary const *dict)
     }
 
     if (CP != nullptr) {
-        std::vector<pbxsetting::Setting> settings;
-        for (size_t n = 0; n < CP->count(); n++) {
-            auto CPK = CP->key(n);
-            auto CPV = CP->value <plist::String> (CPK);
-
-            if (CPV != nullptr) {
-                pbxsetting::Setting setting = pbxsetting::Setting::Parse(CPK, CPV->value());
-                settings.push_back(setting);
-            }
-        }
-        _customProperties = pbxsetting::Level(settings);
+        _customProperties = ParseProperties(CP);
     }
 
     if (DP != nullptr) {
-        std::vector<pbxsetting::Setting> settings;
-        for (size_t n = 0; n < DP->count(); n++) {
-            auto DPK = DP->key(n);
-            auto DPV = DP->value <plist::String> (DPK);
-
-            if (DPV != nullptr) {
-                pbxsetting::Setting setting = pbxsetting::Setting::Parse(DPK, DPV->value());
-                settings.push_back(setting);
-            }
-        }
-        _defaultProperties = pbxsetting::Level(settings);
+        _defaultProperties = ParseProperties(DP);
     }
 
     if (PCFNs != nullptr) {
@@ -200,6 +217,53 @@ parse(plist::Dictionary const *dict)
     return true;
 }
 
+std::unordered_set<std::string> const &Target::
+ParsedKeys()
+{
+    /* Parsing an empty dictionary still asks for every key it handles. */
+    static std::unordered_set<std::string> const keys = [] {
+        std::unordered_set<std::string> seen;
+        auto empty = plist::Dictionary::New();
+        Target().parse(empty.get(), &seen, false);
+        return seen;
+    }();
+    return keys;
+}
+
+/*
+ * Properties are parsed straight from a binary view rather than decoded.
+ */
+static bool
+IsProperties(std::string const &key)
+{
+    return key == "DefaultProperties" || key == "CustomProperties";
+}
+
+static std::unique_ptr<plist::Dictionary>
+LoadSettings(plist::Format::BinaryView::Value const &root, std::unordered_set<std::string> const &keys)
+{
+    auto settings = plist::Dictionary::New();
+    for (size_t n = 0; n < root.count().value_or(0); n++) {
+        ext::optional<std::string> key = root.key(n);
+        ext::optional<plist::Format::BinaryView::Value> value = root.value(n);
+        if (!key || !value) {
+            return nullptr;
+        }
+
+        if (keys.find(*key) == keys.end()) {
+            /* Not decoded, so warn here as parsing would have. */
+            fprintf(stderr, "warning: unhandled Target key %s\n", key->c_str());
+        } else if (IsProperties(*key) && value->type() == plist::ObjectType::Dictionary) {
+            continue;
+        } else if (std::unique_ptr<plist::Object> object = value->copy()) {
+            settings->set(*key, std::move(object));
+        } else {
+            return nullptr;
+        }
+    }
+    return settings;
+}
+
 Target::shared_ptr Target::
 Open(Filesystem const *filesystem, std::shared_ptr<Manager> manager, std::shared_ptr<Platform> platform, std::string const &path)
 {
@@ -223,20 +287,31 @@ Open(Filesystem const *filesystem, std::shared_ptr<Manager> manager, std::shared
         return nullptr;
     }
 
-    std::vector<uint8_t> contents;
-    if (!filesystem->read(&contents, settingsFileName)) {
+    ext::optional<libutil::MappedFile> contents = filesystem->map(settingsFileName);
+    if (!contents) {
         return nullptr;
     }
 
     /*
-     * Parse settings property list.
+     * Parse settings property list. Binary settings can be large; only decode
+     * the keys that are parsed.
      */
-    auto result = plist::Format::Any::Deserialize(contents);
-    if (result.first == nullptr) {
+    std::unique_ptr<plist::Format::BinaryView> view;
+    std::unique_ptr<plist::Object> settings;
+    if (plist::Format::Binary::Identify(contents->contents()) != nullptr) {
+        view = plist::Format::BinaryView::Open(contents->contents()).first;
+        if (view == nullptr || view->root().type() != plist::ObjectType::Dictionary) {
+            return nullptr;
+        }
+        settings = LoadSettings(view->root(), ParsedKeys());
+    } else {
+        settings = plist::Format::Any::Deserialize(contents->contents()).first;
+    }
+    if (settings == nullptr) {
         return nullptr;
     }
 
-    plist::Dictionary *plist = plist::CastTo<plist::Dictionary>(result.first.get());
+    plist::Dictionary *plist = plist::CastTo<plist::Dictionary>(settings.get());
     if (plist == nullptr) {
         return nullptr;
     }
@@ -253,10 +328,24 @@ Open(Filesystem const *filesystem, std::shared_ptr<Manager> manager, std::shared
     /*
      * Parse the settings dictionary.
      */
-    if (!target->parse(plist)) {
+    std::unordered_set<std::string> seen;
+    if (!target->parse(plist, &seen, true)) {
         return nullptr;
     }
 
+    if (view != nullptr) {
+        /* Properties were left out when loading; parse them in place. */
+        auto DP = view->root().value("DefaultProperties");
+        if (DP && DP->type() == plist::ObjectType::Dictionary) {
+            target->_defaultProperties = ParseProperties(*DP);
+        }
+
+        auto CP = view->root().value("CustomProperties");
+        if (CP && CP->type() == plist::ObjectType::Dictionary) {
+            target->_customProperties = ParseProperties(*CP);
+        }
+    }
+
     /*
      * Parse product information.
      */
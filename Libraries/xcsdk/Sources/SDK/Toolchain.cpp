@@ -156,15 +156,15 @@ Open(Filesystem const *filesystem, std::string const &path)
         return nullptr;
     }
 
-    std::vector<uint8_t> contents;
-    if (!filesystem->read(&contents, settingsFileName)) {
+    ext::optional<libutil::MappedFile> contents = filesystem->map(settingsFileName);
+    if (!contents) {
         return nullptr;
     }
 
     /*
      * Parse property list.
      */
-    auto result = plist::Format::Any::Deserialize(contents);
+    auto result = plist::Format::Any::Deserialize(contents->contents());
     if (result.first == nullptr) {
         return nullptr;
     }
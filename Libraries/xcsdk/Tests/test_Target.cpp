@@ -0,0 +1,75 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <gtest/gtest.h>
+#include <xcsdk/SDK/Target.h>
+#include <plist/Dictionary.h>
+#include <plist/String.h>
+#include <plist/Format/Binary.h>
+#include <libutil/MemoryFilesystem.h>
+
+using xcsdk::SDK::Target;
+using libutil::MemoryFilesystem;
+
+static std::vector<uint8_t>
+Contents(std::string const &string)
+{
+    return std::vector<uint8_t>(string.begin(), string.end());
+}
+
+static std::vector<uint8_t>
+BinarySettings()
+{
+    auto defaultProperties = plist::Dictionary::New();
+    defaultProperties->set("PLATFORM_NAME", plist::String::New("test"));
+    auto customProperties = plist::Dictionary::New();
+    customProperties->set("CUSTOM", plist::String::New("$(PLATFORM_NAME)"));
+
+    auto settings = plist::Dictionary::New();
+    settings->set("CanonicalName", plist::String::New("test1.0"));
+    settings->set("DefaultProperties", std::move(defaultProperties));
+    settings->set("CustomProperties", std::move(customProperties));
+    settings->set("Unknown", plist::Dictionary::New());
+
+    return *plist::Format::Binary::Serialize(settings.get(), plist::Format::Binary::Create()).first;
+}
+
+TEST(Target, BinarySettings)
+{
+    auto filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::Directory("Binary.sdk", {
+            MemoryFilesystem::Entry::File("SDKSettings.plist", BinarySettings()),
+        }),
+        MemoryFilesystem::Entry::Directory("ASCII.sdk", {
+            MemoryFilesystem::Entry::File("SDKSettings.plist", Contents("{ \
+                CanonicalName = test1.0; \
+                DefaultProperties = { PLATFORM_NAME = test; }; \
+                CustomProperties = { CUSTOM = \"$(PLATFORM_NAME)\"; }; \
+                Unknown = { }; \
+            }")),
+        }),
+    });
+
+    /* Binary settings are parsed in place, but parse the same. */
+    for (std::string const &name : { "Binary.sdk", "ASCII.sdk" }) {
+        Target::shared_ptr target = Target::Open(&filesystem, nullptr, nullptr, filesystem.path(name));
+        ASSERT_NE(nullptr, target);
+        EXPECT_EQ(std::string("test1.0"), target->canonicalName());
+
+        ASSERT_TRUE(target->defaultProperties());
+        ASSERT_EQ(1u, target->defaultProperties()->settings().size());
+        EXPECT_EQ("PLATFORM_NAME", target->defaultProperties()->settings().front().name());
+        EXPECT_EQ("test", target->defaultProperties()->settings().front().value().raw());
+
+        ASSERT_TRUE(target->customProperties());
+        ASSERT_EQ(1u, target->customProperties()->settings().size());
+        EXPECT_EQ("CUSTOM", target->customProperties()->settings().front().name());
+        EXPECT_EQ("$(PLATFORM_NAME)", target->customProperties()->settings().front().value().raw());
+    }
+}